@@ -0,0 +1,99 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Tag.hpp"
+
+namespace Blam::Tags
+{
+	// A view of a contiguous array of values.
+	template <typename T>
+	struct TagSpan
+	{
+		T *First;
+		T *Last;
+
+		T *begin() const { return First; }
+		T *end() const { return Last; }
+		size_t size() const { return Last - First; }
+		bool empty() const { return First == Last; }
+		T &operator[](size_t index) const { return First[index]; }
+	};
+
+	// Index of the tags in each tag group.
+	//
+	// All of the tag indices are stored in one array, sorted by group and then by index. A sorted array of the group
+	// tags holds where each group's indices start, so finding a group is a binary search and doesn't allocate.
+	// T is what each index is stored as, and must be constructible from a uint16_t.
+	template <typename T>
+	class TagGroupIndex
+	{
+	public:
+		TagGroupIndex() : built(false), tagCount(0) { }
+
+		// Builds the index in one pass over the tag table.
+		// getGroup(uint32_t index) returns the group tag of a tag, or -1 if it isn't loaded.
+		template <typename GetGroupFunc>
+		void Build(uint32_t count, GetGroupFunc &&getGroup)
+		{
+			// Sort (group, index) pairs so that each group's tags end up together and in index order
+			keys.clear();
+			keys.reserve(count);
+			for (uint32_t i = 0; i < count && i < 0xFFFF; i++)
+			{
+				auto group = static_cast<Tag>(getGroup(i));
+				if (group != static_cast<Tag>(-1))
+					keys.push_back(static_cast<uint64_t>(group) << 32 | i);
+			}
+			std::sort(keys.begin(), keys.end());
+
+			groups.clear();
+			entries.clear();
+			entries.reserve(keys.size());
+			for (auto key : keys)
+			{
+				auto group = static_cast<Tag>(key >> 32);
+				if (groups.empty() || groups.back().GroupTag != group)
+					groups.push_back({ group, static_cast<uint32_t>(entries.size()), 0 });
+				groups.back().Count++;
+				entries.emplace_back(static_cast<uint16_t>(key));
+			}
+
+			built = true;
+			tagCount = count;
+		}
+
+		// Marks the index as out of date, so that it is built again the next time it's needed.
+		void Invalidate() { built = false; }
+
+		// Returns true if the index has been built for a tag table of the given size.
+		bool IsBuiltFor(uint32_t count) const { return built && tagCount == count; }
+
+		// Gets the tags in a group. The span is valid until the index is built again.
+		TagSpan<T> Find(Tag groupTag)
+		{
+			auto it = std::lower_bound(groups.begin(), groups.end(), groupTag, [](const Group &group, Tag tag)
+			{
+				return group.GroupTag < tag;
+			});
+			if (it == groups.end() || it->GroupTag != groupTag)
+				return { nullptr, nullptr };
+			auto first = entries.data() + it->First;
+			return { first, first + it->Count };
+		}
+
+	private:
+		struct Group
+		{
+			Tag GroupTag;
+			uint32_t First;
+			uint32_t Count;
+		};
+
+		std::vector<Group> groups;    // Sorted by group tag
+		std::vector<T> entries;       // Tag indices, sorted by group and then by index
+		std::vector<uint64_t> keys;   // Reused while building
+		bool built;
+		uint32_t tagCount;
+	};
+}
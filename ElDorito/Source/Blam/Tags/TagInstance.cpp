@@ -3,6 +3,7 @@
 namespace Blam::Tags
 {
 	std::unordered_map<int32_t, std::string> TagInstance::TagNames = std::unordered_map<int32_t, std::string>();
+	TagGroupIndex<TagInstance> TagInstance::GroupIndex;
 
 	TagInstance::TagInstance(const uint16_t index)
 		: Index(index)
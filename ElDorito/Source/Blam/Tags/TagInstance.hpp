@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include "../../ElDorito.hpp"
 #include "Tags.hpp"
+#include "TagGroupIndex.hpp"
 
 namespace Blam::Tags
 {
@@ -18,6 +19,7 @@ namespace Blam::Tags
 		uint16_t Index;
 
 		static std::unordered_map<int32_t, std::string> TagNames;
+		static TagGroupIndex<TagInstance> GroupIndex;
 
 		TagInstance(const uint16_t index);
 
@@ -90,28 +92,25 @@ namespace Blam::Tags
 		}
 
 		// Gets all valid tag instances within the specified tag group
-		inline static std::vector<TagInstance> GetInstancesInGroup(const Tag groupTag)
+		// The result is only valid until the tags are reloaded
+		inline static TagSpan<TagInstance> GetInstancesInGroup(const Tag groupTag)
 		{
-			auto tagCount = *reinterpret_cast<uint32_t *>(0x22AB008);
-			std::vector<TagInstance> result;
-
-			for (auto i = 0U; i < tagCount; i++)
+			auto tagCount = *MaxTagCountPtr;
+			if (!GroupIndex.IsBuiltFor(tagCount))
 			{
-				auto instance = TagInstance(i);
-
-				if (!IsLoaded(groupTag, instance.Index))
-					continue;
-
-				if (instance.GetDefinition<void>() == nullptr)
-					continue;
-
-				if (instance.GetGroupTag() != groupTag)
-					continue;
-
-				result.push_back(instance);
+				GroupIndex.Build(tagCount, [](uint32_t index)
+				{
+					TagInstance instance(static_cast<uint16_t>(index));
+					return instance.GetDefinition<void>() ? instance.GetGroupTag() : static_cast<Tag>(-1);
+				});
 			}
+			return GroupIndex.Find(groupTag);
+		}
 
-			return result;
+		// Marks the tag group index as out of date after tags are loaded or unloaded
+		inline static void InvalidateGroupIndex()
+		{
+			GroupIndex.Invalidate();
 		}
 
 		// Returns true if the tag of the provided group and index is loaded
@@ -6,6 +6,7 @@
 #include "../Server/BanList.hpp"
 #include "../Utils/Utils.hpp"
 #include "../Utils/Logger.hpp"
+#include "../Utils/CommandTokens.hpp"
 #include "../CommandMap.hpp"
 #include "../Patches/Network.hpp"
 
@@ -170,9 +171,10 @@ namespace ChatCommands
 			}
 		}
 
-		int numArgs = 0;
-		auto args = Modules::CommandLineToArgvA((PCHAR)line.c_str(), &numArgs);
-		std::string cmd = args[0];
+		Utils::CommandTokens args(line);
+		if (args.Empty())
+			return true;
+		std::string cmd(args[0]);
 		std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
 
 		//If we are not already voting, check if the command is initiating one
@@ -189,9 +191,7 @@ namespace ChatCommands
 					return true;
 				}
 				//Now that we know this is the command being invoked, lets prep the argument (if there is one) and pass it in
-				std::vector<std::string> argsVect;
-				for (int i = 1; i < numArgs; i++)
-					argsVect.push_back(args[i]);
+				auto argsVect = args.ToVector(1);
 
 				if (argsVect.size() > 0)
 					elem->processMessage(peer, Utils::String::Join(argsVect));
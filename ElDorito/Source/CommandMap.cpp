@@ -3,6 +3,8 @@
 #include <sstream>
 #include "ElDorito.hpp"
 #include "Blam\BlamNetwork.hpp"
+#include "Utils\CommandTokens.hpp"
+#include "ConfigSnapshot.hpp"
 
 
 namespace Modules
@@ -65,10 +67,18 @@ namespace Modules
 		return ss.str();
 	}
 
-	Command* CommandMap::FindCommand(const std::string& name)
+	namespace
+	{
+		bool NameEquals(const std::string &commandName, std::string_view name)
+		{
+			return commandName.length() > 0 && commandName.length() == name.length() && !_strnicmp(commandName.c_str(), name.data(), name.length());
+		}
+	}
+
+	Command* CommandMap::FindCommand(std::string_view name)
 	{
 		for (auto it = Commands.begin(); it < Commands.end(); it++)
-		if ((it->Name.length() > 0 && !_stricmp(it->Name.c_str(), name.c_str())) || (it->ShortName.length() > 0 && !_stricmp(it->ShortName.c_str(), name.c_str())))
+		if (NameEquals(it->Name, name) || NameEquals(it->ShortName, name))
 			return &(*it);
 
 		return nullptr;
@@ -92,37 +102,62 @@ namespace Modules
 				if (command.UpdateEvent)
 					command.UpdateEvent(std::vector<std::string>(), std::string());
 		}
+		configDirty = true;
+		PublishConfig();
 	}
 
-	std::string CommandMap::ExecuteCommand(std::vector<std::string> command, bool isUserInput)
+	std::string CommandMap::ExecuteCommand(const std::vector<std::string> &command, bool isUserInput)
 	{
-		auto commandEnd = command.end();
-
-		std::stringstream buff;
-		for (auto it = command.begin(); it != commandEnd; ++it)
+		// Bindings store the command name and its raw argument string separately, so tokenize the parts
+		// as if they were joined with spaces instead of joining them into a new string first
+		Utils::CommandTokens tokens;
+		for (auto it = command.begin(); it != command.end(); ++it)
 		{
-			buff << *it;
-			if (it != (commandEnd - 1))
-				buff << " ";
+			if (it != command.begin())
+				tokens.Append(" ");
+			tokens.Append(*it);
 		}
 
-		return ExecuteCommand(buff.str(), isUserInput);
+		auto getLine = [&command]()
+		{
+			std::string line;
+			for (auto it = command.begin(); it != command.end(); ++it)
+			{
+				if (it != command.begin())
+					line += ' ';
+				line += *it;
+			}
+			return line;
+		};
+
+		std::string output;
+		ExecuteTokens(tokens, getLine, isUserInput, &output);
+		if (batchDepth == 0)
+			PublishConfig();
+		return output;
 	}
 
-	bool CommandMap::ExecuteCommandWithStatus(std::string command, bool isUserInput, std::string *output)
+	bool CommandMap::ExecuteCommandWithStatus(std::string_view command, bool isUserInput, std::string *output)
 	{
-		*output = "";
+		Utils::CommandTokens tokens(command);
+		auto result = ExecuteTokens(tokens, [command]() { return std::string(command); }, isUserInput, output);
+		if (batchDepth == 0)
+			PublishConfig();
+		return result;
+	}
 
-		int numArgs = 0;
-		auto args = CommandLineToArgvA((PCHAR)command.c_str(), &numArgs);
+	bool CommandMap::ExecuteTokens(const Utils::CommandTokens &tokens, const std::function<std::string()> &getLine, bool isUserInput, std::string *output)
+	{
+		*output = "";
 
+		auto numArgs = tokens.Count();
 		if (numArgs <= 0)
 		{
 			*output = "Invalid input";
 			return false;
 		}
 
-		auto cmd = FindCommand(args[0]);
+		auto cmd = FindCommand(tokens[0]);
 		if (!cmd || (isUserInput && cmd->Flags & eCommandFlagsInternal))
 		{
 			*output = "Command/Variable not found";
@@ -131,7 +166,7 @@ namespace Modules
 
 		if ((cmd->Flags & eCommandFlagsRunOnMainMenu) && !ElDorito::Instance().GameHasMenuShown)
 		{
-			queuedCommands.push_back(command);
+			queuedCommands.push_back(getLine());
 			*output = "Command queued until mainmenu shows";
 			return true;
 		}
@@ -159,19 +194,16 @@ namespace Modules
 			}
 		}
 
-		std::vector<std::string> argsVect;
-		if (numArgs > 1)
-			for (int i = 1; i < numArgs; i++)
-				argsVect.push_back(args[i]);
-
 		if (cmd->Type == eCommandTypeCommand && cmd->Flags == eCommandFlagsArgsNoParse)
 		{
-			argsVect.clear();
+			std::vector<std::string> argsVect;
 			if (numArgs >= 2)
-				argsVect.push_back(command.substr(std::strlen(args[0]) + 1)); //push unparsed arguments after the command
+				argsVect.push_back(getLine().substr(tokens[0].length() + 1)); //push unparsed arguments after the command
 			return cmd->UpdateEvent(argsVect, *output);
 		}
 
+		auto argsVect = tokens.ToVector(1);
+
 		if (cmd->Type == eCommandTypeCommand)
 			return cmd->UpdateEvent(argsVect, *output); // if it's a command call it and return
 
@@ -181,8 +213,15 @@ namespace Modules
 			return true;
 		}
 
+		return AssignVariable(cmd, argsVect, output);
+	}
+
+	bool CommandMap::AssignVariable(Command *cmd, std::vector<std::string> &arguments, std::string *output)
+	{
+		*output = "";
+
 		std::string previousValue;
-		auto updateRet = SetVariable(cmd, argsVect[0], previousValue);
+		auto updateRet = SetVariable(cmd, arguments[0], previousValue);
 		switch (updateRet)
 		{
 		case eVariableSetReturnValueError:
@@ -193,13 +232,13 @@ namespace Modules
 			return false;
 		case eVariableSetReturnValueOutOfRange:
 			if (cmd->Type == eCommandTypeVariableInt)
-				*output = "Value " + argsVect[0] + " out of range [" + std::to_string(cmd->ValueIntMin) + ".." + std::to_string(cmd->ValueIntMax) + "]";
+				*output = "Value " + arguments[0] + " out of range [" + std::to_string(cmd->ValueIntMin) + ".." + std::to_string(cmd->ValueIntMax) + "]";
 			else if (cmd->Type == eCommandTypeVariableInt64)
-				*output = "Value " + argsVect[0] + " out of range [" + std::to_string(cmd->ValueInt64Min) + ".." + std::to_string(cmd->ValueInt64Max) + "]";
+				*output = "Value " + arguments[0] + " out of range [" + std::to_string(cmd->ValueInt64Min) + ".." + std::to_string(cmd->ValueInt64Max) + "]";
 			else if (cmd->Type == eCommandTypeVariableFloat)
-				*output = "Value " + argsVect[0] + " out of range [" + std::to_string(cmd->ValueFloatMin) + ".." + std::to_string(cmd->ValueFloatMax) + "]";
+				*output = "Value " + arguments[0] + " out of range [" + std::to_string(cmd->ValueFloatMin) + ".." + std::to_string(cmd->ValueFloatMax) + "]";
 			else
-				*output = "Value " + argsVect[0] + " out of range [this shouldn't be happening!]";
+				*output = "Value " + arguments[0] + " out of range [this shouldn't be happening!]";
 			return false;
 		}
 
@@ -209,7 +248,7 @@ namespace Modules
 			return true;
 		}
 
-		auto ret = cmd->UpdateEvent(argsVect, *output);
+		auto ret = cmd->UpdateEvent(arguments, *output);
 
 		if (!ret) // error, revert the variable
 			this->SetVariable(cmd, previousValue, std::string());
@@ -220,7 +259,7 @@ namespace Modules
 		return ret;
 	}
 
-	std::string CommandMap::ExecuteCommand(std::string command, bool isUserInput)
+	std::string CommandMap::ExecuteCommand(std::string_view command, bool isUserInput)
 	{
 		std::string output;
 		ExecuteCommandWithStatus(command, isUserInput, &output);
@@ -400,29 +439,39 @@ namespace Modules
 		return ss.str();
 	}
 
-	std::string CommandMap::ExecuteCommands(std::string& commands, bool isUserInput)
+	std::string CommandMap::ExecuteCommands(const std::string& commands, bool isUserInput)
 	{
-		std::istringstream stream(commands);
 		std::stringstream ss;
-		std::string line;
 		std::string output;
 		int lineIdx = 0;
-		while (std::getline(stream, line))
+		size_t lineStart = 0;
+		batchDepth++; // Publish the whole file at once
+		while (lineStart < commands.length())
 		{
-			line.erase(line.find_last_not_of("\r") + 1);
+			auto lineEnd = commands.find('\n', lineStart);
+			if (lineEnd == std::string::npos)
+				lineEnd = commands.length();
+
+			std::string_view line(commands.data() + lineStart, lineEnd - lineStart);
+			while (!line.empty() && line.back() == '\r')
+				line.remove_suffix(1);
+
 			if (!this->ExecuteCommandWithStatus(line, isUserInput, &output))
 			{
 				ss << "Error at line " << lineIdx << std::endl;
 			}
 			lineIdx++;
+			lineStart = lineEnd + 1;
 		}
+		if (--batchDepth == 0)
+			PublishConfig();
 		return ss.str();
 	}
 
 	std::string CommandMap::ExecuteQueue()
 	{
 		std::stringstream ss;
-		for (auto cmd : queuedCommands)
+		for (auto &&cmd : queuedCommands)
 		{
 			ss << ExecuteCommand(cmd, true) << std::endl;
 		}
@@ -432,6 +481,7 @@ namespace Modules
 
 	void CommandMap::NotifyVariableUpdated(const Command *command)
 	{
+		configDirty = true;
 		for (auto &&callback : variableUpdateCallbacks)
 			callback(command);
 	}
@@ -440,92 +490,19 @@ namespace Modules
 	{
 		variableUpdateCallbacks.push_back(callback);
 	}
-}
 
-namespace Modules
-{
-	PCHAR* CommandLineToArgvA(PCHAR CmdLine, int* _argc)
+	void CommandMap::PublishConfig()
 	{
-		PCHAR* argv;
-		PCHAR  _argv;
-		ULONG   len;
-		ULONG   argc;
-		CHAR   a;
-		ULONG   i, j;
-
-		BOOLEAN  in_QM;
-		BOOLEAN  in_TEXT;
-		BOOLEAN  in_SPACE;
-
-		len = strlen(CmdLine);
-		i = ((len + 2) / 2)*sizeof(PVOID)+sizeof(PVOID);
-
-		argv = (PCHAR*)GlobalAlloc(GMEM_FIXED,
-			i + (len + 2)*sizeof(CHAR));
-
-		if (!argv)
-			return 0;
-
-		_argv = (PCHAR)(((PUCHAR)argv) + i);
-
-		argc = 0;
-		argv[argc] = _argv;
-		in_QM = FALSE;
-		in_TEXT = FALSE;
-		in_SPACE = TRUE;
-		i = 0;
-		j = 0;
-
-		while (a = CmdLine[i]) {
-			if (in_QM) {
-				if (a == '\"') {
-					in_QM = FALSE;
-				}
-				else {
-					_argv[j] = a;
-					j++;
-				}
-			}
-			else {
-				switch (a) {
-				case '\"':
-					in_QM = TRUE;
-					in_TEXT = TRUE;
-					if (in_SPACE) {
-						argv[argc] = _argv + j;
-						argc++;
-					}
-					in_SPACE = FALSE;
-					break;
-				case ' ':
-				case '\t':
-				case '\n':
-				case '\r':
-					if (in_TEXT) {
-						_argv[j] = '\0';
-						j++;
-					}
-					in_TEXT = FALSE;
-					in_SPACE = TRUE;
-					break;
-				default:
-					in_TEXT = TRUE;
-					if (in_SPACE) {
-						argv[argc] = _argv + j;
-						argc++;
-					}
-					_argv[j] = a;
-					j++;
-					in_SPACE = FALSE;
-					break;
-				}
-			}
-			i++;
-		}
-		_argv[j] = '\0';
-		argv[argc] = NULL;
+		// Cleared before reading the variables so that a change made while the snapshot is built gets its own publish
+		if (!configDirty.exchange(false))
+			return;
 
-		(*_argc) = argc;
-		return argv;
+		auto snapshot = std::make_shared<ConfigSnapshot>();
+		for (auto &&command : Commands)
+		{
+			if (command.Type != eCommandTypeCommand)
+				snapshot->Set(&command, { command.ValueString, command.ValueInt, command.ValueInt64, command.ValueFloat });
+		}
+		ConfigSnapshot::Publish(std::move(snapshot));
 	}
-}
\ No newline at end of file
+}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <deque>
+#include <string_view>
 #include <Windows.h>
 #include <functional>
 
@@ -35,10 +37,13 @@ enum CommandFlags
 
 typedef bool (*CommandUpdateFunc)(const std::vector<std::string>& Arguments, std::string& returnInfo);
 
-namespace Modules
+namespace Utils
 {
-	PCHAR* CommandLineToArgvA(PCHAR CmdLine, int* _argc);
+	class CommandTokens;
+}
 
+namespace Modules
+{
 	enum CommandType
 	{
 		eCommandTypeCommand,
@@ -98,17 +103,21 @@ namespace Modules
 
 		Command* AddCommand(Command command);
 		void FinishAddCommands();
-		Command* FindCommand(const std::string& name);
+		Command* FindCommand(std::string_view name);
 
-		std::string ExecuteCommand(std::vector<std::string> command, bool isUserInput = false);
-		std::string ExecuteCommand(std::string command, bool isUserInput = false);
-		std::string ExecuteCommands(std::string& commands, bool isUserInput = false);
-		bool ExecuteCommandWithStatus(std::string command, bool isUserInput, std::string *output);
+		std::string ExecuteCommand(const std::vector<std::string> &command, bool isUserInput = false);
+		std::string ExecuteCommand(std::string_view command, bool isUserInput = false);
+		std::string ExecuteCommands(const std::string& commands, bool isUserInput = false);
+		bool ExecuteCommandWithStatus(std::string_view command, bool isUserInput, std::string *output);
 		std::string ExecuteQueue();
 
 		void OnVariableUpdate(VariableUpdateCallback callback);
 		void NotifyVariableUpdated(const Command *command);
 
+		// Publishes a new ConfigSnapshot if any variable changed since the last one.
+		// This happens after every command or config file, call it after setting variables some other way.
+		void PublishConfig();
+
 		bool GetVariableInt(const std::string& name, unsigned long& value);
 		bool GetVariableInt64(const std::string& name, unsigned long long& value);
 		bool GetVariableFloat(const std::string& name, float& value);
@@ -117,12 +126,22 @@ namespace Modules
 		VariableSetReturnValue SetVariable(const std::string& name, std::string& value, std::string& previousValue);
 		VariableSetReturnValue SetVariable(Command* command, std::string& value, std::string& previousValue);
 
+		// Sets a variable to the first argument and runs its update event, reverting the variable if the event fails.
+		// This is what executing "Variable value" does, minus the command lookup and flag checks.
+		bool AssignVariable(Command *cmd, std::vector<std::string> &arguments, std::string *output);
+
 		std::string GenerateHelpText(std::string moduleFilter = "");
 
 		std::string SaveVariables();
 		std::string SaveKeys();
 	private:
+		// getLine is only called when the original text of the command is needed
+		bool ExecuteTokens(const Utils::CommandTokens &tokens, const std::function<std::string()> &getLine, bool isUserInput, std::string *output);
+
 		std::vector<std::string> queuedCommands;
 		std::vector<VariableUpdateCallback> variableUpdateCallbacks;
+		// Atomic because rcon executes commands on its own thread, so variables can change and get published from there too
+		std::atomic<bool> configDirty { false };
+		int batchDepth = 0;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "ConfigSnapshot.hpp"
+#include <atomic>
+#include <mutex>
+
+namespace
+{
+	const Modules::ConfigSnapshot::Value EmptyValue = { "", 0, 0, 0.f };
+
+	std::shared_ptr<const Modules::ConfigSnapshot> current = std::make_shared<Modules::ConfigSnapshot>();
+	std::atomic<uint64_t> currentVersion(0);
+
+	// Only publishers take this, so that versions are published in order
+	std::mutex publishMutex;
+}
+
+namespace Modules
+{
+	ConfigSnapshot::ConfigSnapshot() : version(0)
+	{
+	}
+
+	void ConfigSnapshot::Set(const Command *variable, Value value)
+	{
+		values[variable] = std::move(value);
+	}
+
+	bool ConfigSnapshot::Contains(const Command *variable) const
+	{
+		return values.find(variable) != values.end();
+	}
+
+	const std::string &ConfigSnapshot::GetString(const Command *variable) const
+	{
+		return Get(variable).String;
+	}
+
+	unsigned long ConfigSnapshot::GetInt(const Command *variable) const
+	{
+		return Get(variable).Int;
+	}
+
+	unsigned long long ConfigSnapshot::GetInt64(const Command *variable) const
+	{
+		return Get(variable).Int64;
+	}
+
+	float ConfigSnapshot::GetFloat(const Command *variable) const
+	{
+		return Get(variable).Float;
+	}
+
+	const ConfigSnapshot::Value &ConfigSnapshot::Get(const Command *variable) const
+	{
+		auto it = values.find(variable);
+		return it != values.end() ? it->second : EmptyValue;
+	}
+
+	std::shared_ptr<const ConfigSnapshot> ConfigSnapshot::Current()
+	{
+		return std::atomic_load(&current);
+	}
+
+	uint64_t ConfigSnapshot::CurrentVersion()
+	{
+		return currentVersion.load(std::memory_order_acquire);
+	}
+
+	void ConfigSnapshot::Publish(std::shared_ptr<ConfigSnapshot> snapshot)
+	{
+		std::lock_guard<std::mutex> lock(publishMutex);
+		auto version = currentVersion.load(std::memory_order_relaxed) + 1;
+		snapshot->version = version;
+		std::atomic_store(&current, std::shared_ptr<const ConfigSnapshot>(std::move(snapshot)));
+		currentVersion.store(version, std::memory_order_release);
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace Modules
+{
+	struct Command;
+
+	// An immutable copy of every variable's value, for threads other than the game thread.
+	//
+	// Variables can only be safely read and written on the game thread. The command map publishes a new
+	// snapshot after each batch of changes, and background threads read values from the current snapshot
+	// instead. A snapshot never changes once published, so it can be held on to for as long as needed.
+	class ConfigSnapshot
+	{
+	public:
+		struct Value
+		{
+			std::string String;
+			unsigned long Int;
+			unsigned long long Int64;
+			float Float;
+		};
+
+		ConfigSnapshot();
+
+		// Only used while building a snapshot, before it's published.
+		void Set(const Command *variable, Value value);
+
+		// The version is assigned when the snapshot is published, and increases with every publish.
+		uint64_t GetVersion() const { return version; }
+
+		bool Contains(const Command *variable) const;
+
+		// Missing variables read as empty/zero.
+		const std::string &GetString(const Command *variable) const;
+		unsigned long GetInt(const Command *variable) const;
+		unsigned long long GetInt64(const Command *variable) const;
+		float GetFloat(const Command *variable) const;
+
+		// Gets the most recently published snapshot. Never returns null, and never waits for a publish in progress
+		// (building the snapshot happens before it's published, swapping it in is just a pointer exchange).
+		static std::shared_ptr<const ConfigSnapshot> Current();
+
+		// Gets the version of the current snapshot without taking a reference to it,
+		// so a worker can cheaply check whether anything changed since it last looked.
+		static uint64_t CurrentVersion();
+
+		// Makes a snapshot the current one. Readers holding the previous snapshot keep it alive until they're done with it.
+		static void Publish(std::shared_ptr<ConfigSnapshot> snapshot);
+
+	private:
+		const Value &Get(const Command *variable) const;
+
+		uint64_t version;
+		std::unordered_map<const Command*, Value> values;
+	};
+}
@@ -1,51 +1,98 @@
 #include "Console.hpp"
-#include "Utils/String.hpp"
+#include <algorithm>
 #include <vector>
-#include "Utils/Logger.hpp"
+#include <boost/lockfree/queue.hpp>
 
 using namespace Console;
 
 namespace
 {
-	std::vector<std::shared_ptr<ConsoleOutputHandler>> Handlers;
+	// Output written beyond this in one tick waits for the next flush
+	const size_t MaxRecordsPerFlush = 4096;
 
-	class LogConsoleOutputHandler : public ConsoleOutputHandler
+	struct RegisteredHandler
 	{
-	public:
-		void WriteLine(const std::string &line) override;
+		std::shared_ptr<ConsoleOutputHandler> Handler;
+		OutputFilter Filter;
 	};
+
+	std::vector<RegisteredHandler> Handlers;
+
+	// Can't queue the records themselves because lockfree queue entries must be trivially assignable
+	boost::lockfree::queue<OutputRecord*> PendingRecords(256);
+
+	// Frees the records which were written after the last flush when the DLL is unloaded
+	struct PendingRecordsCleanup
+	{
+		~PendingRecordsCleanup()
+		{
+			OutputRecord *record;
+			while (PendingRecords.pop(record))
+				delete record;
+		}
+	} Cleanup;
 }
 
 namespace Console
 {
-	void Init()
+	bool OutputFilter::Matches(const OutputRecord &record) const
 	{
-		// Register a log output by default
-		RegisterHandler(std::make_shared<LogConsoleOutputHandler>());
+		if (record.Level < MinLevel)
+			return false;
+		return Modules.empty() || std::find(Modules.begin(), Modules.end(), record.Module) != Modules.end();
 	}
 
 	void WriteLine(const std::string &line)
 	{
-		// Split the string into lines and send each line to each handler
+		WriteLine(OutputLevel::Info, "", line);
+	}
+
+	void WriteLine(OutputLevel level, const std::string &module, const std::string &line)
+	{
+		// Split the string into lines and queue a record for each line
 		// This makes things easy for all of the handlers
-		auto lines = Utils::String::SplitString(line, '\n');
-		for (auto &&lineToPrint : lines)
+		auto time = std::chrono::system_clock::now();
+		size_t start = 0;
+		while (start < line.length())
 		{
-			for (auto &&handler : Handlers)
-				handler->WriteLine(lineToPrint);
+			auto end = line.find('\n', start);
+			if (end == std::string::npos)
+				end = line.length();
+			PendingRecords.push(new OutputRecord{ level, module, time, line.substr(start, end - start) });
+			start = end + 1;
 		}
 	}
 
-	void RegisterHandler(std::shared_ptr<ConsoleOutputHandler> handler)
+	void RegisterHandler(std::shared_ptr<ConsoleOutputHandler> handler, const OutputFilter &filter)
 	{
-		Handlers.push_back(handler);
+		Handlers.push_back({ handler, filter });
 	}
-}
 
-namespace
-{
-	void LogConsoleOutputHandler::WriteLine(const std::string &line)
+	void Flush()
 	{
-		Utils::Logger::Instance().Log(Utils::LogTypes::Debug, Utils::LogLevel::Info, "%s", line.c_str());
+		static std::vector<OutputRecord*> records;
+		static std::vector<const OutputRecord*> handlerRecords;
+
+		OutputRecord *record;
+		while (records.size() < MaxRecordsPerFlush && PendingRecords.pop(record))
+			records.push_back(record);
+		if (records.empty())
+			return;
+
+		for (auto &&handler : Handlers)
+		{
+			handlerRecords.clear();
+			for (auto record : records)
+			{
+				if (handler.Filter.Matches(*record))
+					handlerRecords.push_back(record);
+			}
+			if (!handlerRecords.empty())
+				handler.Handler->WriteRecords(handlerRecords);
+		}
+
+		for (auto record : records)
+			delete record;
+		records.clear();
 	}
-}
\ No newline at end of file
+}
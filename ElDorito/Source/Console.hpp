@@ -1,25 +1,61 @@
 #pragma once
+#include <chrono>
 #include <string>
 #include <memory>
+#include <vector>
 
+// Console output is queued as records and delivered to the handlers in batches once per tick,
+// so it can be written from any thread.
 namespace Console
 {
+	enum class OutputLevel
+	{
+		Trace,
+		Info,
+		Warning,
+		Error
+	};
+
+	// A single line of console output.
+	struct OutputRecord
+	{
+		OutputLevel Level;
+		std::string Module; // The part of the game which wrote the line (e.g. "Server"), empty for command output
+		std::chrono::system_clock::time_point Time;
+		std::string Text;
+	};
+
+	// Selects the records a handler receives.
+	struct OutputFilter
+	{
+		OutputLevel MinLevel = OutputLevel::Trace;
+
+		// If not empty, only records from these modules are received.
+		std::vector<std::string> Modules;
+
+		bool Matches(const OutputRecord &record) const;
+	};
+
 	// Base class for objects which handle console output.
 	class ConsoleOutputHandler
 	{
 	public:
 		virtual ~ConsoleOutputHandler() {}
 
-		// Writes a line to the output.
-		virtual void WriteLine(const std::string &line) = 0;
+		// Writes the records which passed the handler's filter since the last flush, in the order they were written.
+		virtual void WriteRecords(const std::vector<const OutputRecord*> &records) = 0;
 	};
 
-	// Initializes the console.
+	// Initializes the console and registers the handler which writes output to the log.
 	void Init();
 
 	// Writes one or more lines to the console.
 	void WriteLine(const std::string &line);
+	void WriteLine(OutputLevel level, const std::string &module, const std::string &line);
 
 	// Registers an output handler.
-	void RegisterHandler(std::shared_ptr<ConsoleOutputHandler> handler);
+	void RegisterHandler(std::shared_ptr<ConsoleOutputHandler> handler, const OutputFilter &filter = OutputFilter());
+
+	// Delivers the queued output to the handlers. Called once per tick on the main thread.
+	void Flush();
 }
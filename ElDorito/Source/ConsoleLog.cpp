@@ -0,0 +1,52 @@
+#include "Console.hpp"
+#include "Utils/Logger.hpp"
+
+using namespace Console;
+
+namespace
+{
+	// Writes console output to the log
+	class LogConsoleOutputHandler : public ConsoleOutputHandler
+	{
+	public:
+		void WriteRecords(const std::vector<const OutputRecord*> &records) override;
+	};
+}
+
+namespace Console
+{
+	void Init()
+	{
+		// Register a log output by default
+		RegisterHandler(std::make_shared<LogConsoleOutputHandler>());
+	}
+}
+
+namespace
+{
+	Utils::LogLevel ToLogLevel(OutputLevel level)
+	{
+		switch (level)
+		{
+		case OutputLevel::Trace:
+			return Utils::LogLevel::Trace;
+		case OutputLevel::Warning:
+			return Utils::LogLevel::Warning;
+		case OutputLevel::Error:
+			return Utils::LogLevel::Error;
+		default:
+			return Utils::LogLevel::Info;
+		}
+	}
+
+	void LogConsoleOutputHandler::WriteRecords(const std::vector<const OutputRecord*> &records)
+	{
+		for (auto record : records)
+		{
+			if (record->Module.empty())
+				Utils::Logger::Instance().Log(Utils::LogTypes::Debug, ToLogLevel(record->Level), "%s", record->Text.c_str());
+			else
+				Utils::Logger::Instance().Log(Utils::LogTypes::Debug, ToLogLevel(record->Level), "[%s] %s", record->Module.c_str(), record->Text.c_str());
+		}
+	}
+}
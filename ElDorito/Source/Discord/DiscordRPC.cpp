@@ -7,6 +7,7 @@
 #include "../Patches/Core.hpp"
 #include "../Modules/ModuleServer.hpp"
 #include "../Modules/ModuleGame.hpp"
+#include "../ConfigSnapshot.hpp"
 #include "../Web/Ui/ScreenLayer.hpp"
 #include "../ThirdParty/rapidjson/stringbuffer.h"
 #include "../ThirdParty/rapidjson/writer.h"
@@ -189,7 +190,10 @@ namespace
 				extIp = std::string(req.responseBody.begin(), req.responseBody.end() - 1);
 			else
 				extIp = std::string(req.responseBody.begin(), req.responseBody.end());
-			Discord::DiscordRPC::Instance().SetJoinString(extIp + ":" + Modules::ModuleServer::Instance().VarServerPort->ValueString + " " + Modules::ModuleServer::Instance().VarServerPassword->ValueString);
+			auto config = Modules::ConfigSnapshot::Current();
+			auto &port = config->GetString(Modules::ModuleServer::Instance().VarServerPort);
+			auto &password = config->GetString(Modules::ModuleServer::Instance().VarServerPassword);
+			Discord::DiscordRPC::Instance().SetJoinString(extIp + ":" + port + " " + password);
 			return true;
 		}
 
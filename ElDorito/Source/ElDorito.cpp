@@ -1,6 +1,10 @@
 #include "ElDorito.hpp"
 
 #include "Utils/Utils.hpp"
+#include "Utils/DisplayModes.hpp"
+#include "Utils/Logger.hpp"
+#include "Utils/LaunchOptions.hpp"
+#include "Utils/UpdateEngine.hpp"
 #include "ElPatches.hpp"
 #include "Patches/Network.hpp"
 #include "Server/DedicatedServer.hpp"
@@ -22,6 +26,7 @@
 #include "Web/Ui/WebVirtualKeyboard.hpp"
 #include "ElModules.hpp"
 #include "Modules/ModuleGame.hpp"
+#include "Modules/ModuleServer.hpp"
 #include "Patch.hpp"
 #include "Modules/ModuleCamera.hpp"
 #include "Modules/ModuleInput.hpp"
@@ -30,6 +35,11 @@
 #include "Patches/Weapon.hpp"
 #include "Patches/Memory.hpp"
 #include "Patches/Camera.hpp"
+#include "Patches/PlayerUid.hpp"
+#include "Patches/ContentItems.hpp"
+#include "Patches/CustomPackets.hpp"
+#include "Modules/ModuleUPnP.hpp"
+#include "Blam/Tags/TagInstance.hpp"
 #include "Discord/DiscordRPC.h"
 #include "ThirdParty/SOP.hpp"
 
@@ -38,7 +48,6 @@
 #include <Windows.h>
 #include <TlHelp32.h>
 #include <ShlObj.h>
-#include <codecvt>
 #include <detours.h>
 #include "Web/Ui/WebSettings.hpp"
 
@@ -48,6 +57,34 @@ ElDorito::ElDorito()
 {
 }
 
+namespace
+{
+	// Sets a variable given on the command line. Variables are set directly, anything which needs the checks
+	// in ExecuteCommand (commands, internal or host-only variables, or ones queued until the main menu) goes through it.
+	void ApplyVariableOverride(const Utils::LaunchOptions::VariableOverride &variable)
+	{
+		auto &commandMap = Modules::CommandMap::Instance();
+		auto command = commandMap.FindCommand(variable.Name);
+		if (!command)
+		{
+			Utils::Logger::Instance().Log(Utils::LogTypes::Debug, Utils::LogLevel::Warning, "Command line: unknown variable %s", variable.Name.c_str());
+			return;
+		}
+
+		const auto checkedFlags = eCommandFlagsInternal | eCommandFlagsRunOnMainMenu | eCommandFlagsCheat | eCommandFlagsHostOnly | eCommandFlagsForge;
+		if (command->Type == eCommandTypeCommand || (command->Flags & checkedFlags))
+		{
+			commandMap.ExecuteCommand(variable.Name + " \"" + variable.Value + "\"", true);
+			return;
+		}
+
+		std::vector<std::string> arguments{ variable.Value };
+		std::string output;
+		if (!commandMap.AssignVariable(command, arguments, &output))
+			Utils::Logger::Instance().Log(Utils::LogTypes::Debug, Utils::LogLevel::Warning, "Command line: %s: %s", variable.Name.c_str(), output.c_str());
+	}
+}
+
 bool(__cdecl * ElDorito::Video_InitD3D)(bool, bool) = (bool(__cdecl *) (bool, bool)) 0xA21B40;
 
 bool __cdecl ElDorito::hooked_Video_InitD3D(bool windowless, bool nullRefDevice) {
@@ -83,203 +120,244 @@ void ElDorito::killProcessByName(const char *filename, int ourProcessID)
 
 void ElDorito::Initialize()
 {
-	::CreateDirectoryA(GetDirectory().c_str(), NULL);
+	using Utils::StageScheduler;
 
-	if (!SOP_CheckProfile("ElDewrito"))
-	{
-		SOP_SetProfile("ElDewrito", "eldorado.exe");
-	}
-
-	// Parse command-line commands
-	int numArgs = 0;
-	LPWSTR* szArgList = CommandLineToArgvW(GetCommandLineW(), &numArgs);
+	// Initialize runs under the loader lock, so the worker stages can't start until it returns. Nothing on the
+	// caller thread may depend on them; whatever needs their results waits with WaitForStartupStage() later.
+	std::string ed_appdata;
 
-	//Check for the instance switch before initializing anything
-	if (szArgList && numArgs > 1)
+	startup.Add("directories", StageScheduler::StageThread::Caller, {}, [&]
 	{
-		for (int i = 1; i < numArgs; i++)
+		::CreateDirectoryA(GetDirectory().c_str(), NULL);
+
+		if (!SOP_CheckProfile("ElDewrito"))
 		{
-			std::wstring arg = std::wstring(szArgList[i]);
-			if (arg.compare(L"-instance") == 0 && i < numArgs - 1)
-			{
-				instanceName = Utils::String::ThinString(szArgList[i + 1]);
-			}
+			SOP_SetProfile("ElDewrito", "eldorado.exe");
 		}
-	}
 
-	// init our command modules
-	Console::Init();
-	Modules::ElModules::Instance();
-	Server::TempBanList::Instance();
-
-	//Get the local appdata folder
-	PWSTR localAppdata;
-	SHGetKnownFolderPath(FOLDERID_LocalAppData, NULL, NULL, &localAppdata);
-	auto wide_ed_appdata = std::wstring(localAppdata);
-	auto ed_appdata = Utils::String::ThinString(wide_ed_appdata);
-	ed_appdata += "\\ElDewrito";
-	::CreateDirectoryA(ed_appdata.c_str(), NULL);
-
-	// load variables/commands from cfg file
-	// If instancing is enabled then load the instanced dewrito_prefs.cfg
-	if (instanceName != "")
-	{
-		std::stringstream keystream;
-		keystream << "Execute dewrito_prefs_" << instanceName << ".cfg";
-		Modules::CommandMap::Instance().ExecuteCommand(keystream.str());
+		//Get the local appdata folder
+		PWSTR localAppdata;
+		SHGetKnownFolderPath(FOLDERID_LocalAppData, NULL, NULL, &localAppdata);
+		auto wide_ed_appdata = std::wstring(localAppdata);
+		ed_appdata = Utils::String::ThinString(wide_ed_appdata);
+		ed_appdata += "\\ElDewrito";
+		::CreateDirectoryA(ed_appdata.c_str(), NULL);
+	});
 
-		std::stringstream ss;
-		ss << "Execute \"" << ed_appdata << "\\keys_" << instanceName << ".cfg\"";
-		Modules::CommandMap::Instance().ExecuteCommand(ss.str());
-	}
-	else
+	startup.Add("update", StageScheduler::StageThread::Caller, {}, [this]
 	{
-		std::stringstream ss;
-		ss << "Execute dewrito_prefs.cfg";
-		Modules::CommandMap::Instance().ExecuteCommand(ss.str());
-
-		std::stringstream keystream;
-		keystream << "Execute \"" << ed_appdata << "\\keys.cfg\"";
-		Modules::CommandMap::Instance().ExecuteCommand(keystream.str());
-	}
-	Modules::CommandMap::Instance().ExecuteCommand("Execute autoexec.cfg"); // also execute autoexec, which is a user-made cfg guaranteed not to be overwritten by ElDew
-
-	// maybe use an unordered_map here
-	if (!Modules::ModuleInput::Instance().IsCommandBound("game.takescreenshot"))
-		Modules::CommandMap::Instance().ExecuteCommand("Bind PrintScreen Game.TakeScreenshot");
-	if (!Modules::ModuleInput::Instance().IsCommandBound("game.showscreen discord"))
-		Modules::CommandMap::Instance().ExecuteCommand("Bind F4 Game.ShowScreen discord");
-	if (!Modules::ModuleInput::Instance().IsCommandBound("game.showscreen browser"))
-		Modules::CommandMap::Instance().ExecuteCommand("Bind F11 game.showscreen browser");
-
-	mapsFolder = "maps\\";
+		// Staged update files have to be swapped in before anything (even the config) is read from them
+		std::string error;
+		if (!Utils::UpdateEngine::InstallStaged(GetDirectory(), &error))
+			Utils::Logger::Instance().Log(Utils::LogTypes::Game, Utils::LogLevel::Error, "Failed to install update: %s", error.c_str());
+	});
 
-	skipTitleSplash = Modules::ModuleGame::Instance().VarSkipTitleSplash->ValueInt == 1;
+	startup.Add("instance", StageScheduler::StageThread::Caller, {}, [this]
+	{
+		//Check for the instance switch before initializing anything
+		instanceName = Utils::LaunchOptions::Get().InstanceName;
+	});
 
-	if( szArgList && numArgs > 1 )
+	startup.Add("modules", StageScheduler::StageThread::Caller, { "instance" }, []
 	{
-		std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+		// init our command modules
+		Console::Init();
+		Modules::ElModules::Instance();
+		Server::TempBanList::Instance();
+	});
 
-		for( int i = 1; i < numArgs; i++ )
+	startup.Add("config", StageScheduler::StageThread::Caller, { "directories", "modules", "update" }, [&]
+	{
+		// load variables/commands from cfg file
+		// If instancing is enabled then load the instanced dewrito_prefs.cfg
+		if (instanceName != "")
 		{
-			std::wstring arg = std::wstring(szArgList[i]);
-			if (arg.compare(0, 1, L"-") != 0) // if it doesn't start with -
-				continue;
+			std::stringstream keystream;
+			keystream << "Execute dewrito_prefs_" << instanceName << ".cfg";
+			Modules::CommandMap::Instance().ExecuteCommand(keystream.str());
 
-			if (arg.compare(L"-dedicated") == 0 || arg.compare(L"-headless") == 0)
-			{
-				isDedicated = true;
-				Modules::CommandMap::Instance().ExecuteCommand("Server.Dedicated 1");
-			}
+			std::stringstream ss;
+			ss << "Execute \"" << ed_appdata << "\\keys_" << instanceName << ".cfg\"";
+			Modules::CommandMap::Instance().ExecuteCommand(ss.str());
+		}
+		else
+		{
+			std::stringstream ss;
+			ss << "Execute dewrito_prefs.cfg";
+			Modules::CommandMap::Instance().ExecuteCommand(ss.str());
 
-			if (arg.compare(L"-maps") == 0 && i < numArgs - 1)
-			{
-				mapsFolder = Utils::String::ThinString(szArgList[i + 1]);
-				if (mapsFolder.length() > 0 && mapsFolder.back() != '\\' && mapsFolder.back() != '/')
-					mapsFolder += "\\";
-			}
+			std::stringstream keystream;
+			keystream << "Execute \"" << ed_appdata << "\\keys.cfg\"";
+			Modules::CommandMap::Instance().ExecuteCommand(keystream.str());
+		}
+		Modules::CommandMap::Instance().ExecuteCommand("Execute autoexec.cfg"); // also execute autoexec, which is a user-made cfg guaranteed not to be overwritten by ElDew
+	});
 
-			if (arg.compare(L"-webdebug") == 0)
-				webDebugging = true;
+	startup.Add("default-binds", StageScheduler::StageThread::Caller, { "config" }, []
+	{
+		// maybe use an unordered_map here
+		if (!Modules::ModuleInput::Instance().IsCommandBound("game.takescreenshot"))
+			Modules::CommandMap::Instance().ExecuteCommand("Bind PrintScreen Game.TakeScreenshot");
+		if (!Modules::ModuleInput::Instance().IsCommandBound("game.showscreen discord"))
+			Modules::CommandMap::Instance().ExecuteCommand("Bind F4 Game.ShowScreen discord");
+		if (!Modules::ModuleInput::Instance().IsCommandBound("game.showscreen browser"))
+			Modules::CommandMap::Instance().ExecuteCommand("Bind F11 game.showscreen browser");
+	});
+
+	startup.Add("player-uid", StageScheduler::StageThread::Caller, { "config" }, []
+	{
+		// The keys are in the config now, so the UID can be loaded (or a keypair started generating)
+		Patches::PlayerUid::Initialize();
+	});
 
-			if (arg.compare(L"-connect") == 0 && i < numArgs - 1)
-			{
-				serverAddress = Utils::String::ThinString(szArgList[i + 1]);
-				connectToServer = true;
-			}
+	startup.Add("arguments", StageScheduler::StageThread::Caller, { "config" }, [this]
+	{
+		auto &options = Utils::LaunchOptions::Get();
+		for (auto &&error : options.Errors)
+			Utils::Logger::Instance().Log(Utils::LogTypes::Debug, Utils::LogLevel::Warning, "Command line: %s", error.c_str());
 
-			if (arg.compare(L"-password") == 0 && i < numArgs - 1)
-				serverPassword = Utils::String::ThinString(szArgList[i + 1]);
+		mapsFolder = options.MapsFolder.empty() ? "maps\\" : options.MapsFolder;
 
-			if (arg.compare(L"-cache-memory-increase") == 0 && i < numArgs - 1)
-				Patches::Memory::SetGlobalCacheIncrease(std::stoul(szArgList[i + 1]));
+		skipTitleSplash = Modules::ModuleGame::Instance().VarSkipTitleSplash->ValueInt == 1;
 
-			if (arg.compare(L"-lod-increase") == 0)
-				Patches::Camera::IncreaseLOD();
+		if (options.Dedicated)
+		{
+			isDedicated = true;
+			std::vector<std::string> arguments{ "1" };
+			std::string output;
+			Modules::CommandMap::Instance().AssignVariable(Modules::ModuleServer::Instance().VarServerDedicated, arguments, &output);
+		}
 
-			size_t pos = arg.find(L'=');
-			if( pos == std::wstring::npos || arg.length() <= pos + 1 ) // if it doesn't contain an =, or there's nothing after the =
-				continue;
+		webDebugging = options.WebDebug;
+		connectToServer = options.Connect;
+		serverAddress = options.ConnectAddress;
+		serverPassword = options.ConnectPassword;
 
-			std::string argname = converter.to_bytes(arg.substr(1, pos - 1));
-			std::string argvalue = converter.to_bytes(arg.substr(pos + 1));
+		if (options.HasCacheMemoryIncrease)
+			Patches::Memory::SetGlobalCacheIncrease(options.CacheMemoryIncrease);
+		if (options.LodIncrease)
+			Patches::Camera::IncreaseLOD();
 
-			Modules::CommandMap::Instance().ExecuteCommand(argname + " \"" + argvalue + "\"", true);
-		}
-	}
+		for (auto &&variable : options.Overrides)
+			ApplyVariableOverride(variable);
 
 #if _DEBUG
-	// Always enable web debugging in debug builds
-	webDebugging = true;
+		// Always enable web debugging in debug builds
+		webDebugging = true;
 #endif
 
-	Patches::Core::SetMapsFolder(mapsFolder);
+		Patches::Core::SetMapsFolder(mapsFolder);
+	});
 
-	if (isDedicated)
+	startup.Add("frontend", StageScheduler::StageThread::Caller, { "arguments" }, [&]
 	{
-		Patches::Network::ForceDedicated();
-		//// Commenting this out for now because it makes testing difficult
-		DetourRestoreAfterWith();
-		DetourTransactionBegin();
-		DetourUpdateThread(GetCurrentThread());
-		DetourAttach((PVOID*)&Video_InitD3D, &hooked_Video_InitD3D);
-
-		if (DetourTransactionCommit() != NO_ERROR) {
-			return;
+		if (isDedicated)
+		{
+			Patches::Network::ForceDedicated();
+			//// Commenting this out for now because it makes testing difficult
+			DetourRestoreAfterWith();
+			DetourTransactionBegin();
+			DetourUpdateThread(GetCurrentThread());
+			DetourAttach((PVOID*)&Video_InitD3D, &hooked_Video_InitD3D);
+
+			// Skips the rest of initialization
+			if (DetourTransactionCommit() != NO_ERROR)
+				throw std::runtime_error("Failed to hook D3D initialization");
 		}
-	}
-	else
-	{
-		Web::Ui::ScreenLayer::Init();
-		Web::Ui::MpEventDispatcher::Init();
-		Web::Ui::WebChat::Init();
-		Web::Ui::WebScoreboard::Init();
-		Web::Ui::WebConsole::Init();
-		Web::Ui::WebLoadingScreen::Init();
-		Web::Ui::Voting::Init();
-		Web::Ui::WebVirtualKeyboard::Init();
-		Web::Ui::WebSettings::Init();
-
-		if (connectToServer)
+		else
 		{
-			//Skip the title splash screen if we're trying to connect to a server.
-			skipTitleSplash = true;
+			Web::Ui::ScreenLayer::Init();
+			Web::Ui::MpEventDispatcher::Init();
+			Web::Ui::WebChat::Init();
+			Web::Ui::WebScoreboard::Init();
+			Web::Ui::WebConsole::Init();
+			Web::Ui::WebLoadingScreen::Init();
+			Web::Ui::Voting::Init();
+			Web::Ui::WebVirtualKeyboard::Init();
+			Web::Ui::WebSettings::Init();
+
+			// Enumerating display modes is slow on some systems, get it done before the settings screen asks
+			Utils::DisplayModes::Refresh();
+
+			if (connectToServer)
+			{
+				//Skip the title splash screen if we're trying to connect to a server.
+				skipTitleSplash = true;
 
-			std::stringstream connectString;
-			connectString << "connect " << serverAddress << " " << serverPassword;
-			Modules::CommandMap::Instance().ExecuteCommand(connectString.str());
+				std::stringstream connectString;
+				connectString << "connect " << serverAddress << " " << serverPassword;
+				Modules::CommandMap::Instance().ExecuteCommand(connectString.str());
+			}
 		}
-	}
+	});
 
-	setWatermarkText("ElDewrito | Version: " + Utils::Version::GetVersionString() + " | Build Date: " __DATE__);
+	startup.Add("server", StageScheduler::StageThread::Caller, { "frontend" }, [this]
+	{
+		setWatermarkText("ElDewrito | Version: " + Utils::Version::GetVersionString() + " | Build Date: " __DATE__);
+
+		// Initialize server modules
+		Server::Chat::Initialize();
+		ChatCommands::Init();
+		Server::Stats::Init();
+		Server::Voting::Init();
+		Server::VariableSynchronization::Initialize();
+		Server::Rcon::Initialize();
+		Server::Signaling::Initialize();
+	});
+
+	// Background I/O, results are waited for where they're used. These read files an update can replace, so they wait
+	// for it to be installed.
+	startup.Add("ban-list", StageScheduler::StageThread::Worker, { "update" }, []
+	{
+		// Ensure a ban list file exists
+		Server::SaveDefaultBanList(Server::LoadDefaultBanList());
+	});
 
-	// Ensure a ban list file exists
-	Server::SaveDefaultBanList(Server::LoadDefaultBanList());
+	startup.Add("content-index", StageScheduler::StageThread::Worker, { "update" }, []
+	{
+		Patches::ContentItems::IndexContentFiles();
+	});
 
-	// Initialize server modules
-	Server::Chat::Initialize();
-	ChatCommands::Init();
-	Server::Stats::Init();
-	Server::Voting::Init();
-	Server::VariableSynchronization::Initialize();
-	Server::Rcon::Initialize();
-	Server::Signaling::Initialize();
+	// These only start once the frontend is set up, and are skipped if it fails
+	startup.Add("upnp-discovery", StageScheduler::StageThread::Worker, { "frontend" }, []
+	{
+		Modules::ModuleUPnP::Instance().Discover();
+	});
 
-	if (!Blam::Cache::StringIDCache::Instance.Load(mapsFolder + "string_ids.dat"))
+	startup.Add("string-ids", StageScheduler::StageThread::Worker, { "frontend" }, [this]
 	{
-		std::string msg("Failed to load '" + mapsFolder + "string_ids.dat'!");
-		MessageBox(NULL, msg.c_str(), "", MB_OK);
-	}
+		if (!Blam::Cache::StringIDCache::Instance.Load(mapsFolder + "string_ids.dat"))
+		{
+			std::string msg("Failed to load '" + mapsFolder + "string_ids.dat'!");
+			MessageBox(NULL, msg.c_str(), "", MB_OK);
+		}
+	});
+
+	startup.Add("tag-names", StageScheduler::StageThread::Worker, { "frontend" }, []
+	{
+		Blam::Tags::TagInstance::LoadTagNames();
+	});
+
+	startup.Run(2);
 }
 
 void ElDorito::Tick()
 {
+	if (!startupReported && startup.IsFinished())
+	{
+		startup.WaitAll();
+		for (auto &&line : startup.GetReport())
+			Utils::Logger::Instance().Log(Utils::LogTypes::Debug, Utils::LogLevel::Info, "Startup: %s", line.c_str());
+		startupReported = true;
+	}
+
 	Server::VariableSynchronization::Tick();
 	Server::Chat::Tick();
 	Patches::Tick();
 	if (!isDedicated) {
 		Web::Ui::ScreenLayer::Tick();
 		Web::Ui::WebScoreboard::Tick();
+		Web::Ui::Voting::Tick();
 	}
 	else if (GameHasMenuShown)
 		Server::DedicatedServer::Tick();
@@ -299,6 +377,14 @@ void ElDorito::Tick()
 		Modules::CommandMap::Instance().ExecuteQueue();
 		executeCommandQueue = false;
 	}
+	// Catch variables set outside of a command, e.g. by SetVariable calls from patches or the UI
+	Modules::CommandMap::Instance().PublishConfig();
+
+	// Send the packets queued during the tick, one envelope per peer
+	Patches::CustomPackets::FlushQueuedPackets();
+
+	// Deliver output written during the tick, including from the queued commands above
+	Console::Flush();
 }
 
 namespace
@@ -308,6 +394,11 @@ namespace
 	};
 }
 
+void ElDorito::WaitForStartupStage(const std::string &name)
+{
+	startup.Wait(name);
+}
+
 std::string ElDorito::GetDirectory()
 {
 	char Path[MAX_PATH];
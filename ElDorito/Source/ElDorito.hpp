@@ -9,6 +9,7 @@
 #include <map>
 
 #include "Utils/Utils.hpp"
+#include "Utils/StageScheduler.hpp"
 #include "Pointer.hpp"
 
 class ElDorito : public Utils::Singleton < ElDorito >
@@ -34,6 +35,9 @@ public:
 
 	void Initialize();
 	void Tick();
+
+	// Waits for a startup stage to finish, for code which needs the stage's results.
+	void WaitForStartupStage(const std::string &name);
 	void OnMainMenuShown();
 	std::string GetMapsFolder() const { return mapsFolder; }
 	bool IsWebDebuggingEnabled() const { return webDebugging; }
@@ -51,6 +55,8 @@ private:
 	std::string serverPassword = "";
 	std::string instanceName = "";
 	bool skipTitleSplash = false;
+	Utils::StageScheduler startup;
+	bool startupReported = false;
 	static bool(__cdecl * Video_InitD3D)(bool, bool);
 
 	void setWatermarkText(const std::string& Message);
@@ -2,7 +2,10 @@
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <thread>
 #include "ElDorito.hpp"
+#include "Utils/Logger.hpp"
 #include "Modules/ModuleGame.hpp"
 #include "Modules/ModulePlayer.hpp"
 #include "Modules/ModuleWeapon.hpp"
@@ -76,7 +79,16 @@ namespace
 		return false;
 	}
 
-	bool CommandWriteConfig(const std::vector<std::string>& Arguments, std::string& returnInfo)
+	struct ConfigFiles
+	{
+		std::string PrefsPath;
+		std::string Prefs;
+		std::string KeysPath;
+		std::string Keys;
+	};
+
+	// Gets the contents of the config files from the current variables. This has to run on the main thread.
+	ConfigFiles BuildConfigFiles(const std::string &prefsName)
 	{
 		PWSTR localAppdata;
 		SHGetKnownFolderPath(FOLDERID_LocalAppData, NULL, NULL, &localAppdata);
@@ -84,47 +96,63 @@ namespace
 		auto ed_appdata = Utils::String::ThinString(wide_ed_appdata);
 		ed_appdata += "\\ElDewrito";
 
-		std::string keyFile;
-		std::string prefsName = "dewrito_prefs.cfg";
+		ConfigFiles files;
+		files.PrefsPath = "dewrito_prefs.cfg";
 		if (ElDorito::Instance().GetInstanceName() != "")
 		{
 			std::stringstream ss;
 			ss << "dewrito_prefs_" << ElDorito::Instance().GetInstanceName() << ".cfg";
-			prefsName = ss.str();
+			files.PrefsPath = ss.str();
 			std::stringstream keystream;
 			keystream << ed_appdata << "\\keys_" << ElDorito::Instance().GetInstanceName() << ".cfg";
-			keyFile = keystream.str();
+			files.KeysPath = keystream.str();
 		}
 		else
 		{
 			std::stringstream ss;
 			ss << ed_appdata << "\\keys.cfg";
-			keyFile = ss.str();
+			files.KeysPath = ss.str();
 		}
-		if (Arguments.size() > 0)
-			prefsName = Arguments[0];
+		if (!prefsName.empty())
+			files.PrefsPath = prefsName;
+
+		files.Prefs = Modules::CommandMap::Instance().SaveVariables() + "\n" + Modules::ModuleInput::Instance().ExportBindings();
+		files.Keys = Modules::CommandMap::Instance().SaveKeys();
+		return files;
+	}
+
+	// Writes config files. Doesn't touch any variables, so it can run on any thread.
+	bool WriteConfigFiles(const ConfigFiles &files, std::string& returnInfo)
+	{
+		// Writes from WriteConfigAsync() can overlap with each other or with the command
+		static std::mutex writeMutex;
+		std::lock_guard<std::mutex> lock(writeMutex);
 
-		std::ofstream outFile(prefsName, std::ios::trunc);
+		std::ofstream outFile(files.PrefsPath, std::ios::trunc);
 		if (outFile.fail())
 		{
-			returnInfo = "Failed to write config to " + prefsName + "!";
+			returnInfo = "Failed to write config to " + files.PrefsPath + "!";
 			return false;
 		}
-		outFile << Modules::CommandMap::Instance().SaveVariables();
-		outFile << "\n" << Modules::ModuleInput::Instance().ExportBindings();
+		outFile << files.Prefs;
 
-		std::ofstream outKeys(keyFile, std::ios::trunc);
+		std::ofstream outKeys(files.KeysPath, std::ios::trunc);
 		if (outKeys.fail())
 		{
-			returnInfo += "\nFailed to write keys to " + keyFile;
+			returnInfo += "\nFailed to write keys to " + files.KeysPath;
 			return false;
 		}
-		outKeys << Modules::CommandMap::Instance().SaveKeys();
+		outKeys << files.Keys;
 
 
-		returnInfo = "Wrote config to " + prefsName + "\n" + "Wrote Key File to " + keyFile;
+		returnInfo = "Wrote config to " + files.PrefsPath + "\n" + "Wrote Key File to " + files.KeysPath;
 		return true;
 	}
+
+	bool CommandWriteConfig(const std::vector<std::string>& Arguments, std::string& returnInfo)
+	{
+		return WriteConfigFiles(BuildConfigFiles(Arguments.size() > 0 ? Arguments[0] : ""), returnInfo);
+	}
 }
 
 namespace Modules
@@ -152,4 +180,15 @@ namespace Modules
 
 		CommandMap::Instance().FinishAddCommands(); // call this so that the default values can be applied to the game
 	}
+
+	void ElModules::WriteConfigAsync()
+	{
+		auto files = BuildConfigFiles("");
+		std::thread([files]
+		{
+			std::string error;
+			if (!WriteConfigFiles(files, error))
+				Utils::Logger::Instance().Log(Utils::LogTypes::Game, Utils::LogLevel::Error, "%s", error.c_str());
+		}).detach();
+	}
 }
@@ -9,6 +9,10 @@ namespace Modules
 	public:
 		ElModules();
 
+		// Saves the config like WriteConfig, but writes the files on a background thread.
+		// The contents are taken from the variables before this returns.
+		void WriteConfigAsync();
+
 	private:
 	};
 }
\ No newline at end of file
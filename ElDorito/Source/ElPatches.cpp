@@ -32,10 +32,14 @@
 #include "Patches\Simulation.hpp"
 #include "Patches\Camera.hpp"
 #include "Patches\Maps.hpp"
+#include "Patches\Objects.hpp"
 #include "Patches\GameEngineSettings.hpp"
 #include "Patches\DamageSystem.hpp"
 #include "Patches\PlayerScale.hpp"
+#include "Patches\Membership.hpp"
+#include "Patches\PeerCapabilities.hpp"
 #include "Game\Armor.hpp"
+#include "Utils\LaunchOptions.hpp"
 
 #include <fstream>
 
@@ -76,25 +80,17 @@ namespace Patches
 		Simulation::ApplyAll();
 		Camera::ApplyAll();
 		Maps::ApplyAll();
+		Objects::ApplyAll();
 		GameEngineSettings::ApplyAll();
 		DamageSystem::ApplyAll();
 
-		Network::PlayerPropertiesExtender::Instance().Add(std::make_shared<Game::Armor::ArmorExtension>());
+		Network::PlayerPropertiesExtender::Instance().Add("eldewrito-player-armor", std::make_shared<Game::Armor::ArmorExtension>());
 
 		PlayerRepresentation::ApplyAll();
+		PeerCapabilities::ApplyAll();
 
-		//Since these patches are happening before ED gets initalized, we dont know if we are in dedi mode or not.
-		bool isdedicated = false;
-		int numArgs = 0;
-		LPWSTR* szArgList = CommandLineToArgvW(GetCommandLineW(), &numArgs);
-		for (int i = 1; i < numArgs; i++)
-		{
-			std::wstring arg = std::wstring(szArgList[i]);
-			if (arg.compare(L"-headless") == 0 || arg.compare(L"-dedicated") == 0)
-				isdedicated = true;
-		}
-
-		if (!isdedicated)
+		//Since these patches are happening before ED gets initalized, check the command line for dedi mode
+		if (!Utils::LaunchOptions::Get().Dedicated)
 			DirectXHook::ApplyAll();
 	}
 
@@ -104,7 +100,11 @@ namespace Patches
 
 	void ApplyAfterTagsLoaded()
 	{
-		Blam::Tags::TagInstance::LoadTagNames();
+		// Both are loaded in the background during startup
+		ElDorito::Instance().WaitForStartupStage("string-ids");
+		ElDorito::Instance().WaitForStartupStage("tag-names");
+		Blam::Tags::TagInstance::InvalidateGroupIndex();
+
 		Game::Armor::LoadArmorPermutations();
 		Game::Armor::RefreshUiPlayer();
 		Ui::ApplyAfterTagsLoaded(); //No UI calls interacting with tags before this!
@@ -118,6 +118,8 @@ namespace Patches
 		Sprint::Tick();
 		Forge::Tick();
 		PlayerScale::Tick();
+		PlayerUid::Tick();
+		Membership::Tick();
 		static bool appliedFirstTickPatches = false;
 		if (appliedFirstTickPatches)
 			return;
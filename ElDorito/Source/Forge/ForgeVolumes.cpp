@@ -7,6 +7,7 @@
 #include "../Blam/Tags/Game/Globals.hpp"
 #include "../Modules/ModuleForge.hpp"
 #include "../Patches/Core.hpp"
+#include "../Patches/Objects.hpp"
 #include "ForgeUtil.hpp"
 
 namespace
@@ -499,31 +500,31 @@ namespace
 
 	void FindVolumes()
 	{
-		auto objects = Blam::Objects::GetObjects();
-		for (auto it = objects.begin(); it != objects.end(); ++it)
+		auto objectIndices = Patches::Objects::FindObjectsWithTag(Forge::Volumes::KILL_VOLUME_TAG_INDEX);
+		auto garbageVolumeIndices = Patches::Objects::FindObjectsWithTag(Forge::Volumes::GARBAGE_VOLUME_TAG_INDEX);
+		objectIndices.insert(objectIndices.end(), garbageVolumeIndices.begin(), garbageVolumeIndices.end());
+
+		for (auto objectIndex : objectIndices)
 		{
-			if (it->Type != Blam::Objects::eObjectTypeCrate || !it->Data)
+			auto objectHeader = Blam::Objects::GetObjects().Get(objectIndex);
+			if (!objectHeader || objectHeader->Type != Blam::Objects::eObjectTypeCrate || !objectHeader->Data)
 				continue;
-			auto mpProperties = it->Data->GetMultiplayerProperties();
+			auto mpProperties = objectHeader->Data->GetMultiplayerProperties();
 			if (!mpProperties)
 				continue;
 
-			if (it->Data->TagIndex != Forge::Volumes::KILL_VOLUME_TAG_INDEX &&
-				it->Data->TagIndex != Forge::Volumes::GARBAGE_VOLUME_TAG_INDEX)
-				continue;
-
-			auto volumeIndex = GetNextVolumeIndex(it.CurrentDatumIndex);
+			auto volumeIndex = GetNextVolumeIndex(objectIndex);
 			if (volumeIndex == -1)
 				continue;
 
 			auto &volume = state.Volumes[volumeIndex];
 
-			GetObjectZoneShape(it.CurrentDatumIndex, &volume.Zone, 0);
-			volume.ObjectIndex = it.CurrentDatumIndex;
+			GetObjectZoneShape(objectIndex, &volume.Zone, 0);
+			volume.ObjectIndex = objectIndex;
 			volume.TeamIndex = mpProperties->TeamIndex & 0xff;
 			volume.Flags = 0;
 
-			switch (it->Data->TagIndex)
+			switch (objectHeader->Data->TagIndex)
 			{
 			case Forge::Volumes::KILL_VOLUME_TAG_INDEX:
 			{
@@ -3,6 +3,7 @@
 #include "../Blam/BlamObjects.hpp"
 #include "../Blam/BlamPlayers.hpp"
 #include "../Forge/ForgeUtil.hpp"
+#include "../Patches/Objects.hpp"
 
 namespace Forge::PrematchCamera
 {
@@ -13,14 +14,7 @@ namespace Forge::PrematchCamera
 		if (CAMERA_OBJECT_TAG_INDEX == -1)
 			return -1;
 
-		auto objects = Blam::Objects::GetObjects();
-		for (auto it = objects.begin(); it != objects.end(); ++it)
-		{
-			if (it->Data->TagIndex == CAMERA_OBJECT_TAG_INDEX)
-				return it.CurrentDatumIndex;
-		}
-
-		return -1;
+		return Patches::Objects::FindObjectWithTag(CAMERA_OBJECT_TAG_INDEX);
 	}
 
 	void PlaceCameraObject()
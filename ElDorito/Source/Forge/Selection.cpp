@@ -4,6 +4,7 @@
 #include "../Blam/BlamObjects.hpp"
 #include "../Blam/BlamInput.hpp"
 #include "../Forge/ForgeUtil.hpp"
+#include "../Patches/Objects.hpp"
 #include <stack>
 
 using namespace Blam;
@@ -12,6 +13,8 @@ using namespace Blam::Math;
 namespace
 {
 	Forge::ObjectSet s_SelectedObjects;
+
+	std::vector<uint32_t> GetPlacedObjectsWithTag(const Blam::MapVariant *mapv, uint32_t tagIndex);
 }
 
 namespace Forge
@@ -45,15 +48,8 @@ namespace Forge
 
 		const auto mapv = GetMapVariant();
 
-		for (auto i = 0; i < 640; i++)
-		{
-			auto& placement = mapv->Placements[i];
-			if (placement.ObjectIndex == -1 || placement.BudgetIndex == -1)
-				continue;
-
-			if (mapv->Budget[placement.BudgetIndex].TagIndex == currentObject->TagIndex)
-				s_SelectedObjects.Add(placement.ObjectIndex);
-		}
+		for (auto objectIndex : GetPlacedObjectsWithTag(mapv, currentObject->TagIndex))
+			s_SelectedObjects.Add(objectIndex);
 	}
 
 	void Selection::SelectEverything()
@@ -104,15 +100,8 @@ namespace Forge
 
 		const auto mapv = GetMapVariant();
 
-		for (auto i = 0; i < 640; i++)
-		{
-			auto& placement = mapv->Placements[i];
-			if (placement.ObjectIndex == -1 || placement.BudgetIndex == -1)
-				continue;
-
-			if (mapv->Budget[placement.BudgetIndex].TagIndex == currentObject->TagIndex)
-				s_SelectedObjects.Remove(placement.ObjectIndex);
-		}
+		for (auto objectIndex : GetPlacedObjectsWithTag(mapv, currentObject->TagIndex))
+			s_SelectedObjects.Remove(objectIndex);
 	}
 
 	void Selection::Invert()
@@ -307,3 +296,23 @@ namespace Forge
 		}
 	}
 }
+
+namespace
+{
+	std::vector<uint32_t> GetPlacedObjectsWithTag(const Blam::MapVariant *mapv, uint32_t tagIndex)
+	{
+		std::vector<uint32_t> result;
+		for (auto objectIndex : Patches::Objects::FindObjectsWithTag(tagIndex))
+		{
+			auto object = Blam::Objects::Get(objectIndex);
+			if (!object || object->PlacementIndex == -1)
+				continue;
+
+			// Only objects that are still placed in the map variant can be selected
+			auto& placement = mapv->Placements[object->PlacementIndex];
+			if (placement.ObjectIndex == objectIndex && placement.BudgetIndex != -1)
+				result.push_back(objectIndex);
+		}
+		return result;
+	}
+}
@@ -149,6 +149,15 @@ namespace Game::Armor
 		out->Unknown1C = stream->ReadUnsigned<uint32_t>(0, 0xFFFFFFFF);
 	}
 
+	int ArmorExtension::GetMaxSerializedBits() const
+	{
+		// Colors, unused, armor, unused, Unknown1C
+		auto bits = ColorIndices::Count * 24 + 32;
+		for (int i = 0; i < ArmorIndices::Count; i++)
+			bits += Utils::Bits::CountBits(MaxArmorIndices[i]);
+		return bits + 3 * 8 + 32;
+	}
+
 	void RefreshUiPlayer()
 	{
 		updateUiPlayerArmor = true;
@@ -14,6 +14,7 @@ namespace Game::Armor
 		void ApplyData(int playerIndex, Blam::Players::PlayerProperties *properties, const Blam::Players::PlayerCustomization &data) override;
 		void Serialize(Blam::BitStream *stream, const Blam::Players::PlayerCustomization &data) override;
 		void Deserialize(Blam::BitStream *stream, Blam::Players::PlayerCustomization *out) override;
+		int GetMaxSerializedBits() const override;
 	};
 
 	void RefreshUiPlayer();
@@ -0,0 +1,413 @@
+#include "GameVariantText.hpp"
+#include "PlayerTraits.hpp"
+#include "../Utils/Unicode.hpp"
+#include "../ThirdParty/rapidjson/document.h"
+#include "../ThirdParty/rapidjson/prettywriter.h"
+#include "../ThirdParty/rapidjson/stringbuffer.h"
+#include <cstring>
+#include <fstream>
+#include <openssl/evp.h>
+
+namespace
+{
+	using namespace Game::PlayerTraits;
+
+	const uint32_t CompiledMagic = 'EDGV';
+	const uint32_t CompiledVersion = 2;
+	const size_t HashSize = 32; // SHA-256
+
+	// Offsets of the fields in Blam::BLAM_GAME_VARIANT. They're spelled out here because that struct uses wchar_t
+	// for the name, which is only 2 bytes on Windows.
+	namespace Offsets
+	{
+		const size_t Name = 0x34;
+		const size_t NameLength = 0x10; // UTF-16 units
+		const size_t Description = 0x54;
+		const size_t DescriptionSize = 0x80;
+		const size_t Author = 0xD4;
+		const size_t AuthorSize = 0x10;
+		const size_t TeamGame = 0x124;
+		const size_t RoundTimeLimit = 0x125;
+		const size_t NumberOfRounds = 0x126;
+		const size_t RespawnTime = 0x12D;
+	}
+
+	// The bit widths the game's variant encoder writes these settings with.
+	// Anything larger gets truncated when the variant is sent to other players or saved.
+	namespace Limits
+	{
+		const uint8_t RoundTimeLimit = (1 << 8) - 1;
+		const uint8_t NumberOfRounds = (1 << 4) - 1;
+		const uint8_t RespawnTime = (1 << 8) - 1;
+	}
+
+	struct BaseSetting
+	{
+		const char *Name;
+		size_t Offset;
+		uint8_t Min;
+		uint8_t Max;
+		bool IsBool;
+	};
+
+	const BaseSetting BaseSettings[] =
+	{
+		{ "teams", Offsets::TeamGame, 0, 1, true },
+		{ "timeLimit", Offsets::RoundTimeLimit, 0, Limits::RoundTimeLimit, false },
+		{ "rounds", Offsets::NumberOfRounds, 1, Limits::NumberOfRounds, false },
+		{ "respawnTime", Offsets::RespawnTime, 0, Limits::RespawnTime, false },
+	};
+
+	bool ApplyString(const rapidjson::Value &value, const char *name, char *out, size_t maxSize, std::string &error)
+	{
+		if (!value.IsString())
+		{
+			error = std::string("\"") + name + "\" must be a string";
+			return false;
+		}
+		if (value.GetStringLength() >= maxSize)
+		{
+			error = std::string("\"") + name + "\" can't be longer than " + std::to_string(maxSize - 1) + " characters";
+			return false;
+		}
+		memset(out, 0, maxSize);
+		memcpy(out, value.GetString(), value.GetStringLength());
+		return true;
+	}
+
+	// Wide strings in the variant are UTF-16, stored little-endian regardless of the size of wchar_t
+	bool ApplyWideString(const rapidjson::Value &value, const char *name, uint8_t *out, size_t maxLength, std::string &error)
+	{
+		if (!value.IsString())
+		{
+			error = std::string("\"") + name + "\" must be a string";
+			return false;
+		}
+		auto str = Utils::Unicode::Utf8ToUtf16(std::string(value.GetString(), value.GetStringLength()));
+		if (str.length() >= maxLength)
+		{
+			error = std::string("\"") + name + "\" can't be longer than " + std::to_string(maxLength - 1) + " characters";
+			return false;
+		}
+		memset(out, 0, maxLength * sizeof(uint16_t));
+		for (size_t i = 0; i < str.length(); i++)
+		{
+			out[i * 2] = static_cast<uint8_t>(str[i] & 0xFF);
+			out[i * 2 + 1] = static_cast<uint8_t>((str[i] >> 8) & 0xFF);
+		}
+		return true;
+	}
+
+	std::string ReadWideString(const uint8_t *data, size_t maxLength)
+	{
+		std::wstring str;
+		for (size_t i = 0; i < maxLength; i++)
+		{
+			auto unit = static_cast<uint16_t>(data[i * 2] | (data[i * 2 + 1] << 8));
+			if (!unit)
+				break;
+			str += static_cast<wchar_t>(unit);
+		}
+		return Utils::Unicode::Utf16ToUtf8(str);
+	}
+
+	bool ApplyBaseSetting(const BaseSetting &setting, const rapidjson::Value &value, uint8_t *variant, std::string &error)
+	{
+		unsigned int result;
+		if (setting.IsBool && value.IsBool())
+			result = value.GetBool() ? 1 : 0;
+		else if (!setting.IsBool && value.IsUint())
+			result = value.GetUint();
+		else
+		{
+			error = std::string("\"") + setting.Name + "\" must be " + (setting.IsBool ? "true or false" : "a number");
+			return false;
+		}
+		if (result < setting.Min || result > setting.Max)
+		{
+			error = std::string("\"") + setting.Name + "\" must be between " + std::to_string(setting.Min) + " and " + std::to_string(setting.Max);
+			return false;
+		}
+		variant[setting.Offset] = static_cast<uint8_t>(result);
+		return true;
+	}
+
+	const TraitField* FindTraitField(const char *group, const char *name)
+	{
+		for (auto &&field : TraitFields)
+		{
+			if (strcmp(field.Group, group) == 0 && strcmp(field.Name, name) == 0)
+				return &field;
+		}
+		return nullptr;
+	}
+
+	bool ApplyTraitProfile(const rapidjson::Value &profile, size_t index, uint8_t *profileData, std::string &error)
+	{
+		auto prefix = "trait profile " + std::to_string(index) + ": ";
+		if (!profile.IsObject())
+		{
+			error = prefix + "must be an object or null";
+			return false;
+		}
+
+		for (auto group = profile.MemberBegin(); group != profile.MemberEnd(); ++group)
+		{
+			if (!group->value.IsObject())
+			{
+				error = prefix + "\"" + group->name.GetString() + "\" must be an object";
+				return false;
+			}
+			for (auto trait = group->value.MemberBegin(); trait != group->value.MemberEnd(); ++trait)
+			{
+				auto name = std::string(group->name.GetString()) + "." + trait->name.GetString();
+				auto field = FindTraitField(group->name.GetString(), trait->name.GetString());
+				if (!field)
+				{
+					error = prefix + "unknown trait \"" + name + "\"";
+					return false;
+				}
+				if (!trait->value.IsUint() || trait->value.GetUint() > field->Max)
+				{
+					error = prefix + "\"" + name + "\" must be between 0 and " + std::to_string(field->Max);
+					return false;
+				}
+
+				auto value = trait->value.GetUint();
+				if (field->Size == sizeof(uint16_t))
+					*reinterpret_cast<uint16_t*>(profileData + field->Offset) = static_cast<uint16_t>(value);
+				else
+					profileData[field->Offset] = static_cast<uint8_t>(value);
+			}
+		}
+		return true;
+	}
+
+	uint32_t ReadTraitField(const TraitField &field, const uint8_t *profileData)
+	{
+		if (field.Size == sizeof(uint16_t))
+			return *reinterpret_cast<const uint16_t*>(profileData + field.Offset);
+		return profileData[field.Offset];
+	}
+}
+
+namespace Game::GameVariantText
+{
+	bool GetBase(const std::string &text, std::string &base, std::string &error)
+	{
+		rapidjson::Document document;
+		if (document.Parse<0>(text.c_str()).HasParseError() || !document.IsObject())
+		{
+			error = "Invalid JSON";
+			return false;
+		}
+		if (!document.HasMember("base") || !document["base"].IsString() || !document["base"].GetStringLength())
+		{
+			error = "\"base\" must be the name of a variant";
+			return false;
+		}
+		base = document["base"].GetString();
+		return true;
+	}
+
+	bool Compile(const std::string &text, const std::vector<size_t> &traitProfileOffsets, uint8_t *variant, std::string &error)
+	{
+		rapidjson::Document document;
+		if (document.Parse<0>(text.c_str()).HasParseError() || !document.IsObject())
+		{
+			error = "Invalid JSON";
+			return false;
+		}
+
+		// Work on a copy so that nothing is changed if any value is invalid
+		uint8_t result[VariantSize];
+		memcpy(result, variant, VariantSize);
+
+		for (auto member = document.MemberBegin(); member != document.MemberEnd(); ++member)
+		{
+			std::string name = member->name.GetString();
+			auto &value = member->value;
+			if (name == "base")
+				continue;
+			if (name == "name")
+			{
+				if (!ApplyWideString(value, "name", result + Offsets::Name, Offsets::NameLength, error))
+					return false;
+				continue;
+			}
+			if (name == "description")
+			{
+				if (!ApplyString(value, "description", reinterpret_cast<char*>(result + Offsets::Description), Offsets::DescriptionSize, error))
+					return false;
+				continue;
+			}
+			if (name == "author")
+			{
+				if (!ApplyString(value, "author", reinterpret_cast<char*>(result + Offsets::Author), Offsets::AuthorSize, error))
+					return false;
+				continue;
+			}
+			if (name == "traitProfiles")
+			{
+				if (!value.IsArray())
+				{
+					error = "\"traitProfiles\" must be an array";
+					return false;
+				}
+				if (value.Size() > traitProfileOffsets.size())
+				{
+					error = "The base variant only has " + std::to_string(traitProfileOffsets.size()) + " trait profiles";
+					return false;
+				}
+				for (rapidjson::SizeType i = 0; i < value.Size(); i++)
+				{
+					if (value[i].IsNull())
+						continue; // Left as it is in the base variant
+					if (!ApplyTraitProfile(value[i], i, result + traitProfileOffsets[i], error))
+						return false;
+				}
+				continue;
+			}
+
+			auto found = false;
+			for (auto &&setting : BaseSettings)
+			{
+				if (name != setting.Name)
+					continue;
+				if (!ApplyBaseSetting(setting, value, result, error))
+					return false;
+				found = true;
+				break;
+			}
+			if (!found)
+			{
+				error = "Unknown setting \"" + name + "\"";
+				return false;
+			}
+		}
+
+		memcpy(variant, result, VariantSize);
+		return true;
+	}
+
+	std::string Decompile(const uint8_t *variant, const std::vector<size_t> &traitProfileOffsets, const std::string &base)
+	{
+		auto description = reinterpret_cast<const char*>(variant + Offsets::Description);
+		auto author = reinterpret_cast<const char*>(variant + Offsets::Author);
+
+		rapidjson::StringBuffer buffer;
+		rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+		writer.StartObject();
+		writer.Key("base");
+		writer.String(base.c_str());
+
+		writer.Key("name");
+		writer.String(ReadWideString(variant + Offsets::Name, Offsets::NameLength).c_str());
+		writer.Key("description");
+		writer.String(description, static_cast<rapidjson::SizeType>(strnlen(description, Offsets::DescriptionSize)));
+		writer.Key("author");
+		writer.String(author, static_cast<rapidjson::SizeType>(strnlen(author, Offsets::AuthorSize)));
+
+		for (auto &&setting : BaseSettings)
+		{
+			writer.Key(setting.Name);
+			if (setting.IsBool)
+				writer.Bool(variant[setting.Offset] != 0);
+			else
+				writer.Uint(variant[setting.Offset]);
+		}
+
+		writer.Key("traitProfiles");
+		writer.StartArray();
+		for (auto offset : traitProfileOffsets)
+		{
+			writer.StartObject();
+			const char *currentGroup = nullptr;
+			for (auto &&field : TraitFields)
+			{
+				if (!currentGroup || strcmp(currentGroup, field.Group) != 0)
+				{
+					if (currentGroup)
+						writer.EndObject();
+					currentGroup = field.Group;
+					writer.Key(currentGroup);
+					writer.StartObject();
+				}
+				writer.Key(field.Name);
+				writer.Uint(ReadTraitField(field, variant + offset));
+			}
+			if (currentGroup)
+				writer.EndObject();
+			writer.EndObject();
+		}
+		writer.EndArray();
+
+		writer.EndObject();
+		return buffer.GetString();
+	}
+
+	std::string ComputeHash(const std::string &text, const std::string &baseData)
+	{
+		unsigned char hash[EVP_MAX_MD_SIZE];
+		unsigned int hashSize = 0;
+		auto context = EVP_MD_CTX_create();
+		auto ok = context &&
+			EVP_DigestInit_ex(context, EVP_sha256(), nullptr) &&
+			EVP_DigestUpdate(context, &CompiledVersion, sizeof(CompiledVersion)) &&
+			EVP_DigestUpdate(context, text.c_str(), text.length()) &&
+			EVP_DigestUpdate(context, baseData.c_str(), baseData.length()) &&
+			EVP_DigestFinal_ex(context, hash, &hashSize);
+		if (context)
+			EVP_MD_CTX_destroy(context);
+		if (!ok || hashSize != HashSize)
+			return "";
+
+		static const char HexDigits[] = "0123456789abcdef";
+		std::string hashStr;
+		for (unsigned int i = 0; i < hashSize; i++)
+		{
+			hashStr += HexDigits[hash[i] >> 4];
+			hashStr += HexDigits[hash[i] & 0xF];
+		}
+		return hashStr;
+	}
+
+	bool LoadCompiled(const std::string &path, const std::string &hash, uint8_t *variant)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		uint32_t magic = 0, version = 0;
+		char storedHash[HashSize * 2] = { 0 };
+		file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		file.read(reinterpret_cast<char*>(&version), sizeof(version));
+		file.read(storedHash, sizeof(storedHash));
+		if (!file || magic != CompiledMagic || version != CompiledVersion)
+			return false;
+		if (hash.length() != sizeof(storedHash) || memcmp(hash.c_str(), storedHash, sizeof(storedHash)) != 0)
+			return false;
+
+		uint8_t data[VariantSize];
+		file.read(reinterpret_cast<char*>(data), VariantSize);
+		if (!file)
+			return false;
+		memcpy(variant, data, VariantSize);
+		return true;
+	}
+
+	bool SaveCompiled(const std::string &path, const std::string &hash, const uint8_t *variant)
+	{
+		if (hash.length() != HashSize * 2)
+			return false;
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			return false;
+		file.write(reinterpret_cast<const char*>(&CompiledMagic), sizeof(CompiledMagic));
+		file.write(reinterpret_cast<const char*>(&CompiledVersion), sizeof(CompiledVersion));
+		file.write(hash.c_str(), hash.length());
+		file.write(reinterpret_cast<const char*>(variant), VariantSize);
+		return file.good();
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Text (JSON) format for game variants.
+//
+// A text variant names a base variant (a built-in gametype or a custom variant file) and overrides its
+// base settings and trait profiles. Trait profiles are listed in the order the game deserializes them, and
+// only their changed traits need to be given. For example:
+//
+// {
+//     "base": "team_slayer",
+//     "name": "Swat",
+//     "timeLimit": 10,
+//     "traitProfiles": [ { "health": { "shieldMultiplier": 0 } } ]
+// }
+//
+// Compiling applies the text to the binary form of the base variant, validating every value against the
+// limits used by the game's variant and trait profile serializers.
+namespace Game::GameVariantText
+{
+	// Size of the binary game variant
+	const size_t VariantSize = 0x264;
+
+	// Gets the name of the base variant that a text variant builds on.
+	bool GetBase(const std::string &text, std::string &base, std::string &error);
+
+	// Applies a text variant to the binary data of its base variant.
+	// traitProfileOffsets holds the offset of each trait profile in the variant data, in deserialization order.
+	// The variant is left untouched if the text is invalid.
+	bool Compile(const std::string &text, const std::vector<size_t> &traitProfileOffsets, uint8_t *variant, std::string &error);
+
+	// Converts binary variant data to a text variant containing every setting the format covers.
+	std::string Decompile(const uint8_t *variant, const std::vector<size_t> &traitProfileOffsets, const std::string &base);
+
+	// Computes the hash used to check whether a compiled variant is up to date.
+	// baseData is the contents of the base variant file, or empty for a built-in base.
+	std::string ComputeHash(const std::string &text, const std::string &baseData);
+
+	// Loads a compiled variant from the cache. Fails if the file doesn't exist or has a different hash.
+	bool LoadCompiled(const std::string &path, const std::string &hash, uint8_t *variant);
+
+	bool SaveCompiled(const std::string &path, const std::string &hash, const uint8_t *variant);
+}
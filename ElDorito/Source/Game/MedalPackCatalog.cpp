@@ -0,0 +1,270 @@
+#include "MedalPackCatalog.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <boost/filesystem.hpp>
+#include "../ThirdParty/rapidjson/document.h"
+#include "../ThirdParty/rapidjson/error/en.h"
+#include "../ThirdParty/rapidjson/stringbuffer.h"
+#include "../ThirdParty/rapidjson/writer.h"
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+	// Enough to tell what's wrong with a pack without flooding the settings UI
+	const size_t MaxErrors = 50;
+
+	const char ImageDirName[] = "images";
+	const char AudioDirName[] = "audio";
+
+	int64_t GetModifiedTime(const fs::path &path);
+	int64_t GetFileSize(const fs::path &path);
+	bool IsSafePath(const std::string &path);
+}
+
+namespace Game
+{
+	MedalPackCatalog::MedalPackCatalog(const std::string &directory, EventNameValidator isKnownEvent)
+		: directory(directory), isKnownEvent(std::move(isKnownEvent))
+	{
+	}
+
+	size_t MedalPackCatalog::Refresh()
+	{
+		std::vector<std::string> names;
+		boost::system::error_code ec;
+		for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+		{
+			if (fs::is_directory(it->path(), ec) && fs::exists(it->path() / "events.json", ec))
+				names.push_back(it->path().filename().string());
+		}
+		std::sort(names.begin(), names.end());
+
+		std::vector<MedalPackInfo> newPacks;
+		std::vector<std::vector<WatchedPath>> newWatchedPaths;
+		size_t validated = 0;
+		for (auto &&name : names)
+		{
+			auto it = std::lower_bound(packs.begin(), packs.end(), name, [](const MedalPackInfo &pack, const std::string &name)
+			{
+				return pack.Name < name;
+			});
+			if (it != packs.end() && it->Name == name)
+			{
+				auto &watchedPaths = packWatchedPaths[it - packs.begin()];
+				if (IsUnchanged(watchedPaths))
+				{
+					newPacks.push_back(std::move(*it));
+					newWatchedPaths.push_back(std::move(watchedPaths));
+					continue;
+				}
+			}
+
+			std::vector<WatchedPath> watchedPaths;
+			newPacks.push_back(Validate(name, &watchedPaths));
+			newWatchedPaths.push_back(std::move(watchedPaths));
+			validated++;
+		}
+
+		packs = std::move(newPacks);
+		packWatchedPaths = std::move(newWatchedPaths);
+		return validated;
+	}
+
+	std::string MedalPackCatalog::ToJson() const
+	{
+		rapidjson::StringBuffer buffer;
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+		writer.StartArray();
+		for (auto &&pack : packs)
+		{
+			writer.StartObject();
+			writer.Key("name");
+			writer.String(pack.Name.c_str());
+			writer.Key("valid");
+			writer.Bool(pack.Valid);
+			writer.Key("events");
+			writer.Uint(pack.EventCount);
+			writer.Key("assetBytes");
+			writer.Uint64(pack.AssetBytes);
+			writer.Key("errors");
+			writer.StartArray();
+			for (auto &&error : pack.Errors)
+				writer.String(error.c_str());
+			writer.EndArray();
+			writer.EndObject();
+		}
+		writer.EndArray();
+		return buffer.GetString();
+	}
+
+	MedalPackInfo MedalPackCatalog::Validate(const std::string &name, std::vector<WatchedPath> *watchedPaths) const
+	{
+		MedalPackInfo pack = {};
+		pack.Name = name;
+
+		auto packPath = fs::path(directory) / name;
+		auto eventsPath = packPath / "events.json";
+		auto imagePath = packPath / ImageDirName;
+		auto audioPath = packPath / AudioDirName;
+
+		// Adding or removing a file changes the modification time of its directory, so these notice files that a pack
+		// references appearing or disappearing. Files replaced in place are noticed by watching each of them below.
+		for (auto &&path : { packPath, eventsPath, imagePath, audioPath })
+			watchedPaths->push_back({ path.string(), GetModifiedTime(path), GetFileSize(path) });
+
+		size_t errorCount = 0;
+		auto addError = [&](const std::string &error)
+		{
+			if (errorCount++ < MaxErrors)
+				pack.Errors.push_back(error);
+		};
+
+		std::string json;
+		{
+			std::ifstream in(eventsPath.string(), std::ios::binary);
+			std::stringstream stream;
+			stream << in.rdbuf();
+			json = stream.str();
+			if (!in)
+				addError("Failed to read events.json");
+		}
+		pack.AssetBytes = json.size();
+
+		rapidjson::Document document;
+		if (document.Parse<0>(json.c_str()).HasParseError())
+		{
+			std::stringstream ss;
+			ss << "events.json: " << rapidjson::GetParseError_En(document.GetParseError()) << " (at offset " << document.GetErrorOffset() << ")";
+			addError(ss.str());
+		}
+		else if (!document.IsObject())
+		{
+			addError("events.json: The root must be an object");
+		}
+		else
+		{
+			std::vector<std::string> countedFiles;
+			auto checkFile = [&](const std::string &eventName, const rapidjson::Value &value, const fs::path &assetDir)
+			{
+				if (!value.IsString())
+				{
+					addError(eventName + ": File names must be strings");
+					return;
+				}
+				std::string file = value.GetString();
+				if (!IsSafePath(file))
+				{
+					addError(eventName + ": Invalid file name \"" + file + "\"");
+					return;
+				}
+
+				boost::system::error_code ec;
+				auto path = packPath / file;
+				if (!fs::is_regular_file(path, ec))
+					path = assetDir / file;
+				if (!fs::is_regular_file(path, ec))
+				{
+					addError(eventName + ": \"" + file + "\" does not exist");
+					return;
+				}
+
+				// Files that several medals share are only counted once
+				auto key = path.generic_string();
+				auto it = std::lower_bound(countedFiles.begin(), countedFiles.end(), key);
+				if (it != countedFiles.end() && *it == key)
+					return;
+				countedFiles.insert(it, key);
+				auto size = GetFileSize(path);
+				pack.AssetBytes += size >= 0 ? size : 0;
+				watchedPaths->push_back({ path.string(), GetModifiedTime(path), size });
+			};
+			auto checkFiles = [&](const std::string &eventName, const rapidjson::Value &event, const char *singleKey, const char *listKey, const fs::path &assetDir)
+			{
+				auto single = event.FindMember(singleKey);
+				if (single != event.MemberEnd())
+					checkFile(eventName, single->value, assetDir);
+
+				auto list = event.FindMember(listKey);
+				if (list == event.MemberEnd())
+					return;
+				if (!list->value.IsArray())
+				{
+					addError(eventName + ": \"" + listKey + "\" must be an array");
+					return;
+				}
+				for (auto it = list->value.Begin(); it != list->value.End(); ++it)
+					checkFile(eventName, *it, assetDir);
+			};
+
+			for (auto it = document.MemberBegin(); it != document.MemberEnd(); ++it)
+			{
+				std::string eventName = it->name.GetString();
+				pack.EventCount++;
+				if (isKnownEvent && !isKnownEvent(eventName))
+					addError("Unknown event \"" + eventName + "\"");
+				if (!it->value.IsObject())
+				{
+					addError(eventName + ": The event must be an object");
+					continue;
+				}
+				checkFiles(eventName, it->value, "image", "images", imagePath);
+				checkFiles(eventName, it->value, "sound", "sounds", audioPath);
+			}
+		}
+
+		if (errorCount > MaxErrors)
+			pack.Errors.push_back("..." + std::to_string(errorCount - MaxErrors) + " more errors");
+		pack.Valid = errorCount == 0;
+		return pack;
+	}
+
+	bool MedalPackCatalog::IsUnchanged(const std::vector<WatchedPath> &watchedPaths)
+	{
+		for (auto &&watched : watchedPaths)
+		{
+			if (GetModifiedTime(watched.Path) != watched.ModifiedTime || GetFileSize(watched.Path) != watched.Size)
+				return false;
+		}
+		return true;
+	}
+}
+
+namespace
+{
+	int64_t GetModifiedTime(const fs::path &path)
+	{
+		boost::system::error_code ec;
+		auto time = fs::last_write_time(path, ec);
+		return ec ? -1 : static_cast<int64_t>(time);
+	}
+
+	int64_t GetFileSize(const fs::path &path)
+	{
+		boost::system::error_code ec;
+		if (!fs::is_regular_file(path, ec))
+			return -1;
+		auto size = fs::file_size(path, ec);
+		return ec ? -1 : static_cast<int64_t>(size);
+	}
+
+	bool IsSafePath(const std::string &path)
+	{
+		// Only files inside the pack
+		if (path.empty() || path.front() == '/' || path.front() == '\\' || path.find(':') != std::string::npos)
+			return false;
+
+		size_t start = 0;
+		while (true)
+		{
+			auto end = path.find_first_of("/\\", start);
+			auto part = path.substr(start, end == std::string::npos ? std::string::npos : end - start);
+			if (part == "..")
+				return false;
+			if (end == std::string::npos)
+				return true;
+			start = end + 1;
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Catalog of the medal packs in a directory.
+//
+// A medal pack is a subdirectory containing an events.json, which maps multiplayer event names to the medal that is
+// shown for them. For example:
+//
+// {
+//     "earn_wp_event_kill": { "image": "kill.png", "sound": "kill.wav" },
+//     "general_event_game_over": { "sounds": [ "game_over.wav" ] }
+// }
+//
+// "image" and "sound" (or "images" and "sounds" arrays) name files relative to the pack directory. Images can also
+// be in the pack's images/ directory and sounds in its audio/ directory.
+namespace Game
+{
+	struct MedalPackInfo
+	{
+		std::string Name;                // Name of the pack's directory
+		bool Valid;                      // True if there are no errors
+		uint32_t EventCount;
+		uint64_t AssetBytes;             // Size of events.json and every file it references
+		std::vector<std::string> Errors;
+	};
+
+	class MedalPackCatalog
+	{
+	public:
+		// Checks whether an event name in events.json is one the game sends.
+		typedef std::function<bool(const std::string &eventName)> EventNameValidator;
+
+		MedalPackCatalog(const std::string &directory, EventNameValidator isKnownEvent);
+
+		// Looks for packs that were added, removed or changed. A pack is only validated again if the modification
+		// time of its directory, its events.json or its images/audio directories changed, or the size or modification
+		// time of a file it references changed. Returns the number of packs that were validated.
+		size_t Refresh();
+
+		// Gets the packs found by the last refresh, sorted by name.
+		const std::vector<MedalPackInfo> &GetPacks() const { return packs; }
+
+		// Lists the packs as a JSON array of { name, valid, events, assetBytes, errors } objects.
+		std::string ToJson() const;
+
+	private:
+		struct WatchedPath
+		{
+			std::string Path;
+			int64_t ModifiedTime; // -1 if it doesn't exist
+			int64_t Size;         // -1 for directories and files that don't exist
+		};
+
+		MedalPackInfo Validate(const std::string &name, std::vector<WatchedPath> *watchedPaths) const;
+		static bool IsUnchanged(const std::vector<WatchedPath> &watchedPaths);
+
+		std::string directory;
+		EventNameValidator isKnownEvent;
+		std::vector<MedalPackInfo> packs;
+		std::vector<std::vector<WatchedPath>> packWatchedPaths; // Parallel to packs
+	};
+}
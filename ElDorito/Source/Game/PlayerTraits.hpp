@@ -0,0 +1,295 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "../Blam/BitStream.hpp"
+
+namespace Game::PlayerTraits
+{
+	// The highest valid value of each trait.
+	// Values outside of these are reset to 0 when a trait profile is deserialized.
+	namespace Limits
+	{
+		const uint8_t DamageResistance = 15;
+		const uint8_t ShieldRechargeRate = 9;
+		const uint8_t ShieldMultiplier = 5;
+		const uint8_t HeadshotImmunity = 2;
+		const uint8_t ShieldVampirism = 5;
+
+		const uint8_t DamageModifier = 12;
+		const uint8_t PrimaryWeaponIndex = 0xFF;
+		const uint8_t SecondaryWeaponIndex = 0xFF;
+		const uint8_t InitialGrenades = 2;
+		const uint8_t InfiniteAmmo = 3;
+		const uint8_t GrenadeRegeneration = 2;
+		const uint8_t WeaponPickup = 2;
+
+		const uint8_t PlayerSpeed = 15;
+		const uint8_t PlayerGravity = 10;
+		const uint8_t VehicleUse = 3;
+
+		const uint8_t ActiveCamo = 4;
+		const uint8_t Waypoint = 5;
+		const uint8_t PlayerSize = 18;
+		const uint8_t ForcedColor = 13;
+
+		const uint8_t MotionTrackerMode = 4;
+		const uint8_t MotionTrackerRange = 7;
+	}
+
+	struct c_player_health_traits
+	{
+		uint8_t DamageResistance;
+		uint8_t ShieldRechargeRate;
+		uint8_t ShieldMultiplier;
+		uint8_t HeadshotImmunity;
+		uint8_t ShieldVampirism;
+		uint8_t field_5;
+		uint8_t field_6;
+		uint8_t field_7;
+
+		void Serialize(Blam::BitStream &stream)
+		{
+			stream.WriteUnsigned(DamageResistance, 4);
+			stream.WriteUnsigned(ShieldRechargeRate, 4);
+			stream.WriteUnsigned(ShieldMultiplier, 3);
+			stream.WriteUnsigned(HeadshotImmunity, 2);
+			stream.WriteUnsigned(ShieldVampirism, 3);
+		}
+
+		void Deserialize(Blam::BitStream &stream)
+		{
+			DamageResistance = stream.ReadUnsigned<uint8_t>(4);
+			if (DamageResistance > Limits::DamageResistance)
+				DamageResistance = 0;
+			ShieldRechargeRate = stream.ReadUnsigned<uint8_t>(4);
+			if (ShieldRechargeRate > Limits::ShieldRechargeRate)
+				ShieldRechargeRate = 0;
+			ShieldMultiplier = stream.ReadUnsigned<uint8_t>(3);
+			if (ShieldMultiplier > Limits::ShieldMultiplier)
+				ShieldMultiplier = 0;
+			HeadshotImmunity = stream.ReadUnsigned<uint8_t>(2);
+			if (HeadshotImmunity > Limits::HeadshotImmunity)
+				HeadshotImmunity = 0;
+			ShieldVampirism = stream.ReadUnsigned<uint8_t>(3);
+			if (ShieldVampirism > Limits::ShieldVampirism)
+				ShieldVampirism = 0;
+		}
+	};
+	static_assert(sizeof(c_player_health_traits) == 0x8, "c_player_health_traits invalid");
+
+	struct c_player_weapon_traits
+	{
+		uint16_t field_0;
+		uint8_t PrimaryWeaponIndex;
+		uint8_t SecondaryWeaponIndex;
+		uint8_t DamageModifier;
+		uint8_t GrenadeRegeeration;
+		uint8_t InfiniteAmmo;
+		uint8_t WeaponPickup;
+
+		void Serialize(Blam::BitStream &stream)
+		{
+			stream.WriteUnsigned(DamageModifier, 4);
+			stream.WriteUnsigned(PrimaryWeaponIndex, 8);
+			stream.WriteUnsigned(SecondaryWeaponIndex, 8);
+			stream.WriteUnsigned(field_0, 2);
+			stream.WriteUnsigned(InfiniteAmmo, 3);
+			stream.WriteUnsigned(GrenadeRegeeration, 2);
+			stream.WriteUnsigned(WeaponPickup, 2);
+		}
+
+		void Deserialize(Blam::BitStream &stream)
+		{
+			DamageModifier = stream.ReadUnsigned<uint8_t>(4);
+			if (DamageModifier > Limits::DamageModifier)
+				DamageModifier = 0;
+			PrimaryWeaponIndex = ValidateWeaponIndex(stream.ReadUnsigned<uint8_t>(8));
+			SecondaryWeaponIndex = ValidateWeaponIndex(stream.ReadUnsigned<uint8_t>(8));
+			field_0 = stream.ReadUnsigned<uint8_t>(2);
+			if (field_0 > Limits::InitialGrenades)
+				field_0 = 0;
+			InfiniteAmmo = stream.ReadUnsigned<uint8_t>(3);
+			if (InfiniteAmmo > Limits::InfiniteAmmo)
+				InfiniteAmmo = 0;
+			GrenadeRegeeration = stream.ReadUnsigned<uint8_t>(2);
+			if (GrenadeRegeeration > Limits::GrenadeRegeneration)
+				GrenadeRegeeration = 0;
+			WeaponPickup = stream.ReadUnsigned<uint8_t>(2);
+			if (WeaponPickup > Limits::WeaponPickup)
+				WeaponPickup = 0;
+		}
+
+		uint8_t ValidateWeaponIndex(uint8_t index)
+		{
+			auto v5 = index;
+			auto v6 = v5 < 0;
+			if (v5 < 0)
+				v6 = v5 < 0;
+			auto v7 = v5 == -1 || v5 == -3 || v5 == -2;
+			auto v8 = (!v6 || v7) == 0;
+			auto v9 = -2;
+			auto v10 = -2;
+			if (!v8)
+				v10 = v5;
+			return v10;
+		}
+	};
+	static_assert(sizeof(c_player_health_traits) == 0x8, "c_player_weapon_traits invalid");
+
+	struct c_player_movement_traits
+	{
+		uint8_t PlayerSpeed;
+		uint8_t PlayerGravity;
+		uint8_t VehicleUse;
+		uint8_t field_3;
+
+		void Serialize(Blam::BitStream &stream)
+		{
+			stream.WriteUnsigned(PlayerSpeed, 4);
+			stream.WriteUnsigned(PlayerGravity, 4);
+			stream.WriteUnsigned(VehicleUse, 2);
+		}
+
+		void Deserialize(Blam::BitStream &stream)
+		{
+			PlayerSpeed = stream.ReadUnsigned<uint8_t>(4);
+			if (PlayerSpeed > Limits::PlayerSpeed)
+				PlayerSpeed = 0;
+			PlayerGravity = stream.ReadUnsigned<uint8_t>(4);
+			if (PlayerGravity > Limits::PlayerGravity)
+				PlayerGravity = 0;
+			VehicleUse = stream.ReadUnsigned<uint8_t>(2);
+			if (VehicleUse > Limits::VehicleUse)
+				VehicleUse = 0;
+		}
+	};
+	static_assert(sizeof(c_player_movement_traits) == 0x4, "c_player_movement_traits invalid");
+
+	struct c_player_appearance_traits
+	{
+		uint8_t ActiveCamo;
+		uint8_t Waypoint;
+		uint8_t Aura;  // now player size
+		uint8_t ForcedColor;
+
+		void Serialize(Blam::BitStream &stream)
+		{
+			stream.WriteUnsigned(ActiveCamo, 3);
+			stream.WriteUnsigned(Waypoint, 3);
+			stream.WriteUnsigned(Aura, 5);
+			stream.WriteUnsigned(ForcedColor, 4);
+		}
+
+		void Deserialize(Blam::BitStream &stream)
+		{
+			ActiveCamo = stream.ReadUnsigned<uint8_t>(3);
+			if (ActiveCamo > Limits::ActiveCamo)
+				ActiveCamo = 0;
+			Waypoint = stream.ReadUnsigned<uint8_t>(3);
+			if (Waypoint > Limits::Waypoint)
+				Waypoint = 0;
+			Aura = stream.ReadUnsigned<uint8_t>(5);
+			if (Aura > Limits::PlayerSize)
+				Aura = 0;
+			ForcedColor = stream.ReadUnsigned<uint8_t>(4);
+			if (ForcedColor > Limits::ForcedColor)
+				ForcedColor = 0;
+		}
+	};
+	static_assert(sizeof(c_player_appearance_traits) == 0x4, "c_player_appearance_traits invalid");
+
+	struct c_player_sensor_traits
+	{
+		uint16_t MotionTrackerMode;
+		uint16_t MotionTrackerRange;
+
+		void Serialize(Blam::BitStream &stream)
+		{
+			stream.WriteUnsigned(MotionTrackerMode, 3);
+			stream.WriteUnsigned(MotionTrackerRange, 3);
+		}
+
+		void Deserialize(Blam::BitStream &stream)
+		{
+			MotionTrackerMode = stream.ReadUnsigned<uint8_t>(3);
+			if (MotionTrackerMode > Limits::MotionTrackerMode)
+				MotionTrackerMode = 0;
+			MotionTrackerRange = stream.ReadUnsigned<uint8_t>(3);
+			if (MotionTrackerRange > Limits::MotionTrackerRange)
+				MotionTrackerRange = 0;
+		}
+	};
+	static_assert(sizeof(c_player_sensor_traits) == 0x4, "c_player_sensor_traits invalid");
+
+	struct c_player_trait_profile
+	{
+		c_player_health_traits Health;
+		c_player_weapon_traits Weapon;
+		c_player_movement_traits Movement;
+		c_player_appearance_traits Appearance;
+		c_player_sensor_traits Sensory;
+
+		void Serialize(Blam::BitStream &stream)
+		{
+			Health.Serialize(stream);
+			Weapon.Serialize(stream);
+			Movement.Serialize(stream);
+			Appearance.Serialize(stream);
+			Sensory.Serialize(stream);
+		}
+
+		void Deserialize(Blam::BitStream &stream)
+		{
+			Health.Deserialize(stream);
+			Weapon.Deserialize(stream);
+			Movement.Deserialize(stream);
+			Appearance.Deserialize(stream);
+			Sensory.Deserialize(stream);
+		}
+	};
+	static_assert(sizeof(c_player_trait_profile) == 0x1C, "c_player_trait_profile invalid");
+
+	// Describes a single trait in a c_player_trait_profile, for tools that edit profiles field by field.
+	struct TraitField
+	{
+		const char *Group;
+		const char *Name;
+		size_t Offset; // Offset from the start of the profile
+		size_t Size;   // 1 or 2 bytes
+		uint8_t Max;
+	};
+
+#define TRAIT_FIELD(group, groupName, type, field, name, max) \
+	{ groupName, name, offsetof(c_player_trait_profile, group) + offsetof(type, field), sizeof(type::field), max }
+
+	const TraitField TraitFields[] =
+	{
+		TRAIT_FIELD(Health, "health", c_player_health_traits, DamageResistance, "damageResistance", Limits::DamageResistance),
+		TRAIT_FIELD(Health, "health", c_player_health_traits, ShieldRechargeRate, "shieldRechargeRate", Limits::ShieldRechargeRate),
+		TRAIT_FIELD(Health, "health", c_player_health_traits, ShieldMultiplier, "shieldMultiplier", Limits::ShieldMultiplier),
+		TRAIT_FIELD(Health, "health", c_player_health_traits, HeadshotImmunity, "headshotImmunity", Limits::HeadshotImmunity),
+		TRAIT_FIELD(Health, "health", c_player_health_traits, ShieldVampirism, "shieldVampirism", Limits::ShieldVampirism),
+
+		TRAIT_FIELD(Weapon, "weapons", c_player_weapon_traits, DamageModifier, "damageModifier", Limits::DamageModifier),
+		TRAIT_FIELD(Weapon, "weapons", c_player_weapon_traits, PrimaryWeaponIndex, "primaryWeapon", Limits::PrimaryWeaponIndex),
+		TRAIT_FIELD(Weapon, "weapons", c_player_weapon_traits, SecondaryWeaponIndex, "secondaryWeapon", Limits::SecondaryWeaponIndex),
+		TRAIT_FIELD(Weapon, "weapons", c_player_weapon_traits, field_0, "initialGrenades", Limits::InitialGrenades),
+		TRAIT_FIELD(Weapon, "weapons", c_player_weapon_traits, InfiniteAmmo, "infiniteAmmo", Limits::InfiniteAmmo),
+		TRAIT_FIELD(Weapon, "weapons", c_player_weapon_traits, GrenadeRegeeration, "grenadeRegeneration", Limits::GrenadeRegeneration),
+		TRAIT_FIELD(Weapon, "weapons", c_player_weapon_traits, WeaponPickup, "weaponPickup", Limits::WeaponPickup),
+
+		TRAIT_FIELD(Movement, "movement", c_player_movement_traits, PlayerSpeed, "speed", Limits::PlayerSpeed),
+		TRAIT_FIELD(Movement, "movement", c_player_movement_traits, PlayerGravity, "gravity", Limits::PlayerGravity),
+		TRAIT_FIELD(Movement, "movement", c_player_movement_traits, VehicleUse, "vehicleUse", Limits::VehicleUse),
+
+		TRAIT_FIELD(Appearance, "appearance", c_player_appearance_traits, ActiveCamo, "activeCamo", Limits::ActiveCamo),
+		TRAIT_FIELD(Appearance, "appearance", c_player_appearance_traits, Waypoint, "waypoint", Limits::Waypoint),
+		TRAIT_FIELD(Appearance, "appearance", c_player_appearance_traits, Aura, "size", Limits::PlayerSize),
+		TRAIT_FIELD(Appearance, "appearance", c_player_appearance_traits, ForcedColor, "forcedColor", Limits::ForcedColor),
+
+		TRAIT_FIELD(Sensory, "sensors", c_player_sensor_traits, MotionTrackerMode, "motionTrackerMode", Limits::MotionTrackerMode),
+		TRAIT_FIELD(Sensory, "sensors", c_player_sensor_traits, MotionTrackerRange, "motionTrackerRange", Limits::MotionTrackerRange),
+	};
+
+#undef TRAIT_FIELD
+}
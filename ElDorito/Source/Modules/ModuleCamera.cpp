@@ -5,6 +5,9 @@
 #include "../Patches/Ui.hpp"
 #include "../Blam/BlamInput.hpp"
 #include "ModuleInput.hpp"
+#include "../Utils/CameraPath.hpp"
+#include <boost/filesystem.hpp>
+#include <fstream>
 
 namespace
 {
@@ -20,6 +23,18 @@ namespace
 
 	bool flying = false;
 
+	// Camera.Speed is the distance moved per 1/60th of a second, so that it feels the same as it did at 60 FPS
+	const float CameraSpeedScale = 60.0f;
+
+	// Z/C zoom speed in radians per second
+	const float FovSpeed = 0.18f;
+
+	const auto CameraPathDirectory = "mods/camera";
+
+	Utils::CameraPath::Path cameraPath;
+	Utils::CameraPath::Player cameraPathPlayer;
+	Utils::CameraPath::FrameClock cameraClock;
+
 	// determine which camera definitions are editable based on the current camera mode
 	bool __stdcall IsCameraDefinitionEditable(CameraDefinitionType definition)
 	{
@@ -213,6 +228,7 @@ namespace
 		auto mode = Utils::String::ToLower(Modules::ModuleCamera::Instance().VarCameraMode->ValueString);
 
 		flying = false;
+		cameraPathPlayer.Stop();
 			
 		Pointer directorGlobalsPtr(ElDorito::GetMainTls(GameGlobals::Director::TLSOffset)[0]);
 
@@ -326,6 +342,153 @@ namespace
 		return true;
 	}
 
+	bool CommandCameraPathAdd(const std::vector<std::string>& Arguments, std::string& returnInfo)
+	{
+		if (!flying)
+		{
+			returnInfo = "Camera path keyframes can only be added in flying mode";
+			return false;
+		}
+
+		Pointer directorGlobalsPtr(ElDorito::GetMainTls(GameGlobals::Director::TLSOffset)[0]);
+		Pointer playerControlGlobalsPtr(ElDorito::GetMainTls(GameGlobals::Input::TLSOffset)[0]);
+
+		Utils::CameraPath::Keyframe keyframe;
+		keyframe.Position.X = directorGlobalsPtr(0x834).Read<float>();
+		keyframe.Position.Y = directorGlobalsPtr(0x838).Read<float>();
+		keyframe.Position.Z = directorGlobalsPtr(0x83C).Read<float>();
+		keyframe.Yaw = playerControlGlobalsPtr(0x30C).Read<float>();
+		keyframe.Pitch = playerControlGlobalsPtr(0x310).Read<float>();
+		keyframe.Fov = directorGlobalsPtr(0x858).Read<float>();
+		cameraPath.Add(keyframe);
+
+		std::stringstream ss;
+		ss << "Added keyframe " << cameraPath.GetKeyframes().size() << " (path length " << cameraPath.GetLength() << ")";
+		returnInfo = ss.str();
+		return true;
+	}
+
+	bool CommandCameraPathClear(const std::vector<std::string>& Arguments, std::string& returnInfo)
+	{
+		cameraPathPlayer.Stop();
+		cameraPath.Clear();
+		returnInfo = "Camera path cleared";
+		return true;
+	}
+
+	bool CommandCameraPathPlay(const std::vector<std::string>& Arguments, std::string& returnInfo)
+	{
+		if (!flying)
+		{
+			returnInfo = "Camera paths can only be played in flying mode";
+			return false;
+		}
+		if (cameraPath.GetKeyframes().size() < 2)
+		{
+			returnInfo = "The camera path needs at least two keyframes";
+			return false;
+		}
+
+		auto speed = Modules::ModuleCamera::Instance().VarCameraSpeed->ValueFloat * CameraSpeedScale;
+		if (Arguments.size() >= 1)
+		{
+			try
+			{
+				speed = std::stof(Arguments[0]);
+			}
+			catch (const std::exception&)
+			{
+				speed = 0;
+			}
+			if (speed <= 0)
+			{
+				returnInfo = "Invalid speed";
+				return false;
+			}
+		}
+
+		cameraPathPlayer.Start(speed);
+		std::stringstream ss;
+		ss << "Playing camera path at " << speed << " units per second";
+		returnInfo = ss.str();
+		return true;
+	}
+
+	bool CommandCameraPathStop(const std::vector<std::string>& Arguments, std::string& returnInfo)
+	{
+		cameraPathPlayer.Stop();
+		return true;
+	}
+
+	bool CommandCameraPathSave(const std::vector<std::string>& Arguments, std::string& returnInfo)
+	{
+		if (Arguments.size() != 1)
+		{
+			returnInfo = "expected camera path name";
+			return false;
+		}
+		if (!Utils::CameraPath::IsValidName(Arguments[0]))
+		{
+			returnInfo = "Invalid camera path name \"" + Arguments[0] + "\"";
+			return false;
+		}
+		if (cameraPath.Empty())
+		{
+			returnInfo = "The camera path is empty";
+			return false;
+		}
+
+		boost::system::error_code error;
+		boost::filesystem::create_directories(CameraPathDirectory, error);
+		auto fileName = (boost::filesystem::path(CameraPathDirectory) / Arguments[0]).replace_extension(".json").string();
+		std::ofstream file(fileName, std::ios::trunc);
+		if (!file.is_open())
+		{
+			returnInfo = "Unable to write " + fileName;
+			return false;
+		}
+		file << Utils::CameraPath::Serialize(cameraPath);
+
+		returnInfo = "Saved camera path to " + fileName;
+		return true;
+	}
+
+	bool CommandCameraPathLoad(const std::vector<std::string>& Arguments, std::string& returnInfo)
+	{
+		if (Arguments.size() != 1)
+		{
+			returnInfo = "expected camera path name";
+			return false;
+		}
+		if (!Utils::CameraPath::IsValidName(Arguments[0]))
+		{
+			returnInfo = "Invalid camera path name \"" + Arguments[0] + "\"";
+			return false;
+		}
+
+		auto fileName = (boost::filesystem::path(CameraPathDirectory) / Arguments[0]).replace_extension(".json").string();
+		std::ifstream file(fileName);
+		if (!file.is_open())
+		{
+			returnInfo = "Unable to read " + fileName;
+			return false;
+		}
+		std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		std::string error;
+		if (!Utils::CameraPath::Deserialize(json, &cameraPath, &error))
+		{
+			returnInfo = "Invalid camera path " + fileName + ": " + error;
+			return false;
+		}
+		cameraPathPlayer.Stop();
+
+		std::stringstream ss;
+		ss << "Loaded " << cameraPath.GetKeyframes().size() << " keyframes from " << fileName;
+		returnInfo = ss.str();
+		return true;
+	}
+
 	bool VariableCameraShowCoordinatesUpdate(const std::vector<std::string>& Arguments, std::string& returnInfo)
 	{
 		auto session = Blam::Network::GetActiveSession();
@@ -402,17 +565,29 @@ namespace Modules
 		VarCameraShowCoordinates = AddVariableInt("ShowCoordinates", "coords", "The cameras field of view", eCommandFlagsArchived, 0, VariableCameraShowCoordinatesUpdate);
 		VarCameraShowCoordinates->ValueIntMin = 0;
 		VarCameraShowCoordinates->ValueIntMax = 1;
+
+		VarCameraPathAdd = AddCommand("PathAdd", "camera_path_add", "Adds the flying camera's position, look angles and field of view to the camera path", eCommandFlagsNone, CommandCameraPathAdd);
+		VarCameraPathClear = AddCommand("PathClear", "camera_path_clear", "Removes all keyframes from the camera path", eCommandFlagsNone, CommandCameraPathClear);
+		VarCameraPathPlay = AddCommand("PathPlay", "camera_path_play", "Moves the flying camera along the camera path at a constant speed", eCommandFlagsNone, CommandCameraPathPlay, { "speed(float) The speed in world units per second, defaults to the camera speed" });
+		VarCameraPathStop = AddCommand("PathStop", "camera_path_stop", "Stops playing the camera path", eCommandFlagsNone, CommandCameraPathStop);
+		VarCameraPathSave = AddCommand("PathSave", "camera_path_save", "Saves the camera path to mods/camera", eCommandFlagsNone, CommandCameraPathSave, { "name(string) The name of the camera path" });
+		VarCameraPathLoad = AddCommand("PathLoad", "camera_path_load", "Loads a camera path from mods/camera", eCommandFlagsNone, CommandCameraPathLoad, { "name(string) The name of the camera path" });
 	}
 
 	void ModuleCamera::UpdatePosition()
 	{
 		if (!flying)
+		{
+			cameraClock.Reset();
 			return;
+		}
 
 		Pointer directorGlobalsPtr(ElDorito::GetMainTls(GameGlobals::Director::TLSOffset)[0]);
 		Pointer playerControlGlobalsPtr(ElDorito::GetMainTls(GameGlobals::Input::TLSOffset)[0]);
 
-		float moveDelta = Modules::ModuleCamera::Instance().VarCameraSpeed->ValueFloat;
+		// scale movement by the frame time so that it doesn't depend on the frame rate
+		float seconds = cameraClock.Tick();
+		float moveDelta = Modules::ModuleCamera::Instance().VarCameraSpeed->ValueFloat * CameraSpeedScale * seconds;
 		float lookDelta = 0.01f;	// not used yet
 
 		// current values
@@ -437,48 +612,66 @@ namespace Modules
 		float iRight = cos(hLookAngle + 3.14159265359f / 2);
 		float jRight = sin(hLookAngle + 3.14159265359f / 2);
 
-		struct ControllerAxes { int16_t LeftX, LeftY, RightX, RightY; };
-		auto& controllerAxes = *(ControllerAxes*)(0x0244D1F0 + 0x2F4);
-		bool controllerEnabled = Pointer::Base(0x204DE98).Read<bool>();
-
-		if (GetActionState(Blam::Input::eGameActionUiLeftBumper)->Ticks > 0)
-			zPos -= moveDelta;
-
-		if (GetActionState(Blam::Input::eGameActionUiRightBumper)->Ticks > 0)
-			zPos += moveDelta;
-
-		if (GetActionState(Blam::Input::eGameActionMoveForward)->Ticks > 0 || GetActionState(Blam::Input::eGameActionMoveBack)->Ticks > 0 || (controllerEnabled && controllerAxes.LeftY != 0))
+		if (cameraPathPlayer.IsPlaying())
 		{
-			float mod = 1;
-			if (controllerEnabled)
-				mod = controllerAxes.LeftY / 32768.0f;
-			else if (GetActionState(Blam::Input::eGameActionMoveBack)->Ticks > 0)
-				mod = -1;
-
-			xPos += iForward * (moveDelta * mod);
-			yPos += jForward * (moveDelta * mod);
-			zPos += kForward * (moveDelta * mod);
+			auto keyframe = cameraPathPlayer.Advance(cameraPath, seconds);
+			xPos = keyframe.Position.X;
+			yPos = keyframe.Position.Y;
+			zPos = keyframe.Position.Z;
+			hLookAngle = keyframe.Yaw;
+			vLookAngle = keyframe.Pitch;
+			fov = keyframe.Fov;
+
+			// update the player's look angles too so that the camera doesn't snap back when playback ends
+			float wrappedAngle = fmod(hLookAngle, 2 * 3.14159265359f);
+			playerControlGlobalsPtr(0x30C).WriteFast<float>(wrappedAngle < 0 ? wrappedAngle + 2 * 3.14159265359f : wrappedAngle);
+			playerControlGlobalsPtr(0x310).WriteFast<float>(vLookAngle);
 		}
-
-		if (GetActionState(Blam::Input::eGameActionMoveLeft)->Ticks > 0 || GetActionState(Blam::Input::eGameActionMoveRight)->Ticks > 0 || (controllerEnabled && controllerAxes.LeftX != 0))
+		else
 		{
-			float mod = 1;
-			if (controllerEnabled)
-				mod = controllerAxes.LeftX / 32768.0f;
-			else if (GetActionState(Blam::Input::eGameActionMoveLeft)->Ticks > 0)
-				mod = -1;
+			struct ControllerAxes { int16_t LeftX, LeftY, RightX, RightY; };
+			auto& controllerAxes = *(ControllerAxes*)(0x0244D1F0 + 0x2F4);
+			bool controllerEnabled = Pointer::Base(0x204DE98).Read<bool>();
 
-			xPos -= iRight * (moveDelta * mod);
-			yPos -= jRight * (moveDelta * mod);
-		}
+			if (GetActionState(Blam::Input::eGameActionUiLeftBumper)->Ticks > 0)
+				zPos -= moveDelta;
 
-		if (GetAsyncKeyState('Z') & 0x8000)
-		{
-			fov -= 0.003f;
-		}
-		if (GetAsyncKeyState('C') & 0x8000)
-		{
-			fov += 0.003f;
+			if (GetActionState(Blam::Input::eGameActionUiRightBumper)->Ticks > 0)
+				zPos += moveDelta;
+
+			if (GetActionState(Blam::Input::eGameActionMoveForward)->Ticks > 0 || GetActionState(Blam::Input::eGameActionMoveBack)->Ticks > 0 || (controllerEnabled && controllerAxes.LeftY != 0))
+			{
+				float mod = 1;
+				if (controllerEnabled)
+					mod = controllerAxes.LeftY / 32768.0f;
+				else if (GetActionState(Blam::Input::eGameActionMoveBack)->Ticks > 0)
+					mod = -1;
+
+				xPos += iForward * (moveDelta * mod);
+				yPos += jForward * (moveDelta * mod);
+				zPos += kForward * (moveDelta * mod);
+			}
+
+			if (GetActionState(Blam::Input::eGameActionMoveLeft)->Ticks > 0 || GetActionState(Blam::Input::eGameActionMoveRight)->Ticks > 0 || (controllerEnabled && controllerAxes.LeftX != 0))
+			{
+				float mod = 1;
+				if (controllerEnabled)
+					mod = controllerAxes.LeftX / 32768.0f;
+				else if (GetActionState(Blam::Input::eGameActionMoveLeft)->Ticks > 0)
+					mod = -1;
+
+				xPos -= iRight * (moveDelta * mod);
+				yPos -= jRight * (moveDelta * mod);
+			}
+
+			if (GetAsyncKeyState('Z') & 0x8000)
+			{
+				fov -= FovSpeed * seconds;
+			}
+			if (GetAsyncKeyState('C') & 0x8000)
+			{
+				fov += FovSpeed * seconds;
+			}
 		}
 
 		// update position
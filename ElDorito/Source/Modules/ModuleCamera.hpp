@@ -20,6 +20,12 @@ namespace Modules
 		Command* VarCameraLoad;
 		Command* VarCameraPosition;
 		Command* VarCameraShowCoordinates;
+		Command* VarCameraPathAdd;
+		Command* VarCameraPathClear;
+		Command* VarCameraPathPlay;
+		Command* VarCameraPathStop;
+		Command* VarCameraPathSave;
+		Command* VarCameraPathLoad;
 
 		// patches to stop camera mode from changing
 		Patch Debug1CameraPatch;
@@ -14,12 +14,16 @@
 #include "../Patches/Core.hpp"
 #include "../Patches/Forge.hpp"
 #include "../Patches/Maps.hpp"
+#include "../Patches/GameEngineSettings.hpp"
+#include "../Game/GameVariantText.hpp"
 #include "../Web/WebRenderer.hpp"
 #include "../Web/Ui/ScreenLayer.hpp"
+#include "../Web/Ui/MpEventDispatcher.hpp"
 #include "ModuleServer.hpp"
 #include "../Patch.hpp"
 #include "boost/filesystem.hpp"
 #include "../Utils/Logger.hpp"
+#include "../Utils/HttpUpdateTransport.hpp"
 #include "../ThirdParty/rapidjson/rapidjson.h"
 #include "../ThirdParty/rapidjson/document.h"
 #include "../ThirdParty/rapidjson/stringbuffer.h"
@@ -149,16 +153,20 @@ namespace
 				vect->push_back(str);
 				ss << "Added \"" << str << "\" to " << (exclude ? "exclude" : "include") << " filters list" << std::endl << std::endl;
 			}
+
+			auto &gameModule = Modules::ModuleGame::Instance();
+			Utils::Logger::Instance().SetFilters(gameModule.FiltersInclude, gameModule.FiltersExclude);
 		}
 
+		ss << "Patterns can start with (?i) to ignore case, start with ^ to match the start of a message, or end with $ to match the end." << std::endl << std::endl;
 		ss << "Include filters (message must contain these strings):";
 
-		for (auto filter : Modules::ModuleGame::Instance().FiltersInclude)
+		for (auto &&filter : Modules::ModuleGame::Instance().FiltersInclude)
 			ss << std::endl << filter;
 
 		ss << std::endl << std::endl << "Exclude filters (message must not contain these strings):";
 
-		for (auto filter : Modules::ModuleGame::Instance().FiltersExclude)
+		for (auto &&filter : Modules::ModuleGame::Instance().FiltersExclude)
 			ss << std::endl << filter;
 
 		returnInfo = ss.str();
@@ -546,20 +554,41 @@ namespace
 		return true;
 	}
 
+	const auto GameVariantBlfSize = 0x3BC;
+
+	// Where the trait profiles were in the last variant of each game type that the game parsed.
+	// The layout of a variant only depends on its game type, so this also locates the trait profiles
+	// in built-in variants, which the game generates from the wezr tag instead of parsing.
+	std::vector<size_t> traitProfileLayouts[Blam::GameType::GameTypeCount];
+
+	bool ParseGameVariant(const uint8_t *blfData, uint8_t *out, std::vector<size_t> *traitProfileOffsets = nullptr)
+	{
+		typedef bool(__thiscall *ParseGameVariantBlfPtr)(const void *blf, uint8_t *outVariant, bool *result);
+		auto ParseGameVariantBlf = reinterpret_cast<ParseGameVariantBlfPtr>(0x573150);
+
+		// Note where the trait profiles end up so that text variants can edit them
+		Patches::GameEngineSettings::BeginTraitProfileCapture(out, Game::GameVariantText::VariantSize);
+		auto result = ParseGameVariantBlf(blfData, out, nullptr);
+		auto offsets = Patches::GameEngineSettings::EndTraitProfileCapture();
+
+		auto type = reinterpret_cast<const Blam::BLAM_GAME_VARIANT*>(out)->GameType;
+		if (result && type < Blam::GameType::GameTypeCount && !offsets.empty())
+			traitProfileLayouts[type] = offsets;
+		if (traitProfileOffsets)
+			*traitProfileOffsets = std::move(offsets);
+		return result;
+	}
+
 	bool LoadGameVariant(std::ifstream &file, uint8_t *out)
 	{
 		// Verify file size
-		const auto GameVariantBlfSize = 0x3BC;
 		if (GetFileSize(file) < GameVariantBlfSize)
 			return false;
 
 		// Load it into a buffer and have the game parse it
 		uint8_t blfData[GameVariantBlfSize];
 		file.read(reinterpret_cast<char*>(blfData), GameVariantBlfSize);
-
-		typedef bool(__thiscall *ParseGameVariantBlfPtr)(void *blf, uint8_t *outVariant, bool *result);
-		auto ParseGameVariant = reinterpret_cast<ParseGameVariantBlfPtr>(0x573150);
-		return ParseGameVariant(blfData, out, nullptr);
+		return ParseGameVariant(blfData, out);
 	}
 
 	template<class T>
@@ -646,6 +675,149 @@ namespace
 		"vip",
 	};
 
+	// Opens the binary file of a custom game variant.
+	bool OpenGameVariantFile(const std::string &name, std::ifstream &file, std::string &fileName)
+	{
+		for (auto &&extension : GameTypeExtensions)
+		{
+			fileName = "mods/variants/" + name + "/variant." + extension;
+			file.open(fileName, std::ios::binary);
+			if (file.is_open())
+				return true;
+		}
+		return false;
+	}
+
+	// Reads the BLF data of a custom game variant. Returns false if there isn't a valid file for it.
+	bool ReadGameVariantFile(const std::string &name, std::string &blfData)
+	{
+		blfData.clear();
+
+		std::ifstream file;
+		std::string fileName;
+		if (!OpenGameVariantFile(name, file, fileName) || GetFileSize(file) < GameVariantBlfSize)
+			return false;
+
+		blfData.resize(GameVariantBlfSize);
+		file.read(&blfData[0], GameVariantBlfSize);
+		return true;
+	}
+
+	// Parses custom variant files until the trait profile layout of a game type is known.
+	void FindTraitProfileLayout(uint32_t type)
+	{
+		boost::system::error_code error;
+		for (boost::filesystem::directory_iterator it("mods/variants", error), end; !error && it != end; it.increment(error))
+		{
+			std::string blfData;
+			if (!ReadGameVariantFile(it->path().filename().string(), blfData))
+				continue;
+
+			uint8_t variantData[Game::GameVariantText::VariantSize];
+			ParseGameVariant(reinterpret_cast<const uint8_t*>(blfData.c_str()), variantData);
+			if (!traitProfileLayouts[type].empty())
+				return;
+		}
+	}
+
+	// Loads a custom variant from its BLF data, or a built-in variant if there is no data.
+	bool LoadBaseGameVariant(const std::string &name, const std::string &blfData, uint8_t *out, std::vector<size_t> &traitProfileOffsets)
+	{
+		traitProfileOffsets.clear();
+		if (!blfData.empty())
+			return ParseGameVariant(reinterpret_cast<const uint8_t*>(blfData.c_str()), out, &traitProfileOffsets);
+		if (!LoadDefaultGameVariant(name, out))
+			return false;
+
+		auto type = reinterpret_cast<const Blam::BLAM_GAME_VARIANT*>(out)->GameType;
+		if (type >= Blam::GameType::GameTypeCount)
+			return true;
+		if (traitProfileLayouts[type].empty())
+			FindTraitProfileLayout(type);
+		traitProfileOffsets = traitProfileLayouts[type];
+		return true;
+	}
+
+	// Loads a text variant, using the compiled form if it's up to date.
+	bool LoadTextGameVariant(const std::string &name, std::ifstream &file, uint8_t *out, std::string &returnInfo)
+	{
+		std::stringstream textStream;
+		textStream << file.rdbuf();
+		auto text = textStream.str();
+
+		std::string base, error;
+		if (!Game::GameVariantText::GetBase(text, base, error))
+		{
+			returnInfo += "\n" + error;
+			return false;
+		}
+
+		// The compiled variant is only up to date if neither the text nor the base file have changed
+		std::string baseData;
+		ReadGameVariantFile(base, baseData);
+		auto hash = Game::GameVariantText::ComputeHash(text, baseData);
+		auto compiledFileName = "mods/variants/" + name + "/variant.bin";
+		if (Game::GameVariantText::LoadCompiled(compiledFileName, hash, out))
+			return true;
+
+		uint8_t variantData[Game::GameVariantText::VariantSize];
+		std::vector<size_t> traitProfileOffsets;
+		if (!LoadBaseGameVariant(base, baseData, variantData, traitProfileOffsets))
+		{
+			returnInfo += "\nInvalid base game variant " + base + "!";
+			return false;
+		}
+
+		if (!Game::GameVariantText::Compile(text, traitProfileOffsets, variantData, error))
+		{
+			returnInfo += "\n" + error;
+			if (baseData.empty() && traitProfileOffsets.empty())
+				returnInfo += "\nThe trait profiles of built-in gametypes can only be edited if there is a custom variant of the same type in mods/variants.";
+			return false;
+		}
+		memcpy(out, variantData, sizeof(variantData));
+
+		if (!Game::GameVariantText::SaveCompiled(compiledFileName, hash, out))
+			returnInfo += "\nUnable to save " + compiledFileName;
+		return true;
+	}
+
+	bool CommandExportGameType(const std::vector<std::string>& Arguments, std::string& returnInfo)
+	{
+		if (Arguments.size() != 1)
+		{
+			returnInfo = "You must specify a built-in gametype or custom gametype name!";
+			return false;
+		}
+		auto name = Arguments[0];
+
+		uint8_t variantData[Game::GameVariantText::VariantSize];
+		std::string blfData;
+		std::vector<size_t> traitProfileOffsets;
+		ReadGameVariantFile(name, blfData);
+		if (!LoadBaseGameVariant(name, blfData, variantData, traitProfileOffsets))
+		{
+			returnInfo = "Invalid game variant " + name + "!";
+			return false;
+		}
+
+		// Exporting a custom variant puts the text next to it, where it takes priority when loading the variant
+		auto directory = "mods/variants/" + name;
+		boost::system::error_code error;
+		boost::filesystem::create_directories(directory, error);
+		auto textFileName = directory + "/variant.json";
+		std::ofstream textFile(textFileName, std::ios::trunc);
+		if (!textFile.is_open())
+		{
+			returnInfo = "Unable to write " + textFileName;
+			return false;
+		}
+		textFile << Game::GameVariantText::Decompile(variantData, traitProfileOffsets, name);
+
+		returnInfo = "Exported " + name + " to " + textFileName;
+		return true;
+	}
+
 	bool CommandGameType(const std::vector<std::string>& Arguments, std::string& returnInfo)
 	{
 		if (Arguments.size() != 1)
@@ -661,18 +833,21 @@ namespace
 		auto name = Arguments[0];
 		uint8_t variantData[0x264];
 
-		// Check if this is a custom gametype by searching for a file
-		// corresponding to each supported game mode
+		// Check if this is a custom gametype by searching for a text variant
+		// or a file corresponding to each supported game mode
 		std::ifstream gameVariant;
-		std::string variantFileName;
-		for (auto &&extension : GameTypeExtensions)
+		std::string variantFileName = "mods/variants/" + name + "/variant.json";
+		gameVariant.open(variantFileName);
+		if (gameVariant.is_open())
 		{
-			variantFileName = "mods/variants/" + name + "/variant." + extension;
-			gameVariant.open(variantFileName, std::ios::binary);
-			if (gameVariant.is_open())
-				break;
+			returnInfo = "Loading text game variant " + variantFileName + "...";
+			if (!LoadTextGameVariant(name, gameVariant, variantData, returnInfo))
+			{
+				returnInfo += "\nInvalid game variant file!";
+				return false;
+			}
 		}
-		if (gameVariant.is_open())
+		else if (OpenGameVariantFile(name, gameVariant, variantFileName))
 		{
 			returnInfo = "Loading game variant " + variantFileName + "...";
 			if (!LoadGameVariant(gameVariant, variantData))
@@ -822,26 +997,16 @@ namespace
 	
 	bool CommandListMedalPacks(const std::vector<std::string>& arguments, std::string& returnInfo)
 	{
-		Modules::ModuleGame::Instance().MedalPackList.clear();
-		boost::filesystem::path p("mods/medals/");
-		boost::filesystem::directory_iterator end_itr;
-		if (boost::filesystem::exists(p))
-		{
-			// cycle through the directory
-			for (boost::filesystem::directory_iterator itr(p); itr != end_itr; ++itr)
-			{
-				if (!is_regular_file(itr->path()))
-				{
-					std::string file = std::string(itr->path().generic_string());
-					file.append("\\events.json");
-					auto path = boost::filesystem::path(file);
-					if (boost::filesystem::exists(path))
-						Modules::ModuleGame::Instance().MedalPackList.push_back(itr->path().filename().string());
-				}
-			}
-		}
+		// Only packs that changed since the last call are validated again
+		auto &gameModule = Modules::ModuleGame::Instance();
+		gameModule.MedalPacks.Refresh();
+
+		gameModule.MedalPackList.clear();
+		for (auto &&pack : gameModule.MedalPacks.GetPacks())
+			gameModule.MedalPackList.push_back(pack.Name);
+
 		// Return a comma-separated list
-		for (auto&& name : Modules::ModuleGame::Instance().MedalPackList)
+		for (auto&& name : gameModule.MedalPackList)
 		{
 			if (returnInfo.length() > 0)
 				returnInfo += ',';
@@ -1107,8 +1272,59 @@ namespace
 		return true;
 	}
 
+	bool CommandMapPrefetchStatus(const std::vector<std::string>& Arguments, std::string& returnInfo)
+	{
+		auto stats = Patches::Maps::GetPrefetchStats();
+
+		std::stringstream ss;
+		ss << "Status: " << (stats.Running ? "running" : (stats.Cancelled ? "cancelled" : "idle")) << std::endl;
+		ss << "Files: " << stats.FilesCompleted << " completed, " << stats.FilesFailed << " failed" << std::endl;
+		ss << "Prefetched: " << stats.BytesPrefetched / 1024 << " of " << stats.BytesRequested / 1024 << " KB in " << stats.ElapsedSeconds << "s" << std::endl;
+		ss << "Estimated load time saved: " << stats.ReadSeconds << "s";
+		returnInfo = ss.str();
+		return true;
+	}
+
+	Utils::UpdateEngine &GetUpdateEngine()
+	{
+		static Utils::UpdateEngine engine(ElDorito::Instance().GetDirectory(), Utils::UpdatePublicKey);
+		return engine;
+	}
+
+	bool VariableUpdateUrlUpdated(const std::vector<std::string>& arguments, std::string& returnInfo)
+	{
+		// Only the signature protects an update sent in the clear, so don't allow it at all
+		if (arguments.size() < 1 || arguments[0].empty() || Utils::HttpUpdateTransport::IsSecureUrl(arguments[0]))
+			return true;
+
+		returnInfo = "The update URL has to start with https://";
+		return false;
+	}
+
 	bool CommandGameUpdate(const std::vector<std::string>& Arguments, std::string& returnInfo)
 	{
+		auto &updateUrl = Modules::ModuleGame::Instance().VarUpdateUrl->ValueString;
+		if (!updateUrl.empty())
+		{
+			// The config could have been edited by hand, so this is checked here as well as when the variable is set
+			if (!Utils::HttpUpdateTransport::IsSecureUrl(updateUrl))
+			{
+				returnInfo = "Game.UpdateURL has to be an https:// URL";
+				return false;
+			}
+
+			auto &engine = GetUpdateEngine();
+			if (engine.IsRunning())
+			{
+				returnInfo = "An update is already in progress. Use Game.UpdateStatus to see its progress.";
+				return false;
+			}
+			engine.Start(std::make_shared<Utils::HttpUpdateTransport>(updateUrl));
+			returnInfo = "Checking for updates. Use Game.UpdateStatus to see the progress.";
+			return true;
+		}
+
+		// Without an update URL, fall back to the standalone updater
 		auto ret = int(ShellExecuteA(nullptr, nullptr, "updater.exe", "", nullptr, SW_SHOWNORMAL));
 		if (ret <= 32)
 		{
@@ -1127,6 +1343,46 @@ namespace
 		return CommandGameExit(Arguments, returnInfo);
 	}
 
+	bool CommandGameUpdateStatus(const std::vector<std::string>& Arguments, std::string& returnInfo)
+	{
+		auto progress = GetUpdateEngine().GetProgress();
+
+		std::stringstream ss;
+		switch (progress.State)
+		{
+		case Utils::UpdateState::Idle:
+			ss << "Status: idle";
+			break;
+		case Utils::UpdateState::Checking:
+			ss << "Status: checking for updates";
+			break;
+		case Utils::UpdateState::Downloading:
+			ss << "Status: downloading";
+			break;
+		case Utils::UpdateState::UpToDate:
+			ss << "Status: up to date";
+			break;
+		case Utils::UpdateState::Staged:
+			ss << "Status: the update will be installed the next time the game starts";
+			break;
+		case Utils::UpdateState::Failed:
+			ss << "Status: failed (" << progress.Error << ")";
+			break;
+		case Utils::UpdateState::Cancelled:
+			ss << "Status: cancelled";
+			break;
+		}
+		if (!progress.Version.empty())
+			ss << std::endl << "Version: " << progress.Version;
+		if (progress.FilesToDownload)
+		{
+			ss << std::endl << "Files: " << progress.FilesDownloaded << " of " << progress.FilesToDownload;
+			ss << std::endl << "Downloaded: " << progress.BytesDownloaded / 1024 << " of " << progress.BytesToDownload / 1024 << " KB";
+		}
+		returnInfo = ss.str();
+		return true;
+	}
+
 	//EXAMPLE:
 	/*std::string VariableGameNameUpdate(const std::vector<std::string>& Arguments)
 	{
@@ -1143,7 +1399,7 @@ namespace
 
 namespace Modules
 {
-	ModuleGame::ModuleGame() : ModuleBase("Game")
+	ModuleGame::ModuleGame() : ModuleBase("Game"), MedalPacks("mods/medals/", Web::Ui::MpEventDispatcher::IsEventName)
 	{
 		AddCommand("LogLevel", "loglevel", "Debug log verbosity level", eCommandFlagsNone, CommandGameLogLevel, { "trace|info|warning|error|none The log verbosity level" });
 
@@ -1165,6 +1421,8 @@ namespace Modules
 
 		AddCommand("GameType", "gametype", "Loads a gametype", eCommandFlagsNone, CommandGameType, { "name(string) The internal name of the built-in gametype or custom gametype to load" });
 
+		AddCommand("ExportGameType", "export_gametype", "Writes a gametype out as a text variant (mods/variants/<name>/variant.json)", eCommandFlagsNone, CommandExportGameType, { "name(string) The internal name of the built-in gametype or custom gametype to export" });
+
 		AddCommand("Start", "start", "Starts or restarts the game", eCommandFlagsNone, CommandGameStart);
 
 		AddCommand("End", "end", "Ends the game", eCommandFlagsNone, CommandGameEnd);
@@ -1201,6 +1459,12 @@ namespace Modules
 
 		AddCommand("Update", "update", "Update the game to the latest version", eCommandFlagsNone, CommandGameUpdate);
 
+		AddCommand("UpdateStatus", "update_status", "Displays the progress of the last update", eCommandFlagsNone, CommandGameUpdateStatus);
+
+		VarUpdateUrl = AddVariableString("UpdateURL", "update_url", "HTTPS URL of the update manifest, which is signed in <URL>.sig. If this is empty, Game.Update runs updater.exe instead", eCommandFlagsArchived, "", VariableUpdateUrlUpdated);
+
+		AddCommand("MapPrefetchStatus", "map_prefetch_status", "Displays the progress of the last map prefetch", eCommandFlagsNone, CommandMapPrefetchStatus);
+
 		VarMenuURL = AddVariableString("MenuURL", "menu_url", "url(string) The URL of the page you want to load inside the menu", eCommandFlagsArchived, "http://scooterpsu.github.io/");
 
 		VarLanguage = AddVariableString("Language", "language", "The language to use", eCommandFlagsArchived, "english", VariableLanguageUpdated);
@@ -1249,6 +1513,14 @@ namespace Modules
 		VarDiscordEnable = AddVariableInt("Discord.Enable", "discord.enable", "Enable/disable discord integration", eCommandFlagsArchived, 1);
 		VarDiscordAutoAccept = AddVariableInt("Discord.AutoAccept", "discord.auto_accept", "Allow auto accepting join requests", eCommandFlagsArchived, 0);
 
+		VarMapPrefetch = AddVariableInt("MapPrefetch", "map_prefetch", "Read the next map into the file cache as soon as it has been voted on", eCommandFlagsArchived, 1);
+		VarMapPrefetch->ValueIntMin = 0;
+		VarMapPrefetch->ValueIntMax = 1;
+
+		VarMapPrefetchRate = AddVariableInt("MapPrefetchRate", "map_prefetch_rate", "Maximum read rate of the map prefetcher in KB/s (0 = unlimited)", eCommandFlagsArchived, 32768);
+
+		VarMapPrefetchSharedLimit = AddVariableInt("MapPrefetchSharedLimit", "map_prefetch_shared_limit", "Maximum number of MB to prefetch from each shared cache file (0 = only prefetch the .map file)", eCommandFlagsArchived, 64);
+
 		/*EXAMPLES: adds a variable "Game.Name", default value ElDewrito, calls VariableGameNameUpdate when value is updated
 		AddVariableString("Name", "gamename", "Title of the game", "ElDewrito", VariableGameNameUpdate);
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ModuleBase.hpp"
+#include "../Game/MedalPackCatalog.hpp"
 
 namespace Modules
 {
@@ -25,12 +26,17 @@ namespace Modules
 		Command* VarCefMedals;
 		Command* VarDiscordEnable;
 		Command* VarDiscordAutoAccept;
+		Command* VarMapPrefetch;
+		Command* VarMapPrefetchRate;
+		Command* VarMapPrefetchSharedLimit;
+		Command* VarUpdateUrl;
 
 		int DebugFlags;
 
 		std::vector<std::string> CustomMapList;
 		std::vector<std::string> MapList;
 		std::vector<std::string> MedalPackList;
+		Game::MedalPackCatalog MedalPacks;
 		std::vector<std::string> FiltersExclude;
 		std::vector<std::string> FiltersInclude;
 
@@ -1,12 +1,9 @@
 #include "ModuleGraphics.hpp"
 #include <sstream>
-#include <unordered_set>
-#include <algorithm>
 #include "../ElDorito.hpp"
 #include "../Blam/BlamTypes.hpp"
 #include "../Patches/Ui.hpp"
-#include "../ThirdParty/rapidjson/stringbuffer.h"
-#include "../ThirdParty/rapidjson/writer.h"
+#include "../Utils/DisplayModes.hpp"
 #include <boost/regex.hpp>
 
 namespace
@@ -155,36 +152,13 @@ namespace
 
 	bool CommandSupportedResolutions(const std::vector<std::string>& Arguments, std::string& returnInfo)
 	{
-		DEVMODE devmode = { 0 };
-		devmode.dmSize = sizeof(devmode);
-		std::vector<DEVMODE> supportedDevModes;
-		std::unordered_set<uint64_t> seen;
-
-		for (auto i = 0; EnumDisplaySettings(NULL, i, &devmode); i++)
-		{
-			auto key = (uint64_t)devmode.dmPelsWidth << 32 | devmode.dmPelsHeight;
-			if (seen.find(key) == seen.end())
-			{
-				seen.insert(key);
-				supportedDevModes.emplace_back(devmode);
-			}
-		}
-
-		std::sort(supportedDevModes.begin(), supportedDevModes.end(),
-			[](const DEVMODE& a, const DEVMODE& b) { return a.dmPelsWidth < b.dmPelsWidth; });
-
-		rapidjson::StringBuffer buffer;
-		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-
-		writer.StartArray();
-		for (const auto& d : supportedDevModes)
-		{
-			auto resolutionStr = std::to_string(d.dmPelsWidth) + "x" + std::to_string(d.dmPelsHeight);
-			writer.String(resolutionStr.c_str());
-		}
-		writer.EndArray();
+		returnInfo = Utils::DisplayModes::GetResolutionsJson();
+		return true;
+	}
 
-		returnInfo = buffer.GetString();
+	bool CommandSupportedDisplayModes(const std::vector<std::string>& Arguments, std::string& returnInfo)
+	{
+		returnInfo = Utils::DisplayModes::GetDisplayModesJson();
 		return true;
 	}
 }
@@ -235,5 +209,6 @@ namespace Modules
 		VarCustomHUDColorsSecondary = AddVariableString("CustomHUDColorsSecondary", "hud_colors_2", "Change the primary custom HUD color.", eCommandFlagsArchived, "#27CB9B", VariableCustomHUDColorsUpdate);
 
 		AddCommand("SupportedResolutions", "supported_resolutions", "List the supported screen resolutions", eCommandFlagsNone, CommandSupportedResolutions);
+		AddCommand("SupportedDisplayModes", "supported_display_modes", "List the supported screen resolutions and their refresh rates", eCommandFlagsNone, CommandSupportedDisplayModes);
 	}
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <iomanip>
 #include <algorithm>
 #include <unordered_set>
+#include <future>
 
 namespace
 {
@@ -124,14 +125,20 @@ namespace
 	}
 	bool GenerateTimestamp(const std::vector<std::string>& Arguments, std::string& returnInfo)
 	{
-		auto &modulePlayer = Modules::ModulePlayer::Instance();
-		std::string encryptedString;
 		time_t now = time(0);
 		std::tm* now_tm = gmtime(&now);
 		char buf[42];
 		strftime(buf, 42, "%Y%m%d %X", now_tm);
-		Utils::Cryptography::PrivateEncrypt(Utils::Cryptography::ReformatKey(true, modulePlayer.VarPlayerPrivKey->ValueString), buf, strlen(buf), encryptedString);
-		returnInfo = encryptedString;
+
+		// Goes through the signing queue like every other use of the private key. The command has to return the result,
+		// so it still waits for it.
+		std::promise<std::string> encrypted;
+		auto result = encrypted.get_future();
+		Patches::PlayerUid::GetIdentity().PrivateEncryptAsync(std::vector<uint8_t>(buf, buf + strlen(buf)), [&encrypted](bool success, const std::string &encryptedString)
+		{
+			encrypted.set_value(success ? encryptedString : "");
+		});
+		returnInfo = result.get();
 		return true;
 	}
 	std::string GenerateRandomServiceTag()
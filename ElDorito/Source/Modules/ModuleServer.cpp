@@ -3,6 +3,7 @@
 #include <Windows.h>
 
 #include "ModuleServer.hpp"
+#include "../ConfigSnapshot.hpp"
 #include <sstream>
 #include <fstream>
 #include <algorithm>
@@ -109,13 +110,16 @@ namespace
 
 		GetEndpoints(announceEndpoints, "announce");
 
+		auto config = Modules::ConfigSnapshot::Current();
+		auto &port = config->GetString(Modules::ModuleServer::Instance().VarServerPort);
+
 		for (auto server : announceEndpoints)
 		{
 			HttpRequest req(L"ElDewrito/" + Utils::String::WidenString(Utils::Version::GetVersionString()), L"", L"");
 
 			try
 			{
-				if (!req.SendRequest(Utils::String::WidenString(server + "?port=" + Modules::ModuleServer::Instance().VarServerPort->ValueString), L"GET", L"", L"", L"", NULL, 0))
+				if (!req.SendRequest(Utils::String::WidenString(server + "?port=" + port), L"GET", L"", L"", L"", NULL, 0))
 				{
 					ss << "Unable to connect to master server " << server << " (error: " << req.lastError << "/" << std::to_string(GetLastError()) << ")" << std::endl << std::endl;
 					continue;
@@ -167,7 +171,7 @@ namespace
 
 		std::string errors = ss.str();
 		if (errors.length() > 0)
-			Utils::Logger::Instance().Log(Utils::LogTypes::Network, Utils::LogLevel::Info, "Announce: " + ss.str());
+			Utils::Logger::Instance().Log(Utils::LogTypes::Network, Utils::LogLevel::Info, "Announce: %s", errors.c_str());
 
 		return true;
 	}
@@ -179,13 +183,16 @@ namespace
 
 		GetEndpoints(announceEndpoints, "announce");
 
+		auto config = Modules::ConfigSnapshot::Current();
+		auto &port = config->GetString(Modules::ModuleServer::Instance().VarServerPort);
+
 		for (auto server : announceEndpoints)
 		{
 			HttpRequest req(L"ElDewrito/" + Utils::String::WidenString(Utils::Version::GetVersionString()), L"", L"");
 
 			try
 			{
-				if (!req.SendRequest(Utils::String::WidenString(server + "?port=" + Modules::ModuleServer::Instance().VarServerPort->ValueString + "&shutdown=true"), L"GET", L"", L"", L"", NULL, 0))
+				if (!req.SendRequest(Utils::String::WidenString(server + "?port=" + port + "&shutdown=true"), L"GET", L"", L"", L"", NULL, 0))
 				{
 					ss << "Unable to connect to master server " << server << " (error: " << req.lastError << "/" << std::to_string(GetLastError()) << ")" << std::endl << std::endl;
 					continue;
@@ -237,7 +244,7 @@ namespace
 
 		std::string errors = ss.str();
 		if (errors.length() > 0)
-			Utils::Logger::Instance().Log(Utils::LogTypes::Network, Utils::LogLevel::Info, "Unannounce: " + ss.str());
+			Utils::Logger::Instance().Log(Utils::LogTypes::Network, Utils::LogLevel::Info, "Unannounce: %s", errors.c_str());
 
 		return true;
 	}
@@ -1,4 +1,5 @@
 #include "ModuleUPnP.hpp"
+#include "../ElDorito.hpp"
 
 #include <miniupnpc/upnpcommands.h>
 #include <string>
@@ -7,15 +8,20 @@ namespace Modules
 {
 	ModuleUPnP::ModuleUPnP() : ModuleBase("UPnP")
 	{
-		upnpDevice = upnpDiscover(2000, NULL, NULL, 0, 0, 2, &upnpDiscoverError);
-
 		VarUPnPEnabled = AddVariableInt("Enabled", "upnp_enabled", "Enables UPnP to automatically port forward when hosting a game.", eCommandFlagsArchived, 1);
 		VarUPnPEnabled->ValueIntMin = 0;
 		VarUPnPEnabled->ValueIntMax = 1;
 	}
 
+	void ModuleUPnP::Discover()
+	{
+		upnpDevice = upnpDiscover(2000, NULL, NULL, 0, 0, 2, &upnpDiscoverError);
+	}
+
 	Utils::UPnPResult ModuleUPnP::UPnPForwardPort(bool tcp, int externalport, int internalport, const std::string & ruleName)
 	{
+		ElDorito::Instance().WaitForStartupStage("upnp-discovery");
+
 		struct UPNPUrls urls;
 		struct IGDdatas data;
 		char lanaddr[16];
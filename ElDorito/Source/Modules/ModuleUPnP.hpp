@@ -13,9 +13,13 @@ namespace Modules
 		Command* VarUPnPEnabled;
 
 		ModuleUPnP();
+
+		// Looks for a UPnP device. This blocks for up to 2 seconds, so it runs as a startup stage instead of in the constructor.
+		void Discover();
+
 		Utils::UPnPResult UPnPForwardPort(bool tcp, int externalport, int internalport, const std::string & ruleName);
 	private:
-		int upnpDiscoverError;
+		int upnpDiscoverError = UPNPDISCOVER_UNKNOWN_ERROR;
 		UPNPDev* upnpDevice = nullptr;
 	};
 }
\ No newline at end of file
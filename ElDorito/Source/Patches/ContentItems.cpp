@@ -62,6 +62,7 @@ namespace
 	bool __fastcall c_gui_map_selected_item__get_file_path_hook(void *thisptr, void *unused, char *buff, int bufflen);
 	bool __fastcall c_gui_game_variant_selected_item__get_file_path_hook(void *thisptr, void *unused, char *buff, int bufflen);
 	void __fastcall c_content_item_delete_hook(c_content_item *thisptr, void *unused, int a1);
+	void IndexBLFContentFiles(const std::wstring &path);
 
 	struct
 	{
@@ -132,6 +133,21 @@ namespace Patches::ContentItems
 		Hook(0x127500, malloc, HookFlags::IsCall).Apply();
 		Hook(0x1275E0, free, HookFlags::IsCall).Apply();
 	}
+
+	void IndexContentFiles()
+	{
+		// The directories are read with the wide APIs so that names outside the ANSI code page survive, the paths are
+		// stored as UTF-8 like every other content item path
+		wchar_t currentDir[kMaxPath];
+		memset(currentDir, 0, kMaxPath * sizeof(wchar_t));
+		GetCurrentDirectoryW(kMaxPath, currentDir);
+
+		std::wstring variantPath = std::wstring(currentDir) + L"\\mods\\variants";
+		std::wstring mapsPath = std::wstring(currentDir) + L"\\mods\\maps";
+
+		IndexBLFContentFiles(variantPath);
+		IndexBLFContentFiles(mapsPath);
+	}
 }
 
 namespace
@@ -139,10 +155,19 @@ namespace
 	uint8_t* contentItemsGlobal = 0;
 	bool enumerated = false;
 
-	bool AddContentItem(wchar_t* itemPath)
+	const size_t ContentHeaderSize = 0xF8;
+
+	// A BLF file found by IndexContentFiles()
+	struct IndexedContentFile
 	{
-		uint8_t fileData[0xF8];
+		std::string Path;
+		uint8_t Header[ContentHeaderSize];
+	};
+	std::vector<IndexedContentFile> indexedContentFiles;
 
+	// Reads the content header from a BLF file. Returns false if it isn't a BLF.
+	bool ReadContentHeader(const wchar_t *itemPath, uint8_t *fileData)
+	{
 		FILE* file;
 		if (_wfopen_s(&file, itemPath, L"rb") != 0 || !file)
 			return false;
@@ -167,9 +192,14 @@ namespace
 		}
 
 		fseek(file, 0x40, SEEK_SET);
-		fread(fileData, 1, 0xF8, file);
+		fread(fileData, 1, ContentHeaderSize, file);
 		fclose(file);
+		return true;
+	}
 
+	// Adds a content item to the game's content list from its path and header.
+	void AddContentItem(const std::string &path, const uint8_t *fileData)
+	{
 		const auto sub_525330 = (signed int(*)(int a1))(0x525330);
 
 		typedef int(__cdecl *GlobalsArrayPushFunc)(void* globalArrayPtr);
@@ -186,19 +216,9 @@ namespace
 		contentItem->Unknown04 = 0x11;
 		contentItem->ContentType = contentType;
 		contentItem->Catalog = contentCatalog;
-		memcpy(contentItem->ContentHeader, fileData, 0xF8);
+		memcpy(contentItem->ContentHeader, fileData, ContentHeaderSize);
 
-		auto path = Utils::String::ThinString(itemPath);
 		strcpy_s(contentItem->FilePath, path.c_str());
-
-		return true;
-	}
-
-	bool AddContentItem(std::string itemPath)
-	{
-		// need to convert path from ASCII to unicode now
-		std::wstring unicode = Utils::String::WidenString(itemPath);
-		return AddContentItem((wchar_t*)unicode.c_str());
 	}
 
 	void GetFilePathForItem(wchar_t* dest, size_t MaxCount, wchar_t* variantName, int variantType)
@@ -224,28 +244,35 @@ namespace
 		}
 	}
 
-	void AddAllBLFContentItems(std::string path)
+	void IndexBLFContentFiles(const std::wstring &path)
 	{
-		struct dirent *entry;
-		DIR *dp;
-		dp = opendir(path.c_str());
+		struct _wdirent *entry;
+		_WDIR *dp;
+		dp = _wopendir(path.c_str());
 		if (dp == NULL)
 			return;
 
-		while ((entry = readdir(dp)))
+		while ((entry = _wreaddir(dp)))
 		{
-			if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+			if (wcscmp(entry->d_name, L".") == 0 || wcscmp(entry->d_name, L"..") == 0)
 				continue;
 
-			std::string filePath = path + std::string("\\") + std::string(entry->d_name);
+			std::wstring filePath = path + L"\\" + entry->d_name;
 
 			if (S_ISDIR(entry->d_type)) // if it's a folder, recurse through it
-				AddAllBLFContentItems(filePath);
+				IndexBLFContentFiles(filePath);
 			else if (S_ISREG(entry->d_type)) // otherwise if it's a file try adding it as a BLF
-				AddContentItem(filePath);
+			{
+				IndexedContentFile item;
+				item.Path = Utils::String::ThinString(filePath);
+				if (item.Path.length() >= kMaxPath)
+					continue; // Doesn't fit in the content item
+				if (ReadContentHeader(filePath.c_str(), item.Header))
+					indexedContentFiles.push_back(std::move(item));
+			}
 		}
 
-		closedir(dp);
+		_wclosedir(dp);
 	}
 
 	char CallsXEnumerateHook()
@@ -255,17 +282,12 @@ namespace
 		if (enumerated)
 			return 1;
 
-		// TODO: change this to use unicode instead of ASCII
-
-		char currentDir[kMaxPath];
-		memset(currentDir, 0, kMaxPath);
-		GetCurrentDirectoryA(kMaxPath, currentDir);
-
-		std::string variantPath = std::string(currentDir) + std::string("\\mods\\variants");
-		std::string mapsPath = std::string(currentDir) + std::string("\\mods\\maps");
-
-		AddAllBLFContentItems(variantPath);
-		AddAllBLFContentItems(mapsPath);
+		// The files are indexed during startup
+		ElDorito::Instance().WaitForStartupStage("content-index");
+		for (auto &&item : indexedContentFiles)
+			AddContentItem(item.Path, item.Header);
+		indexedContentFiles.clear();
+		indexedContentFiles.shrink_to_fit();
 
 		enumerated = true;
 		return 1;
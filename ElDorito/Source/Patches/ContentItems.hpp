@@ -3,4 +3,8 @@
 namespace Patches::ContentItems
 {
 	void ApplyAll();
+
+	// Finds the BLF files in the mods folders and reads their headers, so that enumerating content only has to add them.
+	// This does file I/O only and can run on any thread.
+	void IndexContentFiles();
 }
@@ -257,6 +257,9 @@ namespace
 		if (!LoadMap(data))
 			return false;
 
+		// Loading a map can change which tags are loaded
+		Blam::Tags::TagInstance::InvalidateGroupIndex();
+
 		for (auto &&callback : mapLoadedCallbacks)
 			callback(static_cast<const char*>(data) + 0x24); // hax
 
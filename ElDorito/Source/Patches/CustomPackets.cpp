@@ -1,9 +1,11 @@
 #include "CustomPackets.hpp"
+#include "PacketEnvelope.hpp"
+#include "PeerCapabilities.hpp"
 #include "../Pointer.hpp"
 #include "../Patch.hpp"
-#include "../Utils/Cryptography.hpp"
-#include <unordered_map>
+#include <algorithm>
 #include <limits>
+#include <vector>
 
 namespace
 {
@@ -11,19 +13,35 @@ namespace
 
 	const int CustomPacketId = 0x27; // Last packet ID used by the game is 0x26
 
-	struct CustomPacket
-	{
-		std::string Name;
-		std::shared_ptr<RawPacketHandler> Handler;
-	};
-	std::unordered_map<PacketGuid, CustomPacket> customPackets;
-	CustomPacket* LookUpPacketType(PacketGuid guid);
+	typedef BasicEnvelopePacket<PacketBase> EnvelopePacket;
+	typedef BasicEnvelopeWriter<PacketBase> EnvelopeWriter;
+
+	PacketRegistry<RawPacketHandler> customPackets;
+	const PacketRegistry<RawPacketHandler>::Entry *LookUpPacketType(PacketGuid guid);
 
 	void InitializePacketsHook();
 	void HandlePacketHook();
 
 	void SerializeCustomPacket(Blam::BitStream *stream, int packetSize, const void *packet);
 	bool DeserializeCustomPacket(Blam::BitStream *stream, int packetSize, void *packet);
+	bool DispatchPacket(Blam::Network::ObserverChannel *sender, const PacketBase *packet);
+
+	// Envelopes are registered like any other packet type, and unpacked by their handler
+	constexpr PacketName EnvelopePacketName("eldewrito-packet-envelope");
+
+	class EnvelopePacketHandler : public RawPacketHandler
+	{
+	public:
+		int GetMinRawPacketSize() const override;
+		int GetMaxRawPacketSize() const override;
+		void SerializeRawPacket(Blam::BitStream *stream, int packetSize, const void *packet) override;
+		bool DeserializeRawPacket(Blam::BitStream *stream, int packetSize, void *packet) override;
+		void HandleRawPacket(Blam::Network::ObserverChannel *sender, const void *packet) override;
+	};
+
+	// Packets queued for each peer during the current tick
+	EnvelopeWriter queuedPackets[Blam::Network::MaxPeers];
+	void SendQueuedPackets(int targetPeer);
 }
 
 namespace Patches::CustomPackets
@@ -32,6 +50,8 @@ namespace Patches::CustomPackets
 	{
 		Hook(0x9E226, InitializePacketsHook, HookFlags::IsCall).Apply();
 		Hook(0x9CAFA, HandlePacketHook).Apply();
+
+		RegisterPacketImpl(EnvelopePacketName, std::make_shared<EnvelopePacketHandler>());
 	}
 
 	void SendPacket(int targetPeer, const void *packet, int packetSize)
@@ -45,18 +65,39 @@ namespace Patches::CustomPackets
 		session->Observer->ObserverChannelSendMessage(0, channelIndex, false, CustomPacketId, packetSize, packet);
 	}
 
-	PacketGuid RegisterPacketImpl(const std::string &name, std::shared_ptr<RawPacketHandler> handler)
+	void QueuePacket(int targetPeer, const void *packet, int packetSize)
 	{
-		PacketGuid guid;
-		if (!Utils::Cryptography::Hash32(name, &guid))
-			throw std::runtime_error("Failed to generate packet GUID");
-		if (LookUpPacketType(guid))
-			throw std::runtime_error("Duplicate packet GUID"); // TODO: Throwing an exception here might not be the best idea...
-		CustomPacket packet;
-		packet.Name = name;
-		packet.Handler = handler;
-		customPackets[guid] = packet;
-		return guid;
+		if (targetPeer < 0 || targetPeer >= Blam::Network::MaxPeers)
+			return;
+
+		// A peer which doesn't understand envelopes would drop them (and maybe the connection), so only queue for
+		// peers which have said they do and send everything else straight away
+		if (!PeerCapabilities::PeerSupports(targetPeer, PeerCapabilities::PacketEnvelopes))
+		{
+			SendPacket(targetPeer, packet, packetSize);
+			return;
+		}
+
+		auto &writer = queuedPackets[targetPeer];
+		if (writer.Add(packet, packetSize))
+			return;
+
+		// The envelope is full, so send it and start a new one
+		SendQueuedPackets(targetPeer);
+		if (!writer.Add(packet, packetSize))
+			SendPacket(targetPeer, packet, packetSize); // Too big for an envelope
+	}
+
+	void FlushQueuedPackets()
+	{
+		for (auto i = 0; i < Blam::Network::MaxPeers; i++)
+			SendQueuedPackets(i);
+	}
+
+	PacketGuid RegisterPacketImpl(const PacketName &name, std::shared_ptr<RawPacketHandler> handler)
+	{
+		customPackets.Add(name, handler);
+		return name.Guid;
 	}
 }
 
@@ -82,12 +123,9 @@ namespace
 		Patch(0x80022, { static_cast<uint8_t>(CustomPacketId + 1) }).Apply();
 	}
 
-	CustomPacket* LookUpPacketType(PacketGuid guid)
+	const PacketRegistry<RawPacketHandler>::Entry *LookUpPacketType(PacketGuid guid)
 	{
-		auto it = customPackets.find(guid);
-		if (it == customPackets.end())
-			return nullptr;
-		return &it->second;
+		return customPackets.Find(guid);
 	}
 
 	void SerializeCustomPacket(Blam::BitStream *stream, int packetSize, const void *packet)
@@ -145,16 +183,79 @@ namespace
 		// Only handle the master custom packet
 		if (id != CustomPacketId)
 			return false;
+		return DispatchPacket(sender, static_cast<const PacketBase*>(packet));
+	}
 
+	bool DispatchPacket(Blam::Network::ObserverChannel *sender, const PacketBase *packet)
+	{
 		// Use the type GUID to look up the handler to use
-		auto packetBase = static_cast<const PacketBase*>(packet);
-		auto type = LookUpPacketType(packetBase->TypeGuid);
+		auto type = LookUpPacketType(packet->TypeGuid);
 		if (!type)
 			return false;
 		type->Handler->HandleRawPacket(sender, packet);
 		return true;
 	}
 
+	void SendQueuedPackets(int targetPeer)
+	{
+		auto &writer = queuedPackets[targetPeer];
+		if (writer.Empty())
+			return;
+
+		if (writer.Count() == 1)
+		{
+			// Not worth wrapping a single packet
+			auto envelope = writer.Finish(EnvelopePacketName.Guid);
+			ForEachEnvelopePacket(envelope, writer.GetSize(), [&](const PacketBase *packet, int packetSize)
+			{
+				SendPacket(targetPeer, packet, packetSize);
+			});
+		}
+		else
+		{
+			SendPacket(targetPeer, writer.Finish(EnvelopePacketName.Guid), writer.GetSize());
+		}
+		writer.Reset();
+	}
+
+	// Envelopes can't be nested
+	RawPacketHandler *LookUpEnvelopedPacketHandler(PacketGuid guid)
+	{
+		if (guid == EnvelopePacketName.Guid)
+			return nullptr;
+		auto type = LookUpPacketType(guid);
+		return type ? type->Handler.get() : nullptr;
+	}
+
+	int EnvelopePacketHandler::GetMinRawPacketSize() const
+	{
+		return Envelope::FirstEntryOffset<PacketBase>;
+	}
+
+	int EnvelopePacketHandler::GetMaxRawPacketSize() const
+	{
+		return MaxEnvelopeSize;
+	}
+
+	void EnvelopePacketHandler::SerializeRawPacket(Blam::BitStream *stream, int packetSize, const void *packet)
+	{
+		SerializeEnvelope(stream, packetSize, static_cast<const EnvelopePacket*>(packet), LookUpEnvelopedPacketHandler);
+	}
+
+	bool EnvelopePacketHandler::DeserializeRawPacket(Blam::BitStream *stream, int packetSize, void *packet)
+	{
+		return DeserializeEnvelope(stream, packetSize, static_cast<EnvelopePacket*>(packet), LookUpEnvelopedPacketHandler);
+	}
+
+	void EnvelopePacketHandler::HandleRawPacket(Blam::Network::ObserverChannel *sender, const void *packet)
+	{
+		// The envelope's size isn't passed to handlers, but DeserializeEnvelope already checked that the packets fit
+		ForEachEnvelopePacket(static_cast<const EnvelopePacket*>(packet), MaxEnvelopeSize, [&](const PacketBase *envelopedPacket, int packetSize)
+		{
+			DispatchPacket(sender, envelopedPacket);
+		});
+	}
+
 	__declspec(naked) void HandlePacketHook()
 	{
 		__asm
@@ -51,8 +51,12 @@
  *    or "eldewrito" for packets built into ElDewrito. This helps ensure
  *    uniqueness.
  *
+ *    The packet's GUID is a hash of its name. Declaring the name as a
+ *    constexpr PacketName computes it at compile time:
+ *
+ *    constexpr Patches::CustomPackets::PacketName ExamplePacketName("eldewrito-example-packet");
  *    auto handler = std::make_shared<ExamplePacketHandler>();
- *    auto myPacketSender = Patches::CustomPacket::RegisterPacket<ExamplePacketData>("eldewrito-example-packet", handler);
+ *    auto myPacketSender = Patches::CustomPacket::RegisterPacket<ExamplePacketData>(ExamplePacketName, handler);
  *
  * 5. Finally, to send packets, use the New() method on your PacketSender
  *    object to create a packet with a properly-initialized header. Fill in its
@@ -98,15 +102,37 @@
  *
  *    auto examplePacket = myPacketSender->New(123);
  *
- *    Note that this will give you a shared_ptr to the packet instead of just
- *    returning a struct as with the fixed-size packets. This is done because
- *    variable-length structs cannot be stack-allocated by definition.
+ *    Note that this will give you a PooledPacket which owns the packet instead
+ *    of just returning a struct as with the fixed-size packets. This is done
+ *    because variable-length structs cannot be stack-allocated by definition.
+ *    The packet's buffer comes from a per-thread pool and is returned to it
+ *    when the PooledPacket is destroyed, so sending doesn't allocate.
  *
  *    Extra elements are made available by the ExtraData[] array on the packet
  *    object. After you fill out the Data and ExtraData[] arrays, you can then
  *    send the packet using the sender object like you would a fixed-size
  *    packet.
  *
+ * ********************
+ * * BATCHING PACKETS *
+ * ********************
+ *
+ * Every packet sent with Send() is a separate message with its own header.
+ * If you send lots of small packets, use Queue() instead:
+ *
+ *    myPacketSender->Queue(peer, myPacket);
+ *
+ * Queued packets are held until the end of the tick, and then everything
+ * queued for a peer is sent together in one envelope packet. The receiver
+ * unpacks the envelope and handles each packet as if it had been sent on its
+ * own, in the order they were queued. Queued packets are sent after any
+ * packets sent with Send() during the same tick, so don't mix the two for
+ * messages whose order matters.
+ *
+ * Envelopes are only used for peers which advertised support for them (see
+ * PeerCapabilities.hpp), which only the host knows about. Packets queued for
+ * any other peer are sent right away as if Send() had been called.
+ *
  * ***********************
  * * BLAM NETWORKING 101 *
  * ***********************
@@ -188,8 +214,11 @@
 
 #include "../Blam/BitStream.hpp"
 #include "../Blam/BlamNetwork.hpp"
+#include "../Utils/BufferPool.hpp"
+#include "PacketRegistry.hpp"
 
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include <memory>
 #include <vector>
@@ -200,12 +229,73 @@ namespace Patches::CustomPackets
 {
 	void ApplyAll();
 
-	// Type used for a custom packet GUID.
-	typedef uint32_t PacketGuid;
+	// Owns a packet allocated from the packet buffer pool, and returns it to the pool when destroyed.
+	template<class TPacket>
+	class PooledPacket
+	{
+	public:
+		PooledPacket()
+			: packet(nullptr), size(0)
+		{
+		}
+
+		PooledPacket(TPacket *packet, size_t size)
+			: packet(packet), size(size)
+		{
+		}
+
+		PooledPacket(PooledPacket &&other)
+			: packet(other.packet), size(other.size)
+		{
+			other.packet = nullptr;
+		}
+
+		PooledPacket& operator=(PooledPacket &&other)
+		{
+			if (this != &other)
+			{
+				Reset();
+				packet = other.packet;
+				size = other.size;
+				other.packet = nullptr;
+			}
+			return *this;
+		}
+
+		PooledPacket(const PooledPacket&) = delete;
+		PooledPacket& operator=(const PooledPacket&) = delete;
+
+		~PooledPacket()
+		{
+			Reset();
+		}
+
+		TPacket *get() const { return packet; }
+		TPacket *operator->() const { return packet; }
+		TPacket &operator*() const { return *packet; }
+		explicit operator bool() const { return packet != nullptr; }
+
+	private:
+		void Reset()
+		{
+			if (packet)
+				Utils::BufferPool::Free(packet, size);
+			packet = nullptr;
+		}
+
+		TPacket *packet;
+		size_t size;
+	};
 
 	// Sends raw packet data.
 	void SendPacket(int targetPeer, const void *packet, int packetSize);
 
+	// Queues raw packet data to be sent in an envelope at the end of the tick.
+	void QueuePacket(int targetPeer, const void *packet, int packetSize);
+
+	// Sends the packets queued during this tick, with one envelope per peer.
+	void FlushQueuedPackets();
+
 	// Base class for raw packet data handlers.
 	class RawPacketHandler
 	{
@@ -304,16 +394,13 @@ namespace Patches::CustomPackets
 			return CalculateSize(extraDataCount);
 		}
 
-		// Allocates a new variadic packet.
-		static std::shared_ptr<TPacketType> Allocate(PacketGuid guid, int extraDataCount)
+		// Allocates a new variadic packet from the packet buffer pool.
+		static PooledPacket<TPacketType> Allocate(PacketGuid guid, int extraDataCount)
 		{
 			auto packetSize = CalculateSize(extraDataCount);
-			auto buffer = new uint8_t[packetSize];
-			new (buffer) VariadicPacket<TData, TExtraData>(guid, extraDataCount);
-			return std::shared_ptr<TPacketType>(reinterpret_cast<TPacketType*>(buffer), [](TPacketType* x)
-			{
-				delete[] reinterpret_cast<uint8_t*>(x);
-			});
+			auto buffer = Utils::BufferPool::Allocate(packetSize);
+			auto packet = new (buffer) VariadicPacket<TData, TExtraData>(guid, extraDataCount);
+			return PooledPacket<TPacketType>(packet, packetSize);
 		}
 
 		// Initializes a variadic packet from a buffer.
@@ -491,6 +578,12 @@ namespace Patches::CustomPackets
 			SendPacket(targetPeer, &packet, sizeof(packet));
 		}
 
+		// Queues packet data to be sent to a peer at the end of the tick.
+		void Queue(int targetPeer, const TPacket &packet) const
+		{
+			QueuePacket(targetPeer, &packet, sizeof(packet));
+		}
+
 	private:
 		PacketGuid id;
 	};
@@ -508,7 +601,7 @@ namespace Patches::CustomPackets
 		}
 
 		// Creates a new packet.
-		std::shared_ptr<TPacket> New(int extraDataCount) const
+		PooledPacket<TPacket> New(int extraDataCount) const
 		{
 			return TPacket::Allocate(id, extraDataCount);
 		}
@@ -519,24 +612,42 @@ namespace Patches::CustomPackets
 			SendPacket(targetPeer, &packet, packet.GetSize());
 		}
 
+		// Sends packet data to a peer.
+		void Send(int targetPeer, const PooledPacket<TPacket> &packet)
+		{
+			Send(targetPeer, *packet);
+		}
+
 		// Sends packet data to a peer.
 		void Send(int targetPeer, std::shared_ptr<const TPacket> packet)
 		{
 			Send(targetPeer, *packet);
 		}
 
+		// Queues packet data to be sent to a peer at the end of the tick.
+		void Queue(int targetPeer, const TPacket &packet)
+		{
+			QueuePacket(targetPeer, &packet, packet.GetSize());
+		}
+
+		// Queues packet data to be sent to a peer at the end of the tick.
+		void Queue(int targetPeer, const PooledPacket<TPacket> &packet)
+		{
+			Queue(targetPeer, *packet);
+		}
+
 	private:
 		PacketGuid id;
 	};
 
 	// Registers a packet handler under a particular name and returns the
-	// GUID of the new packet type.
-	PacketGuid RegisterPacketImpl(const std::string &name, std::shared_ptr<RawPacketHandler> handler);
+	// GUID of the new packet type. Throws if another packet's GUID collides with it.
+	PacketGuid RegisterPacketImpl(const PacketName &name, std::shared_ptr<RawPacketHandler> handler);
 
 	// Registers a packet handler under a particular name and returns an
 	// object which can be used to easily send packets.
 	template<class TPacket>
-	std::shared_ptr<PacketSender<TPacket>> RegisterPacket(const std::string &name, std::shared_ptr<PacketHandler<TPacket>> handler)
+	std::shared_ptr<PacketSender<TPacket>> RegisterPacket(const PacketName &name, std::shared_ptr<PacketHandler<TPacket>> handler)
 	{
 		auto id = RegisterPacketImpl(name, handler);
 		return std::make_shared<PacketSender<TPacket>>(id);
@@ -545,7 +656,7 @@ namespace Patches::CustomPackets
 	// Registers a variadic packet handler under a particular name and
 	// returns an object which can be used to easily send packets.
 	template<class TPacket, class TExtraData>
-	std::shared_ptr<VariadicPacketSender<TPacket, TExtraData>> RegisterVariadicPacket(const std::string &name, std::shared_ptr<VariadicPacketHandler<TPacket, TExtraData>> handler)
+	std::shared_ptr<VariadicPacketSender<TPacket, TExtraData>> RegisterVariadicPacket(const PacketName &name, std::shared_ptr<VariadicPacketHandler<TPacket, TExtraData>> handler)
 	{
 		auto id = RegisterPacketImpl(name, handler);
 		return std::make_shared<VariadicPacketSender<TPacket, TExtraData>>(id);
@@ -1,228 +1,18 @@
 #include "GameEngineSettings.hpp"
 #include "../Blam/BitStream.hpp"
+#include "../Game/PlayerTraits.hpp"
 #include "../Patch.hpp"
 
 namespace
 {
-	struct c_player_health_traits
-	{
-		uint8_t DamageResistance;
-		uint8_t ShieldRechargeRate;
-		uint8_t ShieldMultiplier;
-		uint8_t HeadshotImmunity;
-		uint8_t ShieldVampirism;
-		uint8_t field_5;
-		uint8_t field_6;
-		uint8_t field_7;
-
-		void Serialize(Blam::BitStream &stream)
-		{
-			stream.WriteUnsigned(DamageResistance, 4);
-			stream.WriteUnsigned(ShieldRechargeRate, 4);
-			stream.WriteUnsigned(ShieldMultiplier, 3);
-			stream.WriteUnsigned(HeadshotImmunity, 2);
-			stream.WriteUnsigned(ShieldVampirism, 3);
-		}
-
-		void Deserialize(Blam::BitStream &stream)
-		{
-			DamageResistance = stream.ReadUnsigned<uint8_t>(4);
-			if (DamageResistance > 15)
-				DamageResistance = 0;
-			ShieldRechargeRate = stream.ReadUnsigned<uint8_t>(4);
-			if (ShieldRechargeRate > 9)
-				ShieldRechargeRate = 0;
-			ShieldMultiplier = stream.ReadUnsigned<uint8_t>(3);
-			if (ShieldMultiplier > 5)
-				ShieldMultiplier = 0;
-			HeadshotImmunity = stream.ReadUnsigned<uint8_t>(2);
-			if (HeadshotImmunity > 2)
-				HeadshotImmunity = 0;
-			ShieldVampirism = stream.ReadUnsigned<uint8_t>(3);
-			if (ShieldVampirism > 5)
-				ShieldVampirism = 0;
-		}
-	};
-	static_assert(sizeof(c_player_health_traits) == 0x8, "c_player_health_traits invalid");
-
-	struct c_player_weapon_traits
-	{
-		uint16_t field_0;
-		uint8_t PrimaryWeaponIndex;
-		uint8_t SecondaryWeaponIndex;
-		uint8_t DamageModifier;
-		uint8_t GrenadeRegeeration;
-		uint8_t InfiniteAmmo;
-		uint8_t WeaponPickup;
-
-		void Serialize(Blam::BitStream &stream)
-		{
-			stream.WriteUnsigned(DamageModifier, 4);
-			stream.WriteUnsigned(PrimaryWeaponIndex, 8);
-			stream.WriteUnsigned(SecondaryWeaponIndex, 8);
-			stream.WriteUnsigned(field_0, 2);
-			stream.WriteUnsigned(InfiniteAmmo, 3);
-			stream.WriteUnsigned(GrenadeRegeeration, 2);
-			stream.WriteUnsigned(WeaponPickup, 2);
-		}
-
-		void Deserialize(Blam::BitStream &stream)
-		{
-			DamageModifier = stream.ReadUnsigned<uint8_t>(4);
-			if (DamageModifier > 12)
-				DamageModifier = 0;
-			PrimaryWeaponIndex = ValidateWeaponIndex(stream.ReadUnsigned<uint8_t>(8));
-			SecondaryWeaponIndex = ValidateWeaponIndex(stream.ReadUnsigned<uint8_t>(8));
-			field_0 = stream.ReadUnsigned<uint8_t>(2);
-			if (field_0 > 2)
-				field_0 = 0;
-			InfiniteAmmo = stream.ReadUnsigned<uint8_t>(3);
-			if (InfiniteAmmo > 3)
-				InfiniteAmmo = 0;
-			GrenadeRegeeration = stream.ReadUnsigned<uint8_t>(2);
-			if (GrenadeRegeeration > 2)
-				GrenadeRegeeration = 0;
-			WeaponPickup = stream.ReadUnsigned<uint8_t>(2);
-			if (WeaponPickup > 2)
-				WeaponPickup = 0;
-		}
-
-		uint8_t ValidateWeaponIndex(uint8_t index)
-		{
-			auto v5 = index;
-			auto v6 = v5 < 0;
-			if (v5 < 0)
-				v6 = v5 < 0;
-			auto v7 = v5 == -1 || v5 == -3 || v5 == -2;
-			auto v8 = (!v6 || v7) == 0;
-			auto v9 = -2;
-			auto v10 = -2;
-			if (!v8)
-				v10 = v5;
-			return v10;
-		}
-	};
-	static_assert(sizeof(c_player_health_traits) == 0x8, "c_player_weapon_traits invalid");
-
-	struct c_player_movement_traits
-	{
-		uint8_t PlayerSpeed;
-		uint8_t PlayerGravity;
-		uint8_t VehicleUse;
-		uint8_t field_3;
-
-		void Serialize(Blam::BitStream &stream)
-		{
-			stream.WriteUnsigned(PlayerSpeed, 4);
-			stream.WriteUnsigned(PlayerGravity, 4);
-			stream.WriteUnsigned(VehicleUse, 2);
-		}
-
-		void Deserialize(Blam::BitStream &stream)
-		{
-			PlayerSpeed = stream.ReadUnsigned<uint8_t>(4);
-			if (PlayerSpeed > 15)
-				PlayerSpeed = 0;
-			PlayerGravity = stream.ReadUnsigned<uint8_t>(4);
-			if (PlayerGravity > 10)
-				PlayerGravity = 0;
-			VehicleUse = stream.ReadUnsigned<uint8_t>(2);
-			if (VehicleUse > 3)
-				VehicleUse = 0;
-		}
-	};
-	static_assert(sizeof(c_player_movement_traits) == 0x4, "c_player_movement_traits invalid");
-
-	struct c_player_appearance_traits
-	{
-		uint8_t ActiveCamo;
-		uint8_t Waypoint;
-		uint8_t Aura;  // now player size
-		uint8_t ForcedColor;
-
-		void Serialize(Blam::BitStream &stream)
-		{
-			stream.WriteUnsigned(ActiveCamo, 3);
-			stream.WriteUnsigned(Waypoint, 3);
-			stream.WriteUnsigned(Aura, 5);
-			stream.WriteUnsigned(ForcedColor, 4);
-		}
-
-		void Deserialize(Blam::BitStream &stream)
-		{
-			ActiveCamo = stream.ReadUnsigned<uint8_t>(3);
-			if (ActiveCamo > 4)
-				ActiveCamo = 0;
-			Waypoint = stream.ReadUnsigned<uint8_t>(3);
-			if (Waypoint > 5)
-				Waypoint = 0;
-			Aura = stream.ReadUnsigned<uint8_t>(5);
-			if (Aura > 18)
-				Aura = 0;
-			ForcedColor = stream.ReadUnsigned<uint8_t>(4);
-			if (ForcedColor > 13)
-				ForcedColor = 0;
-		}
-	};
-	static_assert(sizeof(c_player_appearance_traits) == 0x4, "c_player_appearance_traits invalid");
-
-	struct c_player_sensor_traits
-	{
-		uint16_t MotionTrackerMode;
-		uint16_t MotionTrackerRange;
-
-		void Serialize(Blam::BitStream &stream)
-		{
-			stream.WriteUnsigned(MotionTrackerMode, 3);
-			stream.WriteUnsigned(MotionTrackerRange, 3);
-		}
-
-		void Deserialize(Blam::BitStream &stream)
-		{
-			MotionTrackerMode = stream.ReadUnsigned<uint8_t>(3);
-			if (MotionTrackerMode > 4)
-				MotionTrackerMode = 0;
-			MotionTrackerRange = stream.ReadUnsigned<uint8_t>(3);
-			if (MotionTrackerRange > 7)
-				MotionTrackerRange = 0;
-		}
-	};
-	static_assert(sizeof(c_player_sensor_traits) == 0x4, "c_player_sensor_traits invalid");
-
-	struct c_player_trait_profile
-	{
-		c_player_health_traits Health;
-		c_player_weapon_traits Weapon;
-		c_player_movement_traits Movement;
-		c_player_appearance_traits Appearance;
-		c_player_sensor_traits Sensory;
-
-		void Serialize(Blam::BitStream &stream)
-		{
-			Health.Serialize(stream);
-			Weapon.Serialize(stream);
-			Movement.Serialize(stream);
-			Appearance.Serialize(stream);
-			Sensory.Serialize(stream);
-		}
-
-		void Deserialize(Blam::BitStream &stream)
-		{
-			Health.Deserialize(stream);
-			Weapon.Deserialize(stream);
-			Movement.Deserialize(stream);
-			Appearance.Deserialize(stream);
-			Sensory.Deserialize(stream);
-		}
-	};
-	static_assert(sizeof(c_player_trait_profile) == 0x1C, "c_player_trait_profile invalid");
+	using namespace Game::PlayerTraits;
 
 	float __fastcall c_player_health_traits__get_damage_resistance_hook(uint8_t *thisptr, void *unused);
 	float __fastcall c_player_movement_traits__get_walking_speed_hook(uint8_t *thisptr, void *unused);
 	float __fastcall c_player_movement_traits__get_personal_gravity_hook(c_player_movement_traits *thisptr, void *unused);
 
 	void __fastcall c_player_trait_profile__serialize_hook(c_player_trait_profile &profile, void *unused, Blam::BitStream &stream) { profile.Serialize(stream); }
-	void __fastcall c_player_trait_profile__deserialize_hook(c_player_trait_profile &profile, void *unused, Blam::BitStream &stream) { profile.Deserialize(stream); }
+	void __fastcall c_player_trait_profile__deserialize_hook(c_player_trait_profile &profile, void *unused, Blam::BitStream &stream);
 	void __fastcall c_player_health_traits__serialize_hook(c_player_health_traits &traits, void *unused, Blam::BitStream &stream) { traits.Serialize(stream); }
 	void __fastcall c_player_weapon_traits__serialize_hook(c_player_weapon_traits &traits, void *unused, Blam::BitStream &stream) { traits.Serialize(stream); }
 	void __fastcall c_player_movement_traits__serialize_hook(c_player_movement_traits &traits, void *unused, Blam::BitStream &stream) { traits.Serialize(stream); }
@@ -235,6 +25,13 @@ namespace
 	void __fastcall c_player_sensor_traits__deserialize_hook(c_player_sensor_traits &traits, void *unused, Blam::BitStream &stream) { traits.Deserialize(stream); }
 
 	void AuraTraitDefaultFixHook();
+
+	struct
+	{
+		const uint8_t *Buffer;
+		size_t Size;
+		std::vector<size_t> Offsets;
+	} traitProfileCapture;
 }
 
 namespace Patches::GameEngineSettings
@@ -306,10 +103,34 @@ namespace Patches::GameEngineSettings
 
 		Hook(0x174D5D, AuraTraitDefaultFixHook).Apply();
 	}
+
+	void BeginTraitProfileCapture(const uint8_t *buffer, size_t size)
+	{
+		traitProfileCapture.Buffer = buffer;
+		traitProfileCapture.Size = size;
+		traitProfileCapture.Offsets.clear();
+	}
+
+	std::vector<size_t> EndTraitProfileCapture()
+	{
+		traitProfileCapture.Buffer = nullptr;
+		traitProfileCapture.Size = 0;
+		return std::move(traitProfileCapture.Offsets);
+	}
 }
 
 namespace
 {
+	void __fastcall c_player_trait_profile__deserialize_hook(c_player_trait_profile &profile, void *unused, Blam::BitStream &stream)
+	{
+		profile.Deserialize(stream);
+
+		auto profileAddress = reinterpret_cast<const uint8_t*>(&profile);
+		auto &capture = traitProfileCapture;
+		if (capture.Buffer && profileAddress >= capture.Buffer && profileAddress + sizeof(profile) <= capture.Buffer + capture.Size)
+			capture.Offsets.push_back(profileAddress - capture.Buffer);
+	}
+
 	float __fastcall c_player_health_traits__get_damage_resistance_hook(uint8_t* thisptr, void *unused)
 	{
 		switch (*(uint8_t*)thisptr)
@@ -1,6 +1,16 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace Patches::GameEngineSettings
 {
 	void ApplyAll();
+
+	// Starts recording the offset of every trait profile that gets deserialized into a buffer.
+	// Used to find the trait profiles in a game variant while the game parses it.
+	void BeginTraitProfileCapture(const uint8_t *buffer, size_t size);
+
+	// Stops recording and returns the offsets in the order the profiles were deserialized.
+	std::vector<size_t> EndTraitProfileCapture();
 }
@@ -1,5 +1,6 @@
 #include "LoadingScreen.hpp"
 #include "../Patch.hpp"
+#include "Maps.hpp"
 
 using namespace Patches::LoadingScreen;
 
@@ -43,6 +44,9 @@ namespace
 		auto ShowLoadingScreen = reinterpret_cast<ShowLoadingScreenPtr>(0x52EE40);
 		ShowLoadingScreen(mapPath, unk);
 
+		// The loader owns the disk from here on
+		Patches::Maps::CancelPrefetch();
+
 		if (ActiveUi)
 			ActiveUi->Show(mapPath);
 	}
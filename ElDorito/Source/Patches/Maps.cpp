@@ -1,6 +1,8 @@
 #include "Maps.hpp"
 #include "../Patch.hpp"
 #include "../Blam/BlamTypes.hpp"
+#include "../Modules/ModuleGame.hpp"
+#include "../Utils/Logger.hpp"
 
 namespace
 {
@@ -8,6 +10,19 @@ namespace
 	int EnumerateMapsHook(int a1);
 
 	bool TryLoadDefaultMapVariant(int mapId, Blam::MapVariant* buffer);
+
+	// Resource caches shared between every map, in the order the loader touches them
+	const char* SharedCacheFiles[] =
+	{
+		"tags.dat",
+		"resources.dat",
+		"textures.dat",
+		"textures_b.dat",
+		"audio.dat",
+	};
+
+	Utils::FilePrefetcher MapPrefetcher;
+	int PrefetchedMapId = -1;
 }
 
 namespace Patches::Maps
@@ -33,6 +48,61 @@ namespace Patches::Maps
 		if (!TryLoadDefaultMapVariant(mapid, mapv))
 			c_map_variant_initialize(mapv, mapid);
 	}
+
+	void PrefetchMap(int mapId)
+	{
+		const auto maps_get_map_path = (void(*)(int campaignId, int mapid, char *buff, int buffLen))(0x0054C040);
+		const auto maps_get_maps_path = (char*(*)())(0x00501FC0);
+
+		auto &gameModule = Modules::ModuleGame::Instance();
+		if (!gameModule.VarMapPrefetch->ValueInt || mapId < 0)
+			return;
+
+		// Don't restart a prefetch that is already warming the same map
+		if (mapId == PrefetchedMapId && MapPrefetcher.IsRunning())
+			return;
+
+		char mapPath[256];
+		maps_get_map_path(-1, mapId, mapPath, sizeof(mapPath));
+		if (!mapPath[0] || strlen(mapPath) + 4 >= sizeof(mapPath))
+			return;
+		strcat_s(mapPath, sizeof(mapPath), ".map");
+
+		// The .map file is small and read in full, the shared caches are only read up to the configured limit
+		std::vector<Utils::PrefetchRequest> requests;
+		requests.push_back({ mapPath, 0 });
+
+		uint64_t sharedLimit = static_cast<uint64_t>(gameModule.VarMapPrefetchSharedLimit->ValueInt) * 1024 * 1024;
+		if (sharedLimit > 0)
+		{
+			std::string mapsFolder = maps_get_maps_path();
+			for (auto fileName : SharedCacheFiles)
+				requests.push_back({ mapsFolder + fileName, sharedLimit });
+		}
+
+		PrefetchedMapId = mapId;
+		MapPrefetcher.Start(std::move(requests), static_cast<uint64_t>(gameModule.VarMapPrefetchRate->ValueInt) * 1024);
+		Utils::Logger::Instance().Log(Utils::LogTypes::Game, Utils::LogLevel::Info, "Prefetching map %s", mapPath);
+	}
+
+	void CancelPrefetch()
+	{
+		if (PrefetchedMapId < 0)
+			return;
+
+		MapPrefetcher.Cancel();
+		PrefetchedMapId = -1;
+
+		auto stats = MapPrefetcher.GetStats();
+		Utils::Logger::Instance().Log(Utils::LogTypes::Game, Utils::LogLevel::Info,
+			"Map prefetch %s: %llu of %llu bytes in %.2fs, saving ~%.2fs of disk reads",
+			stats.Cancelled ? "cancelled" : "completed", stats.BytesPrefetched, stats.BytesRequested, stats.ElapsedSeconds, stats.ReadSeconds);
+	}
+
+	Utils::PrefetchStats GetPrefetchStats()
+	{
+		return MapPrefetcher.GetStats();
+	}
 }
 
 namespace
@@ -1,9 +1,19 @@
 #pragma once
 
 #include "../Blam/BlamTypes.hpp"
+#include "../Utils/FilePrefetcher.hpp"
 
 namespace Patches::Maps
 {
 	void ApplyAll();
 	void InitializeMapVariant(Blam::MapVariant *mapv, int mapid);
+
+	// Starts warming the file cache with a map's .map file and the shared cache files in the background.
+	// Call as soon as the next map is known (e.g. when a vote resolves) so the load mostly hits memory.
+	void PrefetchMap(int mapId);
+
+	// Cancels the map prefetch in progress, if any.
+	void CancelPrefetch();
+
+	Utils::PrefetchStats GetPrefetchStats();
 }
\ No newline at end of file
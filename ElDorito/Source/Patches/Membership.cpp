@@ -0,0 +1,74 @@
+#include "Membership.hpp"
+#include "../Blam/BlamNetwork.hpp"
+
+#include <vector>
+
+namespace
+{
+	using namespace Patches::Membership;
+
+	static_assert(MembershipSnapshot::MaxPeers == Blam::Network::MaxPeers, "MembershipSnapshot::MaxPeers is wrong");
+	static_assert(MembershipSnapshot::MaxPlayers == Blam::Network::MaxPlayers, "MembershipSnapshot::MaxPlayers is wrong");
+
+	MembershipDiffer differ;
+	MembershipSnapshot currentSnapshot;
+	std::vector<MembershipEvent> pendingEvents;
+	std::vector<MembershipEventCallback> membershipEventCallbacks;
+}
+
+namespace Patches::Membership
+{
+	void Tick()
+	{
+		// Everyone leaves when there is no session
+		auto session = Blam::Network::GetActiveSession();
+		if (session && session->IsEstablished())
+			TakeSnapshot(session->MembershipInfo, &currentSnapshot);
+		else
+			currentSnapshot.Clear();
+
+		pendingEvents.clear();
+		differ.Diff(currentSnapshot, &pendingEvents);
+		for (auto &&event : pendingEvents)
+		{
+			for (auto &&callback : membershipEventCallbacks)
+				callback(event);
+		}
+	}
+
+	void TakeSnapshot(const Blam::Network::SessionMembership &membership, MembershipSnapshot *result)
+	{
+		result->Clear();
+		result->HostPeer = membership.HostPeerIndex;
+
+		for (auto peer = membership.FindFirstPeer(); peer >= 0; peer = membership.FindNextPeer(peer))
+		{
+			result->Peers[peer].Connected = true;
+			result->Peers[peer].Player = membership.GetPeerPlayer(peer);
+		}
+
+		for (auto player = membership.FindFirstPlayer(); player >= 0; player = membership.FindNextPlayer(player))
+		{
+			auto &session = membership.PlayerSessions[player];
+			auto &entry = result->Players[player];
+			entry.Active = true;
+			entry.Peer = session.PeerIndex;
+			entry.Uid = session.Properties.Uid;
+			entry.Team = session.Properties.TeamIndex;
+
+			// The rest of the name stays zeroed so that names can be compared directly
+			for (auto i = 0; i < MembershipSnapshot::MaxNameLength - 1 && session.Properties.DisplayName[i]; i++)
+				entry.Name[i] = session.Properties.DisplayName[i];
+		}
+	}
+
+	const MembershipSnapshot &GetSnapshot()
+	{
+		return differ.GetSnapshot();
+	}
+
+	void OnMembershipEvent(MembershipEventCallback callback)
+	{
+		membershipEventCallbacks.push_back(callback);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <functional>
+#include "MembershipDiff.hpp"
+
+namespace Blam::Network
+{
+	struct SessionMembership;
+}
+
+// Tracks changes to the session membership once per tick, so that code which reacts to players joining, leaving or
+// changing their data can subscribe to events instead of scanning the membership itself.
+namespace Patches::Membership
+{
+	// Compares the membership with the previous tick and fires events for any changes.
+	void Tick();
+
+	// Copies the parts of the membership that are tracked into a snapshot.
+	void TakeSnapshot(const Blam::Network::SessionMembership &membership, MembershipSnapshot *result);
+
+	// Gets the membership as of the last tick.
+	const MembershipSnapshot &GetSnapshot();
+
+	// Callback for a membership event handler function.
+	typedef std::function<void(const MembershipEvent &event)> MembershipEventCallback;
+
+	// Registers a function to be called for each membership change. Events are delivered in sequence order during
+	// the tick that they are detected on.
+	void OnMembershipEvent(MembershipEventCallback callback);
+}
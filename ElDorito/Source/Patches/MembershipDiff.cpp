@@ -0,0 +1,125 @@
+#include "MembershipDiff.hpp"
+
+#include <cstring>
+
+namespace
+{
+	using namespace Patches::Membership;
+
+	// Gets the UID of the player a peer has, or 0 if none
+	uint64_t GetPeerUid(const MembershipSnapshot &snapshot, int peer)
+	{
+		auto player = snapshot.Peers[peer].Player;
+		if (player < 0 || player >= MembershipSnapshot::MaxPlayers || !snapshot.Players[player].Active)
+			return 0;
+		return snapshot.Players[player].Uid;
+	}
+
+	// Checks whether a peer index was taken over by someone else between two snapshots. A player keeps their UID once
+	// their properties have arrived, so a player without one is someone new who is waiting for theirs.
+	bool WasPeerReplaced(const MembershipSnapshot &previous, const MembershipSnapshot &next, int peer)
+	{
+		if (!previous.Peers[peer].Connected || !next.Peers[peer].Connected)
+			return false;
+		auto previousUid = GetPeerUid(previous, peer);
+		auto nextUid = GetPeerUid(next, peer);
+		auto nextPlayer = next.Peers[peer].Player;
+		auto hasNextPlayer = nextPlayer >= 0 && nextPlayer < MembershipSnapshot::MaxPlayers && next.Players[nextPlayer].Active;
+		return previousUid && hasNextPlayer && previousUid != nextUid;
+	}
+}
+
+namespace Patches::Membership
+{
+	void MembershipSnapshot::Clear()
+	{
+		memset(this, 0, sizeof(*this));
+		HostPeer = -1;
+		for (auto &&peer : Peers)
+			peer.Player = -1;
+		for (auto &&player : Players)
+			player.Peer = -1;
+	}
+
+	MembershipDiffer::MembershipDiffer()
+		: sequence(0)
+	{
+		previous.Clear();
+	}
+
+	void MembershipDiffer::Diff(const MembershipSnapshot &next, std::vector<MembershipEvent> *events)
+	{
+		auto addEvent = [&](MembershipEventType type, int peer, int player, uint64_t uid) -> MembershipEvent&
+		{
+			MembershipEvent event;
+			memset(&event, 0, sizeof(event));
+			event.Type = type;
+			event.Sequence = ++sequence;
+			event.Peer = peer;
+			event.Player = player;
+			event.Uid = uid;
+			event.OldValue = -1;
+			event.NewValue = -1;
+			events->push_back(event);
+			return events->back();
+		};
+
+		if (next.HostPeer != previous.HostPeer)
+		{
+			auto &event = addEvent(MembershipEventType::HostChanged, next.HostPeer, -1, 0);
+			event.OldValue = previous.HostPeer;
+			event.NewValue = next.HostPeer;
+		}
+
+		// Departures come first so that a peer index which is reused shows up as leaving and then joining
+		for (auto i = 0; i < MembershipSnapshot::MaxPeers; i++)
+		{
+			if (previous.Peers[i].Connected && (!next.Peers[i].Connected || WasPeerReplaced(previous, next, i)))
+				addEvent(MembershipEventType::PeerLeft, i, previous.Peers[i].Player, GetPeerUid(previous, i));
+		}
+		for (auto i = 0; i < MembershipSnapshot::MaxPeers; i++)
+		{
+			if (next.Peers[i].Connected && (!previous.Peers[i].Connected || WasPeerReplaced(previous, next, i)))
+				addEvent(MembershipEventType::PeerJoined, i, next.Peers[i].Player, GetPeerUid(next, i));
+		}
+
+		for (auto i = 0; i < MembershipSnapshot::MaxPeers; i++)
+		{
+			if (!next.Peers[i].Connected)
+				continue;
+			auto stayed = previous.Peers[i].Connected && !WasPeerReplaced(previous, next, i);
+			auto oldPlayer = stayed ? previous.Peers[i].Player : -1;
+			auto newPlayer = next.Peers[i].Player;
+			if (newPlayer == oldPlayer)
+				continue;
+			auto &event = addEvent(MembershipEventType::PlayerAssigned, i, newPlayer, GetPeerUid(next, i));
+			event.OldValue = oldPlayer;
+			event.NewValue = newPlayer;
+		}
+
+		// Only players who are still the same person can have their data change. A player whose properties haven't
+		// arrived yet has no UID, so getting one isn't a different person, and their name shows up as a change.
+		for (auto i = 0; i < MembershipSnapshot::MaxPlayers; i++)
+		{
+			auto &oldPlayer = previous.Players[i];
+			auto &newPlayer = next.Players[i];
+			if (!oldPlayer.Active || !newPlayer.Active || (oldPlayer.Uid && oldPlayer.Uid != newPlayer.Uid))
+				continue;
+
+			if (memcmp(oldPlayer.Name, newPlayer.Name, sizeof(newPlayer.Name)) != 0)
+			{
+				auto &event = addEvent(MembershipEventType::NameChanged, newPlayer.Peer, i, newPlayer.Uid);
+				memcpy(event.OldName, oldPlayer.Name, sizeof(event.OldName));
+				memcpy(event.NewName, newPlayer.Name, sizeof(event.NewName));
+			}
+			if (oldPlayer.Team != newPlayer.Team)
+			{
+				auto &event = addEvent(MembershipEventType::TeamChanged, newPlayer.Peer, i, newPlayer.Uid);
+				event.OldValue = oldPlayer.Team;
+				event.NewValue = newPlayer.Team;
+			}
+		}
+
+		previous = next;
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Patches::Membership
+{
+	// The parts of the session membership that changes are tracked for.
+	// This is kept separate from the engine's structures so that it can be copied and compared cheaply.
+	struct MembershipSnapshot
+	{
+		static const int MaxPeers = 17;
+		static const int MaxPlayers = 16;
+		static const int MaxNameLength = 16;
+
+		struct PeerEntry
+		{
+			bool Connected;
+			int Player; // -1 if none
+		};
+
+		struct PlayerEntry
+		{
+			bool Active;
+			int Peer;
+			uint64_t Uid;
+			int Team;
+			wchar_t Name[MaxNameLength];
+		};
+
+		int HostPeer; // -1 if there is no session
+		PeerEntry Peers[MaxPeers];
+		PlayerEntry Players[MaxPlayers];
+
+		// Resets the snapshot to an empty session.
+		void Clear();
+	};
+
+	enum class MembershipEventType
+	{
+		PeerJoined,     // Peer joined. Player and Uid are set if it already has a player.
+		PeerLeft,       // Peer left. Player and Uid are the player it had, if any.
+		PlayerAssigned, // Peer's player changed from OldValue to NewValue (either can be -1)
+		NameChanged,    // Player's name changed from OldName to NewName (OldName is empty when their properties first arrive)
+		TeamChanged,    // Player's team changed from OldValue to NewValue
+		HostChanged,    // The host moved from peer OldValue to peer NewValue (either can be -1)
+	};
+
+	struct MembershipEvent
+	{
+		MembershipEventType Type;
+		uint32_t Sequence; // Increases by one for each event
+		int Peer;          // -1 if none
+		int Player;        // -1 if none
+		uint64_t Uid;      // 0 if there is no player
+		int OldValue;
+		int NewValue;
+		wchar_t OldName[MembershipSnapshot::MaxNameLength];
+		wchar_t NewName[MembershipSnapshot::MaxNameLength];
+	};
+
+	// Compares each membership snapshot with the one before it to produce a journal of events.
+	class MembershipDiffer
+	{
+	public:
+		MembershipDiffer();
+
+		// Compares a snapshot with the previous one and appends an event to events for each change. The snapshot
+		// then becomes the one the next call compares against.
+		void Diff(const MembershipSnapshot &next, std::vector<MembershipEvent> *events);
+
+		// Gets the snapshot passed to the last call to Diff().
+		const MembershipSnapshot &GetSnapshot() const { return previous; }
+
+		// Gets the sequence number of the last event, or 0 if there haven't been any.
+		uint32_t GetSequence() const { return sequence; }
+
+	private:
+		MembershipSnapshot previous;
+		uint32_t sequence;
+	};
+}
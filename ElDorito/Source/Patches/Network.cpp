@@ -7,10 +7,12 @@
 #include <ctime>
 #include <fstream>
 #include <iomanip>
+#include <vector>
 
 #include "PlayerPropertiesExtension.hpp"
 #include "../Patch.hpp"
 #include "../Utils/VersionInfo.hpp"
+#include "../Utils/DisplayModes.hpp"
 #include "../Modules/ModuleServer.hpp"
 #include "../ElDorito.hpp"
 #include "../ThirdParty/rapidjson/writer.h"
@@ -21,7 +23,6 @@
 #include "../Modules/ModuleServer.hpp"
 #include "../Modules/ModuleUPnP.hpp"
 #include "../Server/Voting.hpp"
-#include "../Server/Stats.hpp"
 #include "../Utils/Logger.hpp"
 #include "../Web/Ui/ScreenLayer.hpp"
 #include "../Server/Signaling.hpp"
@@ -123,6 +124,10 @@ namespace Patches::Network
 
 				Web::Ui::ScreenLayer::Notify("mouse-xbutton-event", jsonBuffer.GetString(), true);
 			}
+			else if (msg == WM_DISPLAYCHANGE)
+			{
+				Utils::DisplayModes::Refresh();
+			}
 
 			typedef int(__stdcall *Game_WndProcFunc)(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 			Game_WndProcFunc Game_WndProc = (Game_WndProcFunc)0x42E6A0;
@@ -806,7 +811,6 @@ namespace
 			SanitizePlayerName(reinterpret_cast<wchar_t*>(data));
 			Server::Signaling::SendPeerPassword(playerIndex);
 			Server::Voting::PlayerJoinedVoteInProgress(playerIndex);
-			Server::Stats::NewPlayerJoined();
 			isNewMember = true;
 		}
 
@@ -952,7 +956,8 @@ namespace
 		// Copy the player properties to a new array and add the extension data
 		auto packetSize = GetPlayerPropertiesPacketSize();
 		auto extendedSize = packetSize - PlayerPropertiesPacketHeaderSize - PlayerPropertiesPacketFooterSize;
-		auto extendedProperties = std::make_unique<uint8_t[]>(extendedSize);
+		static std::vector<uint8_t> extendedProperties;
+		extendedProperties.resize(extendedSize);
 		memcpy(&extendedProperties[0], properties, PlayerPropertiesSize);
 		Patches::Network::PlayerPropertiesExtender::Instance().BuildData(playerIndex, &extendedProperties[PlayerPropertiesSize]);
 
@@ -969,9 +974,9 @@ namespace
 			if (channelIndex == -1)
 				return true;
 
-			// Allocate the packet
-			auto packet = std::make_unique<uint8_t[]>(packetSize);
-			memset(&packet[0], 0, packetSize);
+			// Set up the packet, reusing the buffer from last time
+			static std::vector<uint8_t> packet;
+			packet.assign(packetSize, 0);
 
 			// Initialize it
 			typedef void (*InitPacketPtr)(int id, void *packet);
@@ -1013,9 +1018,9 @@ namespace
 		bool succeeded = DeserializePlayerProperties(stream, buffer, flag);
 
 		// Deserialize extended data
-		if (succeeded)
-			Patches::Network::PlayerPropertiesExtender::Instance().DeserializeData(stream, buffer + PlayerPropertiesSize);
-		return succeeded;
+		if (!succeeded)
+			return false;
+		return Patches::Network::PlayerPropertiesExtender::Instance().DeserializeData(stream, buffer + PlayerPropertiesSize);
 	}
 
 	char __fastcall Network_state_end_game_write_stats_enterHook(void* thisPtr, int unused, int a2, int a3, int a4)
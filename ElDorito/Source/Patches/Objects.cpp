@@ -0,0 +1,96 @@
+#include "Objects.hpp"
+#include <Windows.h>
+#include <detours.h>
+#include "../Utils/ObjectRegistry.hpp"
+
+namespace
+{
+	uint32_t(__cdecl *object_new)(void *placementData) = reinterpret_cast<decltype(object_new)>(0x00B30440);
+	void(__cdecl *object_delete)(uint32_t objectIndex) = reinterpret_cast<decltype(object_delete)>(0x00B2CD10);
+
+	uint32_t __cdecl ObjectNewHook(void *placementData);
+	void __cdecl ObjectDeleteHook(uint32_t objectIndex);
+
+	// Objects can also go away without object_delete being called (e.g. when the map unloads),
+	// so every handle is checked against the object array before it's handed out
+	bool IsLiveObject(uint32_t objectIndex, uint32_t tagIndex, Blam::Objects::ObjectType type);
+	std::vector<uint32_t> FilterLiveObjects(const std::vector<uint32_t> &objects, uint32_t tagIndex, Blam::Objects::ObjectType type);
+
+	Utils::ObjectRegistry Registry;
+}
+
+namespace Patches::Objects
+{
+	void ApplyAll()
+	{
+		DetourTransactionBegin();
+		DetourUpdateThread(GetCurrentThread());
+		DetourAttach((PVOID*)&object_new, &ObjectNewHook);
+		DetourAttach((PVOID*)&object_delete, &ObjectDeleteHook);
+		if (DetourTransactionCommit() != NO_ERROR)
+			OutputDebugString("Object registry hooks failed.");
+	}
+
+	uint32_t FindObjectWithTag(uint32_t tagIndex)
+	{
+		auto objects = FindObjectsWithTag(tagIndex);
+		return objects.empty() ? -1 : objects.front();
+	}
+
+	std::vector<uint32_t> FindObjectsWithTag(uint32_t tagIndex)
+	{
+		return FilterLiveObjects(Registry.GetWithTag(tagIndex), tagIndex, Blam::Objects::eObjectTypeNone);
+	}
+
+	std::vector<uint32_t> FindObjectsOfType(Blam::Objects::ObjectType type)
+	{
+		return FilterLiveObjects(Registry.GetOfType(type), -1, type);
+	}
+}
+
+namespace
+{
+	uint32_t __cdecl ObjectNewHook(void *placementData)
+	{
+		auto objectIndex = object_new(placementData);
+		if (objectIndex == -1)
+			return objectIndex;
+
+		auto header = Blam::Objects::GetObjects().Get(objectIndex);
+		if (header && header->Data)
+			Registry.Add(objectIndex, header->Data->TagIndex, header->Type);
+		return objectIndex;
+	}
+
+	void __cdecl ObjectDeleteHook(uint32_t objectIndex)
+	{
+		Registry.Remove(objectIndex);
+		object_delete(objectIndex);
+	}
+
+	bool IsLiveObject(uint32_t objectIndex, uint32_t tagIndex, Blam::Objects::ObjectType type)
+	{
+		auto header = Blam::Objects::GetObjects().Get(objectIndex);
+		if (!header || !header->Data)
+			return false;
+		if (tagIndex != -1 && header->Data->TagIndex != tagIndex)
+			return false;
+		if (type != Blam::Objects::eObjectTypeNone && header->Type != type)
+			return false;
+		return true;
+	}
+
+	std::vector<uint32_t> FilterLiveObjects(const std::vector<uint32_t> &objects, uint32_t tagIndex, Blam::Objects::ObjectType type)
+	{
+		std::vector<uint32_t> result;
+		result.reserve(objects.size());
+		for (auto objectIndex : objects)
+		{
+			if (IsLiveObject(objectIndex, tagIndex, type))
+				result.push_back(objectIndex);
+			else
+				Registry.Remove(objectIndex); // Stale, drop it so it isn't checked again
+		}
+		return result;
+	}
+}
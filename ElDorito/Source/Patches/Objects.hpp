@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "../Blam/BlamObjects.hpp"
+
+namespace Patches::Objects
+{
+	void ApplyAll();
+
+	// Finds a live object with a tag index. Returns -1 if there isn't one.
+	uint32_t FindObjectWithTag(uint32_t tagIndex);
+
+	// Finds every live object with a tag index.
+	std::vector<uint32_t> FindObjectsWithTag(uint32_t tagIndex);
+
+	// Finds every live object of a type.
+	std::vector<uint32_t> FindObjectsOfType(Blam::Objects::ObjectType type);
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "PacketRegistry.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+// Envelopes carry several custom packets to a peer as a single message.
+//
+// In memory, an envelope is an envelope packet followed by an entry for each packet it holds: the packet's size and
+// then a copy of the packet, padded to an 8-byte boundary so the next packet stays aligned. On the wire, each packet
+// is written as its size and type GUID followed by whatever its handler serializes. The packet headers inside an
+// envelope are not sent, because they are the same as the envelope's.
+//
+// This is kept apart from the packet code so that it can be built without the engine headers. TPacketBase is the
+// custom packet base struct (PacketBase in CustomPackets.hpp), which needs a Header member and a TypeGuid member.
+// Handlers are looked up through a function returning a RawPacketHandler-like object, and TStream is a BitStream.
+namespace Patches::CustomPackets
+{
+	// Maximum size of an envelope in memory.
+	const int MaxEnvelopeSize = 4096;
+
+	// Maximum number of packets in an envelope.
+	const int MaxEnvelopePackets = 255;
+
+	template<class TPacketBase>
+	struct BasicEnvelopePacket : TPacketBase
+	{
+		explicit BasicEnvelopePacket(PacketGuid guid)
+			: TPacketBase(guid), PacketCount(0)
+		{
+		}
+
+		uint32_t PacketCount;
+	};
+
+	namespace Envelope
+	{
+		const int Alignment = 8;
+		const int EntryHeaderSize = 8; // Packet size followed by padding
+
+		const int PacketCountBits = 8;
+		const int PacketSizeBits = 16;
+
+		static_assert(MaxEnvelopePackets < (1 << PacketCountBits), "MaxEnvelopePackets doesn't fit in the packet count");
+		static_assert(MaxEnvelopeSize < (1 << PacketSizeBits), "MaxEnvelopeSize doesn't fit in a packet size");
+
+		constexpr int AlignUp(int offset)
+		{
+			return (offset + Alignment - 1) & ~(Alignment - 1);
+		}
+
+		template<class TPacketBase>
+		constexpr int FirstEntryOffset = AlignUp(static_cast<int>(sizeof(BasicEnvelopePacket<TPacketBase>)));
+	}
+
+	// Gathers packets into an envelope.
+	template<class TPacketBase>
+	class BasicEnvelopeWriter
+	{
+	public:
+		BasicEnvelopeWriter()
+			: size(Envelope::FirstEntryOffset<TPacketBase>), count(0)
+		{
+		}
+
+		// Copies a packet into the envelope. Returns false if there isn't room for it.
+		bool Add(const void *packet, int packetSize)
+		{
+			if (count >= MaxEnvelopePackets || packetSize < static_cast<int>(sizeof(TPacketBase)))
+				return false;
+			auto packetOffset = size + Envelope::EntryHeaderSize;
+			if (packetSize > MaxEnvelopeSize - packetOffset)
+				return false;
+
+			memset(buffer + size, 0, Envelope::EntryHeaderSize);
+			*reinterpret_cast<int32_t*>(buffer + size) = packetSize;
+			memcpy(buffer + packetOffset, packet, packetSize);
+
+			auto end = packetOffset + packetSize;
+			size = Envelope::AlignUp(end);
+			memset(buffer + end, 0, size - end);
+			count++;
+			return true;
+		}
+
+		int Count() const { return count; }
+		bool Empty() const { return count == 0; }
+
+		// Fills in the envelope's header and returns it. GetSize() is its size in bytes.
+		const BasicEnvelopePacket<TPacketBase> *Finish(PacketGuid envelopeGuid)
+		{
+			auto envelope = new (buffer) BasicEnvelopePacket<TPacketBase>(envelopeGuid);
+			envelope->PacketCount = count;
+			return envelope;
+		}
+
+		int GetSize() const { return size; }
+
+		// Empties the envelope.
+		void Reset()
+		{
+			size = Envelope::FirstEntryOffset<TPacketBase>;
+			count = 0;
+		}
+
+	private:
+		alignas(Envelope::Alignment) uint8_t buffer[MaxEnvelopeSize];
+		int size;
+		int count;
+	};
+
+	// Calls callback(const TPacketBase *packet, int packetSize) for each packet in an envelope built by
+	// BasicEnvelopeWriter or DeserializeEnvelope, in the order they were added.
+	template<class TPacketBase, class Callback>
+	void ForEachEnvelopePacket(const BasicEnvelopePacket<TPacketBase> *envelope, int envelopeSize, Callback &&callback)
+	{
+		auto bytes = reinterpret_cast<const uint8_t*>(envelope);
+		auto offset = Envelope::FirstEntryOffset<TPacketBase>;
+		for (uint32_t i = 0; i < envelope->PacketCount; i++)
+		{
+			if (offset + Envelope::EntryHeaderSize > envelopeSize)
+				return;
+			auto packetSize = *reinterpret_cast<const int32_t*>(bytes + offset);
+			auto packetOffset = offset + Envelope::EntryHeaderSize;
+			if (packetSize < static_cast<int>(sizeof(TPacketBase)) || packetSize > envelopeSize - packetOffset)
+				return;
+			callback(reinterpret_cast<const TPacketBase*>(bytes + packetOffset), packetSize);
+			offset = Envelope::AlignUp(packetOffset + packetSize);
+		}
+	}
+
+	// Serializes the packets in an envelope. lookUp(guid) returns the handler for a packet inside an envelope, or
+	// null if the type isn't allowed there. Packets without a handler or with a bad size are left out.
+	template<class TStream, class TPacketBase, class TLookUp>
+	void SerializeEnvelope(TStream *stream, int envelopeSize, const BasicEnvelopePacket<TPacketBase> *envelope, TLookUp &&lookUp)
+	{
+		auto findHandler = [&](const TPacketBase *packet, int packetSize) -> decltype(lookUp(PacketGuid()))
+		{
+			auto handler = lookUp(packet->TypeGuid);
+			if (!handler || packetSize < handler->GetMinRawPacketSize() || packetSize > handler->GetMaxRawPacketSize())
+				return nullptr;
+			return handler;
+		};
+
+		// The count has to be written first, so find out how many packets can actually be serialized
+		auto validCount = 0;
+		ForEachEnvelopePacket(envelope, envelopeSize, [&](const TPacketBase *packet, int packetSize)
+		{
+			if (findHandler(packet, packetSize))
+				validCount++;
+		});
+		validCount = std::min(validCount, MaxEnvelopePackets);
+		stream->WriteUnsigned(static_cast<uint32_t>(validCount), Envelope::PacketCountBits);
+
+		auto written = 0;
+		ForEachEnvelopePacket(envelope, envelopeSize, [&](const TPacketBase *packet, int packetSize)
+		{
+			auto handler = findHandler(packet, packetSize);
+			if (!handler || written >= validCount)
+				return;
+			stream->WriteUnsigned(static_cast<uint32_t>(packetSize), Envelope::PacketSizeBits);
+			stream->WriteUnsigned(packet->TypeGuid, static_cast<int>(sizeof(PacketGuid) * 8));
+			handler->SerializeRawPacket(stream, packetSize, packet);
+			written++;
+		});
+	}
+
+	// Deserializes the packets in an envelope into a buffer of envelopeSize bytes which starts with the envelope's
+	// header. Returns false if any packet is invalid or they don't fit.
+	template<class TStream, class TPacketBase, class TLookUp>
+	bool DeserializeEnvelope(TStream *stream, int envelopeSize, BasicEnvelopePacket<TPacketBase> *envelope, TLookUp &&lookUp)
+	{
+		if (envelopeSize < Envelope::FirstEntryOffset<TPacketBase>)
+			return false;
+
+		auto bytes = reinterpret_cast<uint8_t*>(envelope);
+		auto count = stream->template ReadUnsigned<uint32_t>(Envelope::PacketCountBits);
+		auto offset = Envelope::FirstEntryOffset<TPacketBase>;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			auto packetSize = stream->template ReadUnsigned<int>(Envelope::PacketSizeBits);
+			auto guid = stream->template ReadUnsigned<PacketGuid>(static_cast<int>(sizeof(PacketGuid) * 8));
+			auto handler = lookUp(guid);
+			if (!handler)
+				return false;
+			if (packetSize < static_cast<int>(sizeof(TPacketBase)) || packetSize < handler->GetMinRawPacketSize() || packetSize > handler->GetMaxRawPacketSize())
+				return false;
+
+			auto packetOffset = offset + Envelope::EntryHeaderSize;
+			if (packetOffset > envelopeSize || packetSize > envelopeSize - packetOffset)
+				return false;
+
+			memset(bytes + offset, 0, Envelope::EntryHeaderSize);
+			*reinterpret_cast<int32_t*>(bytes + offset) = packetSize;
+
+			// Packets in an envelope share its header
+			auto packet = reinterpret_cast<TPacketBase*>(bytes + packetOffset);
+			memset(static_cast<void*>(packet), 0, packetSize);
+			memcpy(&packet->Header, &envelope->Header, sizeof(packet->Header));
+			packet->TypeGuid = guid;
+			if (!handler->DeserializeRawPacket(stream, packetSize, packet))
+				return false;
+
+			offset = Envelope::AlignUp(packetOffset + packetSize);
+		}
+		envelope->PacketCount = count;
+		return true;
+	}
+}
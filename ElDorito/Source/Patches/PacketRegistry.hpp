@@ -0,0 +1,66 @@
+#pragma once
+#include "../Utils/Sha1.hpp"
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Patches::CustomPackets
+{
+	// Type used for a custom packet GUID.
+	typedef uint32_t PacketGuid;
+
+	// A packet name along with its GUID (the first 4 bytes of the name's SHA-1 digest).
+	struct PacketName
+	{
+		template<size_t N>
+		constexpr PacketName(const char(&name)[N])
+			: Name(name, N - 1), Guid(Utils::Sha1::Hash32(name, N - 1))
+		{
+		}
+
+		PacketName(const std::string &name)
+			: Name(name), Guid(Utils::Sha1::Hash32(name.c_str(), name.length()))
+		{
+		}
+
+		std::string_view Name;
+		PacketGuid Guid;
+	};
+
+	// The registered packet types, looked up by GUID every time a custom packet is sent or received.
+	// GUIDs are already hashes, so a hash map lookup beats searching a sorted list (see PacketRegistryTest).
+	template<class THandler>
+	class PacketRegistry
+	{
+	public:
+		struct Entry
+		{
+			PacketGuid Guid;
+			std::string Name;
+			std::shared_ptr<THandler> Handler;
+		};
+
+		// Throws std::runtime_error if another packet already has the same GUID.
+		void Add(const PacketName &name, std::shared_ptr<THandler> handler)
+		{
+			if (auto existing = Find(name.Guid))
+				throw std::runtime_error("Duplicate packet GUID for \"" + std::string(name.Name) + "\" (already used by \"" + existing->Name + "\")");
+			entries.emplace(name.Guid, Entry { name.Guid, std::string(name.Name), std::move(handler) });
+		}
+
+		// Returns null if the GUID isn't registered.
+		const Entry *Find(PacketGuid guid) const
+		{
+			auto it = entries.find(guid);
+			return it != entries.end() ? &it->second : nullptr;
+		}
+
+		size_t Size() const { return entries.size(); }
+
+	private:
+		std::unordered_map<PacketGuid, Entry> entries;
+	};
+}
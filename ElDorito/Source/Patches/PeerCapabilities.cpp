@@ -0,0 +1,83 @@
+#include "PeerCapabilities.hpp"
+#include "Membership.hpp"
+#include "PlayerPropertiesExtension.hpp"
+#include "../Blam/BlamNetwork.hpp"
+
+#include <cstring>
+
+namespace
+{
+	using namespace Patches::PeerCapabilities;
+
+	// Everything this build supports
+	const uint32_t LocalCapabilities = PacketEnvelopes | ChatBatches;
+
+	// The capabilities each player's peer advertised, or 0 if it didn't send any
+	uint32_t PlayerCapabilities[Blam::Network::MaxPlayers];
+
+	// Player-properties packet extension to send the capabilities of the player's peer
+	class CapabilitiesExtension : public Patches::Network::PlayerPropertiesExtension<uint32_t>
+	{
+	protected:
+		void BuildData(int playerIndex, uint32_t *out) override
+		{
+			*out = LocalCapabilities;
+		}
+
+		void ApplyData(int playerIndex, Blam::Players::PlayerProperties *properties, const uint32_t &data) override
+		{
+			if (playerIndex >= 0 && playerIndex < Blam::Network::MaxPlayers)
+				PlayerCapabilities[playerIndex] = data;
+		}
+
+		void Serialize(Blam::BitStream *stream, const uint32_t &data) override
+		{
+			stream->WriteUnsigned(data, 32);
+		}
+
+		void Deserialize(Blam::BitStream *stream, uint32_t *out) override
+		{
+			*out = stream->ReadUnsigned<uint32_t>(32);
+		}
+
+		int GetMaxSerializedBits() const override
+		{
+			return 32;
+		}
+	};
+
+	void OnMembershipEvent(const Patches::Membership::MembershipEvent &event)
+	{
+		using Patches::Membership::MembershipEventType;
+
+		// A player slot's capabilities are only valid until its peer leaves. Peers which don't send the extension
+		// never overwrite the entry, so it has to be cleared here rather than when the next player takes the slot.
+		if (event.Type == MembershipEventType::PeerLeft && event.Player >= 0)
+			PlayerCapabilities[event.Player] = 0;
+		else if (event.Type == MembershipEventType::HostChanged && event.NewValue < 0)
+			memset(PlayerCapabilities, 0, sizeof(PlayerCapabilities));
+	}
+}
+
+namespace Patches::PeerCapabilities
+{
+	void ApplyAll()
+	{
+		Network::PlayerPropertiesExtender::Instance().Add("eldewrito-peer-capabilities", std::make_shared<CapabilitiesExtension>());
+		Membership::OnMembershipEvent(OnMembershipEvent);
+	}
+
+	bool PeerSupports(int peer, Capability capability)
+	{
+		auto session = Blam::Network::GetActiveSession();
+		if (!session || peer < 0)
+			return false;
+		auto membership = &session->MembershipInfo;
+		if (peer == membership->LocalPeerIndex)
+			return true;
+		auto player = membership->GetPeerPlayer(peer);
+		if (player < 0 || player >= Blam::Network::MaxPlayers)
+			return false;
+		return (PlayerCapabilities[player] & capability) != 0;
+	}
+}
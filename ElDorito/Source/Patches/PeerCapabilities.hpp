@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+// Lets peers advertise which optional packets they understand, so that newer packets are only sent to peers which
+// can read them and older peers keep getting the packets they already know.
+namespace Patches::PeerCapabilities
+{
+	// Optional features a peer can support.
+	enum Capability : uint32_t
+	{
+		// The peer understands "eldewrito-packet-envelope".
+		PacketEnvelopes = 1 << 0,
+
+		// The peer understands "eldewrito-text-chat-batch".
+		ChatBatches = 1 << 1,
+	};
+
+	// Registers the player-properties extension which the capabilities are sent in.
+	void ApplyAll();
+
+	// Returns true if a peer advertised support for a capability.
+	// Capabilities are sent with player properties, so only the host knows them, and only once the peer's player
+	// properties have arrived. The local peer always supports everything.
+	bool PeerSupports(int peer, Capability capability);
+}
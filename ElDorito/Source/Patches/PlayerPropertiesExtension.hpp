@@ -3,9 +3,9 @@
 #include "../Utils/Singleton.hpp"
 #include "../Blam/BitStream.hpp"
 #include "../Blam/BlamPlayers.hpp"
+#include "PlayerPropertiesLayout.hpp"
 
-#include <vector>
-#include <memory>
+#include <cstdint>
 
 namespace Patches::Network
 {
@@ -29,6 +29,10 @@ namespace Patches::Network
 
 		// Deserializes extension data that was received from the network.
 		virtual void Deserialize(Blam::BitStream *stream, void *out) = 0;
+
+		// Gets the most bits Serialize() can write. Every extension's data is padded to this on the wire so that peers
+		// without the extension can skip it, so it should be exact rather than the size of the data in memory.
+		virtual int GetMaxSerializedBits() const = 0;
 	};
 
 	// Helper class which adds type safety to PlayerPropertiesExtensionBase.
@@ -77,31 +81,7 @@ namespace Patches::Network
 
 	// Singleton object which lets the player-properties packet be extended with custom data
 	// TODO: Make this more generic and not so specific to player-properties
-	class PlayerPropertiesExtender : public Utils::Singleton<PlayerPropertiesExtender>
+	class PlayerPropertiesExtender : public PlayerPropertiesLayout<PlayerPropertiesExtensionBase>, public Utils::Singleton<PlayerPropertiesExtender>
 	{
-	public:
-		// Adds an extension to the player-properties packet.
-		void Add(std::shared_ptr<PlayerPropertiesExtensionBase> extension)
-		{
-			extensions.push_back(extension);
-		}
-
-		// Gets the total size of the player-properties extension data.
-		size_t GetTotalSize();
-
-		// Writes all extension data out to a player-properties structure.
-		void BuildData(int playerIndex, void *out);
-
-		// Applies all extension data in a player-properties structure.
-		void ApplyData(int playerIndex, Blam::Players::PlayerProperties *properties, const void *data);
-
-		// Serializes all extension data in a player-properties structure.
-		void SerializeData(Blam::BitStream *stream, const void *data);
-
-		// Deserializes all extension data in a player-properties structure.
-		void DeserializeData(Blam::BitStream *stream, void *out);
-
-	private:
-		std::vector<std::shared_ptr<PlayerPropertiesExtensionBase>> extensions;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include "../Utils/Sha1.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Patches::Network
+{
+	// The layout of the player-properties extension data, and the code to build, apply and send it.
+	//
+	// The layout is frozen the first time it is used, so every extension has to be added before then. In memory, the
+	// data is a bitmask of the extensions that are present followed by each extension's data. On the wire, it is a hash
+	// of the layout, a list of each extension's ID and bit budget, and then each extension's serialized data padded out
+	// to its budget. Extensions which the other end doesn't have, or which have a different budget there, are skipped
+	// over and left out of the mask so they aren't applied.
+	//
+	// This is kept apart from the game's player structures so that it can be built without the engine headers. THandler
+	// is the extension interface (PlayerPropertiesExtensionBase), and the stream and properties types are whatever the
+	// handlers take.
+	template<class THandler>
+	class PlayerPropertiesLayout
+	{
+	public:
+		// Maximum number of extensions, limited by the size of the presence mask.
+		static const int MaxExtensions = 32;
+
+		// Adds an extension. The name identifies the extension across the network and must be unique. Throws
+		// std::runtime_error if the layout is already frozen or the name is taken.
+		void Add(const std::string &name, std::shared_ptr<THandler> extension)
+		{
+			if (frozen)
+				throw std::runtime_error("Player-properties extension \"" + name + "\" was added after the layout was frozen");
+			if (extensions.size() >= MaxExtensions)
+				throw std::runtime_error("Too many player-properties extensions to add \"" + name + "\"");
+
+			auto id = Utils::Sha1::Hash32(name.c_str(), name.length());
+			for (auto &&existing : extensions)
+			{
+				if (existing.Id == id)
+					throw std::runtime_error("Duplicate player-properties extension ID for \"" + name + "\" (already used by \"" + existing.Name + "\")");
+			}
+
+			Extension entry;
+			entry.Id = id;
+			entry.Name = name;
+			entry.Handler = extension;
+			entry.Offset = 0;
+			entry.Size = 0;
+			entry.MaxBits = 0;
+			extensions.push_back(std::move(entry));
+		}
+
+		// Computes the layout of the extension data if it hasn't been computed yet. Later calls to Add() will fail.
+		void Freeze()
+		{
+			if (frozen)
+				return;
+			frozen = true;
+
+			// Lay out the data structures in order, and hash each one's ID and budget
+			std::string descriptor;
+			auto offset = FirstExtensionOffset;
+			for (auto &&extension : extensions)
+			{
+				extension.Offset = offset;
+				extension.Size = extension.Handler->GetDataSize();
+				extension.MaxBits = extension.Handler->GetMaxSerializedBits();
+				if (extension.MaxBits < 0 || extension.MaxBits >= (1 << BudgetBits))
+					throw std::runtime_error("Player-properties extension \"" + extension.Name + "\" has an invalid bit budget");
+				offset = AlignUp(offset + extension.Size);
+
+				descriptor.append(reinterpret_cast<const char*>(&extension.Id), sizeof(extension.Id));
+				descriptor.append(reinterpret_cast<const char*>(&extension.MaxBits), sizeof(extension.MaxBits));
+			}
+			totalSize = offset;
+			layoutHash = Utils::Sha1::Hash32(descriptor.c_str(), descriptor.length());
+		}
+
+		// Gets a hash of the extension IDs and bit budgets.
+		uint32_t GetLayoutHash()
+		{
+			Freeze();
+			return layoutHash;
+		}
+
+		// Gets the total size of the extension data.
+		size_t GetTotalSize()
+		{
+			Freeze();
+			return totalSize;
+		}
+
+		// Writes all extension data for a player.
+		void BuildData(int playerIndex, void *out)
+		{
+			Freeze();
+			auto bytes = static_cast<uint8_t*>(out);
+			memset(bytes, 0, totalSize);
+
+			PresenceMask present = 0;
+			for (size_t i = 0; i < extensions.size(); i++)
+			{
+				extensions[i].Handler->BuildData(playerIndex, bytes + extensions[i].Offset);
+				present |= 1U << i;
+			}
+			memcpy(bytes, &present, sizeof(present));
+		}
+
+		// Applies the extension data which is present to a player.
+		template<class TProperties>
+		void ApplyData(int playerIndex, TProperties *properties, const void *data)
+		{
+			Freeze();
+			auto bytes = static_cast<const uint8_t*>(data);
+			PresenceMask present;
+			memcpy(&present, bytes, sizeof(present));
+
+			// Apply the data structures which were received
+			for (size_t i = 0; i < extensions.size(); i++)
+			{
+				if (present & (1U << i))
+					extensions[i].Handler->ApplyData(playerIndex, properties, bytes + extensions[i].Offset);
+			}
+		}
+
+		// Serializes the extension data which is present.
+		template<class TStream>
+		void SerializeData(TStream *stream, const void *data)
+		{
+			Freeze();
+			auto bytes = static_cast<const uint8_t*>(data);
+			PresenceMask present;
+			memcpy(&present, bytes, sizeof(present));
+
+			auto count = 0;
+			for (size_t i = 0; i < extensions.size(); i++)
+			{
+				if (present & (1U << i))
+					count++;
+			}
+
+			// Layout
+			stream->WriteUnsigned(layoutHash, 32);
+			stream->WriteUnsigned(static_cast<uint32_t>(count), CountBits);
+			for (size_t i = 0; i < extensions.size(); i++)
+			{
+				if (!(present & (1U << i)))
+					continue;
+				stream->WriteUnsigned(extensions[i].Id, 32);
+				stream->WriteUnsigned(static_cast<uint32_t>(extensions[i].MaxBits), BudgetBits);
+			}
+
+			// Serialize the data structures in order, padding each one to its budget so they can be skipped
+			for (size_t i = 0; i < extensions.size(); i++)
+			{
+				if (!(present & (1U << i)))
+					continue;
+				auto start = stream->Position();
+				extensions[i].Handler->Serialize(stream, bytes + extensions[i].Offset);
+				WritePadding(stream, extensions[i].MaxBits - (stream->Position() - start));
+			}
+		}
+
+		// Deserializes extension data. Returns false if the data is malformed.
+		template<class TStream>
+		bool DeserializeData(TStream *stream, void *out)
+		{
+			Freeze();
+			auto bytes = static_cast<uint8_t*>(out);
+			memset(bytes, 0, totalSize);
+
+			// Layout
+			auto hash = stream->template ReadUnsigned<uint32_t>(32);
+			auto count = stream->template ReadUnsigned<int>(CountBits);
+			if (count > MaxExtensions)
+				return false;
+			RemoteExtension remote[MaxExtensions];
+			for (auto i = 0; i < count; i++)
+			{
+				remote[i].Id = stream->template ReadUnsigned<uint32_t>(32);
+				remote[i].Bits = stream->template ReadUnsigned<int>(BudgetBits);
+			}
+
+			PresenceMask present = 0;
+			if (hash == layoutHash && count == static_cast<int>(extensions.size()))
+			{
+				// Same layout, so everything can be read in order
+				for (auto i = 0; i < count; i++)
+				{
+					if (!DeserializeExtension(stream, extensions[i], bytes))
+						return false;
+					present |= 1U << i;
+				}
+			}
+			else
+			{
+				// Read the extensions which match up and skip the rest
+				for (auto i = 0; i < count; i++)
+				{
+					size_t match = 0;
+					while (match < extensions.size() && extensions[match].Id != remote[i].Id)
+						match++;
+
+					if (match == extensions.size() || extensions[match].MaxBits != remote[i].Bits || (present & (1U << match)))
+					{
+						SkipBits(stream, remote[i].Bits);
+						continue;
+					}
+					if (!DeserializeExtension(stream, extensions[match], bytes))
+						return false;
+					present |= 1U << match;
+				}
+			}
+			memcpy(bytes, &present, sizeof(present));
+			return true;
+		}
+
+	private:
+		// Extension data is aligned to this many bytes, enough for any member an extension's structure could have
+		static const size_t DataAlignment = 8;
+
+		// The presence mask comes first
+		typedef uint32_t PresenceMask;
+		static const size_t FirstExtensionOffset = DataAlignment;
+
+		static const int CountBits = 6;
+		static const int BudgetBits = 16;
+
+		static_assert(MaxExtensions < (1 << CountBits), "MaxExtensions doesn't fit in the extension count");
+		static_assert(MaxExtensions <= sizeof(PresenceMask) * 8, "MaxExtensions doesn't fit in the presence mask");
+
+		struct Extension
+		{
+			uint32_t Id;
+			std::string Name;
+			std::shared_ptr<THandler> Handler;
+			size_t Offset;
+			size_t Size;
+			int MaxBits;
+		};
+
+		// An entry in the list of extensions a packet was sent with
+		struct RemoteExtension
+		{
+			uint32_t Id;
+			int Bits;
+		};
+
+		std::vector<Extension> extensions;
+		bool frozen = false;
+		uint32_t layoutHash = 0;
+		size_t totalSize = 0;
+
+		static size_t AlignUp(size_t offset)
+		{
+			return (offset + DataAlignment - 1) & ~(DataAlignment - 1);
+		}
+
+		template<class TStream>
+		static void WritePadding(TStream *stream, int bits)
+		{
+			for (; bits > 0; bits -= 32)
+				stream->WriteUnsigned(0U, bits < 32 ? bits : 32);
+		}
+
+		template<class TStream>
+		static void SkipBits(TStream *stream, int bits)
+		{
+			for (; bits > 0; bits -= 32)
+				stream->template ReadUnsigned<uint32_t>(bits < 32 ? bits : 32);
+		}
+
+		template<class TStream>
+		static bool DeserializeExtension(TStream *stream, const Extension &extension, uint8_t *out)
+		{
+			auto start = stream->Position();
+			extension.Handler->Deserialize(stream, out + extension.Offset);
+			auto used = stream->Position() - start;
+			if (used > extension.MaxBits)
+				return false;
+			SkipBits(stream, extension.MaxBits - used);
+			return true;
+		}
+	};
+}
@@ -84,6 +84,13 @@ namespace
 			stream->ReadString(out->ServiceTag);
 			out->Gender = stream->ReadBool();
 		}
+
+		int GetMaxSerializedBits() const override
+		{
+			// Name ID, service tag length and characters, gender
+			const auto maxTagLength = sizeof(RepresentationData::ServiceTag) - 1;
+			return 32 + Utils::Bits::CountBits(maxTagLength) + static_cast<int>(maxTagLength) * 8 + 1;
+		}
 	};
 }
 
@@ -92,7 +99,7 @@ namespace Patches::PlayerRepresentation
 {
 	void ApplyAll()
 	{
-		Patches::Network::PlayerPropertiesExtender::Instance().Add(std::make_unique<PlayerRepresentationExtensions>());
+		Patches::Network::PlayerPropertiesExtender::Instance().Add("eldewrito-player-representation", std::make_shared<PlayerRepresentationExtensions>());
 	}
 
 	void UpdateLocalRepresentation()
@@ -2,11 +2,23 @@
 
 #include <cstdint>
 #include <string>
+#include "../Utils/PlayerIdentity.hpp"
 
 namespace Patches::PlayerUid
 {
 	void ApplyAll();
+
+	// Loads the keypair from the config, generating one in the background if there isn't one yet.
+	// Must be called after the config has been executed.
+	void Initialize();
+
+	// Applies a keypair that finished generating in the background.
+	void Tick();
+
 	uint64_t Get();
 	std::string GetFormattedPrivKey();
 	bool ParseUid(const std::string &str, uint64_t *out);
+
+	// Gets the local player's identity, for signing data with the player's key.
+	Utils::PlayerIdentity& GetIdentity();
 }
\ No newline at end of file
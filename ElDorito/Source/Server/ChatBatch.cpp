@@ -0,0 +1,223 @@
+#include "ChatBatch.hpp"
+#include <cstring>
+
+namespace
+{
+	using namespace Server::Chat;
+
+	// Set in a message's flags byte if its body refers to an earlier message
+	const uint8_t BodyReferenceFlag = 0x80;
+
+	bool HasSender(ChatMessageType type)
+	{
+		return type != ChatMessageType::Server;
+	}
+
+	bool HasTarget(ChatMessageType type)
+	{
+		return type == ChatMessageType::Whisper;
+	}
+}
+
+namespace Server::Chat
+{
+	ChatBatchWriter::ChatBatchWriter(bool dedupBodies)
+		: dedupBodies(dedupBodies)
+	{
+		bodyOffsets.reserve(MaxBatchMessages);
+		Reset();
+	}
+
+	bool ChatBatchWriter::Add(const ChatMessage &message)
+	{
+		if (bodyOffsets.size() >= MaxBatchMessages)
+			return false;
+
+		auto length = strnlen(message.Body, MaxMessageLength);
+
+		// Look for an earlier message with the same body
+		auto reference = -1;
+		if (dedupBodies)
+		{
+			for (size_t i = 0; i < bodyOffsets.size(); i++)
+			{
+				auto offset = bodyOffsets[i];
+				if (batch.Data[offset] == length && memcmp(&batch.Data[offset + 1], message.Body, length) == 0)
+				{
+					reference = static_cast<int>(i);
+					break;
+				}
+			}
+		}
+
+		size_t size = 1;
+		if (HasSender(message.Type))
+			size++;
+		if (HasTarget(message.Type))
+			size++;
+		size += (reference >= 0) ? 1 : 1 + length;
+		if (batch.Size + size > MaxBatchSize)
+			return false;
+
+		auto out = &batch.Data[batch.Size];
+		*out++ = static_cast<uint8_t>(message.Type) | (reference >= 0 ? BodyReferenceFlag : 0);
+		if (HasSender(message.Type))
+			*out++ = message.SenderPlayer;
+		if (HasTarget(message.Type))
+			*out++ = message.TargetPlayer;
+
+		if (reference >= 0)
+		{
+			*out++ = static_cast<uint8_t>(reference);
+			bodyOffsets.push_back(bodyOffsets[reference]);
+		}
+		else
+		{
+			bodyOffsets.push_back(static_cast<uint16_t>(out - batch.Data));
+			*out++ = static_cast<uint8_t>(length);
+			memcpy(out, message.Body, length);
+		}
+
+		batch.Size += static_cast<uint16_t>(size);
+		return true;
+	}
+
+	bool ChatBatchWriter::Empty() const
+	{
+		return bodyOffsets.empty();
+	}
+
+	const ChatBatch &ChatBatchWriter::GetBatch() const
+	{
+		return batch;
+	}
+
+	void ChatBatchWriter::Reset()
+	{
+		batch.Size = 0;
+		bodyOffsets.clear();
+	}
+
+	bool ReadChatBatch(const ChatBatch &batch, const std::function<void(const ChatMessage &message)> &callback)
+	{
+		if (batch.Size > MaxBatchSize)
+			return false;
+
+		uint16_t bodyOffsets[MaxBatchMessages];
+		size_t count = 0;
+		size_t pos = 0;
+		while (pos < batch.Size)
+		{
+			if (count >= MaxBatchMessages)
+				return false;
+
+			ChatMessage message;
+			memset(&message, 0, sizeof(message));
+
+			auto flags = batch.Data[pos++];
+			message.Type = static_cast<ChatMessageType>(flags & ~BodyReferenceFlag);
+			if (static_cast<uint32_t>(message.Type) >= static_cast<uint32_t>(ChatMessageType::Count))
+				return false;
+
+			if (HasSender(message.Type))
+			{
+				if (pos >= batch.Size || batch.Data[pos] >= MaxChatPlayers)
+					return false;
+				message.SenderPlayer = batch.Data[pos++];
+			}
+			if (HasTarget(message.Type))
+			{
+				if (pos >= batch.Size || batch.Data[pos] >= MaxChatPlayers)
+					return false;
+				message.TargetPlayer = batch.Data[pos++];
+			}
+
+			if (pos >= batch.Size)
+				return false;
+			size_t bodyOffset;
+			if (flags & BodyReferenceFlag)
+			{
+				auto reference = batch.Data[pos++];
+				if (reference >= count)
+					return false;
+				bodyOffset = bodyOffsets[reference];
+			}
+			else
+			{
+				bodyOffset = pos;
+				auto length = batch.Data[pos];
+				if (length > MaxMessageLength || pos + 1 + length > batch.Size)
+					return false;
+				pos += 1 + length;
+			}
+
+			memcpy(message.Body, &batch.Data[bodyOffset + 1], batch.Data[bodyOffset]);
+			bodyOffsets[count++] = static_cast<uint16_t>(bodyOffset);
+			callback(message);
+		}
+		return true;
+	}
+
+	void ChatOutbox::Queue(const ChatMessage &message, PeerBitSet peers)
+	{
+		if (peers.any())
+			messages.push_back({ message, peers });
+	}
+
+	bool ChatOutbox::Empty() const
+	{
+		return messages.empty();
+	}
+
+	void ChatOutbox::Flush(bool dedupBodies, PeerBitSet batchPeers, const std::function<void(int peer, const ChatBatch &batch)> &sendBatch,
+		const std::function<void(int peer, const ChatMessage &message)> &sendMessage)
+	{
+		if (messages.empty())
+			return;
+
+		ChatBatchWriter writer(dedupBodies);
+		lastPeerMessages.clear();
+
+		for (auto peer = 0; peer < MaxChatPeers; peer++)
+		{
+			peerMessages.clear();
+			for (size_t i = 0; i < messages.size(); i++)
+			{
+				if (messages[i].Peers[peer])
+					peerMessages.push_back(static_cast<uint32_t>(i));
+			}
+			if (peerMessages.empty())
+				continue;
+
+			if (!batchPeers[peer])
+			{
+				for (auto index : peerMessages)
+					sendMessage(peer, messages[index].Message);
+				continue;
+			}
+
+			if (peerMessages != lastPeerMessages)
+			{
+				batches.clear();
+				writer.Reset();
+				for (auto index : peerMessages)
+				{
+					auto &message = messages[index].Message;
+					if (writer.Add(message))
+						continue;
+
+					// Full, start a new batch (a single message always fits)
+					batches.push_back(writer.GetBatch());
+					writer.Reset();
+					writer.Add(message);
+				}
+				batches.push_back(writer.GetBatch());
+				lastPeerMessages.swap(peerMessages);
+			}
+
+			for (auto &&batch : batches)
+				sendBatch(peer, batch);
+		}
+		messages.clear();
+	}
+}
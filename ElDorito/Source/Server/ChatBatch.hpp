@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "ChatMessage.hpp"
+
+namespace Server::Chat
+{
+	// The maximum size of an encoded batch in bytes, kept under the network MTU.
+	const size_t MaxBatchSize = 1024;
+
+	// The maximum number of messages in one batch.
+	const size_t MaxBatchMessages = 255;
+
+	// Several chat messages encoded into one packet.
+	//
+	// Each message is a flags byte (the message type, plus 0x80 if the body is a reference),
+	// the sender index for non-server messages, the target index for whispers, and then either
+	// a length-prefixed body or the index of an earlier message in the batch with the same body.
+	struct ChatBatch
+	{
+		// The number of bytes used in Data.
+		uint16_t Size;
+
+		uint8_t Data[MaxBatchSize];
+	};
+
+	// Encodes messages into a batch.
+	class ChatBatchWriter
+	{
+	public:
+		// If dedupBodies is true, a body that was already written to the batch is written as a reference to it.
+		explicit ChatBatchWriter(bool dedupBodies);
+
+		// Appends a message to the batch. Returns false if it doesn't fit, in which case the batch should be sent and reset.
+		bool Add(const ChatMessage &message);
+
+		bool Empty() const;
+
+		// Gets the encoded batch so far.
+		const ChatBatch &GetBatch() const;
+
+		void Reset();
+
+	private:
+		bool dedupBodies;
+		ChatBatch batch;
+
+		// Offsets of each message's body in the batch data, for finding duplicates
+		std::vector<uint16_t> bodyOffsets;
+	};
+
+	// Decodes a batch, calling the callback for each message in order. Returns false if the batch is malformed,
+	// in which case the messages before the error have already been passed to the callback.
+	bool ReadChatBatch(const ChatBatch &batch, const std::function<void(const ChatMessage &message)> &callback);
+
+	// Collects the messages sent to each peer during a tick so they can be sent as one batch per peer.
+	class ChatOutbox
+	{
+	public:
+		// Queues a message to a set of peers.
+		void Queue(const ChatMessage &message, PeerBitSet peers);
+
+		bool Empty() const;
+
+		// Encodes the queued messages for each peer in batchPeers and passes the batches to sendBatch, then clears the
+		// queue. Messages are kept in the order they were queued. Batches which would exceed MaxBatchSize are split.
+		// Peers which aren't in batchPeers (because they don't understand batches) get each message through sendMessage.
+		void Flush(bool dedupBodies, PeerBitSet batchPeers, const std::function<void(int peer, const ChatBatch &batch)> &sendBatch,
+			const std::function<void(int peer, const ChatMessage &message)> &sendMessage);
+
+	private:
+		struct QueuedMessage
+		{
+			ChatMessage Message;
+			PeerBitSet Peers;
+		};
+
+		std::vector<QueuedMessage> messages;
+
+		// Batches are reused for consecutive peers which receive the same messages
+		std::vector<ChatBatch> batches;
+		std::vector<uint32_t> peerMessages;
+		std::vector<uint32_t> lastPeerMessages;
+	};
+}
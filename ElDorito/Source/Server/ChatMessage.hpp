@@ -0,0 +1,68 @@
+#pragma once
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// The chat messages exchanged between the host and clients, kept apart from the packet code so that the batch
+// encoding can be built without the network headers.
+namespace Server::Chat
+{
+	// The number of peers and players in a session. ServerChat.cpp checks these against Blam::Network.
+	const int MaxChatPeers = 17;
+	const int MaxChatPlayers = 16;
+
+	// Chat message types.
+	enum class ChatMessageType: uint32_t
+	{
+		// The message should be sent to all players.
+		Global,
+
+		// The message should only be sent to players on the same team as
+		// the sender.
+		Team,
+
+		// The message should be sent to a specific player.
+		Whisper,
+
+		// The message was sent automatically by the server to a particular
+		// player or set of players.
+		Server,
+
+		// Not actually a message type, just used to indicate the number of
+		// valid message types.
+		Count
+	};
+
+	// The maximum length of a chat message in characters, not including a null terminator.
+	const size_t MaxMessageLength = 128;
+
+	// Chat message data.
+	struct ChatMessage
+	{
+		ChatMessage() { }
+
+		// Initializes a chat message from a type and a body.
+		ChatMessage(ChatMessageType type, const std::string &body)
+		{
+			memset(this, 0, sizeof(*this));
+			Type = type;
+			memcpy(Body, body.c_str(), body.length() < MaxMessageLength ? body.length() : MaxMessageLength);
+		}
+
+		// The message type.
+		ChatMessageType Type;
+
+		// For non-server messages, the index of the player that originally sent the message.
+		uint8_t SenderPlayer;
+
+		// For directed messages, the index of the player to send the message to.
+		uint8_t TargetPlayer;
+
+		// The message body.
+		char Body[MaxMessageLength + 1];
+	};
+
+	// A std::bitset of peers.
+	typedef std::bitset<MaxChatPeers> PeerBitSet;
+}
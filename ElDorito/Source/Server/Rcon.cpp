@@ -12,6 +12,7 @@
 #include "../Patches/Core.hpp"
 #include "../Modules/ModuleGame.hpp"
 #include "../Modules/ModuleServer.hpp"
+#include "../ConfigSnapshot.hpp"
 #include "../Utils/Cryptography.hpp"
 #include "../Utils/WebSocket.hpp"
 
@@ -48,8 +49,10 @@ namespace Server::Rcon
 		Patches::Core::OnShutdown(ForceStopServer);
 		if (Modules::ModuleServer::Instance().VarRconPassword->ValueString == "")
 		{
-			// Ensure a password is set
-			Utils::Cryptography::RandomPassword(DefaultPasswordLength, Modules::ModuleServer::Instance().VarRconPassword->ValueString);
+			// Ensure a password is set, through SetVariable so that the rcon thread's snapshot has it
+			std::string password, previousPassword;
+			Utils::Cryptography::RandomPassword(DefaultPasswordLength, password);
+			Modules::CommandMap::Instance().SetVariable(Modules::ModuleServer::Instance().VarRconPassword, password, previousPassword);
 			Modules::CommandMap::Instance().ExecuteCommand("WriteConfig");
 		}
 		CreateThread(nullptr, 0, RconThread, nullptr, 0, nullptr);
@@ -85,7 +88,7 @@ namespace
 			rconServer.set_close_handler(websocketpp::lib::bind(OnClose, &rconServer, _1));
 			rconServer.set_timer(1000, websocketpp::lib::bind(OnTimer, &rconServer, _1));
 
-			auto port = Modules::ModuleGame::Instance().VarRconPort->ValueInt;
+			auto port = Modules::ConfigSnapshot::Current()->GetInt(Modules::ModuleGame::Instance().VarRconPort);
 			rconServer.listen(static_cast<uint16_t>(port));
 			rconServer.start_accept();
 			rconServer.run();
@@ -144,7 +147,7 @@ namespace
 	void ProcessPassword(server* rconServer, websocketpp::connection_hdl hdl, server::message_ptr msg)
 	{
 		auto inPassword = msg->get_payload();
-		auto actualPassword = Modules::ModuleServer::Instance().VarRconPassword->ValueString;
+		auto actualPassword = Modules::ConfigSnapshot::Current()->GetString(Modules::ModuleServer::Instance().VarRconPassword);
 		if (inPassword == actualPassword)
 		{
 			// Mark the connection as authenticated
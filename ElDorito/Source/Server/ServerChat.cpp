@@ -1,8 +1,10 @@
 #define _CRT_SECURE_NO_WARNINGS
 
 #include "ServerChat.hpp"
+#include "ChatBatch.hpp"
 #include "Rcon.hpp"
 #include "../Patches/CustomPackets.hpp"
+#include "../Patches/PeerCapabilities.hpp"
 #include "../Modules/ModuleServer.hpp"
 #include "../Modules/ModuleGame.hpp"
 #include "../Utils/String.hpp"
@@ -16,10 +18,25 @@ namespace
 {
 	using namespace Server::Chat;
 
+	static_assert(MaxChatPeers == Blam::Network::MaxPeers, "MaxChatPeers is wrong");
+	static_assert(MaxChatPlayers == Blam::Network::MaxPlayers, "MaxChatPlayers is wrong");
+
 	typedef Patches::CustomPackets::Packet<ChatMessage> ChatMessagePacket;
 	typedef Patches::CustomPackets::PacketSender<ChatMessage> ChatMessagePacketSender;
 
+	typedef Patches::CustomPackets::Packet<ChatBatch> ChatBatchPacket;
+	typedef Patches::CustomPackets::PacketSender<ChatBatch> ChatBatchPacketSender;
+
+	constexpr Patches::CustomPackets::PacketName ChatPacketName("eldewrito-text-chat");
+	constexpr Patches::CustomPackets::PacketName ChatBatchPacketName("eldewrito-text-chat-batch");
 	std::shared_ptr<ChatMessagePacketSender> PacketSender;
+	std::shared_ptr<ChatBatchPacketSender> BatchPacketSender;
+
+	// Messages from the host to other peers, sent once per tick
+	ChatOutbox Outbox;
+
+	// Chat log lines, written once per tick
+	std::vector<std::string> PendingLogLines;
 
 	bool HostReceivedMessage(Blam::Network::Session *session, int peer, const ChatMessage &message);
 	void ClientReceivedMessage(const ChatMessage &message);
@@ -100,6 +117,37 @@ namespace
 		}
 	};
 
+	// Packet handler for batches of chat messages sent by the host.
+	class ChatBatchPacketHandler: public Patches::CustomPackets::PacketHandler<ChatBatch>
+	{
+	public:
+		void Serialize(Blam::BitStream *stream, const ChatBatch *data) override
+		{
+			stream->WriteUnsigned<uint16_t>(data->Size, 0, MaxBatchSize);
+			stream->WriteBlock(data->Size * 8, data->Data);
+		}
+
+		bool Deserialize(Blam::BitStream *stream, ChatBatch *data) override
+		{
+			data->Size = stream->ReadUnsigned<uint16_t>(0, MaxBatchSize);
+			if (data->Size > MaxBatchSize)
+				return false;
+			stream->ReadBlock(data->Size * 8, data->Data);
+			return true;
+		}
+
+		void HandlePacket(Blam::Network::ObserverChannel *sender, const ChatBatchPacket *packet) override
+		{
+			auto session = Blam::Network::GetActiveSession();
+			if (!session || session->IsHost())
+				return;
+			auto peer = session->GetChannelPeer(sender);
+			if (peer < 0 || peer != session->MembershipInfo.HostPeerIndex)
+				return;
+			ReadChatBatch(packet->Data, ClientReceivedMessage);
+		}
+	};
+
 	// Registered chat handlers
 	std::vector<std::shared_ptr<ChatHandler>> chatHandlers;
 
@@ -127,8 +175,9 @@ namespace
 		if (ignore)
 			return true; // Message was rejected by a handler
 
-		// Loop through each peer and send them a packet (or handle the message
+		// Queue the message for each remote peer (or handle the message
 		// immediately if it's being sent to the local peer)
+		PeerBitSet remotePeers;
 		auto membership = &session->MembershipInfo;
 		for (auto peer = membership->FindFirstPeer(); peer >= 0; peer = membership->FindNextPeer(peer))
 		{
@@ -136,12 +185,36 @@ namespace
 				continue; // Not being sent to this peer
 			if (peer == membership->LocalPeerIndex)
 				ClientReceivedMessage(*message);
-			else if (!SendMessagePacket(peer, *message))
-				return false;
+			else
+				remotePeers.set(peer);
 		}
+		Outbox.Queue(*message, remotePeers);
 		return true;
 	}
 
+	// Sends the messages queued during this tick as one batch per peer (or more if they don't fit in one).
+	// Peers that didn't advertise batch support get the messages one packet at a time like before.
+	void FlushOutbox()
+	{
+		if (Outbox.Empty())
+			return;
+
+		PeerBitSet batchPeers;
+		for (auto peer = 0; peer < MaxChatPeers; peer++)
+			batchPeers[peer] = Patches::PeerCapabilities::PeerSupports(peer, Patches::PeerCapabilities::ChatBatches);
+
+		Outbox.Flush(true, batchPeers, [](int peer, const ChatBatch &batch)
+		{
+			auto packet = BatchPacketSender->New();
+			packet.Data.Size = batch.Size;
+			memcpy(packet.Data.Data, batch.Data, batch.Size);
+			BatchPacketSender->Send(peer, packet);
+		}, [](int peer, const ChatMessage &message)
+		{
+			SendMessagePacket(peer, message);
+		});
+	}
+
 	// Gets a bitset of peers on the same team as a peer.
 	bool GetTeamPeers(Blam::Network::Session *session, int senderPeer, PeerBitSet *result)
 	{
@@ -276,21 +349,31 @@ namespace
 		return ss.str();
 	}
 
-	// Writes a message to the log file.
+	// Queues a message to be written to the log file.
 	void LogMessage(Blam::Network::Session *session, int peer, const ChatMessage &message)
 	{
 		auto &serverModule = Modules::ModuleServer::Instance();
 		if (!serverModule.VarChatLogEnabled->ValueInt)
 			return;
 
+		PendingLogLines.push_back(GetLogString(session, peer, message));
+	}
+
+	// Writes the queued messages to the log file.
+	void FlushLog()
+	{
+		if (PendingLogLines.empty())
+			return;
+
 		// Try to open the log file for appending
 		auto chatLogFile = Modules::ModuleServer::Instance().VarChatLogFile->ValueString;
 		std::ofstream logFile(chatLogFile, std::ios::app);
-		if (!logFile)
-			return;
-
-		logFile << GetLogString(session,peer, message) << "\n";
-
+		if (logFile)
+		{
+			for (auto &&line : PendingLogLines)
+				logFile << line << "\n";
+		}
+		PendingLogLines.clear();
 	}
 
 	// Callback for when a message is received as the host.
@@ -369,11 +452,16 @@ namespace Server::Chat
 
 		// Register custom packet type
 		auto handler = std::make_shared<ChatMessagePacketHandler>();
-		PacketSender = Patches::CustomPackets::RegisterPacket<ChatMessage>("eldewrito-text-chat", handler);
+		PacketSender = Patches::CustomPackets::RegisterPacket<ChatMessage>(ChatPacketName, handler);
+		auto batchHandler = std::make_shared<ChatBatchPacketHandler>();
+		BatchPacketSender = Patches::CustomPackets::RegisterPacket<ChatBatch>(ChatBatchPacketName, batchHandler);
 	}
 
 	void Tick()
 	{
+		FlushOutbox();
+		FlushLog();
+
 		// Compute the time delta (the game also uses timeGetTime in its various subsystems to do this)
 		auto currentTimeMs = timeGetTime();
 		auto timeDeltaMs = currentTimeMs - LastTimeMs;
@@ -489,11 +577,4 @@ namespace Server::Chat
 	{
 		return ::GetSenderName(Blam::Network::GetActiveSession(), message);
 	}
-
-	ChatMessage::ChatMessage(ChatMessageType type, const std::string &body)
-	{
-		memset(this, 0, sizeof(*this));
-		Type = type;
-		strncpy(Body, body.c_str(), sizeof(Body) / sizeof(Body[0]) - 1);
-	}
 }
@@ -35,6 +35,8 @@ using namespace Patches::CustomPackets;
 
 namespace
 {
+	constexpr PacketName SignalPacketName("eldewrito-signal-server-echo");
+
 	DWORD WINAPI SignalingThread(LPVOID);
 	bool OnValidate(server* signalServer, websocketpp::connection_hdl hdl);
 	void OnMessage(server* signalServer, websocketpp::connection_hdl hdl, server::message_ptr msg);
@@ -99,7 +101,7 @@ namespace Server::Signaling
 	void Initialize()
 	{
 		wsphandler = std::make_shared<WebSocketPacketHandler>();
-		wspsender = RegisterPacket<WebSocketPacketData>("eldewrito-signal-server-echo", wsphandler);
+		wspsender = RegisterPacket<WebSocketPacketData>(SignalPacketName, wsphandler);
 
 		Patches::Network::OnLifeCycleStateChanged(LifeCycleChanged);
 		Patches::Core::OnShutdown(ForceStopServer);
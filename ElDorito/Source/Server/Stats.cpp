@@ -5,9 +5,12 @@
 #include "../Blam/BlamNetwork.hpp"
 #include "../Patches/Events.hpp"
 #include "../Patches/Core.hpp"
+#include "../Patches/Membership.hpp"
 #include "../Modules/ModuleServer.hpp"
 #include "../Modules/ModulePlayer.hpp"
+#include "../ConfigSnapshot.hpp"
 #include "../Utils/Logger.hpp"
+#include "../Utils/Unicode.hpp"
 #include "../ElDorito.hpp"
 #include "../ThirdParty/rapidjson/writer.h"
 #include "../ThirdParty/HttpRequest.hpp"
@@ -24,6 +27,9 @@ namespace Server::Stats
 	time_t sendStatsTime = 0;
 
 	std::string playersInfoEndpoint;
+
+	// Set when the players info needs to be sent again
+	bool playersChanged = false;
 	int numberOfRounds = 1;
 	// retrieves master server endpoints from dewrito.json
 	void GetStatsEndpoints(std::vector<std::string>& destVect)
@@ -120,13 +126,15 @@ namespace Server::Stats
 				char uid[17];
 				Blam::Players::FormatUid(uid, player->Properties.Uid);
 
+				char name[Utils::Unicode::Utf8Size<16>::Value], filteredName[Utils::Unicode::Utf8Size<16>::Value], serviceTag[Utils::Unicode::Utf8Size<6>::Value];
+
 				writer.StartObject();
 				writer.Key("name");
-				writer.String(Utils::String::ThinString(player->Properties.ClientProperties.DisplayName).c_str());
+				writer.String(name, Utils::Unicode::Utf16ToUtf8(player->Properties.ClientProperties.DisplayName, name));
 				writer.Key("filteredName");
-				writer.String(Utils::String::ThinString(player->Properties.DisplayName).c_str());
+				writer.String(filteredName, Utils::Unicode::Utf16ToUtf8(player->Properties.DisplayName, filteredName));
 				writer.Key("serviceTag");
-				writer.String(Utils::String::ThinString(player->Properties.ServiceTag).c_str());
+				writer.String(serviceTag, Utils::Unicode::Utf16ToUtf8(player->Properties.ServiceTag, serviceTag));
 				writer.Key("playerIndex");
 				writer.Int(playerIdx);
 				writer.Key("uid");
@@ -193,29 +201,32 @@ namespace Server::Stats
 		if (statsEndpoints.size() == 0)
 			return false;
 		
+		auto config = Modules::ConfigSnapshot::Current();
+		auto &serverModule = Modules::ModuleServer::Instance();
+
 		rapidjson::StringBuffer s;
 		rapidjson::Writer<rapidjson::StringBuffer> writer(s);
 		writer.StartObject();
 		writer.Key("gameVersion");
 		writer.String(Utils::Version::GetVersionString().c_str());
 		writer.Key("serverName");
-		writer.String(Modules::ModuleServer::Instance().VarServerName->ValueString.c_str());
+		writer.String(config->GetString(serverModule.VarServerName).c_str());
 		writer.Key("serverPort");
-		writer.Int(Modules::ModuleServer::Instance().VarServerPort->ValueInt);
+		writer.Int(config->GetInt(serverModule.VarServerPort));
 		writer.Key("port");
 		writer.Int(Pointer(0x1860454).Read<uint32_t>());
 		writer.Key("hostPlayer");
-		writer.String(Modules::ModulePlayer::Instance().VarPlayerName->ValueString.c_str());
+		writer.String(config->GetString(Modules::ModulePlayer::Instance().VarPlayerName).c_str());
 
 		writer.Key("game");
 		writer.StartObject();
 
 		writer.Key("sprintEnabled");
-		writer.Bool(Modules::ModuleServer::Instance().VarServerSprintEnabled->ValueInt != 0);
+		writer.Bool(config->GetInt(serverModule.VarServerSprintEnabled) != 0);
 		writer.Key("sprintUnlimitedEnabled");
-		writer.Bool(Modules::ModuleServer::Instance().VarServerSprintUnlimited->ValueInt != 0);
+		writer.Bool(config->GetInt(serverModule.VarServerSprintUnlimited) != 0);
 		writer.Key("maxPlayers");
-		writer.Int(Modules::ModuleServer::Instance().VarServerMaxPlayers->ValueInt);
+		writer.Int(config->GetInt(serverModule.VarServerMaxPlayers));
 
 		std::string mapName((char*)Pointer(0x22AB018)(0x1A4));
 		std::wstring mapVariantName((wchar_t*)Pointer(0x1863ACA));
@@ -308,12 +319,13 @@ namespace Server::Stats
 			#pragma region Player
 			writer.StartObject();
 
+			char name[Utils::Unicode::Utf8Size<16>::Value], clientName[Utils::Unicode::Utf8Size<16>::Value], serviceTag[Utils::Unicode::Utf8Size<6>::Value];
 			writer.Key("name");
-			writer.String(Utils::String::ThinString(player->Properties.DisplayName).c_str());
+			writer.String(name, Utils::Unicode::Utf16ToUtf8(player->Properties.DisplayName, name));
 			writer.Key("clientName");
-			writer.String(Utils::String::ThinString(player->Properties.ClientProperties.DisplayName).c_str());
+			writer.String(clientName, Utils::Unicode::Utf16ToUtf8(player->Properties.ClientProperties.DisplayName, clientName));
 			writer.Key("serviceTag");
-			writer.String(Utils::String::ThinString(player->Properties.ServiceTag).c_str());
+			writer.String(serviceTag, Utils::Unicode::Utf16ToUtf8(player->Properties.ServiceTag, serviceTag));
 			writer.Key("ip");
 			writer.String(ipStr);
 			writer.Key("team");
@@ -509,25 +521,44 @@ namespace Server::Stats
 
 namespace Server::Stats
 {
+	void OnMembershipEvent(const Patches::Membership::MembershipEvent &event)
+	{
+		// Only the host announces players, and changes seen as a client mustn't be sent after becoming host
+		auto* session = Blam::Network::GetActiveSession();
+		if (!session || !session->IsEstablished() || !session->IsHost())
+			return;
+
+		// Players get an index when they join, and a name once their properties arrive
+		using Patches::Membership::MembershipEventType;
+		if ((event.Type == MembershipEventType::PlayerAssigned && event.NewValue >= 0) || event.Type == MembershipEventType::NameChanged)
+			playersChanged = true;
+	}
+
 	void Init()
 	{
 		Patches::Network::OnLifeCycleStateChanged(LifeCycleStateChanged);
+		Patches::Membership::OnMembershipEvent(OnMembershipEvent);
 		Patches::Events::OnEvent(OnEvent);
 		Patches::Core::OnGameStart(OnGameStart);
 		GetPlayersInfoEndpoint();
 	}
 
-	void NewPlayerJoined()
-	{
-		auto thread = CreateThread(NULL, 0, GetPlayersInfo_Thread, (LPVOID)"", 0, NULL);
-	}
-
 	void Tick()
 	{
 		auto* session = Blam::Network::GetActiveSession();
 
 		if (!session || !session->IsEstablished() || !session->IsHost())
+		{
+			playersChanged = false;
 			return;
+		}
+
+		// Sent at most once per tick, however many players joined or got their names during it
+		if (playersChanged)
+		{
+			playersChanged = false;
+			auto thread = CreateThread(NULL, 0, GetPlayersInfo_Thread, (LPVOID)"", 0, NULL);
+		}
 
 		time_t curTime1;
 		time(&curTime1);
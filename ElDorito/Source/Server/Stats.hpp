@@ -4,5 +4,4 @@ namespace Server::Stats
 {
 	void Init();
 	void Tick();
-	void NewPlayerJoined();
 }
@@ -31,6 +31,8 @@ namespace
 
 	std::unordered_map<SyncID, SynchronizationBinding> syncBindings;
 
+	constexpr PacketName SyncPacketName("eldewrito-sync-var");
+
 	// Packet structures
 	struct SyncUpdatePacketData
 	{
@@ -71,7 +73,7 @@ namespace Server::VariableSynchronization
 	void Initialize()
 	{
 		auto updateHandler = std::make_shared<SyncUpdateHandler>();
-		updateSender = RegisterVariadicPacket<SyncUpdatePacketData, SyncUpdatePacketVar>("eldewrito-sync-var", updateHandler);
+		updateSender = RegisterVariadicPacket<SyncUpdatePacketData, SyncUpdatePacketVar>(SyncPacketName, updateHandler);
 	}
 
 	void Synchronize(Command *serverVariable, Command *clientVariable)
@@ -219,16 +221,15 @@ namespace
 			TickBinding(&binding.second);
 	}
 
-	std::vector<SynchronizationBinding*> FindOutOfDateBindings(int peerIndex)
+	void FindOutOfDateBindings(int peerIndex, std::vector<SynchronizationBinding*> &result)
 	{
 		// Find bindings which don't have the peer in their set
-		std::vector<SynchronizationBinding*> result;
+		result.clear();
 		for (auto &&binding : syncBindings)
 		{
 			if (!binding.second.SynchronizedPeers[peerIndex])
 				result.push_back(&binding.second);
 		}
-		return result;
 	}
 
 	void BuildVariableUpdate(const SynchronizationBinding *binding, SyncUpdatePacketVar *result)
@@ -256,7 +257,7 @@ namespace
 		}
 	}
 
-	std::shared_ptr<SyncUpdatePacket> BuildUpdatePacket(const std::vector<SynchronizationBinding*> &bindings)
+	PooledPacket<SyncUpdatePacket> BuildUpdatePacket(const std::vector<SynchronizationBinding*> &bindings)
 	{
 		auto result = updateSender->New(bindings.size());
 		for (size_t i = 0; i < bindings.size(); i++)
@@ -270,14 +271,15 @@ namespace
 
 	void SynchronizePeer(int peerIndex)
 	{
-		// Get the bindings which need to be sent to the peer
-		auto outOfDateBindings = FindOutOfDateBindings(peerIndex);
+		// Get the bindings which need to be sent to the peer, reusing the list between peers
+		static std::vector<SynchronizationBinding*> outOfDateBindings;
+		FindOutOfDateBindings(peerIndex, outOfDateBindings);
 		if (!outOfDateBindings.size())
 			return;
 
-		// Build and send an update packet
+		// Build and queue an update packet, it goes out with anything else sent to the peer this tick
 		auto packet = BuildUpdatePacket(outOfDateBindings);
-		updateSender->Send(peerIndex, packet);
+		updateSender->Queue(peerIndex, packet);
 
 		// Mark the peer as synchronized
 		for (auto binding : outOfDateBindings)
@@ -12,6 +12,7 @@ namespace
 	typedef Patches::CustomPackets::Packet<VotingMessage> VotingMessagePacket;
 	typedef Patches::CustomPackets::PacketSender<VotingMessage> VotingMessagePacketSender;
 
+	constexpr Patches::CustomPackets::PacketName VotingPacketName("eldewrito-voting-message");
 	std::shared_ptr<VotingMessagePacketSender> VotingPacketSender;
 	void ReceivedVotingMessage(Blam::Network::Session *session, int peer, const VotingMessage &message);
 
@@ -150,7 +151,7 @@ namespace
 		}
 		auto packet = VotingPacketSender->New();
 		packet.Data = message;
-		VotingPacketSender->Send(peer, packet);
+		VotingPacketSender->Queue(peer, packet);
 		return true;
 	}
 
@@ -160,11 +161,6 @@ namespace
 
 namespace Server::Voting
 {
-	VotingMessage::VotingMessage(VotingMessageType type)
-	{
-		memset(this, 0, sizeof(*this));
-		Type = type;
-	}
 	void AddMessageHandler(std::shared_ptr<VotingMessageHandler> handler)
 	{
 		votingMessageHandlers.push_back(handler);
@@ -173,7 +169,7 @@ namespace Server::Voting
 	{
 		// Register custom packet type
 		auto handler = std::make_shared<VotingMessagePacketHandler>();
-		VotingPacketSender = Patches::CustomPackets::RegisterPacket<VotingMessage>("eldewrito-voting-message", handler);
+		VotingPacketSender = Patches::CustomPackets::RegisterPacket<VotingMessage>(VotingPacketName, handler);
 	}
 
 	//Sends a voting message to all peers
@@ -18,6 +18,7 @@
 #include "../Modules/ModuleServer.hpp"
 #include "../Modules/ModuleGame.hpp"
 #include "../Patches/Network.hpp"
+#include "../Patches/Maps.hpp"
 #include "../Blam/BlamNetwork.hpp"
 #include "../ElDorito.hpp"
 #include "../ThirdParty/rapidjson/writer.h"
@@ -383,6 +384,9 @@ namespace Server::Voting
 			Modules::CommandMap::Instance().ExecuteCommand(command);
 		}
 
+		//Warm the file cache while everyone waits for the game to start
+		Patches::Maps::PrefetchMap(winningOption.haloMap.mapId);
+
 		time(&winnerChosenTime);
 		voteStartedTime = 0;
 		mapVotes.clear();
@@ -650,6 +654,8 @@ namespace Server::Voting
 			Modules::CommandMap::Instance().ExecuteCommand(command);
 		}
 
+		//The current option is played unless it gets vetoed, so start warming the file cache now
+		Patches::Maps::PrefetchMap(currentVetoOption.haloMap.mapId);
 	}
 
 	void VetoSystem::SetStartTimer()
@@ -0,0 +1,86 @@
+#include "BufferPool.hpp"
+#include <new>
+
+namespace
+{
+	const size_t MinClassSize = 256;
+	const int ClassCount = 9; // 256 bytes to 64 KB
+
+	// Buffers beyond this are returned to the heap instead of cached
+	const int MaxCachedPerClass = 8;
+
+	static_assert((MinClassSize << (ClassCount - 1)) == Utils::BufferPool::MaxPooledSize, "Size classes don't match MaxPooledSize");
+
+	// Cached buffers store the free list in themselves
+	struct FreeBuffer
+	{
+		FreeBuffer *Next;
+	};
+
+	struct ThreadCache
+	{
+		FreeBuffer *FreeLists[ClassCount] = {};
+		int Counts[ClassCount] = {};
+
+		~ThreadCache()
+		{
+			for (auto i = 0; i < ClassCount; i++)
+			{
+				while (FreeLists[i])
+				{
+					auto next = FreeLists[i]->Next;
+					::operator delete(FreeLists[i]);
+					FreeLists[i] = next;
+				}
+			}
+		}
+	};
+
+	thread_local ThreadCache cache;
+
+	int GetSizeClass(size_t size)
+	{
+		if (size > Utils::BufferPool::MaxPooledSize)
+			return -1;
+		auto sizeClass = 0;
+		for (auto classSize = MinClassSize; classSize < size; classSize <<= 1)
+			sizeClass++;
+		return sizeClass;
+	}
+}
+
+namespace Utils::BufferPool
+{
+	void *Allocate(size_t size)
+	{
+		auto sizeClass = GetSizeClass(size);
+		if (sizeClass < 0)
+			return ::operator new(size);
+
+		auto buffer = cache.FreeLists[sizeClass];
+		if (!buffer)
+			return ::operator new(MinClassSize << sizeClass);
+
+		cache.FreeLists[sizeClass] = buffer->Next;
+		cache.Counts[sizeClass]--;
+		return buffer;
+	}
+
+	void Free(void *buffer, size_t size)
+	{
+		if (!buffer)
+			return;
+
+		auto sizeClass = GetSizeClass(size);
+		if (sizeClass < 0 || cache.Counts[sizeClass] >= MaxCachedPerClass)
+		{
+			::operator delete(buffer);
+			return;
+		}
+
+		auto freeBuffer = static_cast<FreeBuffer*>(buffer);
+		freeBuffer->Next = cache.FreeLists[sizeClass];
+		cache.FreeLists[sizeClass] = freeBuffer;
+		cache.Counts[sizeClass]++;
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+
+// Reuses buffers for short-lived allocations (e.g. variable-length packets).
+//
+// Buffers are rounded up to a power-of-two size class and cached per thread, so allocating doesn't
+// take a lock, and an allocate/free pair on the same thread doesn't touch the heap once the cache is warm.
+// Buffers freed on a different thread than they were allocated on go into that thread's cache.
+namespace Utils::BufferPool
+{
+	// Sizes above this aren't pooled.
+	const size_t MaxPooledSize = 64 * 1024;
+
+	void *Allocate(size_t size);
+
+	// The size has to be the same size that was passed to Allocate().
+	void Free(void *buffer, size_t size);
+}
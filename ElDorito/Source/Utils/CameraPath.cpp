@@ -0,0 +1,310 @@
+#include "CameraPath.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "../Blam/Math/MathUtil.hpp"
+#include "../ThirdParty/rapidjson/document.h"
+#include "../ThirdParty/rapidjson/stringbuffer.h"
+#include "../ThirdParty/rapidjson/writer.h"
+
+namespace
+{
+	using Utils::CameraPath::Keyframe;
+
+	// Number of arc length samples taken between each pair of keyframes
+	const size_t SamplesPerSegment = 64;
+
+	// Smallest knot interval, so that keyframes at the same position don't divide by zero
+	const float MinKnotInterval = 1e-3f;
+
+	// A keyframe as a flat list of the values which get interpolated
+	const int ChannelCount = 6;
+	struct Channels
+	{
+		float Values[ChannelCount];
+	};
+
+	Channels ToChannels(const Keyframe &keyframe)
+	{
+		return { { keyframe.Position.X, keyframe.Position.Y, keyframe.Position.Z, keyframe.Yaw, keyframe.Pitch, keyframe.Fov } };
+	}
+
+	Keyframe FromChannels(const Channels &channels)
+	{
+		Keyframe keyframe;
+		keyframe.Position = Blam::Math::RealPoint3D(channels.Values[0], channels.Values[1], channels.Values[2]);
+		keyframe.Yaw = channels.Values[3];
+		keyframe.Pitch = channels.Values[4];
+		keyframe.Fov = channels.Values[5];
+		return keyframe;
+	}
+
+	// Blends between a and b as t goes from t0 to t1
+	Channels Blend(const Channels &a, float t0, const Channels &b, float t1, float t)
+	{
+		auto weight = (t - t0) / (t1 - t0);
+		Channels result;
+		for (auto i = 0; i < ChannelCount; i++)
+			result.Values[i] = a.Values[i] + (b.Values[i] - a.Values[i]) * weight;
+		return result;
+	}
+
+	// Mirrors a across b, used to make up the missing control point at either end of the path
+	Channels Reflect(const Channels &a, const Channels &b)
+	{
+		Channels result;
+		for (auto i = 0; i < ChannelCount; i++)
+			result.Values[i] = 2 * b.Values[i] - a.Values[i];
+		return result;
+	}
+
+	float Distance(const Blam::Math::RealPoint3D &a, const Blam::Math::RealPoint3D &b)
+	{
+		auto delta = b - a;
+		return std::sqrt(delta.X * delta.X + delta.Y * delta.Y + delta.Z * delta.Z);
+	}
+
+	float Distance(const Channels &a, const Channels &b)
+	{
+		return Distance(
+			Blam::Math::RealPoint3D(a.Values[0], a.Values[1], a.Values[2]),
+			Blam::Math::RealPoint3D(b.Values[0], b.Values[1], b.Values[2]));
+	}
+
+	// Centripetal parameterization: knots are spaced by the square root of the distance between points
+	float KnotInterval(const Channels &a, const Channels &b)
+	{
+		return std::max(std::sqrt(Distance(a, b)), MinKnotInterval);
+	}
+
+	// Evaluates the Catmull-Rom segment between p1 and p2 using the Barry-Goldman pyramid
+	Channels CatmullRom(const Channels &p0, const Channels &p1, const Channels &p2, const Channels &p3, float t)
+	{
+		auto t0 = 0.0f;
+		auto t1 = t0 + KnotInterval(p0, p1);
+		auto t2 = t1 + KnotInterval(p1, p2);
+		auto t3 = t2 + KnotInterval(p2, p3);
+		auto u = t1 + (t2 - t1) * t;
+
+		auto a1 = Blend(p0, t0, p1, t1, u);
+		auto a2 = Blend(p1, t1, p2, t2, u);
+		auto a3 = Blend(p2, t2, p3, t3, u);
+		auto b1 = Blend(a1, t0, a2, t2, u);
+		auto b2 = Blend(a2, t1, a3, t3, u);
+		return Blend(b1, t1, b2, t2, u);
+	}
+}
+
+namespace Utils::CameraPath
+{
+	void Path::Add(Keyframe keyframe)
+	{
+		if (!keyframes.empty())
+		{
+			auto previousYaw = keyframes.back().Yaw;
+			keyframe.Yaw = previousYaw + std::remainder(keyframe.Yaw - previousYaw, 2 * Blam::Math::PI);
+		}
+		keyframes.push_back(keyframe);
+
+		// The new keyframe changes the end of the segment before the last one, so it has to be measured again
+		BuildLengthTable(keyframes.size() >= 3 ? keyframes.size() - 3 : 0);
+	}
+
+	void Path::Clear()
+	{
+		keyframes.clear();
+		lengthTable.clear();
+	}
+
+	float Path::GetLength() const
+	{
+		return lengthTable.empty() ? 0 : lengthTable.back();
+	}
+
+	Keyframe Path::Sample(float distance) const
+	{
+		if (lengthTable.size() < 2)
+			return Evaluate(0);
+
+		distance = std::min(std::max(distance, 0.0f), lengthTable.back());
+
+		// Find the samples around the distance and interpolate the parameter between them
+		auto next = std::upper_bound(lengthTable.begin(), lengthTable.end(), distance);
+		auto index = std::min(static_cast<size_t>(std::max(next - lengthTable.begin() - 1, ptrdiff_t(0))), lengthTable.size() - 2);
+		auto span = lengthTable[index + 1] - lengthTable[index];
+		auto fraction = span > 0 ? (distance - lengthTable[index]) / span : 0;
+		return Evaluate((index + fraction) / SamplesPerSegment);
+	}
+
+	Keyframe Path::Evaluate(float parameter) const
+	{
+		if (keyframes.empty())
+			return Keyframe();
+		if (keyframes.size() == 1)
+			return keyframes[0];
+
+		auto lastSegment = keyframes.size() - 2;
+		parameter = std::min(std::max(parameter, 0.0f), static_cast<float>(lastSegment + 1));
+		auto segment = std::min(static_cast<size_t>(parameter), lastSegment);
+
+		auto p1 = ToChannels(keyframes[segment]);
+		auto p2 = ToChannels(keyframes[segment + 1]);
+		auto p0 = segment > 0 ? ToChannels(keyframes[segment - 1]) : Reflect(p2, p1);
+		auto p3 = segment < lastSegment ? ToChannels(keyframes[segment + 2]) : Reflect(p1, p2);
+		return FromChannels(CatmullRom(p0, p1, p2, p3, parameter - segment));
+	}
+
+	void Path::BuildLengthTable(size_t firstSegment)
+	{
+		if (keyframes.size() < 2)
+		{
+			lengthTable.assign(keyframes.size(), 0.0f);
+			return;
+		}
+
+		lengthTable.resize(firstSegment * SamplesPerSegment + 1);
+		lengthTable[0] = 0;
+
+		auto segmentCount = keyframes.size() - 1;
+		auto previous = Evaluate(static_cast<float>(firstSegment)).Position;
+		for (auto i = firstSegment * SamplesPerSegment + 1; i <= segmentCount * SamplesPerSegment; i++)
+		{
+			auto position = Evaluate(static_cast<float>(i) / SamplesPerSegment).Position;
+			lengthTable.push_back(lengthTable.back() + Distance(previous, position));
+			previous = position;
+		}
+	}
+
+	void Player::Start(float speed)
+	{
+		playing = true;
+		this->speed = speed;
+		distance = 0;
+	}
+
+	void Player::Stop()
+	{
+		playing = false;
+	}
+
+	Keyframe Player::Advance(const Path &path, float seconds)
+	{
+		if (playing)
+		{
+			distance += speed * seconds;
+			if (distance >= path.GetLength())
+			{
+				distance = path.GetLength();
+				playing = false;
+			}
+		}
+		return path.Sample(distance);
+	}
+
+	float FrameClock::Tick(float maxSeconds)
+	{
+		auto now = std::chrono::steady_clock::now();
+		if (!running)
+		{
+			running = true;
+			lastTick = now;
+			return 0;
+		}
+
+		auto seconds = std::chrono::duration<float>(now - lastTick).count();
+		lastTick = now;
+		return std::min(seconds, maxSeconds);
+	}
+
+	void FrameClock::Reset()
+	{
+		running = false;
+	}
+
+	std::string Serialize(const Path &path)
+	{
+		rapidjson::StringBuffer buffer;
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+		writer.StartObject();
+		writer.Key("keyframes");
+		writer.StartArray();
+		for (auto &&keyframe : path.GetKeyframes())
+		{
+			writer.StartObject();
+			writer.Key("position");
+			writer.StartArray();
+			writer.Double(keyframe.Position.X);
+			writer.Double(keyframe.Position.Y);
+			writer.Double(keyframe.Position.Z);
+			writer.EndArray();
+			writer.Key("yaw");
+			writer.Double(keyframe.Yaw);
+			writer.Key("pitch");
+			writer.Double(keyframe.Pitch);
+			writer.Key("fov");
+			writer.Double(keyframe.Fov);
+			writer.EndObject();
+		}
+		writer.EndArray();
+		writer.EndObject();
+		return buffer.GetString();
+	}
+
+	bool Deserialize(const std::string &json, Path *result, std::string *error)
+	{
+		rapidjson::Document document;
+		if (document.Parse<0>(json.c_str()).HasParseError() || !document.IsObject())
+		{
+			*error = "Invalid JSON";
+			return false;
+		}
+		if (!document.HasMember("keyframes") || !document["keyframes"].IsArray())
+		{
+			*error = "Missing keyframes";
+			return false;
+		}
+
+		Path path;
+		auto &keyframes = document["keyframes"];
+		for (rapidjson::SizeType i = 0; i < keyframes.Size(); i++)
+		{
+			auto &value = keyframes[i];
+			if (!value.IsObject() ||
+				!value.HasMember("position") || !value["position"].IsArray() || value["position"].Size() != 3 ||
+				!value["position"][0].IsNumber() || !value["position"][1].IsNumber() || !value["position"][2].IsNumber() ||
+				!value.HasMember("yaw") || !value["yaw"].IsNumber() ||
+				!value.HasMember("pitch") || !value["pitch"].IsNumber() ||
+				!value.HasMember("fov") || !value["fov"].IsNumber())
+			{
+				*error = "Keyframe " + std::to_string(i) + " is invalid";
+				return false;
+			}
+
+			auto &position = value["position"];
+			Keyframe keyframe;
+			keyframe.Position = Blam::Math::RealPoint3D(position[0].GetFloat(), position[1].GetFloat(), position[2].GetFloat());
+			keyframe.Yaw = value["yaw"].GetFloat();
+			keyframe.Pitch = value["pitch"].GetFloat();
+			keyframe.Fov = value["fov"].GetFloat();
+			path.Add(keyframe);
+		}
+
+		*result = std::move(path);
+		return true;
+	}
+
+	bool IsValidName(const std::string &name)
+	{
+		if (name.empty() || name.front() == '.')
+			return false; // Also rules out "." and ".."
+
+		// Windows ignores trailing dots and spaces, so "name." would be the same file as "name"
+		if (name.back() == '.' || name.back() == ' ')
+			return false;
+
+		return std::none_of(name.begin(), name.end(), [](char ch)
+		{
+			return static_cast<unsigned char>(ch) < 0x20 || strchr("/\\:*?\"<>|", ch) != nullptr;
+		});
+	}
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+#include "../Blam/Math/RealPoint3D.hpp"
+
+// Camera paths through recorded keyframes, played back at a constant speed.
+//
+// Positions follow a centripetal Catmull-Rom spline, which passes through every keyframe without overshooting or
+// looping between unevenly spaced ones. Look angles and field of view are interpolated along the same curve.
+namespace Utils::CameraPath
+{
+	struct Keyframe
+	{
+		Blam::Math::RealPoint3D Position;
+		float Yaw = 0;   // Horizontal look angle in radians
+		float Pitch = 0; // Vertical look angle in radians
+		float Fov = 0;   // Field of view in radians
+	};
+
+	class Path
+	{
+	public:
+		// Appends a keyframe. Its yaw is unwrapped so that the camera turns the short way from the previous keyframe.
+		void Add(Keyframe keyframe);
+
+		void Clear();
+
+		bool Empty() const { return keyframes.empty(); }
+		const std::vector<Keyframe> &GetKeyframes() const { return keyframes; }
+
+		// Gets the length of the path in world units.
+		// Keyframes at the same position are passed through instantly.
+		float GetLength() const;
+
+		// Gets the camera at a distance along the path, clamped to its ends.
+		Keyframe Sample(float distance) const;
+
+		// Gets the camera at a spline parameter, where keyframe i is at parameter i.
+		Keyframe Evaluate(float parameter) const;
+
+	private:
+		void BuildLengthTable(size_t firstSegment);
+
+		std::vector<Keyframe> keyframes;
+
+		// Arc length at evenly spaced parameters, used to move along the path at a constant speed
+		std::vector<float> lengthTable;
+	};
+
+	// Plays a path at a constant speed.
+	class Player
+	{
+	public:
+		// Starts playing from the beginning of a path. The speed is in world units per second.
+		void Start(float speed);
+
+		void Stop();
+
+		bool IsPlaying() const { return playing; }
+
+		// Moves forward by a time step in seconds and returns the camera. Stops at the end of the path.
+		Keyframe Advance(const Path &path, float seconds);
+
+	private:
+		bool playing = false;
+		float speed = 0;
+		float distance = 0;
+	};
+
+	// Measures the time between frames.
+	class FrameClock
+	{
+	public:
+		// Gets the time in seconds since the last call, limited to maxSeconds so that a hitch doesn't cause a jump.
+		// Returns 0 on the first call after a reset.
+		float Tick(float maxSeconds = 0.1f);
+
+		void Reset();
+
+	private:
+		std::chrono::steady_clock::time_point lastTick;
+		bool running = false;
+	};
+
+	// Converts a path to JSON.
+	std::string Serialize(const Path &path);
+
+	// Reads a path from JSON. Returns false and sets error if it is invalid.
+	bool Deserialize(const std::string &json, Path *result, std::string *error);
+
+	// Checks whether a name can be used for a saved path. Names are file names in the camera path directory, so they
+	// can't contain path separators, drive prefixes or other characters that aren't allowed in file names, and can't
+	// start with a dot.
+	bool IsValidName(const std::string &name);
+}
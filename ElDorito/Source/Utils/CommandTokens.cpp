@@ -0,0 +1,146 @@
+#include "CommandTokens.hpp"
+
+namespace
+{
+	bool IsSeparator(char ch)
+	{
+		return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+	}
+}
+
+namespace Utils
+{
+	CommandTokens::CommandTokens() : count(0), inQuotes(false), inSpace(true)
+	{
+	}
+
+	CommandTokens::CommandTokens(std::string_view line) : CommandTokens()
+	{
+		Append(line);
+	}
+
+	void CommandTokens::Append(std::string_view text)
+	{
+		auto it = text.data();
+		auto end = text.data() + text.length();
+		while (it != end)
+		{
+			if (inQuotes)
+			{
+				// Everything up to the closing quote is part of the argument
+				auto runStart = it;
+				while (it != end && *it != '\"')
+					++it;
+				AppendRun(runStart, it - runStart);
+				if (it == end)
+					break;
+				inQuotes = false;
+				++it;
+				continue;
+			}
+
+			switch (*it)
+			{
+			case '\"':
+				inQuotes = true;
+				if (inSpace)
+					StartToken();
+				inSpace = false;
+				++it;
+				break;
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				inSpace = true;
+				++it;
+				break;
+			default:
+			{
+				if (inSpace)
+					StartToken();
+				inSpace = false;
+
+				auto runStart = it;
+				while (it != end && !IsSeparator(*it) && *it != '\"')
+					++it;
+				AppendRun(runStart, it - runStart);
+				break;
+			}
+			}
+		}
+	}
+
+	std::string_view CommandTokens::operator[](size_t index) const
+	{
+		auto &token = GetToken(index);
+		if (token.Owned)
+			return std::string_view(buffer.data() + token.Offset, token.Length);
+		return token.Data ? std::string_view(token.Data, token.Length) : std::string_view();
+	}
+
+	std::vector<std::string> CommandTokens::ToVector(size_t first) const
+	{
+		std::vector<std::string> result;
+		if (first >= count)
+			return result;
+
+		result.reserve(count - first);
+		for (auto i = first; i < count; i++)
+		{
+			auto token = (*this)[i];
+			result.emplace_back(token.data(), token.length());
+		}
+		return result;
+	}
+
+	void CommandTokens::StartToken()
+	{
+		if (count == InlineCapacity)
+			overflowTokens.assign(inlineTokens, inlineTokens + InlineCapacity);
+		if (count >= InlineCapacity)
+			overflowTokens.push_back({});
+		else
+			inlineTokens[count] = {};
+		count++;
+	}
+
+	void CommandTokens::AppendRun(const char *run, size_t length)
+	{
+		// Characters are only ever added to the last token
+		auto &token = GetToken(count - 1);
+		if (!token.Owned)
+		{
+			if (token.Length == 0)
+			{
+				token.Data = run;
+				token.Length = length;
+				return;
+			}
+			if (length == 0)
+				return;
+			if (token.Data + token.Length == run)
+			{
+				token.Length += length;
+				return;
+			}
+
+			// A quote split the token, it can't be a view anymore
+			token.Offset = buffer.length();
+			buffer.append(token.Data, token.Length);
+			token.Owned = true;
+		}
+		buffer.append(run, length);
+		token.Length += length;
+	}
+
+	CommandTokens::Token &CommandTokens::GetToken(size_t index)
+	{
+		return count > InlineCapacity ? overflowTokens[index] : inlineTokens[index];
+	}
+
+	const CommandTokens::Token &CommandTokens::GetToken(size_t index) const
+	{
+		return count > InlineCapacity ? overflowTokens[index] : inlineTokens[index];
+	}
+}
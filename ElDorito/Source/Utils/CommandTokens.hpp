@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Utils
+{
+	// Splits a command line into arguments.
+	//
+	// Arguments are separated by whitespace, and double quotes group text containing whitespace.
+	// Quotes can appear anywhere in an argument and are removed (a"b c"d is the single argument "ab cd"),
+	// and there are no escape sequences.
+	//
+	// Arguments that are a contiguous part of the input (almost all of them) are views of it, so the input
+	// has to outlive the tokens. Only arguments with quotes in the middle are assembled in an internal buffer.
+	class CommandTokens
+	{
+	public:
+		CommandTokens();
+		explicit CommandTokens(std::string_view line);
+
+		CommandTokens(const CommandTokens&) = delete;
+		CommandTokens& operator=(const CommandTokens&) = delete;
+
+		// Continues tokenizing as if the text was concatenated to the end of the previous input.
+		void Append(std::string_view text);
+
+		size_t Count() const { return count; }
+		bool Empty() const { return count == 0; }
+
+		std::string_view operator[](size_t index) const;
+
+		// Copies the arguments from an index onwards, e.g. to pass them to a command's update function.
+		std::vector<std::string> ToVector(size_t first = 0) const;
+
+	private:
+		struct Token
+		{
+			const char *Data;
+			size_t Offset; // Offset in the buffer if Owned
+			size_t Length;
+			bool Owned;
+		};
+
+		// Most commands have a handful of arguments, more than this spill into a vector
+		static const size_t InlineCapacity = 8;
+
+		void StartToken();
+		void AppendRun(const char *run, size_t length);
+		Token &GetToken(size_t index);
+		const Token &GetToken(size_t index) const;
+
+		Token inlineTokens[InlineCapacity];
+		std::vector<Token> overflowTokens;
+		size_t count;
+		std::string buffer;
+
+		bool inQuotes;
+		bool inSpace;
+	};
+}
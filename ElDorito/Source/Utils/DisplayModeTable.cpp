@@ -0,0 +1,72 @@
+#include "DisplayModeTable.hpp"
+#include <algorithm>
+#include "../ThirdParty/rapidjson/stringbuffer.h"
+#include "../ThirdParty/rapidjson/writer.h"
+
+namespace Utils::DisplayModes
+{
+	std::vector<Resolution> BuildResolutionTable(const std::vector<DisplayMode> &modes)
+	{
+		auto sorted = modes;
+		std::sort(sorted.begin(), sorted.end(), [](const DisplayMode &a, const DisplayMode &b)
+		{
+			if (a.Width != b.Width)
+				return a.Width < b.Width;
+			if (a.Height != b.Height)
+				return a.Height < b.Height;
+			return a.RefreshRate < b.RefreshRate;
+		});
+
+		std::vector<Resolution> table;
+		for (const auto &mode : sorted)
+		{
+			if (table.empty() || table.back().Width != mode.Width || table.back().Height != mode.Height)
+				table.push_back({ mode.Width, mode.Height, {} });
+
+			// Rates of 0 and 1 mean "hardware default" and aren't real rates
+			auto &rates = table.back().RefreshRates;
+			if (mode.RefreshRate > 1 && (rates.empty() || rates.back() != mode.RefreshRate))
+				rates.push_back(mode.RefreshRate);
+		}
+		return table;
+	}
+
+	std::string BuildResolutionsJson(const std::vector<Resolution> &table)
+	{
+		rapidjson::StringBuffer buffer;
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+		writer.StartArray();
+		for (const auto& resolution : table)
+		{
+			auto resolutionStr = std::to_string(resolution.Width) + "x" + std::to_string(resolution.Height);
+			writer.String(resolutionStr.c_str());
+		}
+		writer.EndArray();
+		return buffer.GetString();
+	}
+
+	std::string BuildDisplayModesJson(const std::vector<Resolution> &table)
+	{
+		rapidjson::StringBuffer buffer;
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+		writer.StartArray();
+		for (const auto& resolution : table)
+		{
+			writer.StartObject();
+			writer.Key("width");
+			writer.Uint(resolution.Width);
+			writer.Key("height");
+			writer.Uint(resolution.Height);
+			writer.Key("refreshRates");
+			writer.StartArray();
+			for (auto rate : resolution.RefreshRates)
+				writer.Uint(rate);
+			writer.EndArray();
+			writer.EndObject();
+		}
+		writer.EndArray();
+		return buffer.GetString();
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Turns the display modes reported by the driver into the tables the settings UI shows.
+namespace Utils::DisplayModes
+{
+	// A single mode as reported by the display driver.
+	struct DisplayMode
+	{
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t RefreshRate;
+	};
+
+	// A supported resolution and every refresh rate it can be used at.
+	struct Resolution
+	{
+		uint32_t Width;
+		uint32_t Height;
+		std::vector<uint32_t> RefreshRates; // Ascending, no duplicates
+	};
+
+	// Merges a raw mode list into one entry per resolution, sorted by width and then height.
+	// Drivers list each resolution once per bit depth/scaling mode, so duplicates are expected.
+	std::vector<Resolution> BuildResolutionTable(const std::vector<DisplayMode> &modes);
+
+	// Builds a JSON array of "WIDTHxHEIGHT" strings.
+	std::string BuildResolutionsJson(const std::vector<Resolution> &table);
+
+	// Builds a JSON array of { width, height, refreshRates } objects.
+	std::string BuildDisplayModesJson(const std::vector<Resolution> &table);
+}
@@ -0,0 +1,96 @@
+#include "DisplayModes.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <windows.h>
+
+namespace
+{
+	using namespace Utils::DisplayModes;
+
+	std::mutex cacheMutex;
+	std::condition_variable cacheReady;
+	bool hasCache = false;
+	bool enumerating = false;
+	bool refreshRequested = false; // The display changed while an enumeration was already running
+	std::string resolutionsJson;
+	std::string displayModesJson;
+
+	std::vector<DisplayMode> EnumerateModes()
+	{
+		std::vector<DisplayMode> modes;
+		DEVMODE devmode = { 0 };
+		devmode.dmSize = sizeof(devmode);
+		for (auto i = 0; EnumDisplaySettings(NULL, i, &devmode); i++)
+			modes.push_back({ devmode.dmPelsWidth, devmode.dmPelsHeight, devmode.dmDisplayFrequency });
+		return modes;
+	}
+
+	void EnumerateThread()
+	{
+		while (true)
+		{
+			auto table = BuildResolutionTable(EnumerateModes());
+			auto newResolutionsJson = BuildResolutionsJson(table);
+			auto newDisplayModesJson = BuildDisplayModesJson(table);
+
+			std::lock_guard<std::mutex> lock(cacheMutex);
+			resolutionsJson = std::move(newResolutionsJson);
+			displayModesJson = std::move(newDisplayModesJson);
+			hasCache = true;
+			cacheReady.notify_all();
+
+			// The modes may have changed again while enumerating, so go around once more
+			if (refreshRequested)
+			{
+				refreshRequested = false;
+				continue;
+			}
+			enumerating = false;
+			return;
+		}
+	}
+
+	// cacheMutex must be held
+	void StartEnumerating()
+	{
+		if (enumerating)
+		{
+			refreshRequested = true;
+			return;
+		}
+		enumerating = true;
+		std::thread(EnumerateThread).detach();
+	}
+
+	std::string GetCached(const std::string &json)
+	{
+		std::unique_lock<std::mutex> lock(cacheMutex);
+		if (!hasCache)
+		{
+			if (!enumerating)
+				StartEnumerating();
+			cacheReady.wait(lock, [] { return hasCache; });
+		}
+		return json;
+	}
+}
+
+namespace Utils::DisplayModes
+{
+	void Refresh()
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		StartEnumerating();
+	}
+
+	std::string GetResolutionsJson()
+	{
+		return GetCached(resolutionsJson);
+	}
+
+	std::string GetDisplayModesJson()
+	{
+		return GetCached(displayModesJson);
+	}
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <string>
+#include "DisplayModeTable.hpp"
+
+namespace Utils::DisplayModes
+{
+	// Re-enumerates the display modes on a background thread.
+	// Called at startup and whenever the display configuration changes (WM_DISPLAYCHANGE).
+	void Refresh();
+
+	// Gets the supported resolutions as a JSON array of "WIDTHxHEIGHT" strings.
+	// Only blocks if the modes haven't been enumerated yet.
+	std::string GetResolutionsJson();
+
+	// Gets the supported resolutions as a JSON array of { width, height, refreshRates } objects.
+	std::string GetDisplayModesJson();
+}
@@ -0,0 +1,152 @@
+#include "FilePrefetcher.hpp"
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+	// Large enough for efficient sequential reads, small enough that cancellation is quick
+	const size_t ChunkSize = 256 * 1024;
+
+	double ToSeconds(std::chrono::steady_clock::duration duration)
+	{
+		return std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+	}
+}
+
+namespace Utils
+{
+	FilePrefetcher::FilePrefetcher(std::shared_ptr<PrefetchReader> reader)
+		: reader(std::move(reader)), cancelled(false), running(false), stats()
+	{
+	}
+
+	FilePrefetcher::~FilePrefetcher()
+	{
+		Cancel();
+	}
+
+	void FilePrefetcher::Start(std::vector<PrefetchRequest> requests, uint64_t bytesPerSecond)
+	{
+		Cancel();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stats = {};
+			stats.Running = true;
+		}
+
+		cancelled = false;
+		running = true;
+		worker = std::thread(&FilePrefetcher::Run, this, std::move(requests), bytesPerSecond);
+	}
+
+	void FilePrefetcher::Cancel()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			cancelled = true;
+		}
+		cancelSignal.notify_all();
+
+		if (worker.joinable())
+			worker.join();
+	}
+
+	bool FilePrefetcher::IsRunning() const
+	{
+		return running;
+	}
+
+	PrefetchStats FilePrefetcher::GetStats() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return stats;
+	}
+
+	void FilePrefetcher::Run(std::vector<PrefetchRequest> requests, uint64_t bytesPerSecond)
+	{
+		reader->SetBackgroundPriority(true);
+
+		auto startTime = std::chrono::steady_clock::now();
+		for (auto &&request : requests)
+		{
+			auto success = PrefetchFile(request, bytesPerSecond, startTime);
+			if (cancelled)
+				break;
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (success)
+				stats.FilesCompleted++;
+			else
+				stats.FilesFailed++;
+		}
+
+		reader->SetBackgroundPriority(false);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		stats.ElapsedSeconds = ToSeconds(std::chrono::steady_clock::now() - startTime);
+		stats.Cancelled = cancelled;
+		stats.Running = false;
+		running = false;
+	}
+
+	bool FilePrefetcher::PrefetchFile(const PrefetchRequest &request, uint64_t bytesPerSecond, std::chrono::steady_clock::time_point startTime)
+	{
+		uint64_t fileSize;
+		auto file = reader->Open(request.Path, &fileSize);
+		if (!file)
+			return false;
+
+		auto remaining = fileSize;
+		if (request.MaxBytes > 0)
+			remaining = std::min(remaining, request.MaxBytes);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stats.BytesRequested += remaining;
+		}
+
+		std::unique_ptr<uint8_t[]> buffer(new uint8_t[ChunkSize]);
+		auto success = true;
+		while (remaining > 0 && !cancelled)
+		{
+			auto readStart = std::chrono::steady_clock::now();
+			size_t bytesRead = 0;
+			auto toRead = static_cast<size_t>(std::min<uint64_t>(remaining, ChunkSize));
+			if (!reader->Read(file, buffer.get(), toRead, &bytesRead) || bytesRead == 0)
+			{
+				success = false;
+				break;
+			}
+			auto readTime = std::chrono::steady_clock::now() - readStart;
+			remaining -= bytesRead;
+
+			uint64_t totalPrefetched;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stats.BytesPrefetched += bytesRead;
+				stats.ReadSeconds += ToSeconds(readTime);
+				stats.ElapsedSeconds = ToSeconds(std::chrono::steady_clock::now() - startTime);
+				totalPrefetched = stats.BytesPrefetched;
+			}
+
+			// Sleep until the overall read rate drops back under the limit
+			if (bytesPerSecond > 0)
+			{
+				auto due = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+					std::chrono::duration<double>(static_cast<double>(totalPrefetched) / bytesPerSecond));
+				if (!WaitUntil(due))
+					break;
+			}
+		}
+
+		reader->Close(file);
+		return success && remaining == 0;
+	}
+
+	bool FilePrefetcher::WaitUntil(std::chrono::steady_clock::time_point time)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		return !cancelSignal.wait_until(lock, time, [this] { return cancelled.load(); });
+	}
+}
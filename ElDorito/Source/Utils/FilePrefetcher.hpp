@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+	// A file to read into the OS file cache.
+	struct PrefetchRequest
+	{
+		std::string Path;
+		uint64_t MaxBytes; // 0 = read the whole file
+	};
+
+	struct PrefetchStats
+	{
+		uint64_t BytesRequested;  // Bytes queued for prefetching from the files opened so far
+		uint64_t BytesPrefetched; // Bytes actually read into the file cache
+		uint32_t FilesCompleted;
+		uint32_t FilesFailed;
+		double ElapsedSeconds;    // Wall-clock time spent, including throttling
+		double ReadSeconds;       // Time spent blocked on reads, i.e. the disk time saved at load if the data stays cached
+		bool Running;
+		bool Cancelled;
+	};
+
+	// Opens and reads the files for a FilePrefetcher. All of it is called from the prefetch thread.
+	class PrefetchReader
+	{
+	public:
+		virtual ~PrefetchReader() { }
+
+		// Opens a file for sequential reading and gets its size. Returns nullptr if it can't be opened.
+		virtual void *Open(const std::string &path, uint64_t *size) = 0;
+
+		// Reads the next chunk of a file. Returns false on failure or at the end of the file.
+		virtual bool Read(void *file, uint8_t *buffer, size_t size, size_t *bytesRead) = 0;
+
+		virtual void Close(void *file) = 0;
+
+		// Lowers (or restores) the priority of the calling thread, so the game's own reads get serviced first.
+		virtual void SetBackgroundPriority(bool background) { }
+	};
+
+	// Creates the reader that uses the OS file API, with sequential-scan hints and background I/O priority.
+	std::shared_ptr<PrefetchReader> CreateSystemPrefetchReader();
+
+	// Warms the OS file cache by sequentially reading files on a low-priority background thread.
+	// Reads are throttled to a byte rate so that prefetching doesn't compete with the running game.
+	class FilePrefetcher
+	{
+	public:
+		FilePrefetcher();
+		explicit FilePrefetcher(std::shared_ptr<PrefetchReader> reader);
+		~FilePrefetcher();
+
+		// Starts prefetching a set of files, cancelling any prefetch that is already in progress.
+		// bytesPerSecond limits the read rate (0 = unlimited).
+		void Start(std::vector<PrefetchRequest> requests, uint64_t bytesPerSecond);
+
+		// Stops the current prefetch as soon as the in-flight read completes.
+		void Cancel();
+
+		bool IsRunning() const;
+		PrefetchStats GetStats() const;
+
+	private:
+		void Run(std::vector<PrefetchRequest> requests, uint64_t bytesPerSecond);
+		bool PrefetchFile(const PrefetchRequest &request, uint64_t bytesPerSecond, std::chrono::steady_clock::time_point startTime);
+		bool WaitUntil(std::chrono::steady_clock::time_point time);
+
+		std::shared_ptr<PrefetchReader> reader;
+		std::thread worker;
+		mutable std::mutex mutex;
+		std::condition_variable cancelSignal;
+		std::atomic<bool> cancelled;
+		std::atomic<bool> running;
+		PrefetchStats stats;
+	};
+}
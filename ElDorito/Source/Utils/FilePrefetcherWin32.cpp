@@ -0,0 +1,58 @@
+#include "FilePrefetcher.hpp"
+#include <windows.h>
+
+namespace
+{
+	class Win32PrefetchReader : public Utils::PrefetchReader
+	{
+	public:
+		void *Open(const std::string &path, uint64_t *size) override
+		{
+			auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+				OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				return nullptr;
+
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(file, &fileSize))
+			{
+				CloseHandle(file);
+				return nullptr;
+			}
+			*size = static_cast<uint64_t>(fileSize.QuadPart);
+			return file;
+		}
+
+		bool Read(void *file, uint8_t *buffer, size_t size, size_t *bytesRead) override
+		{
+			DWORD read = 0;
+			if (!ReadFile(file, buffer, static_cast<DWORD>(size), &read, nullptr))
+				return false;
+			*bytesRead = read;
+			return read > 0;
+		}
+
+		void Close(void *file) override
+		{
+			CloseHandle(file);
+		}
+
+		void SetBackgroundPriority(bool background) override
+		{
+			// Background mode lowers both the CPU and the I/O priority of the thread
+			SetThreadPriority(GetCurrentThread(), background ? THREAD_MODE_BACKGROUND_BEGIN : THREAD_MODE_BACKGROUND_END);
+		}
+	};
+}
+
+namespace Utils
+{
+	std::shared_ptr<PrefetchReader> CreateSystemPrefetchReader()
+	{
+		return std::make_shared<Win32PrefetchReader>();
+	}
+
+	FilePrefetcher::FilePrefetcher() : FilePrefetcher(CreateSystemPrefetchReader())
+	{
+	}
+}
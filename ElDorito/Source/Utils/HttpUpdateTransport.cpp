@@ -0,0 +1,185 @@
+#include "HttpUpdateTransport.hpp"
+#include <memory>
+#include <windows.h>
+#include <winhttp.h>
+#include "String.hpp"
+#include "VersionInfo.hpp"
+
+#pragma comment(lib, "winhttp.lib")
+
+namespace
+{
+	struct HandleDeleter
+	{
+		void operator()(HINTERNET handle) const { WinHttpCloseHandle(handle); }
+	};
+	typedef std::unique_ptr<void, HandleDeleter> InternetHandle;
+
+	// Percent-encodes the characters in a manifest path which can't appear in a URL path
+	std::string EncodePath(const std::string &path)
+	{
+		static const char HexDigits[] = "0123456789ABCDEF";
+		std::string result;
+		for (auto c : path)
+		{
+			auto ch = static_cast<unsigned char>(c);
+			if (isalnum(ch) || strchr("/-_.~", ch))
+			{
+				result += c;
+			}
+			else
+			{
+				result += '%';
+				result += HexDigits[ch >> 4];
+				result += HexDigits[ch & 0xF];
+			}
+		}
+		return result;
+	}
+
+	std::string GetErrorString(const char *operation)
+	{
+		return std::string(operation) + " failed (error " + std::to_string(GetLastError()) + ")";
+	}
+
+	// Sends a GET request and streams the response body to a callback.
+	// If rangeStart isn't 0, only the data from that offset is requested, and *partial says whether the server sent it.
+	bool Download(const std::string &url, uint64_t rangeStart, bool *partial, const Utils::UpdateTransport::WriteCallback &write, std::string *error)
+	{
+		auto wideUrl = Utils::String::WidenString(url);
+		URL_COMPONENTSW urlComp = {};
+		urlComp.dwStructSize = sizeof(urlComp);
+		urlComp.dwHostNameLength = static_cast<DWORD>(-1);
+		urlComp.dwUrlPathLength = static_cast<DWORD>(-1);
+		urlComp.dwExtraInfoLength = static_cast<DWORD>(-1);
+		if (!WinHttpCrackUrl(wideUrl.c_str(), static_cast<DWORD>(wideUrl.length()), 0, &urlComp))
+		{
+			*error = "Invalid URL: " + url;
+			return false;
+		}
+		std::wstring hostname(urlComp.lpszHostName, urlComp.dwHostNameLength);
+		std::wstring path(urlComp.lpszUrlPath, urlComp.dwUrlPathLength);
+		if (urlComp.lpszExtraInfo)
+			path.append(urlComp.lpszExtraInfo, urlComp.dwExtraInfoLength);
+		if (path.empty())
+			path = L"/";
+		if (urlComp.nScheme != INTERNET_SCHEME_HTTPS)
+		{
+			*error = "Updates can only be downloaded over HTTPS: " + url;
+			return false;
+		}
+
+		auto userAgent = L"ElDewrito/" + Utils::String::WidenString(Utils::Version::GetVersionString());
+		InternetHandle session(WinHttpOpen(userAgent.c_str(), WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0));
+		if (!session)
+		{
+			*error = GetErrorString("WinHttpOpen");
+			return false;
+		}
+		WinHttpSetTimeouts(session.get(), 10 * 1000, 10 * 1000, 30 * 1000, 30 * 1000);
+		DWORD redirectPolicy = WINHTTP_OPTION_REDIRECT_POLICY_DISALLOW_HTTPS_TO_HTTP;
+		WinHttpSetOption(session.get(), WINHTTP_OPTION_REDIRECT_POLICY, &redirectPolicy, sizeof(redirectPolicy));
+
+		InternetHandle connection(WinHttpConnect(session.get(), hostname.c_str(), urlComp.nPort, 0));
+		if (!connection)
+		{
+			*error = GetErrorString("WinHttpConnect");
+			return false;
+		}
+
+		InternetHandle request(WinHttpOpenRequest(connection.get(), L"GET", path.c_str(), nullptr, WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, WINHTTP_FLAG_SECURE));
+		if (!request)
+		{
+			*error = GetErrorString("WinHttpOpenRequest");
+			return false;
+		}
+
+		std::wstring headers;
+		if (rangeStart)
+			headers = L"Range: bytes=" + std::to_wstring(rangeStart) + L"-\r\n";
+		if (!WinHttpSendRequest(request.get(), headers.empty() ? WINHTTP_NO_ADDITIONAL_HEADERS : headers.c_str(), static_cast<DWORD>(headers.length()), WINHTTP_NO_REQUEST_DATA, 0, 0, 0) ||
+			!WinHttpReceiveResponse(request.get(), nullptr))
+		{
+			*error = GetErrorString("Sending the request");
+			return false;
+		}
+
+		DWORD statusCode = 0;
+		DWORD statusCodeSize = sizeof(statusCode);
+		if (!WinHttpQueryHeaders(request.get(), WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER, WINHTTP_HEADER_NAME_BY_INDEX, &statusCode, &statusCodeSize, WINHTTP_NO_HEADER_INDEX))
+		{
+			*error = GetErrorString("WinHttpQueryHeaders");
+			return false;
+		}
+		if (statusCode != HTTP_STATUS_OK && !(rangeStart && statusCode == HTTP_STATUS_PARTIAL_CONTENT))
+		{
+			*error = "HTTP " + std::to_string(statusCode) + " from " + url;
+			return false;
+		}
+		*partial = statusCode == HTTP_STATUS_PARTIAL_CONTENT;
+
+		uint8_t buffer[64 * 1024];
+		while (true)
+		{
+			DWORD bytesRead = 0;
+			if (!WinHttpReadData(request.get(), buffer, sizeof(buffer), &bytesRead))
+			{
+				*error = GetErrorString("WinHttpReadData");
+				return false;
+			}
+			if (bytesRead == 0)
+				return true;
+			if (!write(buffer, bytesRead))
+			{
+				*error = "The download was aborted";
+				return false;
+			}
+		}
+	}
+}
+
+namespace Utils
+{
+	HttpUpdateTransport::HttpUpdateTransport(const std::string &manifestUrl)
+		: manifestUrl(manifestUrl)
+	{
+		baseUrl = manifestUrl.substr(0, manifestUrl.find_last_of('/') + 1);
+	}
+
+	bool HttpUpdateTransport::IsSecureUrl(const std::string &url)
+	{
+		static const char Scheme[] = "https://";
+		return url.length() > sizeof(Scheme) - 1 && String::ToLower(url.substr(0, sizeof(Scheme) - 1)) == Scheme;
+	}
+
+	bool HttpUpdateTransport::FetchManifest(std::string *manifest, std::string *signature, std::string *error)
+	{
+		manifest->clear();
+		signature->clear();
+		bool partial;
+		auto appendTo = [](std::string *result)
+		{
+			return [result](const uint8_t *data, size_t size)
+			{
+				result->append(reinterpret_cast<const char*>(data), size);
+				return true;
+			};
+		};
+		return Download(manifestUrl, 0, &partial, appendTo(manifest), error) &&
+			Download(manifestUrl + ".sig", 0, &partial, appendTo(signature), error);
+	}
+
+	bool HttpUpdateTransport::FetchFile(const std::string &path, uint64_t *offset, const WriteCallback &write, std::string *error)
+	{
+		auto partial = false;
+		auto started = false;
+		return Download(baseUrl + EncodePath(path), *offset, &partial, [&](const uint8_t *data, size_t size)
+		{
+			// Servers that don't support ranges send the whole file
+			if (!started && !partial)
+				*offset = 0;
+			started = true;
+			return write(data, size);
+		}, error);
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "UpdateEngine.hpp"
+
+namespace Utils
+{
+	// Downloads updates over HTTPS. The manifest's signature is read from <manifest URL>.sig, files are read from the same
+	// directory as the manifest, and partial downloads are resumed with range requests. Anything that isn't HTTPS is
+	// refused, including redirects to it.
+	class HttpUpdateTransport : public UpdateTransport
+	{
+	public:
+		explicit HttpUpdateTransport(const std::string &manifestUrl);
+
+		// Checks whether a URL is one the transport will download from.
+		static bool IsSecureUrl(const std::string &url);
+
+		bool FetchManifest(std::string *manifest, std::string *signature, std::string *error) override;
+		bool FetchFile(const std::string &path, uint64_t *offset, const WriteCallback &write, std::string *error) override;
+
+	private:
+		std::string manifestUrl;
+		std::string baseUrl;
+	};
+}
@@ -0,0 +1,176 @@
+#include "LaunchOptions.hpp"
+#include "Unicode.hpp"
+#include <cwchar>
+
+namespace
+{
+	using Utils::LaunchOptions::Options;
+
+	std::string ToUtf8(const wchar_t *str, size_t length)
+	{
+		// A UTF-16 unit takes at most 3 bytes, but wchar_t is a whole code point (up to 4 bytes) on some platforms
+		std::string result(length * 4, '\0');
+		result.resize(Utils::Unicode::Utf16ToUtf8(str, length, &result[0], result.size() + 1));
+		return result;
+	}
+
+	std::string ToUtf8(const wchar_t *str)
+	{
+		return ToUtf8(str, wcslen(str));
+	}
+
+	bool SetInstance(Options *options, const wchar_t *value)
+	{
+		options->InstanceName = ToUtf8(value);
+		return true;
+	}
+
+	bool SetDedicated(Options *options, const wchar_t *)
+	{
+		options->Dedicated = true;
+		return true;
+	}
+
+	bool SetMapsFolder(Options *options, const wchar_t *value)
+	{
+		options->MapsFolder = ToUtf8(value);
+		if (options->MapsFolder.length() > 0 && options->MapsFolder.back() != '\\' && options->MapsFolder.back() != '/')
+			options->MapsFolder += "\\";
+		return true;
+	}
+
+	bool SetWebDebug(Options *options, const wchar_t *)
+	{
+		options->WebDebug = true;
+		return true;
+	}
+
+	bool SetConnect(Options *options, const wchar_t *value)
+	{
+		options->Connect = true;
+		options->ConnectAddress = ToUtf8(value);
+		return true;
+	}
+
+	bool SetPassword(Options *options, const wchar_t *value)
+	{
+		options->ConnectPassword = ToUtf8(value);
+		return true;
+	}
+
+	bool SetCacheMemoryIncrease(Options *options, const wchar_t *value)
+	{
+		wchar_t *end;
+		auto megabytes = wcstoul(value, &end, 10);
+		if (end == value || *end || megabytes > UINT32_MAX)
+			return false;
+		options->HasCacheMemoryIncrease = true;
+		options->CacheMemoryIncrease = static_cast<uint32_t>(megabytes);
+		return true;
+	}
+
+	bool SetLodIncrease(Options *options, const wchar_t *)
+	{
+		options->LodIncrease = true;
+		return true;
+	}
+
+	struct OptionDefinition
+	{
+		const wchar_t *Name;
+		bool TakesValue;
+		bool(*Apply)(Options *options, const wchar_t *value); // Returns false if the value is invalid, null if ignored
+	};
+
+	const OptionDefinition KnownOptions[] =
+	{
+		{ L"-instance", true, SetInstance },
+		{ L"-dedicated", false, SetDedicated },
+		{ L"-headless", false, SetDedicated },
+		{ L"-maps", true, SetMapsFolder },
+		{ L"-webdebug", false, SetWebDebug },
+		{ L"-connect", true, SetConnect },
+		{ L"-password", true, SetPassword },
+		{ L"-cache-memory-increase", true, SetCacheMemoryIncrease },
+		{ L"-lod-increase", false, SetLodIncrease },
+
+		// Options the game itself reads from the command line
+		{ L"-launcher", false, nullptr },
+		{ L"-dx9ex", false, nullptr },
+		{ L"-window", false, nullptr },
+		{ L"-fullscreen", false, nullptr },
+		{ L"-width", true, nullptr },
+		{ L"-height", true, nullptr },
+		{ L"-adapter", true, nullptr },
+	};
+
+	const OptionDefinition *FindOption(const wchar_t *name)
+	{
+		for (auto &&option : KnownOptions)
+		{
+			if (wcscmp(option.Name, name) == 0)
+				return &option;
+		}
+		return nullptr;
+	}
+}
+
+namespace Utils::LaunchOptions
+{
+	Options Parse(int argc, const wchar_t *const *argv)
+	{
+		Options options;
+		for (auto i = 1; i < argc; i++)
+		{
+			auto arg = argv[i];
+			if (arg[0] == L'+')
+			{
+				// +Module.Variable value
+				if (!arg[1])
+					options.Errors.push_back("Missing variable name after '+'");
+				else if (i + 1 >= argc)
+					options.Errors.push_back("Missing value for " + ToUtf8(arg));
+				else
+					options.Overrides.push_back({ ToUtf8(arg + 1), ToUtf8(argv[++i]) });
+				continue;
+			}
+			if (arg[0] != L'-')
+			{
+				options.Errors.push_back("Unexpected argument \"" + ToUtf8(arg) + "\"");
+				continue;
+			}
+
+			if (auto option = FindOption(arg))
+			{
+				const wchar_t *value = nullptr;
+				if (option->TakesValue)
+				{
+					if (i + 1 >= argc)
+					{
+						options.Errors.push_back("Missing value for " + ToUtf8(arg));
+						continue;
+					}
+					value = argv[++i];
+				}
+				if (option->Apply && !option->Apply(&options, value))
+					options.Errors.push_back("Invalid value \"" + ToUtf8(value) + "\" for " + ToUtf8(arg));
+				continue;
+			}
+
+			// -Module.Variable=value
+			if (auto equals = wcschr(arg, L'='))
+			{
+				if (equals == arg + 1)
+					options.Errors.push_back("Missing variable name in \"" + ToUtf8(arg) + "\"");
+				else if (!equals[1])
+					options.Errors.push_back("Missing value for " + ToUtf8(arg, equals - arg));
+				else
+					options.Overrides.push_back({ ToUtf8(arg + 1, equals - arg - 1), ToUtf8(equals + 1) });
+				continue;
+			}
+
+			options.Errors.push_back("Unknown option " + ToUtf8(arg));
+		}
+		return options;
+	}
+}
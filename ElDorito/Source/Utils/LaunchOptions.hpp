@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Launch arguments, parsed in one pass from a table of known options.
+//
+// Besides the options below, variables can be set with "+Module.Variable value", or the older "-Module.Variable=value".
+// The game's own options (like "-window" or "-width 1280") are accepted and left for the game to read.
+namespace Utils::LaunchOptions
+{
+	// A variable set from the command line.
+	struct VariableOverride
+	{
+		std::string Name;
+		std::string Value;
+	};
+
+	struct Options
+	{
+		std::string InstanceName;       // -instance <name>
+		bool Dedicated = false;         // -dedicated or -headless
+		std::string MapsFolder;         // -maps <folder>, always ends with a slash (empty if not set)
+		bool WebDebug = false;          // -webdebug
+		bool Connect = false;           // -connect <address>
+		std::string ConnectAddress;
+		std::string ConnectPassword;    // -password <password>
+		bool HasCacheMemoryIncrease = false;
+		uint32_t CacheMemoryIncrease = 0; // -cache-memory-increase <megabytes>
+		bool LodIncrease = false;       // -lod-increase
+
+		// Variable overrides, in the order they were given.
+		std::vector<VariableOverride> Overrides;
+
+		// Unknown options and bad or missing values. Parsing carries on past them.
+		std::vector<std::string> Errors;
+	};
+
+	// Parses launch arguments. argv[0] is the program path and is skipped.
+	Options Parse(int argc, const wchar_t *const *argv);
+
+	// Gets the options from the process command line, which is parsed on first use.
+	const Options &Get();
+}
@@ -0,0 +1,22 @@
+#include "LaunchOptions.hpp"
+#include <Windows.h>
+#include <shellapi.h>
+
+namespace Utils::LaunchOptions
+{
+	const Options &Get()
+	{
+		static const Options options = []
+		{
+			auto numArgs = 0;
+			auto argList = CommandLineToArgvW(GetCommandLineW(), &numArgs);
+			if (!argList)
+				return Options();
+
+			auto result = Parse(numArgs, argList);
+			LocalFree(argList);
+			return result;
+		}();
+		return options;
+	}
+}
@@ -0,0 +1,230 @@
+#include "LogFilter.hpp"
+#include <algorithm>
+
+namespace
+{
+	uint8_t ToLower(uint8_t c)
+	{
+		return (c >= 'A' && c <= 'Z') ? static_cast<uint8_t>(c - 'A' + 'a') : c;
+	}
+}
+
+namespace Utils
+{
+	LogFilter::LogFilter() : includeCount(0), stamp(0), includesRemaining(0)
+	{
+	}
+
+	void LogFilter::Compile(const std::vector<std::string> &include, const std::vector<std::string> &exclude)
+	{
+		patterns.clear();
+		emptyPatterns.clear();
+		caseSensitive.Clear();
+		ignoreCase.Clear();
+		includeCount = 0;
+
+		auto addPatterns = [&](const std::vector<std::string> &filters, bool excluded)
+		{
+			for (auto &&filter : filters)
+			{
+				Pattern pattern = {};
+				pattern.IncludeIndex = excluded ? -1 : static_cast<int32_t>(includeCount++);
+
+				auto text = filter;
+				auto folded = text.compare(0, 4, "(?i)") == 0;
+				if (folded)
+					text.erase(0, 4);
+				if (!text.empty() && text.front() == '^')
+				{
+					pattern.AnchorStart = true;
+					text.erase(0, 1);
+				}
+				if (!text.empty() && text.back() == '$')
+				{
+					pattern.AnchorEnd = true;
+					text.pop_back();
+				}
+				pattern.Length = static_cast<uint32_t>(text.length());
+
+				auto index = static_cast<uint32_t>(patterns.size());
+				patterns.push_back(pattern);
+				if (text.empty())
+				{
+					emptyPatterns.push_back(index);
+				}
+				else if (folded)
+				{
+					std::transform(text.begin(), text.end(), text.begin(), [](char c) { return static_cast<char>(ToLower(c)); });
+					ignoreCase.Add(text, index);
+				}
+				else
+				{
+					caseSensitive.Add(text, index);
+				}
+			}
+		};
+		addPatterns(include, false);
+		addPatterns(exclude, true);
+
+		caseSensitive.Compile(false);
+		ignoreCase.Compile(true);
+
+		includeStamps.assign(includeCount, 0);
+		stamp = 0;
+	}
+
+	bool LogFilter::Accepts(const char *message, size_t length)
+	{
+		if (patterns.empty())
+			return true;
+
+		if (++stamp == 0)
+		{
+			std::fill(includeStamps.begin(), includeStamps.end(), 0);
+			stamp = 1;
+		}
+		includesRemaining = includeCount;
+
+		for (auto index : emptyPatterns)
+		{
+			auto &pattern = patterns[index];
+			if (pattern.AnchorStart && pattern.AnchorEnd && length != 0)
+				continue;
+			if (Found(pattern))
+				return false;
+		}
+
+		auto hasExcludes = patterns.size() > includeCount;
+		auto checkCase = !caseSensitive.IsEmpty();
+		auto checkIgnoreCase = !ignoreCase.IsEmpty();
+		uint32_t caseState = 0;
+		uint32_t ignoreCaseState = 0;
+		for (size_t i = 0; i < length; i++)
+		{
+			// Nothing else can change the result once every include has been found
+			if (!hasExcludes && includesRemaining == 0)
+				return true;
+
+			auto c = static_cast<uint8_t>(message[i]);
+			if (checkCase)
+			{
+				caseState = caseSensitive.Next(caseState, c);
+				if (caseSensitive.HasOutput(caseState) && Report(caseSensitive, caseState, i, length))
+					return false;
+			}
+			if (checkIgnoreCase)
+			{
+				ignoreCaseState = ignoreCase.Next(ignoreCaseState, c);
+				if (ignoreCase.HasOutput(ignoreCaseState) && Report(ignoreCase, ignoreCaseState, i, length))
+					return false;
+			}
+		}
+		return includesRemaining == 0;
+	}
+
+	bool LogFilter::Report(const Automaton &automaton, uint32_t state, size_t position, size_t length)
+	{
+		for (auto it = automaton.OutputsBegin(state); it != automaton.OutputsEnd(state); ++it)
+		{
+			auto &pattern = patterns[*it];
+			if (pattern.AnchorStart && position + 1 != pattern.Length)
+				continue;
+			if (pattern.AnchorEnd && position + 1 != length)
+				continue;
+			if (Found(pattern))
+				return true;
+		}
+		return false;
+	}
+
+	bool LogFilter::Found(const Pattern &pattern)
+	{
+		if (pattern.IncludeIndex < 0)
+			return true;
+		auto &includeStamp = includeStamps[pattern.IncludeIndex];
+		if (includeStamp != stamp)
+		{
+			includeStamp = stamp;
+			includesRemaining--;
+		}
+		return false;
+	}
+
+	void LogFilter::Automaton::Clear()
+	{
+		transitions.assign(256, 0);
+		matches.assign(1, {});
+		outputs.clear();
+		outputStarts.clear();
+		patternCount = 0;
+	}
+
+	void LogFilter::Automaton::Add(const std::string &text, uint32_t pattern)
+	{
+		uint32_t state = 0;
+		for (auto c : text)
+		{
+			auto &next = transitions[state * 256 + static_cast<uint8_t>(c)];
+			if (!next)
+			{
+				next = static_cast<uint32_t>(matches.size());
+				matches.emplace_back();
+				transitions.resize(transitions.size() + 256, 0); // Invalidates next
+			}
+			state = transitions[state * 256 + static_cast<uint8_t>(c)];
+		}
+		matches[state].push_back(pattern);
+		patternCount++;
+	}
+
+	void LogFilter::Automaton::Compile(bool ignoreCase)
+	{
+		// Visit the trie breadth-first so that each state's failure state is finished before the state itself. The
+		// missing edges of each state are filled in from its failure state, and its outputs include the failure
+		// state's outputs.
+		auto stateCount = matches.size();
+		std::vector<uint32_t> failures(stateCount, 0);
+		std::vector<uint32_t> queue;
+		queue.reserve(stateCount);
+		queue.push_back(0);
+		for (size_t i = 0; i < queue.size(); i++)
+		{
+			auto state = queue[i];
+			auto failure = failures[state];
+			for (auto c = 0; c < 256; c++)
+			{
+				auto &next = transitions[state * 256 + c];
+				if (next)
+				{
+					failures[next] = state ? transitions[failure * 256 + c] : 0;
+					queue.push_back(next);
+				}
+				else
+				{
+					next = state ? transitions[failure * 256 + c] : 0;
+				}
+			}
+			if (state)
+				matches[state].insert(matches[state].end(), matches[failure].begin(), matches[failure].end());
+		}
+
+		if (ignoreCase)
+		{
+			for (size_t state = 0; state < stateCount; state++)
+			{
+				for (auto c = 'A'; c <= 'Z'; c++)
+					transitions[state * 256 + c] = transitions[state * 256 + ToLower(c)];
+			}
+		}
+
+		outputs.clear();
+		outputStarts.clear();
+		outputStarts.reserve(stateCount + 1);
+		for (auto &&stateMatches : matches)
+		{
+			outputStarts.push_back(static_cast<uint32_t>(outputs.size()));
+			outputs.insert(outputs.end(), stateMatches.begin(), stateMatches.end());
+		}
+		outputStarts.push_back(static_cast<uint32_t>(outputs.size()));
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+	// Decides which log messages get written, based on the Game.LogFilter lists.
+	//
+	// A message is kept if it contains every include pattern and none of the exclude patterns. The patterns are
+	// compiled into Aho-Corasick automatons, so each message is checked in one pass no matter how many there are.
+	//
+	// Patterns are plain substrings, with some optional syntax:
+	//   (?i)text  matches text in any case (ASCII only)
+	//   ^text     only matches text at the start of the message
+	//   text$     only matches text at the end of the message
+	class LogFilter
+	{
+	public:
+		LogFilter();
+
+		// Compiles a set of filters, replacing the ones compiled before.
+		void Compile(const std::vector<std::string> &include, const std::vector<std::string> &exclude);
+
+		// Returns true if there aren't any filters, i.e. every message is accepted.
+		bool IsEmpty() const { return patterns.empty(); }
+
+		// Checks whether a message passes the filters.
+		// This reuses state between calls, so a filter can't be used by more than one thread at a time.
+		bool Accepts(const char *message, size_t length);
+
+	private:
+		struct Pattern
+		{
+			uint32_t Length;
+			int32_t IncludeIndex; // -1 for exclude patterns
+			bool AnchorStart;
+			bool AnchorEnd;
+		};
+
+		// Aho-Corasick automaton with a full transition table, so each input byte is a single lookup
+		class Automaton
+		{
+		public:
+			void Clear();
+			void Add(const std::string &text, uint32_t pattern);
+
+			// Builds the transition table. If ignoreCase is set, uppercase letters move to the same state as
+			// lowercase ones, so patterns must be added in lowercase.
+			void Compile(bool ignoreCase);
+
+			bool IsEmpty() const { return patternCount == 0; }
+			uint32_t Next(uint32_t state, uint8_t c) const { return transitions[state * 256 + c]; }
+			bool HasOutput(uint32_t state) const { return outputStarts[state] != outputStarts[state + 1]; }
+			const uint32_t *OutputsBegin(uint32_t state) const { return outputs.data() + outputStarts[state]; }
+			const uint32_t *OutputsEnd(uint32_t state) const { return outputs.data() + outputStarts[state + 1]; }
+
+		private:
+			std::vector<uint32_t> transitions;            // 256 per state, 0 = no edge while building
+			std::vector<std::vector<uint32_t>> matches;   // Patterns ending at each state, while building
+			std::vector<uint32_t> outputs;                // Patterns ending at each state or any of its suffixes
+			std::vector<uint32_t> outputStarts;           // Start of each state's outputs, plus one past the end
+			size_t patternCount = 0;
+		};
+
+		// Handles the patterns found at a state, and returns true if one of them excludes the message
+		bool Report(const Automaton &automaton, uint32_t state, size_t position, size_t length);
+
+		// Records that a pattern was found, and returns true if it excludes the message
+		bool Found(const Pattern &pattern);
+
+		std::vector<Pattern> patterns;
+		std::vector<uint32_t> emptyPatterns; // Patterns with no text, which are checked without the automatons
+		Automaton caseSensitive;
+		Automaton ignoreCase;
+		uint32_t includeCount;
+
+		// Each include pattern's stamp is set to the current one when it is found, so that nothing has to be cleared
+		// between messages
+		std::vector<uint32_t> includeStamps;
+		uint32_t stamp;
+		uint32_t includesRemaining;
+	};
+}
@@ -137,27 +137,21 @@ namespace Utils
 		if (outfile.fail())
 			return;
 
+		// The filters can be replaced from another thread, so hold a reference to the current ones
+		std::shared_ptr<LogFilter> currentFilter;
+		{
+			std::lock_guard<std::mutex> filterLock(filterMutex);
+			currentFilter = filter;
+		}
+
 		LogEntry entry;
 		while (Entries.pop(entry))
 		{
 			std::string message(entry.Message);
 			delete[] entry.Message;
 
-			for (auto filter : gameModule.FiltersExclude)
-			{
-				// TODO: case-insensitive comparison
-				if (strstr(message.c_str(), filter.c_str()) != nullptr)
-					goto closefile; // string contains an excluded string
-			}
-
-			for (auto filter : gameModule.FiltersInclude)
-			{
-				// TODO: case-insensitive comparison
-				if (strstr(message.c_str(), filter.c_str()) != nullptr)
-					continue;
-
-				goto closefile;  // string doesn't contain an included string
-			}
+			if (currentFilter && !currentFilter->Accepts(message.c_str(), message.length()))
+				continue;
 
 			time_t t = std::chrono::system_clock::to_time_t(entry.Time);
 			tm ourLocalTime;
@@ -170,4 +164,17 @@ namespace Utils
 		closefile:
 		outfile.close();
 	}
+
+	void Logger::SetFilters(const std::vector<std::string> &include, const std::vector<std::string> &exclude)
+	{
+		std::shared_ptr<LogFilter> newFilter;
+		if (!include.empty() || !exclude.empty())
+		{
+			newFilter = std::make_shared<LogFilter>();
+			newFilter->Compile(include, exclude);
+		}
+
+		std::lock_guard<std::mutex> lock(filterMutex);
+		filter = newFilter;
+	}
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include "Singleton.hpp"
+#include "LogFilter.hpp"
+#include <memory>
 #include <string>
 #include <boost/lockfree/queue.hpp>
 #include <mutex>
@@ -43,6 +45,8 @@ namespace Utils
 	class Logger : public Singleton<Logger>
 	{
 		std::mutex flushMutex;
+		std::mutex filterMutex;
+		std::shared_ptr<LogFilter> filter;
 		static DWORD WINAPI Flusher(LPVOID lpParam);
 
 	public:
@@ -54,5 +58,8 @@ namespace Utils
 
 		void Log(LogTypes type, LogLevel level, std::string message, ...);
 		void Flush();
+
+		// Compiles the filters that messages are checked against when they're flushed.
+		void SetFilters(const std::vector<std::string> &include, const std::vector<std::string> &exclude);
 	};
 }
@@ -0,0 +1,128 @@
+#include "ObjectRegistry.hpp"
+
+namespace Utils
+{
+	ObjectRegistry::ObjectRegistry()
+	{
+		Clear();
+	}
+
+	bool ObjectRegistry::Add(uint32_t handle, uint32_t tagIndex, int type)
+	{
+		if (type < 0 || type >= MaxTypes)
+			return false;
+
+		auto index = static_cast<uint16_t>(handle & 0xFFFF);
+		if (index == NullIndex)
+			return false;
+		if (index >= entries.size())
+			entries.resize(index + 1, Entry{ 0, 0, 0, false, NullIndex, NullIndex, NullIndex, NullIndex });
+
+		// The game reuses datum indices, so an entry still here belongs to an object whose deletion was missed
+		if (entries[index].Used)
+			Unlink(index);
+
+		auto &entry = entries[index];
+		entry.Handle = handle;
+		entry.TagIndex = tagIndex;
+		entry.Type = static_cast<int8_t>(type);
+		entry.Used = true;
+
+		auto tagHead = tagHeads.find(tagIndex);
+		entry.PrevByTag = NullIndex;
+		entry.NextByTag = tagHead != tagHeads.end() ? tagHead->second : NullIndex;
+		if (entry.NextByTag != NullIndex)
+			entries[entry.NextByTag].PrevByTag = index;
+		tagHeads[tagIndex] = index;
+
+		entry.PrevByType = NullIndex;
+		entry.NextByType = typeHeads[type];
+		if (entry.NextByType != NullIndex)
+			entries[entry.NextByType].PrevByType = index;
+		typeHeads[type] = index;
+
+		count++;
+		return true;
+	}
+
+	bool ObjectRegistry::Remove(uint32_t handle)
+	{
+		if (!Contains(handle))
+			return false;
+
+		Unlink(static_cast<uint16_t>(handle & 0xFFFF));
+		return true;
+	}
+
+	bool ObjectRegistry::Contains(uint32_t handle) const
+	{
+		auto index = handle & 0xFFFF;
+		return index < entries.size() && entries[index].Used && entries[index].Handle == handle;
+	}
+
+	void ObjectRegistry::Clear()
+	{
+		entries.clear();
+		tagHeads.clear();
+		for (auto &head : typeHeads)
+			head = NullIndex;
+		count = 0;
+	}
+
+	std::vector<uint32_t> ObjectRegistry::GetWithTag(uint32_t tagIndex) const
+	{
+		std::vector<uint32_t> result;
+		auto head = tagHeads.find(tagIndex);
+		if (head == tagHeads.end())
+			return result;
+
+		for (auto i = head->second; i != NullIndex; i = entries[i].NextByTag)
+			result.push_back(entries[i].Handle);
+		return result;
+	}
+
+	std::vector<uint32_t> ObjectRegistry::GetOfType(int type) const
+	{
+		std::vector<uint32_t> result;
+		if (type < 0 || type >= MaxTypes)
+			return result;
+
+		for (auto i = typeHeads[type]; i != NullIndex; i = entries[i].NextByType)
+			result.push_back(entries[i].Handle);
+		return result;
+	}
+
+	uint32_t ObjectRegistry::GetFirstWithTag(uint32_t tagIndex) const
+	{
+		auto head = tagHeads.find(tagIndex);
+		if (head == tagHeads.end())
+			return static_cast<uint32_t>(-1);
+		return entries[head->second].Handle;
+	}
+
+	void ObjectRegistry::Unlink(uint16_t index)
+	{
+		auto &entry = entries[index];
+
+		if (entry.PrevByTag != NullIndex)
+			entries[entry.PrevByTag].NextByTag = entry.NextByTag;
+		else if (entry.NextByTag != NullIndex)
+			tagHeads[entry.TagIndex] = entry.NextByTag;
+		else
+			tagHeads.erase(entry.TagIndex);
+		if (entry.NextByTag != NullIndex)
+			entries[entry.NextByTag].PrevByTag = entry.PrevByTag;
+
+		if (entry.PrevByType != NullIndex)
+			entries[entry.PrevByType].NextByType = entry.NextByType;
+		else
+			typeHeads[entry.Type] = entry.NextByType;
+		if (entry.NextByType != NullIndex)
+			entries[entry.NextByType].PrevByType = entry.PrevByType;
+
+		entry.Used = false;
+		entry.PrevByTag = entry.NextByTag = NullIndex;
+		entry.PrevByType = entry.NextByType = NullIndex;
+		count--;
+	}
+}
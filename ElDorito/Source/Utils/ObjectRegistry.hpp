@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Utils
+{
+	// Index of live objects by tag index and by object type.
+	//
+	// Objects are identified by their datum handle (salt in the high word, index in the low word).
+	// Each object is linked into one list for its tag and one for its type, so adding and removing
+	// objects is O(1) and a lookup only visits the objects that match.
+	// A handle whose salt doesn't match the registered object is stale and is ignored.
+	class ObjectRegistry
+	{
+	public:
+		static const int MaxTypes = 16;
+
+		ObjectRegistry();
+
+		// Registers an object, replacing whatever was registered at the same datum index.
+		// Returns false if the type is out of range.
+		bool Add(uint32_t handle, uint32_t tagIndex, int type);
+
+		// Unregisters an object. Returns false if the handle isn't registered (or is stale).
+		bool Remove(uint32_t handle);
+
+		bool Contains(uint32_t handle) const;
+
+		void Clear();
+
+		// Gets the handles of every registered object with a tag index, newest first.
+		std::vector<uint32_t> GetWithTag(uint32_t tagIndex) const;
+
+		// Gets the handles of every registered object of a type, newest first.
+		std::vector<uint32_t> GetOfType(int type) const;
+
+		// Gets the handle of the most recently added object with a tag index, or -1 if there isn't one.
+		uint32_t GetFirstWithTag(uint32_t tagIndex) const;
+
+		size_t Count() const { return count; }
+
+	private:
+		static const uint16_t NullIndex = 0xFFFF;
+
+		struct Entry
+		{
+			uint32_t Handle;
+			uint32_t TagIndex;
+			int8_t Type;
+			bool Used;
+			uint16_t PrevByTag;
+			uint16_t NextByTag;
+			uint16_t PrevByType;
+			uint16_t NextByType;
+		};
+
+		void Unlink(uint16_t index);
+
+		std::vector<Entry> entries; // Indexed by datum index
+		std::unordered_map<uint32_t, uint16_t> tagHeads;
+		uint16_t typeHeads[MaxTypes];
+		size_t count;
+	};
+}
@@ -0,0 +1,287 @@
+#include "PlayerIdentity.hpp"
+#include <cstring>
+#include <memory>
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+
+namespace
+{
+	// Adds the PEM header and footer to a stripped key, and breaks it into 64 character lines
+	std::string FormatPemKey(const std::string &key, const std::string &keyType)
+	{
+		std::string result = "-----BEGIN " + keyType + "-----\n";
+		for (size_t pos = 0; pos < key.length(); pos += 64)
+			result += key.substr(pos, 64) + "\n";
+		return result + "-----END " + keyType + "-----\n";
+	}
+
+	// Removes the PEM header, footer and newlines from a key
+	std::string StripPemKey(const std::string &key, const std::string &keyType)
+	{
+		auto header = "-----BEGIN " + keyType + "-----";
+		auto footer = "-----END " + keyType + "-----";
+		auto start = key.find(header);
+		auto end = key.find(footer);
+		if (start == std::string::npos || end == std::string::npos || end < start)
+			return "";
+
+		std::string result;
+		for (auto i = start + header.length(); i < end; i++)
+		{
+			if (key[i] != '\n' && key[i] != '\r')
+				result += key[i];
+		}
+		return result;
+	}
+
+	std::string WritePem(EVP_PKEY *key, bool privateKey)
+	{
+		auto bio = BIO_new(BIO_s_mem());
+		if (!bio)
+			return "";
+
+		// Existing configs have the traditional RSA PRIVATE KEY format, which OpenSSL 1.1 no longer writes by default
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+		auto written = privateKey ? PEM_write_bio_PrivateKey_traditional(bio, key, nullptr, nullptr, 0, nullptr, nullptr) : PEM_write_bio_PUBKEY(bio, key);
+#else
+		auto written = privateKey ? PEM_write_bio_PrivateKey(bio, key, nullptr, nullptr, 0, nullptr, nullptr) : PEM_write_bio_PUBKEY(bio, key);
+#endif
+		std::string result;
+		char *data;
+		auto size = BIO_get_mem_data(bio, &data);
+		if (written && size > 0)
+			result.assign(data, size);
+		BIO_free_all(bio);
+		return result;
+	}
+
+	std::string Base64Encode(const unsigned char *data, size_t size)
+	{
+		std::string result(4 * ((size + 2) / 3) + 1, '\0');
+		auto length = EVP_EncodeBlock(reinterpret_cast<unsigned char*>(&result[0]), data, static_cast<int>(size));
+		result.resize(length);
+		return result;
+	}
+}
+
+namespace Utils
+{
+	PlayerIdentity::PlayerIdentity() : privateKey(nullptr), uid(0), stopping(false)
+	{
+	}
+
+	PlayerIdentity::~PlayerIdentity()
+	{
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			stopping = true;
+		}
+		queueSignal.notify_all();
+		if (signThread.joinable())
+			signThread.join();
+
+		// Nothing will sign these now
+		for (auto &&request : signQueue)
+		{
+			if (request.Callback)
+				request.Callback(false, "");
+		}
+
+		Clear();
+	}
+
+	bool PlayerIdentity::SetKeys(const std::string &privKey, const std::string &pubKey)
+	{
+		std::lock_guard<std::mutex> lock(keyMutex);
+		Clear();
+
+		// The UID only depends on the public key
+		if (pubKey.empty())
+			return false;
+		this->pubKey = pubKey;
+		uid = ComputeUid(pubKey);
+
+		if (privKey.empty())
+			return false;
+
+		auto formatted = FormatPemKey(privKey, "RSA PRIVATE KEY");
+		auto bio = BIO_new_mem_buf(formatted.c_str(), static_cast<int>(formatted.length()));
+		if (!bio)
+			return false;
+		auto key = PEM_read_bio_PrivateKey(bio, nullptr, nullptr, nullptr);
+		BIO_free_all(bio);
+		if (!key)
+			return false;
+
+		privateKey = key;
+		formattedPrivKey = std::move(formatted);
+		return true;
+	}
+
+	bool PlayerIdentity::HasUid() const
+	{
+		std::lock_guard<std::mutex> lock(keyMutex);
+		return !pubKey.empty();
+	}
+
+	bool PlayerIdentity::HasPrivateKey() const
+	{
+		std::lock_guard<std::mutex> lock(keyMutex);
+		return privateKey != nullptr;
+	}
+
+	uint64_t PlayerIdentity::GetUid() const
+	{
+		std::lock_guard<std::mutex> lock(keyMutex);
+		return uid;
+	}
+
+	std::string PlayerIdentity::GetPubKey() const
+	{
+		std::lock_guard<std::mutex> lock(keyMutex);
+		return pubKey;
+	}
+
+	std::string PlayerIdentity::GetFormattedPrivKey() const
+	{
+		std::lock_guard<std::mutex> lock(keyMutex);
+		return formattedPrivKey;
+	}
+
+	bool PlayerIdentity::Sign(const void *data, size_t dataSize, std::string &signature) const
+	{
+		std::lock_guard<std::mutex> lock(keyMutex);
+		if (!privateKey)
+			return false;
+
+		auto context = EVP_MD_CTX_create();
+		if (!context)
+			return false;
+
+		std::unique_ptr<unsigned char[]> buffer(new unsigned char[EVP_PKEY_size(privateKey)]);
+		size_t length = EVP_PKEY_size(privateKey);
+		auto success = EVP_DigestSignInit(context, nullptr, EVP_sha256(), nullptr, privateKey) == 1
+			&& EVP_DigestSignUpdate(context, data, dataSize) == 1
+			&& EVP_DigestSignFinal(context, buffer.get(), &length) == 1;
+		EVP_MD_CTX_destroy(context);
+		if (!success)
+			return false;
+
+		signature = Base64Encode(buffer.get(), length);
+		return true;
+	}
+
+	bool PlayerIdentity::PrivateEncrypt(const void *data, size_t dataSize, std::string &encrypted) const
+	{
+		std::lock_guard<std::mutex> lock(keyMutex);
+		if (!privateKey)
+			return false;
+
+		auto context = EVP_PKEY_CTX_new(privateKey, nullptr);
+		if (!context)
+			return false;
+
+		// A raw PKCS #1 signature of the data, without a digest, is the same as RSA_private_encrypt
+		std::unique_ptr<unsigned char[]> buffer(new unsigned char[EVP_PKEY_size(privateKey)]);
+		size_t length = EVP_PKEY_size(privateKey);
+		auto success = EVP_PKEY_sign_init(context) == 1
+			&& EVP_PKEY_CTX_set_rsa_padding(context, RSA_PKCS1_PADDING) == 1
+			&& EVP_PKEY_sign(context, buffer.get(), &length, static_cast<const unsigned char*>(data), dataSize) == 1;
+		EVP_PKEY_CTX_free(context);
+		if (!success)
+			return false;
+
+		encrypted = Base64Encode(buffer.get(), length);
+		return true;
+	}
+
+	void PlayerIdentity::SignAsync(std::vector<uint8_t> data, SignCallback callback)
+	{
+		Queue({ false, std::move(data), std::move(callback) });
+	}
+
+	void PlayerIdentity::PrivateEncryptAsync(std::vector<uint8_t> data, SignCallback callback)
+	{
+		Queue({ true, std::move(data), std::move(callback) });
+	}
+
+	void PlayerIdentity::Queue(SignRequest request)
+	{
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			signQueue.push_back(std::move(request));
+
+			// Only spin up the worker once something actually needs signing
+			if (!signThread.joinable())
+				signThread = std::thread(&PlayerIdentity::SignWorker, this);
+		}
+		queueSignal.notify_one();
+	}
+
+	void PlayerIdentity::SignWorker()
+	{
+		while (true)
+		{
+			SignRequest request;
+			{
+				std::unique_lock<std::mutex> lock(queueMutex);
+				queueSignal.wait(lock, [this] { return stopping || !signQueue.empty(); });
+				if (stopping)
+					return;
+
+				request = std::move(signQueue.front());
+				signQueue.pop_front();
+			}
+
+			std::string result;
+			auto success = request.Encrypt ?
+				PrivateEncrypt(request.Data.data(), request.Data.size(), result) :
+				Sign(request.Data.data(), request.Data.size(), result);
+			if (request.Callback)
+				request.Callback(success, result);
+		}
+	}
+
+	bool PlayerIdentity::Generate(int numBits, std::string &privKey, std::string &pubKey)
+	{
+		EVP_PKEY *key = nullptr;
+		auto context = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+		if (!context)
+			return false;
+		auto success = EVP_PKEY_keygen_init(context) == 1
+			&& EVP_PKEY_CTX_set_rsa_keygen_bits(context, numBits) == 1
+			&& EVP_PKEY_keygen(context, &key) == 1;
+		EVP_PKEY_CTX_free(context);
+		if (!success)
+			return false;
+
+		// strip headers/footers from PEM keys so they can be stored in cfg / transmitted over JSON easier
+		privKey = StripPemKey(WritePem(key, true), "RSA PRIVATE KEY");
+		pubKey = StripPemKey(WritePem(key, false), "PUBLIC KEY");
+		EVP_PKEY_free(key);
+		return !privKey.empty() && !pubKey.empty();
+	}
+
+	uint64_t PlayerIdentity::ComputeUid(const std::string &pubKey)
+	{
+		unsigned char hash[EVP_MAX_MD_SIZE];
+		unsigned int hashSize = 0;
+		EVP_Digest(pubKey.c_str(), pubKey.length(), hash, &hashSize, EVP_sha256(), nullptr);
+
+		uint64_t uid;
+		memcpy(&uid, hash, sizeof(uid)); // use first 8 bytes of SHA256(pubKey) as UID
+		return uid;
+	}
+
+	void PlayerIdentity::Clear()
+	{
+		if (privateKey)
+			EVP_PKEY_free(privateKey);
+		privateKey = nullptr;
+		pubKey.clear();
+		formattedPrivKey.clear();
+		uid = 0;
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef struct evp_pkey_st EVP_PKEY;
+
+namespace Utils
+{
+	// A player's RSA keypair, with the UID, the PEM form of the private key
+	// and the parsed key derived once when the keys are set instead of on every use.
+	//
+	// Keys are stored in the config stripped of their PEM headers and newlines.
+	class PlayerIdentity
+	{
+	public:
+		// Receives the base64 result of a queued private key operation. Runs on the signing thread.
+		typedef std::function<void(bool success, const std::string &result)> SignCallback;
+
+		PlayerIdentity();
+		~PlayerIdentity();
+
+		PlayerIdentity(const PlayerIdentity&) = delete;
+		PlayerIdentity& operator=(const PlayerIdentity&) = delete;
+
+		// Sets the keys (in their stripped form) and derives everything else from them.
+		// Returns false if either key is missing or the private key can't be parsed.
+		bool SetKeys(const std::string &privKey, const std::string &pubKey);
+
+		// True if a public key is set, the UID doesn't need the private key.
+		bool HasUid() const;
+
+		// True if the private key was parsed successfully.
+		bool HasPrivateKey() const;
+
+		uint64_t GetUid() const;
+		std::string GetPubKey() const;
+		std::string GetFormattedPrivKey() const;
+
+		// Creates a base64 SHA-256 RSA signature of the data.
+		bool Sign(const void *data, size_t dataSize, std::string &signature) const;
+
+		// Encrypts the data with the private key and base64-encodes it.
+		bool PrivateEncrypt(const void *data, size_t dataSize, std::string &encrypted) const;
+
+		// Sign() and PrivateEncrypt() on a background thread, in the order they're queued. Requests still queued when
+		// the identity is destroyed fail.
+		void SignAsync(std::vector<uint8_t> data, SignCallback callback);
+		void PrivateEncryptAsync(std::vector<uint8_t> data, SignCallback callback);
+
+		// Generates a new keypair in the stripped format.
+		static bool Generate(int numBits, std::string &privKey, std::string &pubKey);
+
+		// Computes the UID for a public key (the first 8 bytes of its SHA-256).
+		static uint64_t ComputeUid(const std::string &pubKey);
+
+	private:
+		struct SignRequest
+		{
+			bool Encrypt; // PrivateEncrypt() instead of Sign()
+			std::vector<uint8_t> Data;
+			SignCallback Callback;
+		};
+
+		void Clear();
+		void Queue(SignRequest request);
+		void SignWorker();
+
+		mutable std::mutex keyMutex;
+		EVP_PKEY *privateKey;
+		std::string pubKey;
+		std::string formattedPrivKey;
+		uint64_t uid;
+
+		std::mutex queueMutex;
+		std::condition_variable queueSignal;
+		std::deque<SignRequest> signQueue;
+		std::thread signThread;
+		bool stopping;
+	};
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// A constexpr SHA-1, for hashing names into IDs at compile time.
+// Use Utils::Cryptography for anything security-related.
+namespace Utils::Sha1
+{
+	namespace Detail
+	{
+		constexpr uint32_t RotateLeft(uint32_t value, int bits)
+		{
+			return (value << bits) | (value >> (32 - bits));
+		}
+
+		// Gets a byte of the message after padding (0x80, zeros, then the bit length as a big-endian 64-bit integer).
+		constexpr uint8_t GetPaddedByte(const char *data, size_t length, size_t paddedLength, size_t index)
+		{
+			if (index < length)
+				return static_cast<uint8_t>(data[index]);
+			if (index == length)
+				return 0x80;
+			if (index >= paddedLength - 8)
+				return static_cast<uint8_t>((static_cast<uint64_t>(length) * 8) >> ((paddedLength - 1 - index) * 8));
+			return 0;
+		}
+	}
+
+	// Computes the first 4 bytes of the SHA-1 digest of some data, as a big-endian integer.
+	// This matches Utils::Cryptography::Hash32.
+	constexpr uint32_t Hash32(const char *data, size_t length)
+	{
+		uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+		auto paddedLength = (length + 9 + 63) / 64 * 64;
+		for (size_t block = 0; block < paddedLength; block += 64)
+		{
+			uint32_t w[80] = {};
+			for (size_t i = 0; i < 16; i++)
+			{
+				auto offset = block + i * 4;
+				w[i] = static_cast<uint32_t>(Detail::GetPaddedByte(data, length, paddedLength, offset)) << 24
+					| static_cast<uint32_t>(Detail::GetPaddedByte(data, length, paddedLength, offset + 1)) << 16
+					| static_cast<uint32_t>(Detail::GetPaddedByte(data, length, paddedLength, offset + 2)) << 8
+					| static_cast<uint32_t>(Detail::GetPaddedByte(data, length, paddedLength, offset + 3));
+			}
+			for (size_t i = 16; i < 80; i++)
+				w[i] = Detail::RotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+			auto a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+			for (size_t i = 0; i < 80; i++)
+			{
+				uint32_t f = 0, k = 0;
+				if (i < 20)
+				{
+					f = (b & c) | (~b & d);
+					k = 0x5A827999;
+				}
+				else if (i < 40)
+				{
+					f = b ^ c ^ d;
+					k = 0x6ED9EBA1;
+				}
+				else if (i < 60)
+				{
+					f = (b & c) | (b & d) | (c & d);
+					k = 0x8F1BBCDC;
+				}
+				else
+				{
+					f = b ^ c ^ d;
+					k = 0xCA62C1D6;
+				}
+				auto temp = Detail::RotateLeft(a, 5) + f + e + k + w[i];
+				e = d;
+				d = c;
+				c = Detail::RotateLeft(b, 30);
+				b = a;
+				a = temp;
+			}
+			h[0] += a;
+			h[1] += b;
+			h[2] += c;
+			h[3] += d;
+			h[4] += e;
+		}
+		return h[0];
+	}
+
+	template<size_t N>
+	constexpr uint32_t Hash32(const char(&str)[N])
+	{
+		return Hash32(str, N - 1);
+	}
+
+	static_assert(Hash32("abc") == 0xA9993E36, "Utils::Sha1::Hash32 is broken");
+}
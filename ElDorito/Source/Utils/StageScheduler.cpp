@@ -0,0 +1,258 @@
+#include "StageScheduler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace
+{
+	using Utils::StageScheduler;
+
+	bool IsStageFinished(StageScheduler::StageStatus status)
+	{
+		return status == StageScheduler::StageStatus::Done
+			|| status == StageScheduler::StageStatus::Failed
+			|| status == StageScheduler::StageStatus::Skipped;
+	}
+
+	const char *StatusToString(StageScheduler::StageStatus status)
+	{
+		switch (status)
+		{
+		case StageScheduler::StageStatus::Pending:
+			return "pending";
+		case StageScheduler::StageStatus::Running:
+			return "running";
+		case StageScheduler::StageStatus::Done:
+			return "done";
+		case StageScheduler::StageStatus::Failed:
+			return "failed";
+		case StageScheduler::StageStatus::Skipped:
+			return "skipped";
+		}
+		return "";
+	}
+
+	double ToMilliseconds(std::chrono::steady_clock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+}
+
+namespace Utils
+{
+	StageScheduler::~StageScheduler()
+	{
+		// This can run at process exit, after the OS has killed a worker in the middle of a stage, so waiting for every
+		// stage to finish could hang. Instead, stop queueing stages and only wait for the threads themselves: the live
+		// workers return once the stages which were already ready are done, and joining a killed one returns at once.
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		stageReady.notify_all();
+
+		for (auto &&worker : workers)
+			worker.join();
+	}
+
+	void StageScheduler::Add(const std::string &name, StageThread thread, const std::vector<std::string> &dependencies, StageFunction function)
+	{
+		if (FindStage(name) >= 0)
+			throw std::invalid_argument("Duplicate stage \"" + name + "\"");
+
+		auto index = stages.size();
+		for (auto &&dependency : dependencies)
+		{
+			auto dependencyIndex = FindStage(dependency);
+			if (dependencyIndex < 0)
+				throw std::invalid_argument("Stage \"" + name + "\" depends on unknown stage \"" + dependency + "\"");
+			stages[dependencyIndex].Dependents.push_back(index);
+		}
+
+		Stage stage;
+		stage.Name = name;
+		stage.Thread = thread;
+		stage.Function = std::move(function);
+		stage.RemainingDependencies = dependencies.size();
+		stage.DependencyFailed = false;
+		stage.Status = StageStatus::Pending;
+		stage.StartTime = Clock::duration::zero();
+		stage.Duration = Clock::duration::zero();
+		stages.push_back(std::move(stage));
+	}
+
+	void StageScheduler::Run(int workerCount)
+	{
+		startTime = Clock::now();
+
+		auto workerStageCount = 0;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (size_t i = 0; i < stages.size(); i++)
+			{
+				if (stages[i].Thread != StageThread::Worker)
+					continue;
+				workerStageCount++;
+				if (stages[i].RemainingDependencies == 0)
+					readyStages.push_back(i);
+			}
+			unfinishedWorkerStages = workerStageCount;
+		}
+
+		auto threadCount = std::min(std::max(workerCount, 1), workerStageCount);
+		for (auto i = 0; i < threadCount; i++)
+			workers.emplace_back(&StageScheduler::WorkerThread, this);
+
+		for (size_t i = 0; i < stages.size(); i++)
+		{
+			if (stages[i].Thread != StageThread::Caller)
+				continue;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				stageFinished.wait(lock, [&] { return stages[i].RemainingDependencies == 0; });
+			}
+			RunStage(i);
+		}
+	}
+
+	StageScheduler::StageStatus StageScheduler::Wait(const std::string &name)
+	{
+		auto index = FindStage(name);
+		if (index < 0)
+			return StageStatus::Skipped;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		stageFinished.wait(lock, [&] { return IsStageFinished(stages[index].Status); });
+		return stages[index].Status;
+	}
+
+	void StageScheduler::WaitAll()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			stageFinished.wait(lock, [&]
+			{
+				return std::all_of(stages.begin(), stages.end(), [](const Stage &stage) { return IsStageFinished(stage.Status); });
+			});
+		}
+
+		for (auto &&worker : workers)
+			worker.join();
+		workers.clear();
+	}
+
+	bool StageScheduler::IsFinished() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return std::all_of(stages.begin(), stages.end(), [](const Stage &stage) { return IsStageFinished(stage.Status); });
+	}
+
+	std::vector<std::string> StageScheduler::GetReport() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::vector<std::string> report;
+		char line[256];
+		auto end = Clock::duration::zero();
+		for (auto &&stage : stages)
+		{
+			snprintf(line, sizeof(line), "%-24s %-6s start %8.1f ms, took %8.1f ms, %s%s%s",
+				stage.Name.c_str(), stage.Thread == StageThread::Worker ? "worker" : "caller",
+				ToMilliseconds(stage.StartTime), ToMilliseconds(stage.Duration), StatusToString(stage.Status),
+				stage.Error.empty() ? "" : ": ", stage.Error.c_str());
+			report.push_back(line);
+			end = std::max(end, stage.StartTime + stage.Duration);
+		}
+
+		snprintf(line, sizeof(line), "%zu stages finished in %.1f ms", stages.size(), ToMilliseconds(end));
+		report.push_back(line);
+		return report;
+	}
+
+	int StageScheduler::FindStage(const std::string &name) const
+	{
+		for (size_t i = 0; i < stages.size(); i++)
+		{
+			if (stages[i].Name == name)
+				return static_cast<int>(i);
+		}
+		return -1;
+	}
+
+	void StageScheduler::RunStage(size_t index)
+	{
+		auto &stage = stages[index];
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stage.StartTime = Clock::now() - startTime;
+			if (!stage.DependencyFailed)
+				stage.Status = StageStatus::Running;
+		}
+
+		if (stage.DependencyFailed)
+		{
+			FinishStage(index, StageStatus::Skipped, "");
+			return;
+		}
+
+		try
+		{
+			if (stage.Function)
+				stage.Function();
+		}
+		catch (const std::exception &e)
+		{
+			FinishStage(index, StageStatus::Failed, e.what());
+			return;
+		}
+		catch (...)
+		{
+			FinishStage(index, StageStatus::Failed, "unknown exception");
+			return;
+		}
+		FinishStage(index, StageStatus::Done, "");
+	}
+
+	void StageScheduler::FinishStage(size_t index, StageStatus status, const std::string &error)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto &stage = stages[index];
+			stage.Duration = Clock::now() - startTime - stage.StartTime;
+			stage.Status = status;
+			stage.Error = error;
+
+			for (auto dependent : stage.Dependents)
+			{
+				auto &dependentStage = stages[dependent];
+				if (status != StageStatus::Done)
+					dependentStage.DependencyFailed = true;
+				if (--dependentStage.RemainingDependencies == 0 && dependentStage.Thread == StageThread::Worker && !stopping)
+					readyStages.push_back(dependent);
+			}
+
+			if (stage.Thread == StageThread::Worker)
+				unfinishedWorkerStages--;
+		}
+		stageFinished.notify_all();
+		stageReady.notify_all();
+	}
+
+	void StageScheduler::WorkerThread()
+	{
+		while (true)
+		{
+			size_t index;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				stageReady.wait(lock, [this] { return !readyStages.empty() || unfinishedWorkerStages == 0 || stopping; });
+				if (readyStages.empty())
+					return;
+				index = readyStages.front();
+				readyStages.pop_front();
+			}
+			RunStage(index);
+		}
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+	// Runs a set of named stages in dependency order, some on the calling thread and some on a small worker pool.
+	//
+	// Caller stages run in the order they were added, each one waiting for its dependencies first.
+	// Worker stages run as soon as their dependencies are done, so independent work overlaps.
+	// If a stage throws, it's marked as failed and the stages which depend on it are skipped.
+	class StageScheduler
+	{
+	public:
+		enum class StageThread
+		{
+			// The stage runs on the thread that called Run().
+			Caller,
+
+			// The stage runs on a worker thread.
+			Worker,
+		};
+
+		enum class StageStatus
+		{
+			Pending,
+			Running,
+			Done,
+			Failed,
+			Skipped,
+		};
+
+		typedef std::function<void()> StageFunction;
+
+		StageScheduler() = default;
+
+		// Stops the workers once the stages which are ready to run are done. Stages still waiting on a dependency
+		// aren't run.
+		~StageScheduler();
+
+		StageScheduler(const StageScheduler&) = delete;
+		StageScheduler& operator=(const StageScheduler&) = delete;
+
+		// Adds a stage. Dependencies have to be added first, so a dependency cycle can't be declared.
+		// Throws std::invalid_argument if the name is already used or a dependency doesn't exist.
+		void Add(const std::string &name, StageThread thread, const std::vector<std::string> &dependencies, StageFunction function);
+
+		// Starts the worker stages and runs the caller stages. Returns once every caller stage is finished,
+		// worker stages which nothing on the caller thread depends on may still be running.
+		void Run(int workerCount);
+
+		// Waits until a stage is finished and returns its status. Returns Skipped for unknown stages.
+		StageStatus Wait(const std::string &name);
+
+		// Waits until every stage is finished and stops the workers.
+		void WaitAll();
+
+		// Checks whether every stage is finished, without waiting.
+		bool IsFinished() const;
+
+		// Gets a report of when each stage started and how long it took, relative to the call to Run().
+		std::vector<std::string> GetReport() const;
+
+	private:
+		typedef std::chrono::steady_clock Clock;
+
+		struct Stage
+		{
+			std::string Name;
+			StageThread Thread;
+			StageFunction Function;
+			std::vector<size_t> Dependents;
+			size_t RemainingDependencies;
+			bool DependencyFailed;
+			StageStatus Status;
+			std::string Error;
+			Clock::duration StartTime;
+			Clock::duration Duration;
+		};
+
+		int FindStage(const std::string &name) const;
+		void RunStage(size_t index);
+		void FinishStage(size_t index, StageStatus status, const std::string &error);
+		void WorkerThread();
+
+		std::vector<Stage> stages;
+		std::vector<std::thread> workers;
+		std::deque<size_t> readyStages;
+		size_t unfinishedWorkerStages = 0;
+		bool stopping = false;
+		Clock::time_point startTime;
+		Clock::duration totalDuration = Clock::duration::zero();
+
+		mutable std::mutex mutex;
+		std::condition_variable stageFinished;
+		std::condition_variable stageReady;
+	};
+}
@@ -1,4 +1,5 @@
 #include "String.h"
+#include "Unicode.hpp"
 
 // STL
 #include <string>
@@ -7,7 +8,6 @@
 #include <sstream>
 #include <functional>
 #include <cctype>
-#include <codecvt>
 #include <iomanip>
 
 #include <openssl\evp.h>
@@ -215,14 +215,12 @@ namespace Utils::String
 
 	std::wstring WidenString(const std::string &s)
 	{
-		std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>, wchar_t> utf16conv;
-		return utf16conv.from_bytes(s);
+		return Unicode::Utf8ToUtf16(s);
 	}
 
 	std::string ThinString(const std::wstring &str)
 	{
-		std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> utf8conv;
-		return utf8conv.to_bytes(str);
+		return Unicode::Utf16ToUtf8(str);
 	}
 
 	std::string ToLower(const std::string &str)
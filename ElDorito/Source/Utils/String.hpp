@@ -20,6 +20,7 @@ namespace Utils::String
 	void ReplaceCharacters(std::string& str, char replace, char with);
 	bool ReplaceString(std::string &str, const std::string &replace, const std::string &with);
 
+	// Invalid characters are replaced with U+FFFD, see Unicode.hpp for conversions into fixed-size buffers
 	std::wstring WidenString(const std::string &str);
 	std::string ThinString(const std::wstring &str);
 
@@ -0,0 +1,249 @@
+#include "Unicode.hpp"
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define UNICODE_USE_SSE2
+#endif
+
+namespace
+{
+	using Utils::Unicode::ReplacementCharacter;
+
+	// Converts as many leading ASCII characters as possible. Returns the number converted.
+	size_t WidenAscii(const char *str, size_t length, wchar_t *out, size_t outSize)
+	{
+		auto count = length < outSize ? length : outSize;
+		size_t i = 0;
+
+#ifdef UNICODE_USE_SSE2
+		if (sizeof(wchar_t) == sizeof(uint16_t))
+		{
+			auto zero = _mm_setzero_si128();
+			for (; i + 16 <= count; i += 16)
+			{
+				auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+				if (_mm_movemask_epi8(chunk))
+					break; // A byte has its high bit set
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(chunk, zero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(chunk, zero));
+			}
+		}
+#endif
+
+		for (; i + 8 <= count; i += 8)
+		{
+			uint64_t chunk;
+			memcpy(&chunk, str + i, sizeof(chunk));
+			if (chunk & 0x8080808080808080ULL)
+				break;
+			for (auto j = 0; j < 8; j++)
+				out[i + j] = static_cast<wchar_t>(str[i + j]);
+		}
+
+		for (; i < count && !(str[i] & 0x80); i++)
+			out[i] = static_cast<wchar_t>(str[i]);
+		return i;
+	}
+
+	// Converts as many leading ASCII characters as possible. Returns the number converted.
+	size_t ThinAscii(const wchar_t *str, size_t length, char *out, size_t outSize)
+	{
+		auto count = length < outSize ? length : outSize;
+		size_t i = 0;
+
+#ifdef UNICODE_USE_SSE2
+		if (sizeof(wchar_t) == sizeof(uint16_t))
+		{
+			auto nonAsciiMask = _mm_set1_epi16(static_cast<short>(0xFF80));
+			auto zero = _mm_setzero_si128();
+			for (; i + 8 <= count; i += 8)
+			{
+				auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+				auto nonAscii = _mm_cmpeq_epi16(_mm_and_si128(chunk, nonAsciiMask), zero);
+				if (_mm_movemask_epi8(nonAscii) != 0xFFFF)
+					break;
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(chunk, chunk));
+			}
+		}
+#endif
+
+		for (; i < count && static_cast<uint32_t>(str[i]) < 0x80; i++)
+			out[i] = static_cast<char>(str[i]);
+		return i;
+	}
+
+	// Decodes one code point, replacing invalid sequences. Advances pos past what was consumed.
+	uint32_t DecodeUtf8(const unsigned char *str, size_t length, size_t &pos)
+	{
+		auto lead = str[pos++];
+		if (lead < 0x80)
+			return lead;
+
+		size_t extra;
+		uint32_t codePoint, min;
+		if (lead >= 0xC2 && lead <= 0xDF)
+		{
+			extra = 1;
+			codePoint = lead & 0x1F;
+			min = 0x80;
+		}
+		else if (lead >= 0xE0 && lead <= 0xEF)
+		{
+			extra = 2;
+			codePoint = lead & 0x0F;
+			min = 0x800;
+		}
+		else if (lead >= 0xF0 && lead <= 0xF4)
+		{
+			extra = 3;
+			codePoint = lead & 0x07;
+			min = 0x10000;
+		}
+		else
+		{
+			return ReplacementCharacter; // Continuation byte, overlong 2-byte lead or out of range
+		}
+
+		for (size_t i = 0; i < extra; i++)
+		{
+			if (pos >= length || (str[pos] & 0xC0) != 0x80)
+				return ReplacementCharacter; // Truncated, resume at the byte that broke the sequence
+			codePoint = (codePoint << 6) | (str[pos++] & 0x3F);
+		}
+
+		if (codePoint < min || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+			return ReplacementCharacter; // Overlong, out of range or an encoded surrogate
+		return codePoint;
+	}
+
+	size_t EncodeUtf8(uint32_t codePoint, char *out)
+	{
+		if (codePoint < 0x80)
+		{
+			out[0] = static_cast<char>(codePoint);
+			return 1;
+		}
+		if (codePoint < 0x800)
+		{
+			out[0] = static_cast<char>(0xC0 | (codePoint >> 6));
+			out[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+			return 2;
+		}
+		if (codePoint < 0x10000)
+		{
+			out[0] = static_cast<char>(0xE0 | (codePoint >> 12));
+			out[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			out[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+			return 3;
+		}
+		out[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+		out[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+		out[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+		out[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+		return 4;
+	}
+}
+
+namespace Utils::Unicode
+{
+	size_t Utf8ToUtf16(const char *str, size_t length, wchar_t *out, size_t outSize)
+	{
+		if (outSize == 0)
+			return 0;
+
+		auto bytes = reinterpret_cast<const unsigned char*>(str);
+		auto maxUnits = outSize - 1;
+		size_t pos = 0, written = 0;
+		while (pos < length)
+		{
+			auto ascii = WidenAscii(str + pos, length - pos, out + written, maxUnits - written);
+			pos += ascii;
+			written += ascii;
+			if (pos >= length || written >= maxUnits)
+				break;
+
+			auto codePoint = DecodeUtf8(bytes, length, pos);
+			if (codePoint < 0x10000 || sizeof(wchar_t) > sizeof(uint16_t))
+			{
+				out[written++] = static_cast<wchar_t>(codePoint);
+				continue;
+			}
+
+			// Needs a surrogate pair, don't split it if there's only room for half
+			if (written + 2 > maxUnits)
+				break;
+			codePoint -= 0x10000;
+			out[written++] = static_cast<wchar_t>(0xD800 | (codePoint >> 10));
+			out[written++] = static_cast<wchar_t>(0xDC00 | (codePoint & 0x3FF));
+		}
+
+		out[written] = 0;
+		return written;
+	}
+
+	size_t Utf16ToUtf8(const wchar_t *str, size_t length, char *out, size_t outSize)
+	{
+		if (outSize == 0)
+			return 0;
+
+		auto maxBytes = outSize - 1;
+		size_t pos = 0, written = 0;
+		while (pos < length)
+		{
+			auto ascii = ThinAscii(str + pos, length - pos, out + written, maxBytes - written);
+			pos += ascii;
+			written += ascii;
+			if (pos >= length || written >= maxBytes)
+				break;
+
+			auto unit = static_cast<uint32_t>(str[pos]);
+			auto codePoint = unit;
+			auto consumed = 1;
+			if (unit >= 0xD800 && unit <= 0xDBFF)
+			{
+				auto next = pos + 1 < length ? static_cast<uint32_t>(str[pos + 1]) : 0;
+				if (next >= 0xDC00 && next <= 0xDFFF)
+				{
+					codePoint = 0x10000 + ((unit - 0xD800) << 10) + (next - 0xDC00);
+					consumed = 2;
+				}
+				else
+				{
+					codePoint = ReplacementCharacter;
+				}
+			}
+			else if ((unit >= 0xDC00 && unit <= 0xDFFF) || unit > 0x10FFFF)
+			{
+				codePoint = ReplacementCharacter;
+			}
+
+			char encoded[4];
+			auto encodedLength = EncodeUtf8(codePoint, encoded);
+			if (written + encodedLength > maxBytes)
+				break;
+			memcpy(out + written, encoded, encodedLength);
+			written += encodedLength;
+			pos += consumed;
+		}
+
+		out[written] = 0;
+		return written;
+	}
+
+	std::wstring Utf8ToUtf16(const std::string &str)
+	{
+		// Each byte becomes at most one unit
+		std::wstring result(str.length() + 1, L'\0');
+		result.resize(Utf8ToUtf16(str.c_str(), str.length(), &result[0], result.length()));
+		return result;
+	}
+
+	std::string Utf16ToUtf8(const std::wstring &str)
+	{
+		// Each unit becomes at most 3 bytes, or 4 where a wide character holds a whole code point
+		std::string result(str.length() * (sizeof(wchar_t) == sizeof(uint16_t) ? 3 : 4) + 1, '\0');
+		result.resize(Utf16ToUtf8(str.c_str(), str.length(), &result[0], result.length()));
+		return result;
+	}
+}
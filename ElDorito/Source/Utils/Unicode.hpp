@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cwchar>
+#include <string>
+
+// UTF-8 <-> UTF-16 conversion.
+//
+// Wide strings are treated as UTF-16, which is what the game uses for player names and other text.
+// Invalid input (bad UTF-8 sequences, unpaired surrogates) is replaced with U+FFFD instead of failing,
+// and output that doesn't fit is truncated on a code point boundary. Runs of ASCII are converted in bulk.
+namespace Utils::Unicode
+{
+	const uint32_t ReplacementCharacter = 0xFFFD;
+
+	// Converts UTF-8 to UTF-16 into a buffer of outSize units, which always gets null-terminated (if outSize > 0).
+	// Returns the number of units written, not counting the terminator.
+	size_t Utf8ToUtf16(const char *str, size_t length, wchar_t *out, size_t outSize);
+
+	// Converts UTF-16 to UTF-8 into a buffer of outSize bytes, which always gets null-terminated (if outSize > 0).
+	// Returns the number of bytes written, not counting the terminator.
+	size_t Utf16ToUtf8(const wchar_t *str, size_t length, char *out, size_t outSize);
+
+	std::wstring Utf8ToUtf16(const std::string &str);
+	std::string Utf16ToUtf8(const std::wstring &str);
+
+	// Buffer size that's always large enough to hold a fixed-size UTF-16 string of N units as UTF-8.
+	// A unit takes at most 3 bytes (a surrogate pair takes 4 bytes for 2 units), or 4 where wchar_t is a whole code point.
+	template<size_t N>
+	struct Utf8Size
+	{
+		static const size_t Value = N * (sizeof(wchar_t) == sizeof(uint16_t) ? 3 : 4) + 1;
+	};
+
+	// Converts a fixed-size, possibly unterminated game string (e.g. a 16 character player name) without allocating.
+	template<size_t N, size_t OutSize>
+	size_t Utf16ToUtf8(const wchar_t(&str)[N], char(&out)[OutSize])
+	{
+		return Utf16ToUtf8(str, wcsnlen(str, N), out, OutSize);
+	}
+
+	// Converts into a fixed-size game string, truncating it to N - 1 units if necessary.
+	template<size_t N>
+	size_t Utf8ToUtf16(const std::string &str, wchar_t(&out)[N])
+	{
+		return Utf8ToUtf16(str.c_str(), str.length(), out, N);
+	}
+}
@@ -0,0 +1,664 @@
+#include "UpdateEngine.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <boost/filesystem.hpp>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/sha.h>
+#include "../ThirdParty/rapidjson/document.h"
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+	// An entry in the list of staged files
+	struct StagedFile
+	{
+		std::string Path;
+		uint64_t Size;
+		std::string Sha256;
+	};
+
+	const char UpdateDirName[] = "update";
+
+	fs::path GetUpdateDir(const fs::path &root) { return root / UpdateDirName; }
+	fs::path GetStagingDir(const fs::path &root) { return GetUpdateDir(root) / "staging"; }
+	fs::path GetBackupDir(const fs::path &root) { return GetUpdateDir(root) / "backup"; }
+	fs::path GetHashCachePath(const fs::path &root) { return GetUpdateDir(root) / "hashes.txt"; }
+	fs::path GetPendingPath(const fs::path &root) { return GetUpdateDir(root) / "pending.txt"; }
+	fs::path GetJournalPath(const fs::path &root) { return GetUpdateDir(root) / "installing.txt"; }
+
+	bool IsSafePath(const std::string &path);
+	char ToLower(char ch);
+	bool HashFile(const fs::path &path, std::string *hash);
+	bool WriteStagedList(const fs::path &path, const std::vector<StagedFile> &files);
+	bool ReadStagedList(const fs::path &path, std::vector<StagedFile> *files);
+	void RollBack(const fs::path &root, const std::vector<StagedFile> &files, size_t count);
+}
+
+namespace Utils
+{
+	const char UpdatePublicKey[] =
+		"-----BEGIN PUBLIC KEY-----\n"
+		"MIIBojANBgkqhkiG9w0BAQEFAAOCAY8AMIIBigKCAYEAuSFrJj1xt/h7WkFBILxQ\n"
+		"o/I/HJLyBYwquk4pAdHDMM8+PDNLjJ+qVRGay4KIDqPX8EvOYVfnMQRLIar5DwW4\n"
+		"YtTWQAeQeSCqwFksKqthZ7xUkhl57bXC6cJW3J3pVQGWJsn/TaEkF44hUieJmQLs\n"
+		"85nQevsCrHrPhehL28CiohqYCT0SxWHHPwG1mOY3A+ELvfihArBuFGpdGtE7ZrA/\n"
+		"oLKAv5ZB34v+FFoA8vuX/Cn4HL2fpbXKNvYOhr77xa9PtuByR3fwF0xFpt7kRam6\n"
+		"chmvkSfUCtnJiNCrPjZWGkgQ5PkYPWvJ5Dz5uQckGbcQFeDyF0HhaXNvLt+P2Ik5\n"
+		"HKbvTnVyuAmQlto3TOJ57+4aZ+9Ep44FkJSMWpmF6tN4l1hMky18CJNugg95Bmd8\n"
+		"Z+XgZP/FvHd5E5zfRdwM4Ym3ykRoLj2dWbElTK8QRJxmt12fpn43fzbJPQK5n28n\n"
+		"/f6AhfDm+4CscgaAcYSb4nQdmKtGmv3+EPiwNlDrbB4fAgMBAAE=\n"
+		"-----END PUBLIC KEY-----\n";
+
+	bool ParseUpdateManifest(const std::string &json, std::string *version, std::vector<UpdateFile> *files, std::string *error)
+	{
+		rapidjson::Document document;
+		if (document.Parse<0>(json.c_str()).HasParseError() || !document.IsObject())
+		{
+			*error = "The manifest is not valid JSON";
+			return false;
+		}
+
+		version->clear();
+		if (document.HasMember("version") && document["version"].IsString())
+			*version = document["version"].GetString();
+
+		if (!document.HasMember("files") || !document["files"].IsArray())
+		{
+			*error = "The manifest has no file list";
+			return false;
+		}
+
+		files->clear();
+		for (auto it = document["files"].Begin(); it != document["files"].End(); ++it)
+		{
+			if (!it->IsObject() || !it->HasMember("path") || !(*it)["path"].IsString() ||
+				!it->HasMember("size") || !(*it)["size"].IsUint64() ||
+				!it->HasMember("sha256") || !(*it)["sha256"].IsString())
+			{
+				*error = "The manifest has an invalid file entry";
+				return false;
+			}
+
+			UpdateFile file;
+			file.Path = (*it)["path"].GetString();
+			file.Size = (*it)["size"].GetUint64();
+			file.Sha256 = (*it)["sha256"].GetString();
+			std::transform(file.Sha256.begin(), file.Sha256.end(), file.Sha256.begin(), ToLower);
+
+			if (!IsSafePath(file.Path))
+			{
+				*error = "The manifest has an invalid path: " + file.Path;
+				return false;
+			}
+			if (file.Sha256.length() != SHA256_DIGEST_LENGTH * 2 || file.Sha256.find_first_not_of("0123456789abcdef") != std::string::npos)
+			{
+				*error = "The manifest has an invalid hash for " + file.Path;
+				return false;
+			}
+			files->push_back(file);
+		}
+		return true;
+	}
+
+	bool VerifyUpdateManifest(const std::string &manifest, const std::string &signature, const std::string &publicKey)
+	{
+		auto bio = BIO_new_mem_buf(publicKey.c_str(), static_cast<int>(publicKey.length()));
+		if (!bio)
+			return false;
+		auto key = PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr);
+		BIO_free_all(bio);
+		if (!key)
+			return false;
+
+		auto context = EVP_MD_CTX_create();
+		auto success = context
+			&& EVP_DigestVerifyInit(context, nullptr, EVP_sha256(), nullptr, key) == 1
+			&& EVP_DigestVerifyUpdate(context, manifest.data(), manifest.size()) == 1
+			&& EVP_DigestVerifyFinal(context, reinterpret_cast<const unsigned char*>(signature.data()), signature.size()) == 1;
+		if (context)
+			EVP_MD_CTX_destroy(context);
+		EVP_PKEY_free(key);
+		return success;
+	}
+
+	UpdateEngine::UpdateEngine(const std::string &installDir, const std::string &publicKey)
+		: installDir(installDir), publicKey(publicKey), hashCacheChanged(false), cancelled(false), running(false), progress()
+	{
+	}
+
+	UpdateEngine::~UpdateEngine()
+	{
+		Cancel();
+	}
+
+	void UpdateEngine::Start(std::shared_ptr<UpdateTransport> transport)
+	{
+		if (running)
+			return;
+		if (worker.joinable())
+			worker.join();
+
+		cancelled = false;
+		running = true;
+		worker = std::thread([this, transport]
+		{
+			Run(*transport);
+		});
+	}
+
+	bool UpdateEngine::Run(UpdateTransport &transport)
+	{
+		running = true;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			progress = {};
+		}
+
+		fs::path root(installDir);
+		std::vector<UpdateFile> changedFiles;
+		auto success = Check(transport, &changedFiles);
+		if (success)
+		{
+			// Anything staged by an earlier check is either re-verified below or out of date
+			boost::system::error_code ec;
+			fs::remove(GetPendingPath(root), ec);
+
+			if (changedFiles.empty())
+			{
+				fs::remove_all(GetStagingDir(root), ec);
+				SetState(UpdateState::UpToDate);
+			}
+			else
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					progress.FilesToDownload = static_cast<uint32_t>(changedFiles.size());
+					for (auto &&file : changedFiles)
+						progress.BytesToDownload += file.Size;
+				}
+				SetState(UpdateState::Downloading);
+
+				for (auto &&file : changedFiles)
+				{
+					success = Download(transport, file);
+					if (!success)
+						break;
+				}
+
+				if (success)
+				{
+					std::vector<StagedFile> staged;
+					for (auto &&file : changedFiles)
+						staged.push_back({ file.Path, file.Size, file.Sha256 });
+					success = WriteStagedList(GetPendingPath(root), staged);
+					if (success)
+						SetState(UpdateState::Staged);
+					else
+						Fail("Failed to write the list of staged files");
+				}
+			}
+		}
+
+		if (!success && cancelled)
+			SetState(UpdateState::Cancelled);
+		running = false;
+		return success;
+	}
+
+	void UpdateEngine::Cancel()
+	{
+		cancelled = true;
+		if (worker.joinable())
+			worker.join();
+	}
+
+	bool UpdateEngine::IsRunning() const
+	{
+		return running;
+	}
+
+	UpdateProgress UpdateEngine::GetProgress() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return progress;
+	}
+
+	bool UpdateEngine::Check(UpdateTransport &transport, std::vector<UpdateFile> *changedFiles)
+	{
+		SetState(UpdateState::Checking);
+
+		std::string manifest, signature, version, error;
+		std::vector<UpdateFile> files;
+		if (!transport.FetchManifest(&manifest, &signature, &error))
+			return Fail("Failed to download the update manifest: " + error);
+
+		// Everything else trusts the manifest's hashes, so it mustn't even be parsed unless it's genuine
+		if (!VerifyUpdateManifest(manifest, signature, publicKey))
+			return Fail("The update manifest's signature is invalid");
+		if (!ParseUpdateManifest(manifest, &version, &files, &error))
+			return Fail(error);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			progress.Version = version;
+		}
+
+		LoadHashCache();
+		for (auto &&file : files)
+		{
+			if (cancelled)
+				return false;
+
+			std::string hash;
+			if (!GetLocalHash(file.Path, &hash) || hash != file.Sha256)
+				changedFiles->push_back(file);
+		}
+		SaveHashCache();
+		return true;
+	}
+
+	bool UpdateEngine::Download(UpdateTransport &transport, const UpdateFile &file)
+	{
+		fs::path root(installDir);
+		auto stagedPath = GetStagingDir(root) / file.Path;
+		auto partPath = stagedPath;
+		partPath += ".part";
+
+		boost::system::error_code ec;
+		fs::create_directories(stagedPath.parent_path(), ec);
+
+		uint64_t bytesBefore;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			bytesBefore = progress.BytesDownloaded;
+		}
+		auto setFileProgress = [&](uint64_t bytes)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			progress.BytesDownloaded = bytesBefore + bytes;
+		};
+
+		// An earlier run may have staged the file already
+		std::string hash, error;
+		if (fs::exists(stagedPath, ec))
+		{
+			if (fs::file_size(stagedPath, ec) == file.Size && HashFile(stagedPath, &hash) && hash == file.Sha256)
+			{
+				setFileProgress(file.Size);
+				std::lock_guard<std::mutex> lock(mutex);
+				progress.FilesDownloaded++;
+				return true;
+			}
+			fs::remove(stagedPath, ec);
+		}
+
+		// If a resumed download turns out to be corrupt, try once more from the beginning
+		for (auto attempt = 0; attempt < 2; attempt++)
+		{
+			uint64_t offset = fs::exists(partPath, ec) ? fs::file_size(partPath, ec) : 0;
+			if (ec || offset > file.Size)
+			{
+				fs::remove(partPath, ec);
+				offset = 0;
+			}
+			setFileProgress(offset);
+
+			if (offset < file.Size)
+			{
+				std::ofstream out(partPath.string(), std::ios::binary | (offset ? std::ios::app : std::ios::trunc));
+				if (!out)
+					return Fail("Failed to create " + partPath.string());
+
+				auto requestedOffset = offset;
+				auto startOffset = offset;
+				auto started = false;
+				auto tooLarge = false;
+				auto ok = transport.FetchFile(file.Path, &startOffset, [&](const uint8_t *data, size_t size)
+				{
+					if (cancelled)
+						return false;
+					if (!started)
+					{
+						started = true;
+						if (startOffset != requestedOffset)
+						{
+							// The source couldn't resume, so start over
+							out.close();
+							out.open(partPath.string(), std::ios::binary | std::ios::trunc);
+							offset = 0;
+						}
+					}
+					if (offset + size > file.Size)
+					{
+						tooLarge = true;
+						return false;
+					}
+					out.write(reinterpret_cast<const char*>(data), size);
+					offset += size;
+					setFileProgress(offset);
+					return static_cast<bool>(out);
+				}, &error);
+				out.close();
+
+				if (cancelled)
+					return false;
+				if (tooLarge)
+				{
+					fs::remove(partPath, ec);
+					return Fail(file.Path + " is larger than the manifest says");
+				}
+				if (!ok)
+					return Fail("Failed to download " + file.Path + ": " + error);
+			}
+
+			if (fs::file_size(partPath, ec) == file.Size && HashFile(partPath, &hash) && hash == file.Sha256)
+			{
+				fs::rename(partPath, stagedPath, ec);
+				if (ec)
+					return Fail("Failed to stage " + file.Path);
+
+				std::lock_guard<std::mutex> lock(mutex);
+				progress.FilesDownloaded++;
+				return true;
+			}
+			fs::remove(partPath, ec);
+		}
+		return Fail(file.Path + " failed verification");
+	}
+
+	bool UpdateEngine::GetLocalHash(const std::string &path, std::string *hash)
+	{
+		auto fullPath = fs::path(installDir) / path;
+		boost::system::error_code ec;
+		auto size = fs::file_size(fullPath, ec);
+		if (ec)
+			return false;
+		auto modifiedTime = static_cast<int64_t>(fs::last_write_time(fullPath, ec));
+		if (ec)
+			return false;
+
+		auto it = std::lower_bound(hashCache.begin(), hashCache.end(), path, [](const std::pair<std::string, CachedHash> &entry, const std::string &path)
+		{
+			return entry.first < path;
+		});
+		if (it != hashCache.end() && it->first == path && it->second.Size == size && it->second.ModifiedTime == modifiedTime)
+		{
+			*hash = it->second.Sha256;
+			return true;
+		}
+
+		if (!HashFile(fullPath, hash))
+			return false;
+		CachedHash cached = { size, modifiedTime, *hash };
+		if (it != hashCache.end() && it->first == path)
+			it->second = cached;
+		else
+			hashCache.insert(it, { path, cached });
+		hashCacheChanged = true;
+		return true;
+	}
+
+	void UpdateEngine::LoadHashCache()
+	{
+		// Each line is "<sha256> <size> <modified time> <path>"
+		hashCache.clear();
+		hashCacheChanged = false;
+
+		std::ifstream in(GetHashCachePath(fs::path(installDir)).string());
+		std::string line;
+		while (std::getline(in, line))
+		{
+			std::istringstream stream(line);
+			CachedHash cached;
+			std::string path;
+			if (!(stream >> cached.Sha256 >> cached.Size >> cached.ModifiedTime) || stream.get() != ' ' || !std::getline(stream, path))
+				continue;
+			hashCache.emplace_back(path, cached);
+		}
+		std::sort(hashCache.begin(), hashCache.end(), [](const std::pair<std::string, CachedHash> &a, const std::pair<std::string, CachedHash> &b)
+		{
+			return a.first < b.first;
+		});
+	}
+
+	void UpdateEngine::SaveHashCache()
+	{
+		if (!hashCacheChanged)
+			return;
+
+		fs::path root(installDir);
+		boost::system::error_code ec;
+		fs::create_directories(GetUpdateDir(root), ec);
+
+		auto tempPath = GetHashCachePath(root);
+		tempPath += ".tmp";
+		{
+			std::ofstream out(tempPath.string(), std::ios::trunc);
+			for (auto &&entry : hashCache)
+				out << entry.second.Sha256 << ' ' << entry.second.Size << ' ' << entry.second.ModifiedTime << ' ' << entry.first << '\n';
+			if (!out)
+				return;
+		}
+		fs::rename(tempPath, GetHashCachePath(root), ec);
+		hashCacheChanged = false;
+	}
+
+	void UpdateEngine::SetState(UpdateState state)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		progress.State = state;
+	}
+
+	bool UpdateEngine::Fail(const std::string &error)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		progress.State = UpdateState::Failed;
+		progress.Error = error;
+		return false;
+	}
+
+	bool UpdateEngine::InstallStaged(const std::string &installDir, std::string *error)
+	{
+		fs::path root(installDir);
+		boost::system::error_code ec;
+		std::vector<StagedFile> files;
+
+		auto cleanUp = [&]
+		{
+			fs::remove(GetPendingPath(root), ec);
+			fs::remove(GetJournalPath(root), ec);
+			fs::remove_all(GetStagingDir(root), ec);
+			fs::remove_all(GetBackupDir(root), ec);
+		};
+
+		// A journal is only left behind if an install was interrupted, so put the old files back
+		if (fs::exists(GetJournalPath(root), ec))
+		{
+			if (ReadStagedList(GetJournalPath(root), &files))
+				RollBack(root, files, files.size());
+			cleanUp();
+			*error = "An interrupted update was rolled back";
+			return false;
+		}
+
+		if (!fs::exists(GetPendingPath(root), ec))
+			return true;
+
+		if (!ReadStagedList(GetPendingPath(root), &files))
+		{
+			cleanUp();
+			*error = "The list of staged files is corrupt";
+			return false;
+		}
+		for (auto &&file : files)
+		{
+			if (fs::file_size(GetStagingDir(root) / file.Path, ec) != file.Size || ec)
+			{
+				cleanUp();
+				*error = "The staged copy of " + file.Path + " is missing";
+				return false;
+			}
+		}
+
+		// Renaming the list makes it the journal, so nothing is touched until the journal exists
+		fs::rename(GetPendingPath(root), GetJournalPath(root), ec);
+		if (ec)
+		{
+			*error = "Failed to start installing the update";
+			return false;
+		}
+
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			auto targetPath = root / files[i].Path;
+			auto backupPath = GetBackupDir(root) / files[i].Path;
+			fs::create_directories(targetPath.parent_path(), ec);
+			fs::create_directories(backupPath.parent_path(), ec);
+
+			auto replacing = fs::exists(targetPath, ec);
+			ec.clear();
+			if (replacing)
+				fs::rename(targetPath, backupPath, ec);
+			if (!ec)
+				fs::rename(GetStagingDir(root) / files[i].Path, targetPath, ec);
+			if (ec)
+			{
+				*error = "Failed to replace " + files[i].Path + ": " + ec.message();
+				RollBack(root, files, i + 1);
+				cleanUp();
+				return false;
+			}
+		}
+
+		cleanUp();
+		return true;
+	}
+}
+
+namespace
+{
+	bool IsSafePath(const std::string &path)
+	{
+		// Only plain relative paths inside the install directory, and nothing inside the update directory itself
+		if (path.empty() || path.front() == '/' || path.find_first_of("\\:") != std::string::npos)
+			return false;
+
+		size_t start = 0;
+		auto first = true;
+		while (true)
+		{
+			auto end = path.find('/', start);
+			auto part = path.substr(start, end == std::string::npos ? std::string::npos : end - start);
+			if (part.empty() || part == "." || part == "..")
+				return false;
+
+			// Windows ignores case and strips trailing dots and spaces, so "Update" and "update." are the update directory too
+			if (part.back() == '.' || part.back() == ' ')
+				return false;
+			std::transform(part.begin(), part.end(), part.begin(), ToLower);
+			if (first && end != std::string::npos && part == UpdateDirName)
+				return false;
+			if (end == std::string::npos)
+				return true;
+			start = end + 1;
+			first = false;
+		}
+	}
+
+	// ::tolower is undefined for negative chars, which is what bytes above 0x7F are when char is signed
+	char ToLower(char ch)
+	{
+		return static_cast<char>(::tolower(static_cast<unsigned char>(ch)));
+	}
+
+	bool HashFile(const fs::path &path, std::string *hash)
+	{
+		std::ifstream in(path.string(), std::ios::binary);
+		if (!in)
+			return false;
+
+		auto context = EVP_MD_CTX_create();
+		if (!context)
+			return false;
+		auto success = EVP_DigestInit_ex(context, EVP_sha256(), nullptr) == 1;
+		std::vector<char> buffer(64 * 1024);
+		while (success && in)
+		{
+			in.read(buffer.data(), buffer.size());
+			success = EVP_DigestUpdate(context, buffer.data(), static_cast<size_t>(in.gcount())) == 1;
+		}
+
+		unsigned char digest[SHA256_DIGEST_LENGTH];
+		success = success && !in.bad() && EVP_DigestFinal_ex(context, digest, nullptr) == 1;
+		EVP_MD_CTX_destroy(context);
+		if (!success)
+			return false;
+
+		static const char HexDigits[] = "0123456789abcdef";
+		hash->resize(SHA256_DIGEST_LENGTH * 2);
+		for (auto i = 0; i < SHA256_DIGEST_LENGTH; i++)
+		{
+			(*hash)[i * 2] = HexDigits[digest[i] >> 4];
+			(*hash)[i * 2 + 1] = HexDigits[digest[i] & 0xF];
+		}
+		return true;
+	}
+
+	// Each line is "<sha256> <size> <path>"
+	bool WriteStagedList(const fs::path &path, const std::vector<StagedFile> &files)
+	{
+		auto tempPath = path;
+		tempPath += ".tmp";
+		{
+			std::ofstream out(tempPath.string(), std::ios::trunc);
+			for (auto &&file : files)
+				out << file.Sha256 << ' ' << file.Size << ' ' << file.Path << '\n';
+			if (!out)
+				return false;
+		}
+
+		boost::system::error_code ec;
+		fs::rename(tempPath, path, ec);
+		return !ec;
+	}
+
+	bool ReadStagedList(const fs::path &path, std::vector<StagedFile> *files)
+	{
+		std::ifstream in(path.string());
+		if (!in)
+			return false;
+
+		files->clear();
+		std::string line;
+		while (std::getline(in, line))
+		{
+			std::istringstream stream(line);
+			StagedFile file;
+			if (!(stream >> file.Sha256 >> file.Size) || stream.get() != ' ' || !std::getline(stream, file.Path) || !IsSafePath(file.Path))
+				return false;
+			files->push_back(file);
+		}
+		return true;
+	}
+
+	// Restores the original versions of the first count files in an install, in reverse order
+	void RollBack(const fs::path &root, const std::vector<StagedFile> &files, size_t count)
+	{
+		boost::system::error_code ec;
+		for (auto i = count; i-- > 0;)
+		{
+			auto targetPath = root / files[i].Path;
+			auto backupPath = GetBackupDir(root) / files[i].Path;
+
+			// If the staged copy is gone then it was moved into place, and has to be removed
+			if (!fs::exists(GetStagingDir(root) / files[i].Path, ec))
+				fs::remove(targetPath, ec);
+			if (fs::exists(backupPath, ec))
+				fs::rename(backupPath, targetPath, ec);
+		}
+	}
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+	// A file listed in an update manifest.
+	struct UpdateFile
+	{
+		std::string Path;   // Relative to the install directory, with forward slashes
+		uint64_t Size;
+		std::string Sha256; // Lowercase hex
+	};
+
+	// Parses an update manifest:
+	//   { "version": "...", "files": [ { "path": "...", "size": 123, "sha256": "..." }, ... ] }
+	// Paths that are absolute, leave the install directory or point into its update directory (in any case) are rejected.
+	bool ParseUpdateManifest(const std::string &json, std::string *version, std::vector<UpdateFile> *files, std::string *error);
+
+	// Checks a manifest against its detached signature, a SHA-256 RSA signature made with
+	//   openssl dgst -sha256 -sign <private key> -out manifest.json.sig manifest.json
+	// publicKey is the PEM public key the signature has to be made with.
+	bool VerifyUpdateManifest(const std::string &manifest, const std::string &signature, const std::string &publicKey);
+
+	// The PEM public key official update manifests are signed with.
+	extern const char UpdatePublicKey[];
+
+	// Where the update engine downloads from.
+	class UpdateTransport
+	{
+	public:
+		// Receives downloaded data. Returning false aborts the download.
+		typedef std::function<bool(const uint8_t *data, size_t size)> WriteCallback;
+
+		virtual ~UpdateTransport() { }
+
+		// Downloads the manifest and its detached signature.
+		virtual bool FetchManifest(std::string *manifest, std::string *signature, std::string *error) = 0;
+
+		// Downloads a file listed in the manifest, starting at *offset. If the source can't resume, it sets *offset to
+		// where the data actually starts (i.e. 0) before the first write.
+		virtual bool FetchFile(const std::string &path, uint64_t *offset, const WriteCallback &write, std::string *error) = 0;
+	};
+
+	enum class UpdateState
+	{
+		Idle,
+		Checking,    // Downloading the manifest and hashing local files
+		Downloading,
+		UpToDate,
+		Staged,      // Files are downloaded and verified, and will be installed the next time the game starts
+		Failed,
+		Cancelled,
+	};
+
+	struct UpdateProgress
+	{
+		UpdateState State;
+		std::string Version;
+		uint32_t FilesToDownload;
+		uint32_t FilesDownloaded;
+		uint64_t BytesToDownload;
+		uint64_t BytesDownloaded; // Including bytes from resumed partial downloads
+		std::string Error;
+	};
+
+	// Brings an install up to date with an update manifest.
+	//
+	// Nothing is downloaded unless the manifest's signature matches the public key the engine was created with. Files
+	// which differ from the manifest are downloaded into <install>/update/staging. Partial downloads are kept
+	// and resumed, and every file is checked against its SHA-256 hash before it's staged. The hashes of local files
+	// are cached with their size and modification time, so unchanged files aren't hashed again on the next check.
+	// Once everything is staged, InstallStaged() swaps the files in the next time the game starts.
+	class UpdateEngine
+	{
+	public:
+		UpdateEngine(const std::string &installDir, const std::string &publicKey);
+		~UpdateEngine();
+
+		// Starts updating on a background thread. Does nothing if an update is already running.
+		void Start(std::shared_ptr<UpdateTransport> transport);
+
+		// Updates on the calling thread, and returns true if the install is up to date or the update is staged.
+		bool Run(UpdateTransport &transport);
+
+		// Stops the current update as soon as the in-flight write completes. Partial downloads are kept.
+		void Cancel();
+
+		bool IsRunning() const;
+		UpdateProgress GetProgress() const;
+
+		// Swaps staged files into an install. This has to run before any of the files are opened.
+		//
+		// Each replaced file is moved to <install>/update/backup first, and a journal of the swap is written, so if
+		// the swap fails (or the process dies during it) every file is restored. Returns true if there was nothing to
+		// install or the install succeeded.
+		static bool InstallStaged(const std::string &installDir, std::string *error);
+
+	private:
+		struct CachedHash
+		{
+			uint64_t Size;
+			int64_t ModifiedTime;
+			std::string Sha256;
+		};
+
+		bool Check(UpdateTransport &transport, std::vector<UpdateFile> *changedFiles);
+		bool Download(UpdateTransport &transport, const UpdateFile &file);
+		bool GetLocalHash(const std::string &path, std::string *hash);
+		void LoadHashCache();
+		void SaveHashCache();
+		void SetState(UpdateState state);
+		bool Fail(const std::string &error);
+
+		std::string installDir;
+		std::string publicKey;
+		std::vector<std::pair<std::string, CachedHash>> hashCache; // Sorted by path
+		bool hashCacheChanged;
+
+		std::thread worker;
+		mutable std::mutex mutex;
+		std::atomic<bool> cancelled;
+		std::atomic<bool> running;
+		UpdateProgress progress;
+	};
+}
@@ -4,18 +4,21 @@
 #include "../../Ui/WebVirtualKeyboard.hpp"
 #include "../../Ui/WebForge.hpp"
 #include "../../Ui/WebScoreboard.hpp"
+#include "../../Ui/MpEventDispatcher.hpp"
 #include "../../../CommandMap.hpp"
 #include "../../../Blam/BlamNetwork.hpp"
 #include "../../../Discord/DiscordRPC.h"
 #include "../../../Patches/Network.hpp"
 #include "../../../Patches/Input.hpp"
 #include "../../../Patches/Ui.hpp"
+#include "../../../Modules/ModuleGame.hpp"
 #include "../../../Modules/ModuleVoIP.hpp"
 #include "../../../Modules/ModulePlayer.hpp"
 #include "../../../Pointer.hpp"
 #include "../../../Server/ServerChat.hpp"
 #include "../../../Utils/VersionInfo.hpp"
 #include "../../../Utils/String.hpp"
+#include "../../../Utils/Unicode.hpp"
 #include "../../../ThirdParty/rapidjson/writer.h"
 #include "../../../ThirdParty/rapidjson/stringbuffer.h"
 
@@ -25,6 +28,7 @@ namespace
 	bool PingHandlerRegistered;
 
 	void PongReceived(const Blam::Network::NetworkAddress &from, uint32_t timestamp, uint16_t id, uint32_t latency);
+	bool ParseIndexMask(const rapidjson::Value &p_Args, const char *p_Name, uint32_t *p_Result);
 }
 
 namespace Anvil::Client::Rendering::Bridge::ClientFunctions
@@ -445,7 +449,9 @@ namespace Anvil::Client::Rendering::Bridge::ClientFunctions
 		while (playerIdx != -1)
 		{
 			auto player = session->MembershipInfo.PlayerSessions[playerIdx];
-			if (strcmp(Utils::String::ThinString(player.Properties.DisplayName).c_str(), name->value.GetString()) == 0)
+			char playerName[Utils::Unicode::Utf8Size<16>::Value];
+			Utils::Unicode::Utf16ToUtf8(player.Properties.DisplayName, playerName);
+			if (strcmp(playerName, name->value.GetString()) == 0)
 			{
 				rapidjson::StringBuffer buffer;
 				rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
@@ -461,8 +467,9 @@ namespace Anvil::Client::Rendering::Bridge::ClientFunctions
 					{
 						auto p = session->MembershipInfo.PlayerSessions[i];
 						writer.StartObject();
+						char otherName[Utils::Unicode::Utf8Size<16>::Value];
 						writer.Key("PlayerName");
-						writer.String(Utils::String::ThinString(p.Properties.DisplayName).c_str());
+						writer.String(otherName, Utils::Unicode::Utf16ToUtf8(p.Properties.DisplayName, otherName));
 						writer.Key("Kills");
 						writer.Int(pvpStats.StatsAgainstEachPlayer[i].Kills);
 						writer.EndObject();
@@ -480,8 +487,9 @@ namespace Anvil::Client::Rendering::Bridge::ClientFunctions
 					{
 						auto p = session->MembershipInfo.PlayerSessions[i];
 						writer.StartObject();
+						char otherName[Utils::Unicode::Utf8Size<16>::Value];
 						writer.Key("PlayerName");
-						writer.String(Utils::String::ThinString(p.Properties.DisplayName).c_str());
+						writer.String(otherName, Utils::Unicode::Utf16ToUtf8(p.Properties.DisplayName, otherName));
 						writer.Key("Kills");
 						writer.Int(pvpStats.StatsAgainstEachPlayer[i].KilledBy);
 						writer.EndObject();
@@ -674,6 +682,50 @@ namespace Anvil::Client::Rendering::Bridge::ClientFunctions
 		Discord::DiscordRPC::Instance().ReplyToJoinRequest(userId->value.GetString(), replyValue->value.GetInt());
 		return QueryError_Ok;
 	}
+
+	QueryError OnMpEventSubscribe(const rapidjson::Value &p_Args, std::string *p_Result)
+	{
+		auto screenValue = p_Args.FindMember("screen");
+		if (screenValue == p_Args.MemberEnd() || !screenValue->value.IsString())
+		{
+			*p_Result = "Bad query: A \"screen\" argument is required and must be a string";
+			return QueryError_BadQuery;
+		}
+
+		// The "categories" and "audiences" arguments are optional and default to everything, so leaving both out
+		// subscribes the screen to every event
+		uint32_t categories, audiences;
+		if (!ParseIndexMask(p_Args, "categories", &categories) || !ParseIndexMask(p_Args, "audiences", &audiences))
+		{
+			*p_Result = "Bad query: The \"categories\" and \"audiences\" arguments must be arrays of numbers from 0 to 31";
+			return QueryError_BadQuery;
+		}
+
+		Web::Ui::MpEventDispatcher::Subscribe(screenValue->value.GetString(), categories, audiences);
+		return QueryError_Ok;
+	}
+
+	QueryError OnMpEventUnsubscribe(const rapidjson::Value &p_Args, std::string *p_Result)
+	{
+		auto screenValue = p_Args.FindMember("screen");
+		if (screenValue == p_Args.MemberEnd() || !screenValue->value.IsString())
+		{
+			*p_Result = "Bad query: A \"screen\" argument is required and must be a string";
+			return QueryError_BadQuery;
+		}
+
+		Web::Ui::MpEventDispatcher::Unsubscribe(screenValue->value.GetString());
+		return QueryError_Ok;
+	}
+
+	QueryError OnMedalPacks(const rapidjson::Value &p_Args, std::string *p_Result)
+	{
+		// Only packs that changed since the last query are validated again
+		auto &medalPacks = Modules::ModuleGame::Instance().MedalPacks;
+		medalPacks.Refresh();
+		*p_Result = medalPacks.ToJson();
+		return QueryError_Ok;
+	}
 }
 
 namespace
@@ -689,4 +741,25 @@ namespace
 		data += "}";
 		Web::Ui::ScreenLayer::Notify("pong", data, true);
 	}
-}
\ No newline at end of file
+
+	bool ParseIndexMask(const rapidjson::Value &p_Args, const char *p_Name, uint32_t *p_Result)
+	{
+		auto value = p_Args.FindMember(p_Name);
+		if (value == p_Args.MemberEnd())
+		{
+			*p_Result = 0xFFFFFFFF;
+			return true;
+		}
+		if (!value->value.IsArray())
+			return false;
+
+		*p_Result = 0;
+		for (auto &&index : value->value.GetArray())
+		{
+			if (!index.IsInt() || index.GetInt() < 0 || index.GetInt() >= 32)
+				return false;
+			*p_Result |= 1U << index.GetInt();
+		}
+		return true;
+	}
+}
@@ -27,4 +27,7 @@ namespace Anvil::Client::Rendering::Bridge::ClientFunctions
 	QueryError OnForgeAction(const rapidjson::Value &p_Args, std::string *p_Result);
 	QueryError OnShowLan(const rapidjson::Value &p_Args, std::string *p_Result);
 	QueryError OnDiscordReply(const rapidjson::Value &p_Args, std::string *p_Result);
+	QueryError OnMpEventSubscribe(const rapidjson::Value &p_Args, std::string *p_Result);
+	QueryError OnMpEventUnsubscribe(const rapidjson::Value &p_Args, std::string *p_Result);
+	QueryError OnMedalPacks(const rapidjson::Value &p_Args, std::string *p_Result);
 }
@@ -0,0 +1,229 @@
+#include "LoadProgressTracker.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "../../ThirdParty/rapidjson/document.h"
+#include "../../ThirdParty/rapidjson/stringbuffer.h"
+#include "../../ThirdParty/rapidjson/writer.h"
+
+namespace
+{
+	// Loads older than this many samples fade out of the average, so it follows hardware/cache changes
+	const uint32_t HistoryWindow = 8;
+
+	// Weight given to each new estimate, higher values react faster but jitter more
+	const double EtaSmoothing = 0.3;
+}
+
+namespace Web::Ui
+{
+	LoadProgressTracker::LoadProgressTracker(ClockFunc clock)
+		: clock(clock), phase(Phase::None), currentBytes(0), totalBytes(0), phaseSeconds(), smoothedEtaSeconds(-1), completionNotified(false)
+	{
+	}
+
+	void LoadProgressTracker::Show(const std::string &mapName)
+	{
+		this->mapName = mapName;
+		currentBytes = 0;
+		totalBytes = 0;
+		smoothedEtaSeconds = -1;
+		completionNotified = false;
+		std::fill(std::begin(phaseSeconds), std::end(phaseSeconds), 0.0);
+
+		showTime = clock();
+		phaseStartTime = showTime;
+		lastNotifyTime = showTime;
+		phase = Phase::Preparing;
+	}
+
+	void LoadProgressTracker::Begin(uint32_t totalBytes)
+	{
+		// The loader can begin without the loading screen being shown (e.g. the main menu). The map isn't known
+		// then, so the load mustn't be recorded under the name from the previous one.
+		if (phase == Phase::None)
+			Show("");
+
+		currentBytes = 0;
+		this->totalBytes = totalBytes;
+		EnterPhase(Phase::Loading);
+	}
+
+	void LoadProgressTracker::UpdateProgress(uint32_t bytes)
+	{
+		if (phase != Phase::Loading)
+			return;
+
+		currentBytes = std::min(currentBytes + bytes, totalBytes);
+		if (currentBytes >= totalBytes)
+			EnterPhase(Phase::Finishing);
+	}
+
+	void LoadProgressTracker::Hide()
+	{
+		if (phase == Phase::None)
+			return;
+
+		EnterPhase(Phase::None);
+
+		// Only complete loads are representative of how long the next one will take
+		if (mapName.empty() || totalBytes == 0 || currentBytes < totalBytes)
+			return;
+
+		auto &entry = history[mapName];
+		entry.Loads++;
+		auto weight = 1.0 / std::min(entry.Loads, HistoryWindow);
+		entry.AverageSeconds += (GetTotalSeconds() - entry.AverageSeconds) * weight;
+		entry.AverageBytes += (totalBytes - entry.AverageBytes) * weight;
+	}
+
+	bool LoadProgressTracker::ShouldNotify(std::chrono::milliseconds interval)
+	{
+		if (phase == Phase::None)
+			return false;
+
+		// The update for the end of the load always goes out, so the UI doesn't get stuck short of 100%
+		auto now = clock();
+		auto completed = totalBytes > 0 && currentBytes >= totalBytes;
+		if (completed && !completionNotified)
+			completionNotified = true;
+		else if (now - lastNotifyTime < interval)
+			return false;
+
+		lastNotifyTime = now;
+		UpdateEstimate();
+		return true;
+	}
+
+	int64_t LoadProgressTracker::GetEtaMs() const
+	{
+		if (smoothedEtaSeconds < 0)
+			return -1;
+		return static_cast<int64_t>(smoothedEtaSeconds * 1000);
+	}
+
+	double LoadProgressTracker::GetPhaseSeconds(Phase phase) const
+	{
+		auto seconds = phaseSeconds[static_cast<int>(phase)];
+		if (phase == this->phase)
+			seconds += SecondsSince(phaseStartTime);
+		return seconds;
+	}
+
+	double LoadProgressTracker::GetTotalSeconds() const
+	{
+		auto seconds = 0.0;
+		for (auto i = static_cast<int>(Phase::Preparing); i < static_cast<int>(Phase::Count); i++)
+			seconds += GetPhaseSeconds(static_cast<Phase>(i));
+		return seconds;
+	}
+
+	void LoadProgressTracker::EnterPhase(Phase newPhase)
+	{
+		auto now = clock();
+		if (phase != Phase::None)
+			phaseSeconds[static_cast<int>(phase)] += std::chrono::duration<double>(now - phaseStartTime).count();
+
+		phase = newPhase;
+		phaseStartTime = now;
+	}
+
+	void LoadProgressTracker::UpdateEstimate()
+	{
+		auto elapsed = GetTotalSeconds();
+
+		auto historyEta = -1.0;
+		auto it = history.find(mapName);
+		if (it != history.end())
+			historyEta = std::max(0.0, it->second.AverageSeconds - elapsed);
+
+		// Extrapolate the rate of the current load, it can't be known before any bytes are read
+		auto rateEta = -1.0;
+		auto progress = 0.0;
+		if (totalBytes > 0)
+		{
+			progress = static_cast<double>(currentBytes) / totalBytes;
+
+			auto loadingSeconds = GetPhaseSeconds(Phase::Loading);
+			if (currentBytes > 0 && loadingSeconds > 0)
+				rateEta = (totalBytes - currentBytes) / (currentBytes / loadingSeconds);
+		}
+
+		double eta;
+		if (historyEta >= 0 && rateEta >= 0)
+			eta = historyEta * (1 - progress) + rateEta * progress;
+		else if (rateEta >= 0)
+			eta = rateEta;
+		else if (historyEta >= 0)
+			eta = historyEta;
+		else
+			return;
+
+		if (smoothedEtaSeconds < 0)
+			smoothedEtaSeconds = eta;
+		else
+			smoothedEtaSeconds += (eta - smoothedEtaSeconds) * EtaSmoothing;
+	}
+
+	double LoadProgressTracker::SecondsSince(Clock::time_point time) const
+	{
+		return std::chrono::duration<double>(clock() - time).count();
+	}
+
+	bool LoadProgressTracker::LoadHistory(const std::string &path)
+	{
+		std::ifstream in(path, std::ios::in | std::ios::binary);
+		if (!in.is_open())
+			return false;
+
+		std::stringstream contents;
+		contents << in.rdbuf();
+
+		rapidjson::Document document;
+		if (document.Parse<0>(contents.str().c_str()).HasParseError() || !document.IsObject())
+			return false;
+
+		history.clear();
+		for (auto it = document.MemberBegin(); it != document.MemberEnd(); ++it)
+		{
+			auto &map = it->value;
+			if (!map.IsObject() || !map.HasMember("loads") || !map.HasMember("seconds") || !map.HasMember("bytes"))
+				continue;
+			if (!map["loads"].IsUint() || !map["seconds"].IsNumber() || !map["bytes"].IsNumber())
+				continue;
+
+			MapHistory entry;
+			entry.Loads = map["loads"].GetUint();
+			entry.AverageSeconds = map["seconds"].GetDouble();
+			entry.AverageBytes = map["bytes"].GetDouble();
+			history[it->name.GetString()] = entry;
+		}
+		return true;
+	}
+
+	bool LoadProgressTracker::SaveHistory(const std::string &path) const
+	{
+		rapidjson::StringBuffer jsonBuffer;
+		rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
+		jsonWriter.StartObject();
+		for (auto &&entry : history)
+		{
+			jsonWriter.Key(entry.first.c_str());
+			jsonWriter.StartObject();
+			jsonWriter.Key("loads");
+			jsonWriter.Uint(entry.second.Loads);
+			jsonWriter.Key("seconds");
+			jsonWriter.Double(entry.second.AverageSeconds);
+			jsonWriter.Key("bytes");
+			jsonWriter.Double(entry.second.AverageBytes);
+			jsonWriter.EndObject();
+		}
+		jsonWriter.EndObject();
+
+		std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!out.is_open())
+			return false;
+		out << jsonBuffer.GetString();
+		return true;
+	}
+}
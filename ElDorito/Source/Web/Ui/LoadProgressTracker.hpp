@@ -0,0 +1,83 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace Web::Ui
+{
+	// Tracks the phases of a map load and estimates the time remaining.
+	//
+	// The estimate blends the average duration of previous loads of the same map
+	// with the current byte rate, so it is sensible from the very first update
+	// and converges on the measured rate as the load progresses.
+	class LoadProgressTracker
+	{
+	public:
+		typedef std::chrono::steady_clock Clock;
+		typedef Clock::time_point(*ClockFunc)();
+
+		enum class Phase
+		{
+			None,
+			Preparing, // Loading screen shown, waiting for the loader to start reading
+			Loading,   // Reading tags and resources
+			Finishing, // All bytes read, waiting for the map to start
+			Count
+		};
+
+		struct MapHistory
+		{
+			uint32_t Loads;
+			double AverageSeconds;
+			double AverageBytes;
+		};
+
+		explicit LoadProgressTracker(ClockFunc clock = Clock::now);
+
+		void Show(const std::string &mapName);
+
+		// Starts reading. If the loading screen wasn't shown first, the load is tracked without a map name.
+		void Begin(uint32_t totalBytes);
+		void UpdateProgress(uint32_t bytes);
+
+		// Finishes the load and records its duration in the map's history.
+		void Hide();
+
+		// Returns true if a UI update is due, limiting updates to one per interval. The first call after all of the
+		// bytes are read always returns true. The time estimate is refreshed whenever an update is due.
+		bool ShouldNotify(std::chrono::milliseconds interval);
+
+		// Smoothed estimate of the time remaining in milliseconds, or -1 if there is nothing to base it on.
+		int64_t GetEtaMs() const;
+
+		Phase GetPhase() const { return phase; }
+		uint32_t GetCurrentBytes() const { return currentBytes; }
+		uint32_t GetTotalBytes() const { return totalBytes; }
+		const std::string &GetMapName() const { return mapName; }
+		double GetPhaseSeconds(Phase phase) const;
+		double GetTotalSeconds() const;
+
+		const std::unordered_map<std::string, MapHistory> &GetHistory() const { return history; }
+		bool LoadHistory(const std::string &path);
+		bool SaveHistory(const std::string &path) const;
+
+	private:
+		void EnterPhase(Phase newPhase);
+		void UpdateEstimate();
+		double SecondsSince(Clock::time_point time) const;
+
+		ClockFunc clock;
+		Phase phase;
+		std::string mapName;
+		uint32_t currentBytes;
+		uint32_t totalBytes;
+		Clock::time_point showTime;
+		Clock::time_point phaseStartTime;
+		Clock::time_point lastNotifyTime;
+		double phaseSeconds[static_cast<int>(Phase::Count)];
+		double smoothedEtaSeconds;
+		bool completionNotified;
+		std::unordered_map<std::string, MapHistory> history;
+	};
+}
@@ -1,78 +1,87 @@
 #include "MpEventDispatcher.hpp"
+#include "MpEventRouter.hpp"
 #include "../../Blam/BlamEvents.hpp"
 #include "../../Patches/Events.hpp"
 #include "ScreenLayer.hpp"
-#include "../../ThirdParty/rapidjson/writer.h"
-#include "../../ThirdParty/rapidjson/stringbuffer.h"
-#include <unordered_map>
-#include <sstream>
 
 using namespace Blam::Events;
 
 namespace
 {
+	struct EventName
+	{
+		uint32_t StringId;
+		const char *Name;
+	};
+
 	void OnEvent(Blam::DatumHandle player, const Event *event, const EventDefinition *definition);
-	std::string GetEventName(uint32_t stringId);
+	void SendEvent(const std::string &screenId, const std::string &json);
+
+	extern const EventName EventNames[];
+	extern const size_t EventNameCount;
 
-	extern std::unordered_map<uint32_t, std::string> EventNames;
+	Web::Ui::MpEventRouter Router;
 }
 
 namespace Web::Ui::MpEventDispatcher
 {
 	void Init()
 	{
+		for (size_t i = 0; i < EventNameCount; i++)
+			Router.AddEventName(EventNames[i].StringId, EventNames[i].Name);
 		Patches::Events::OnEvent(OnEvent);
 	}
+
+	void Subscribe(const std::string &screenId, uint32_t categoryMask, uint32_t audienceMask)
+	{
+		Router.Subscribe(screenId, categoryMask, audienceMask);
+	}
+
+	void Unsubscribe(const std::string &screenId)
+	{
+		Router.Unsubscribe(screenId);
+	}
+
+	void UnsubscribeAll()
+	{
+		Router.UnsubscribeAll();
+	}
+
+	bool IsEventName(const std::string &name)
+	{
+		for (size_t i = 0; i < EventNameCount; i++)
+		{
+			if (name == EventNames[i].Name)
+				return true;
+		}
+		return false;
+	}
 }
 
 namespace
 {
 	void OnEvent(Blam::DatumHandle player, const Event *event, const EventDefinition *definition)
 	{
+		// Drop events which no screen wants before doing anything else
+		if (!Router.IsSubscribed(event->Type, definition->Audience))
+			return;
+
 		// Ignore the event if it's not targeted at the local player
 		typedef uint32_t(*GetLocalPlayerPtr)(int index);
 		auto GetLocalPlayer = reinterpret_cast<GetLocalPlayerPtr>(0x589C30);
 		if (player.Handle != GetLocalPlayer(0))
 			return;
 
-		rapidjson::StringBuffer jsonBuffer;
-		rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
-		jsonWriter.StartObject();
-
-		// name
-		auto eventName = GetEventName(event->NameStringId);
-		jsonWriter.Key("name");
-		jsonWriter.String(eventName.c_str());
-
-		// category
-		jsonWriter.Key("category");
-		jsonWriter.Int(event->Type);
-
-		// audience
-		jsonWriter.Key("audience");
-		jsonWriter.Int(definition->Audience);
-
-		jsonWriter.EndObject();
-
-		// Broadcast a "mpevent" event to all screens
-		Web::Ui::ScreenLayer::Notify("mpevent", jsonBuffer.GetString(), true);
+		// Send a "mpevent" event to each screen which subscribed to it
+		Router.Dispatch(event->NameStringId, event->Type, definition->Audience, SendEvent);
 	}
 
-	std::string GetEventName(uint32_t stringId)
+	void SendEvent(const std::string &screenId, const std::string &json)
 	{
-		// Try to find the stringID in the event names list
-		std::string name;
-		auto it = EventNames.find(stringId);
-		if (it != EventNames.end())
-			return it->second;
-
-		// If it wasn't found, then just convert it to a hex number
-		std::ostringstream ss;
-		ss << "0x" << std::hex << stringId;
-		return ss.str();
+		Web::Ui::ScreenLayer::NotifyScreen(screenId, "mpevent", json);
 	}
 
-	std::unordered_map<uint32_t, std::string> EventNames =
+	const EventName EventNames[] =
 	{
 		{ 0x40010, "earn_wp_event_kill" },
 		{ 0x40011, "earn_wp_event_assist" },
@@ -277,4 +286,6 @@ namespace
 		{ 0x400F5, "infection_event_alpha_zombie_spawn" },
 		{ 0x400F6, "infection_event_survive" },
 	};
-}
\ No newline at end of file
+
+	const size_t EventNameCount = sizeof(EventNames) / sizeof(EventNames[0]);
+}
@@ -1,6 +1,27 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+
 namespace Web::Ui::MpEventDispatcher
 {
 	void Init();
+
+	// Sends a screen "mpevent" notifications for the events whose category (Blam::Events::EventType) and audience
+	// (Blam::Events::EventAudience) are both set in the masks. Screens which want every event, like they used to get
+	// before there were subscriptions, subscribe with both masks set to 0xFFFFFFFF (which is what mpeventSubscribe
+	// does without categories or audiences). Replaces any previous subscription for the screen.
+	//
+	// Only subscribed screens are sent events. A subscription lasts until the screen is hidden or the UI is reloaded,
+	// so screens should subscribe again each time they are shown.
+	void Subscribe(const std::string &screenId, uint32_t categoryMask, uint32_t audienceMask);
+
+	// Stops sending "mpevent" notifications to a screen.
+	void Unsubscribe(const std::string &screenId);
+
+	// Stops sending "mpevent" notifications to every screen.
+	void UnsubscribeAll();
+
+	// Checks whether a name is one that "mpevent" notifications can have.
+	bool IsEventName(const std::string &name);
 }
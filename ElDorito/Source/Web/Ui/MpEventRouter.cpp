@@ -0,0 +1,132 @@
+#include "MpEventRouter.hpp"
+#include "../../ThirdParty/rapidjson/writer.h"
+#include "../../ThirdParty/rapidjson/stringbuffer.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+	// Enough for the longest event name, so that building JSON doesn't have to grow the buffer
+	const size_t InitialJsonCapacity = 256;
+
+	void AppendNumber(std::string *out, uint32_t value, int base)
+	{
+		char digits[16];
+		auto result = std::to_chars(digits, digits + sizeof(digits), value, base);
+		out->append(digits, result.ptr);
+	}
+
+	void AppendNumber(std::string *out, int value)
+	{
+		char digits[16];
+		auto result = std::to_chars(digits, digits + sizeof(digits), value);
+		out->append(digits, result.ptr);
+	}
+}
+
+namespace Web::Ui
+{
+	MpEventRouter::MpEventRouter()
+	{
+		memset(wantedAudiences, 0, sizeof(wantedAudiences));
+		jsonBuffer.reserve(InitialJsonCapacity);
+	}
+
+	void MpEventRouter::AddEventName(uint32_t stringId, const char *name)
+	{
+		rapidjson::StringBuffer buffer;
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+		writer.StartObject();
+		writer.Key("name");
+		writer.String(name);
+		writer.Key("category");
+
+		// The writer expects a value after the key, so the prefix is everything written so far plus the colon
+		EventName eventName;
+		eventName.StringId = stringId;
+		eventName.JsonPrefix = std::string(buffer.GetString()) + ":";
+		jsonBuffer.reserve(std::max(jsonBuffer.capacity(), eventName.JsonPrefix.length() + InitialJsonCapacity));
+
+		auto it = std::lower_bound(eventNames.begin(), eventNames.end(), stringId, [](const EventName &name, uint32_t id)
+		{
+			return name.StringId < id;
+		});
+		if (it != eventNames.end() && it->StringId == stringId)
+			*it = std::move(eventName);
+		else
+			eventNames.insert(it, std::move(eventName));
+	}
+
+	void MpEventRouter::Subscribe(const std::string &screenId, uint32_t categoryMask, uint32_t audienceMask)
+	{
+		if (!categoryMask || !audienceMask)
+		{
+			Unsubscribe(screenId);
+			return;
+		}
+
+		auto it = std::find_if(subscriptions.begin(), subscriptions.end(), [&](const Subscription &subscription)
+		{
+			return subscription.ScreenId == screenId;
+		});
+		if (it == subscriptions.end())
+			it = subscriptions.insert(subscriptions.end(), Subscription{ screenId, 0, 0 });
+		it->Categories = categoryMask;
+		it->Audiences = audienceMask;
+		UpdateWantedAudiences();
+	}
+
+	void MpEventRouter::Unsubscribe(const std::string &screenId)
+	{
+		subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(), [&](const Subscription &subscription)
+		{
+			return subscription.ScreenId == screenId;
+		}), subscriptions.end());
+		UpdateWantedAudiences();
+	}
+
+	void MpEventRouter::UnsubscribeAll()
+	{
+		subscriptions.clear();
+		UpdateWantedAudiences();
+	}
+
+	void MpEventRouter::UpdateWantedAudiences()
+	{
+		memset(wantedAudiences, 0, sizeof(wantedAudiences));
+		for (auto &&subscription : subscriptions)
+		{
+			for (auto i = 0; i < MaxCategories; i++)
+			{
+				if (subscription.Categories & (1U << i))
+					wantedAudiences[i] |= subscription.Audiences;
+			}
+		}
+	}
+
+	const std::string &MpEventRouter::BuildJson(uint32_t nameStringId, int category, int audience)
+	{
+		auto it = std::lower_bound(eventNames.begin(), eventNames.end(), nameStringId, [](const EventName &name, uint32_t id)
+		{
+			return name.StringId < id;
+		});
+		if (it != eventNames.end() && it->StringId == nameStringId)
+		{
+			jsonBuffer.assign(it->JsonPrefix);
+		}
+		else
+		{
+			// Unknown names are sent as a hex number
+			jsonBuffer.assign("{\"name\":\"0x");
+			AppendNumber(&jsonBuffer, nameStringId, 16);
+			jsonBuffer.append("\",\"category\":");
+		}
+		AppendNumber(&jsonBuffer, category);
+		jsonBuffer.append(",\"audience\":");
+		AppendNumber(&jsonBuffer, audience);
+		jsonBuffer.append("}");
+		return jsonBuffer;
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Web::Ui
+{
+	// Decides which screens receive each multiplayer event and builds the JSON sent to them.
+	//
+	// Screens subscribe to a set of event categories and audiences and are only sent the events which match. Events
+	// which no screen subscribed to are dropped before any JSON is built. The JSON for an event name is built once,
+	// when the name is added, so dispatching an event only has to fill in its category and audience, and neither
+	// dispatching nor dropping an event allocates.
+	class MpEventRouter
+	{
+	public:
+		// Categories and audiences are bit indices in the subscription masks.
+		static const int MaxCategories = 32;
+		static const int MaxAudiences = 32;
+
+		MpEventRouter();
+
+		// Adds a known event name. Events whose names are not known are sent with their string ID in hex.
+		void AddEventName(uint32_t stringId, const char *name);
+
+		// Subscribes a screen to the events whose category and audience are both set in the masks, replacing any
+		// previous subscription. Subscribing with an empty mask unsubscribes the screen.
+		void Subscribe(const std::string &screenId, uint32_t categoryMask, uint32_t audienceMask);
+
+		// Removes a screen's subscription.
+		void Unsubscribe(const std::string &screenId);
+
+		// Removes every subscription.
+		void UnsubscribeAll();
+
+		// Returns true if any screen subscribed to events with a category and audience.
+		bool IsSubscribed(int category, int audience) const
+		{
+			if (category < 0 || category >= MaxCategories || audience < 0 || audience >= MaxAudiences)
+				return false;
+			return (wantedAudiences[category] & (1U << audience)) != 0;
+		}
+
+		// Sends an event to each screen which subscribed to it by calling send(const std::string &screenId,
+		// const std::string &json). Returns the number of screens it was sent to.
+		template<class SendFunc>
+		int Dispatch(uint32_t nameStringId, int category, int audience, SendFunc &&send)
+		{
+			if (!IsSubscribed(category, audience))
+				return 0;
+
+			auto &json = BuildJson(nameStringId, category, audience);
+			auto sent = 0;
+			for (auto &&subscription : subscriptions)
+			{
+				if ((subscription.Categories & (1U << category)) && (subscription.Audiences & (1U << audience)))
+				{
+					send(subscription.ScreenId, json);
+					sent++;
+				}
+			}
+			return sent;
+		}
+
+	private:
+		struct EventName
+		{
+			uint32_t StringId;
+			std::string JsonPrefix; // {"name":"...","category":
+		};
+
+		struct Subscription
+		{
+			std::string ScreenId;
+			uint32_t Categories;
+			uint32_t Audiences;
+		};
+
+		std::vector<EventName> eventNames; // Sorted by string ID
+		std::vector<Subscription> subscriptions;
+		uint32_t wantedAudiences[MaxCategories]; // Every audience subscribed to for each category
+		std::string jsonBuffer;
+
+		void UpdateWantedAudiences();
+		const std::string &BuildJson(uint32_t nameStringId, int category, int audience);
+	};
+}
@@ -1,4 +1,5 @@
 #include "ScreenLayer.hpp"
+#include "MpEventDispatcher.hpp"
 #include "../WebRenderer.hpp"
 #include "../WebRendererSchemeHandler.hpp"
 #include "../../Modules/ModuleServer.hpp"
@@ -143,6 +144,10 @@ namespace Web::Ui::ScreenLayer
 	{
 		if (ElDorito::Instance().IsDedicated())
 			return;
+
+		// A hidden screen subscribes to multiplayer events again when it's shown
+		MpEventDispatcher::Unsubscribe(screenId);
+
 		// ui.hideScreen(id)
 		auto js = "if (window.ui) ui.hideScreen('" + screenId + "');";
 		WebRenderer::GetInstance()->ExecuteJavascript(js);
@@ -510,6 +515,7 @@ namespace
 		{
 			WebRendererSchemeHandler::ClearCache(); // hax
 			webRenderer->ExecuteJavascript("ui.reload();");
+			Web::Ui::MpEventDispatcher::UnsubscribeAll();
 		}
 
 		// If F6 is pressed, reload everything and ignore the cache
@@ -517,6 +523,7 @@ namespace
 		{
 			webRenderer->Reload(true);
 			Web::Ui::ScreenLayer::CaptureInput(false, false);
+			Web::Ui::MpEventDispatcher::UnsubscribeAll();
 		}
 
 		// If F7 is pressed, open the remote debugger in Chrome
@@ -0,0 +1,84 @@
+#include "TimerExtrapolator.hpp"
+
+#include <cmath>
+
+namespace Web::Ui
+{
+	TimerExtrapolator::TimerExtrapolator(double threshold)
+		: threshold(threshold), running(false), baseline{ 0, 0, 0 }, resumeRate(0), lastValue(0),
+		  lastChange{ 0, 0 }, previousChange{ 0, 0 }, hasPreviousChange(false)
+	{
+	}
+
+	void TimerExtrapolator::Start(double value, double rate, double time)
+	{
+		running = true;
+		baseline = { value, rate, time };
+		resumeRate = rate;
+		lastValue = value;
+		lastChange = { value, time };
+		hasPreviousChange = false;
+	}
+
+	void TimerExtrapolator::Stop()
+	{
+		running = false;
+	}
+
+	bool TimerExtrapolator::Update(double value, double time)
+	{
+		if (!running)
+			return false;
+
+		auto delta = value - lastValue;
+		lastValue = value;
+		if (delta == 0)
+		{
+			// A running timer has paused if it has gone long enough without changing for the prediction to be off
+			if (baseline.Rate != 0 && time - lastChange.Time > threshold / std::fabs(baseline.Rate))
+				return Correct(value, 0, time);
+			return false;
+		}
+
+		previousChange = lastChange;
+		lastChange = { value, time };
+
+		// A jump isn't a change in rate, so it shouldn't be used to measure one either
+		if (std::fabs(delta) > threshold)
+		{
+			hasPreviousChange = false;
+			return Correct(value, baseline.Rate != 0 ? baseline.Rate : resumeRate, time);
+		}
+
+		auto hadPreviousChange = hasPreviousChange;
+		hasPreviousChange = true;
+		if (baseline.Rate == 0)
+			return Correct(value, (delta > 0) == (resumeRate > 0) ? resumeRate : -resumeRate, time);
+
+		// A timer which turns around (e.g. a countdown going into overtime) keeps its speed in the new direction
+		if ((delta > 0) != (baseline.Rate > 0))
+			return Correct(value, -baseline.Rate, time);
+
+		if (std::fabs(value - Predict(time)) <= threshold)
+			return false;
+
+		// Measure the new rate from the last step the value took
+		auto rate = baseline.Rate;
+		if (hadPreviousChange && lastChange.Time > previousChange.Time)
+			rate = (lastChange.Value - previousChange.Value) / (lastChange.Time - previousChange.Time);
+		return Correct(value, rate, time);
+	}
+
+	double TimerExtrapolator::Predict(double time) const
+	{
+		return baseline.Value + baseline.Rate * (time - baseline.Time);
+	}
+
+	bool TimerExtrapolator::Correct(double value, double rate, double time)
+	{
+		baseline = { value, rate, time };
+		if (rate != 0)
+			resumeRate = rate;
+		return true;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+namespace Web::Ui
+{
+	// Tracks what a UI timer is predicting and decides when it needs to be corrected.
+	//
+	// The UI is given a baseline: a value, the time it was taken at, and how much the value changes per second. It
+	// extrapolates from that on its own. Each engine value is compared against the same prediction, and a new baseline
+	// is only needed when the timer jumps, pauses, resumes, turns around, or drifts further from the prediction than the
+	// threshold. Corrections are taken at the moment the engine value changes, so the UI stays in step with it.
+	class TimerExtrapolator
+	{
+	public:
+		struct Baseline
+		{
+			double Value;
+			double Rate; // Change in value per second, 0 when paused
+			double Time; // In seconds
+		};
+
+		// Creates an extrapolator which corrects the UI when the value gets further than threshold from the prediction.
+		explicit TimerExtrapolator(double threshold = 1.5);
+
+		// Starts predicting from a value.
+		void Start(double value, double rate, double time);
+
+		// Stops predicting. Updates are ignored until Start() is called again.
+		void Stop();
+
+		bool IsRunning() const { return running; }
+
+		// Checks a value from the engine against the prediction. Returns true if the UI needs the new baseline from
+		// GetBaseline().
+		bool Update(double value, double time);
+
+		// Gets the value the UI is predicting at a time.
+		double Predict(double time) const;
+
+		const Baseline &GetBaseline() const { return baseline; }
+
+	private:
+		struct ChangePoint
+		{
+			double Value;
+			double Time;
+		};
+
+		double threshold;
+		bool running;
+		Baseline baseline;
+		double resumeRate;          // The last nonzero rate, used (in the direction the value moves) when the timer resumes after a pause
+		double lastValue;
+		ChangePoint lastChange;     // When the value last changed
+		ChangePoint previousChange; // The change before that, if hasPreviousChange is set
+		bool hasPreviousChange;
+
+		bool Correct(double value, double rate, double time);
+	};
+}
@@ -1,10 +1,9 @@
 #include "VotingScreen.hpp"
 #include "ScreenLayer.hpp"
+#include "VotingState.hpp"
 #include "../../Server/VotingPackets.hpp"
 #include "../../Patches/Network.hpp"
-#include "../../ThirdParty/rapidjson/writer.h"
-#include "../../ThirdParty/rapidjson/stringbuffer.h"
-#include <unordered_map>
+#include "../../Patches/Maps.hpp"
 #include "../../Patches/Input.hpp"
 
 using namespace Server::Voting;
@@ -13,25 +12,14 @@ namespace
 {
 	void OnUiInputUpdate();
 
-	std::unordered_map<int, std::string> MapNames =
-	{
-		{ 320, "guardian" },
-		{ 340, "riverworld" },
-		{ 705, "s3d_avalanche" },
-		{ 703, "s3d_edge" },
-		{ 700, "s3d_reactor" },
-		{ 31, "s3d_turf" },
-		{ 390, "cyberdyne" },
-		{ 380, "chill" },
-		{ 310, "deadlock" },
-		{ 410, "bunkerworld" },
-		{ 400, "shrine" },
-		{ 30, "zanzibar" },
-	};
+	Web::Ui::Voting::VotingStateModel votingState;
 
 	bool currentlyVoting = false;
 	bool temporarilyHidden = false;
 
+	// Map IDs of the current voting options, used to prefetch the winner
+	int votingOptionMapIds[5] = { -1, -1, -1, -1, -1 };
+
 	void OnVotingEnded();
 }
 
@@ -42,117 +30,29 @@ public:
 
 	void MessageReceived(const VotingMessage &message) override
 	{
+		// UI updates are sent from Tick() so that a burst of messages only results in one notification
+		votingState.Apply(message);
+
 		if (message.Type == VotingMessageType::VotingOptions)
 		{
-			rapidjson::StringBuffer jsonBuffer;
-			rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
-			jsonWriter.StartObject();
-
-			jsonWriter.Key("timeRemaining");
-			jsonWriter.Int(message.voteTime);
-			jsonWriter.Key("votingOptions");
-			jsonWriter.StartArray();
-
-			for (int i = 0; i < 5; i++){
-
-				std::string imageName;
-				auto it = MapNames.find(message.votingOptions[i].mapId);
-				if (it != MapNames.end())
-					imageName = it->second;
-
-				jsonWriter.StartObject();
-				jsonWriter.Key("index");
-				jsonWriter.Int(i + 1);
-
-				jsonWriter.Key("image");
-				jsonWriter.String(imageName.c_str());
-				jsonWriter.Key("mapname");
-				jsonWriter.String(message.votingOptions[i].mapName);
-				jsonWriter.Key("typename");
-				jsonWriter.String(message.votingOptions[i].typeName);
+			for (int i = 0; i < 5; i++)
+				votingOptionMapIds[i] = message.votingOptions[i].mapId;
 
-				jsonWriter.EndObject();
-
-			}
-
-			jsonWriter.EndArray();
-			jsonWriter.EndObject();
 			Web::Ui::Voting::Show();
-			Web::Ui::ScreenLayer::Notify("VotingOptionsUpdated", jsonBuffer.GetString(), true);
 			currentlyVoting = true;
 		}
-		else if (message.Type == VotingMessageType::VetoOption) {
-
-			rapidjson::StringBuffer jsonBuffer;
-			rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
-			jsonWriter.StartObject();
-
-			jsonWriter.Key("timeRemaining");
-			jsonWriter.Int(message.voteTime);
-			jsonWriter.Key("votesNeededToPass");
-			jsonWriter.Int(message.votesNeededToPass);
-			jsonWriter.Key("vetoOption");
-			jsonWriter.StartObject();
-
-
-			std::string imageName;
-			auto it = MapNames.find(message.votingOptions[0].mapId);
-			if (it != MapNames.end())
-				imageName = it->second;
-
-
-			jsonWriter.Key("image");
-			jsonWriter.String(imageName.c_str());
-			jsonWriter.Key("mapname");
-			jsonWriter.String(message.votingOptions[0].mapName);
-			jsonWriter.Key("typename");
-			jsonWriter.String(message.votingOptions[0].typeName);
-			jsonWriter.Key("canveto");
-			jsonWriter.Bool(message.votingOptions[0].canVeto);
-
-			jsonWriter.EndObject();
-			jsonWriter.EndObject();
+		else if (message.Type == VotingMessageType::VetoOption)
+		{
 			Web::Ui::Voting::Show();
-			Web::Ui::ScreenLayer::Notify("VetoOptionsUpdated", jsonBuffer.GetString(), true);
 			currentlyVoting = true;
+
+			// The veto option is what will be played unless it gets vetoed, so start loading it now
+			Patches::Maps::PrefetchMap(message.votingOptions[0].mapId);
 		}
 		else if (message.Type == VotingMessageType::Winner)
 		{
-			rapidjson::StringBuffer jsonBuffer;
-			rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
-			jsonWriter.StartObject();
-			jsonWriter.Key("Winner");
-			jsonWriter.Int(message.winner);
-			jsonWriter.Key("timeUntilGameStart");
-			jsonWriter.Int(message.voteTime);
-			jsonWriter.EndObject();
-			Web::Ui::ScreenLayer::Notify("Winner", jsonBuffer.GetString(), true);
-
-		}
-		else if (message.Type == VotingMessageType::VoteTally)
-		{
-			rapidjson::StringBuffer jsonBuffer;
-			rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
-			jsonWriter.StartObject();
-			jsonWriter.Key("votesNeededToPass");
-			jsonWriter.Int(message.votesNeededToPass);
-
-			jsonWriter.Key("voteCounts");
-			jsonWriter.StartArray();
-			for (int i = 0; i < 5; i++){
-				jsonWriter.StartObject();
-				jsonWriter.Key("OptionIndex");
-				jsonWriter.Int(i + 1);
-				jsonWriter.Key("Count");
-				jsonWriter.Int(message.votes[i]);
-				jsonWriter.EndObject();
-
-			}
-
-			jsonWriter.EndArray();
-			jsonWriter.EndObject();
-			Web::Ui::ScreenLayer::Notify("VoteCountsUpdated", jsonBuffer.GetString(), true);
-
+			if (message.winner >= 1 && message.winner <= 5)
+				Patches::Maps::PrefetchMap(votingOptionMapIds[message.winner - 1]);
 		}
 	}
 };
@@ -190,6 +90,15 @@ namespace Web::Ui::Voting
 	{
 		ScreenLayer::Hide("voting");
 	}
+
+	void Tick()
+	{
+		if (!votingState.HasPendingUpdates())
+			return;
+
+		for (auto &&update : votingState.Flush())
+			ScreenLayer::Notify(update.Event, update.Data, true);
+	}
 }
 
 namespace
@@ -233,6 +142,7 @@ namespace
 
 	void OnVotingEnded()
 	{
+		votingState.Reset();
 		currentlyVoting = false;
 		Web::Ui::ScreenLayer::Notify("VoteEnded", "{}", true);
 		Web::Ui::Voting::Hide();
@@ -5,4 +5,5 @@ namespace Web::Ui::Voting
 	void Init();
 	void Show();
 	void Hide();
+	void Tick();
 }
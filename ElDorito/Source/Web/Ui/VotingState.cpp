@@ -0,0 +1,283 @@
+#include "VotingState.hpp"
+#include <cstring>
+#include <unordered_map>
+#include "../../ThirdParty/rapidjson/writer.h"
+#include "../../ThirdParty/rapidjson/stringbuffer.h"
+
+using namespace Server::Voting;
+
+namespace
+{
+	std::unordered_map<int, std::string> MapNames =
+	{
+		{ 320, "guardian" },
+		{ 340, "riverworld" },
+		{ 705, "s3d_avalanche" },
+		{ 703, "s3d_edge" },
+		{ 700, "s3d_reactor" },
+		{ 31, "s3d_turf" },
+		{ 390, "cyberdyne" },
+		{ 380, "chill" },
+		{ 310, "deadlock" },
+		{ 410, "bunkerworld" },
+		{ 400, "shrine" },
+		{ 30, "zanzibar" },
+	};
+
+	const char *GetMapImage(int mapId)
+	{
+		auto it = MapNames.find(mapId);
+		return it != MapNames.end() ? it->second.c_str() : "";
+	}
+
+	bool OptionsEqual(const VotingOption &a, const VotingOption &b)
+	{
+		return a.mapId == b.mapId && a.canVeto == b.canVeto
+			&& strncmp(a.mapName, b.mapName, sizeof(a.mapName)) == 0
+			&& strncmp(a.typeName, b.typeName, sizeof(a.typeName)) == 0;
+	}
+}
+
+namespace Web::Ui::Voting
+{
+	VotingStateModel::VotingStateModel()
+	{
+		Reset();
+	}
+
+	void VotingStateModel::Reset()
+	{
+		shownType = VotingMessageType::Count;
+		memset(options, 0, sizeof(options));
+		memset(counts, 0, sizeof(counts));
+		votesNeededToPass = 0;
+		timeRemaining = 0;
+		winner = 0;
+
+		optionsChanged = false;
+		vetoChanged = false;
+		winnerChanged = false;
+		votesNeededChanged = false;
+		changedCounts = 0;
+	}
+
+	bool VotingStateModel::HasPendingUpdates() const
+	{
+		return optionsChanged || vetoChanged || winnerChanged || votesNeededChanged || changedCounts != 0;
+	}
+
+	void VotingStateModel::Apply(const VotingMessage &message)
+	{
+		switch (message.Type)
+		{
+		case VotingMessageType::VotingOptions:
+			ApplyOptions(message);
+			break;
+		case VotingMessageType::VetoOption:
+			ApplyVetoOption(message);
+			break;
+		case VotingMessageType::VoteTally:
+			ApplyTally(message);
+			break;
+		case VotingMessageType::Winner:
+			if (message.winner == winner && message.voteTime == timeRemaining)
+				break;
+			winner = message.winner;
+			timeRemaining = message.voteTime;
+			winnerChanged = true;
+			break;
+		}
+	}
+
+	bool VotingStateModel::IsShowing(const VotingMessage &message, VotingMessageType type) const
+	{
+		if (shownType != type || message.voteTime != timeRemaining || winner != 0)
+			return false;
+		// The veto screen only shows the first option
+		auto optionCount = type == VotingMessageType::VetoOption ? 1 : MaxOptions;
+		for (auto i = 0; i < MaxOptions; i++)
+		{
+			if (counts[i] != 0 || (i < optionCount && !OptionsEqual(options[i], message.votingOptions[i])))
+				return false;
+		}
+		return true;
+	}
+
+	void VotingStateModel::ApplyOptions(const VotingMessage &message)
+	{
+		// A message that matches what the UI already shows (the same options and time, and no votes or winner that it
+		// would clear) changes nothing. Anything else is passed on, since the UI resets the vote and its timer with it.
+		if (IsShowing(message, VotingMessageType::VotingOptions))
+			return;
+
+		timeRemaining = message.voteTime;
+		memcpy(options, message.votingOptions, sizeof(options));
+		shownType = VotingMessageType::VotingOptions;
+
+		// A new set of options starts from zero votes, the UI resets its counts along with the options
+		memset(counts, 0, sizeof(counts));
+		changedCounts = 0;
+		winner = 0;
+		winnerChanged = false;
+		vetoChanged = false;
+		optionsChanged = true;
+	}
+
+	void VotingStateModel::ApplyVetoOption(const VotingMessage &message)
+	{
+		if (IsShowing(message, VotingMessageType::VetoOption) && message.votesNeededToPass == votesNeededToPass)
+			return;
+
+		timeRemaining = message.voteTime;
+		memset(options, 0, sizeof(options));
+		options[0] = message.votingOptions[0];
+		votesNeededToPass = message.votesNeededToPass;
+		shownType = VotingMessageType::VetoOption;
+
+		memset(counts, 0, sizeof(counts));
+		changedCounts = 0;
+		votesNeededChanged = false;
+		optionsChanged = false;
+		vetoChanged = true;
+	}
+
+	void VotingStateModel::ApplyTally(const VotingMessage &message)
+	{
+		for (auto i = 0; i < MaxOptions; i++)
+		{
+			if (counts[i] == message.votes[i])
+				continue;
+
+			counts[i] = message.votes[i];
+			changedCounts |= 1 << i;
+		}
+
+		if (message.votesNeededToPass != votesNeededToPass)
+		{
+			votesNeededToPass = message.votesNeededToPass;
+			votesNeededChanged = true;
+		}
+	}
+
+	std::vector<VotingUpdate> VotingStateModel::Flush()
+	{
+		std::vector<VotingUpdate> updates;
+		if (!HasPendingUpdates())
+			return updates;
+
+		// Options first: the UI clears its counts when it receives them
+		if (optionsChanged)
+			updates.push_back({ "VotingOptionsUpdated", BuildOptionsJson() });
+		if (vetoChanged)
+			updates.push_back({ "VetoOptionsUpdated", BuildVetoJson() });
+		if (changedCounts != 0 || votesNeededChanged)
+			updates.push_back({ "VoteCountsUpdated", BuildCountsJson() });
+		if (winnerChanged)
+			updates.push_back({ "Winner", BuildWinnerJson() });
+
+		optionsChanged = false;
+		vetoChanged = false;
+		winnerChanged = false;
+		votesNeededChanged = false;
+		changedCounts = 0;
+		return updates;
+	}
+
+	std::string VotingStateModel::BuildOptionsJson() const
+	{
+		rapidjson::StringBuffer jsonBuffer;
+		rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
+		jsonWriter.StartObject();
+
+		jsonWriter.Key("timeRemaining");
+		jsonWriter.Int(timeRemaining);
+		jsonWriter.Key("votingOptions");
+		jsonWriter.StartArray();
+
+		for (auto i = 0; i < MaxOptions; i++)
+		{
+			jsonWriter.StartObject();
+			jsonWriter.Key("index");
+			jsonWriter.Int(i + 1);
+			jsonWriter.Key("image");
+			jsonWriter.String(GetMapImage(options[i].mapId));
+			jsonWriter.Key("mapname");
+			jsonWriter.String(options[i].mapName);
+			jsonWriter.Key("typename");
+			jsonWriter.String(options[i].typeName);
+			jsonWriter.EndObject();
+		}
+
+		jsonWriter.EndArray();
+		jsonWriter.EndObject();
+		return jsonBuffer.GetString();
+	}
+
+	std::string VotingStateModel::BuildVetoJson() const
+	{
+		rapidjson::StringBuffer jsonBuffer;
+		rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
+		jsonWriter.StartObject();
+
+		jsonWriter.Key("timeRemaining");
+		jsonWriter.Int(timeRemaining);
+		jsonWriter.Key("votesNeededToPass");
+		jsonWriter.Int(votesNeededToPass);
+		jsonWriter.Key("vetoOption");
+		jsonWriter.StartObject();
+		jsonWriter.Key("image");
+		jsonWriter.String(GetMapImage(options[0].mapId));
+		jsonWriter.Key("mapname");
+		jsonWriter.String(options[0].mapName);
+		jsonWriter.Key("typename");
+		jsonWriter.String(options[0].typeName);
+		jsonWriter.Key("canveto");
+		jsonWriter.Bool(options[0].canVeto);
+		jsonWriter.EndObject();
+
+		jsonWriter.EndObject();
+		return jsonBuffer.GetString();
+	}
+
+	std::string VotingStateModel::BuildCountsJson() const
+	{
+		rapidjson::StringBuffer jsonBuffer;
+		rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
+		jsonWriter.StartObject();
+		jsonWriter.Key("votesNeededToPass");
+		jsonWriter.Int(votesNeededToPass);
+
+		// Only the options whose count changed, the UI updates them by index
+		jsonWriter.Key("voteCounts");
+		jsonWriter.StartArray();
+		for (auto i = 0; i < MaxOptions; i++)
+		{
+			if (!(changedCounts & (1 << i)))
+				continue;
+
+			jsonWriter.StartObject();
+			jsonWriter.Key("OptionIndex");
+			jsonWriter.Int(i + 1);
+			jsonWriter.Key("Count");
+			jsonWriter.Int(counts[i]);
+			jsonWriter.EndObject();
+		}
+		jsonWriter.EndArray();
+
+		jsonWriter.EndObject();
+		return jsonBuffer.GetString();
+	}
+
+	std::string VotingStateModel::BuildWinnerJson() const
+	{
+		rapidjson::StringBuffer jsonBuffer;
+		rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
+		jsonWriter.StartObject();
+		jsonWriter.Key("Winner");
+		jsonWriter.Int(winner);
+		jsonWriter.Key("timeUntilGameStart");
+		jsonWriter.Int(timeRemaining);
+		jsonWriter.EndObject();
+		return jsonBuffer.GetString();
+	}
+}
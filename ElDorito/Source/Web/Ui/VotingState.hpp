@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../Server/VotingMessage.hpp"
+
+namespace Web::Ui::Voting
+{
+	// A UI notification produced by the voting state model.
+	struct VotingUpdate
+	{
+		std::string Event;
+		std::string Data;
+	};
+
+	// Client-side copy of the voting state.
+	//
+	// Incoming voting messages are applied to the model, which works out what actually changed.
+	// Changes are held until Flush() so that any number of messages received in a frame
+	// turn into at most one notification per event type. The notifications have the same format
+	// the voting screen always received, but a VoteCountsUpdated only lists the options whose
+	// count changed, and messages that don't change anything (e.g. options re-sent unchanged) are dropped.
+	class VotingStateModel
+	{
+	public:
+		static const int MaxOptions = 5;
+
+		VotingStateModel();
+
+		void Apply(const Server::Voting::VotingMessage &message);
+
+		// Returns the notifications for everything that changed since the last flush, in the order the UI expects them.
+		std::vector<VotingUpdate> Flush();
+
+		void Reset();
+
+		bool HasPendingUpdates() const;
+
+	private:
+		void ApplyOptions(const Server::Voting::VotingMessage &message);
+		void ApplyVetoOption(const Server::Voting::VotingMessage &message);
+		void ApplyTally(const Server::Voting::VotingMessage &message);
+		bool IsShowing(const Server::Voting::VotingMessage &message, Server::Voting::VotingMessageType type) const;
+
+		std::string BuildOptionsJson() const;
+		std::string BuildVetoJson() const;
+		std::string BuildCountsJson() const;
+		std::string BuildWinnerJson() const;
+
+		Server::Voting::VotingMessageType shownType; // VotingOptions or VetoOption, or Count before either arrives
+		Server::Voting::VotingOption options[MaxOptions];
+		int counts[MaxOptions];
+		int votesNeededToPass;
+		int timeRemaining;
+		int winner;
+
+		bool optionsChanged;
+		bool vetoChanged;
+		bool winnerChanged;
+		bool votesNeededChanged;
+		uint32_t changedCounts; // Bit per option
+	};
+}
@@ -12,7 +12,7 @@ namespace
 	class WebConsoleOutputHandler : public Console::ConsoleOutputHandler
 	{
 	public:
-		void WriteLine(const std::string &line) override;
+		void WriteRecords(const std::vector<const Console::OutputRecord*> &records) override;
 	};
 
 	void OnGameInputUpdated();
@@ -39,18 +39,42 @@ namespace Web::Ui::WebConsole
 
 namespace
 {
-	void WebConsoleOutputHandler::WriteLine(const std::string &line)
+	const char *LevelToString(Console::OutputLevel level)
 	{
-		// Create a JSON object with the line
+		switch (level)
+		{
+		case Console::OutputLevel::Trace:
+			return "trace";
+		case Console::OutputLevel::Warning:
+			return "warning";
+		case Console::OutputLevel::Error:
+			return "error";
+		default:
+			return "info";
+		}
+	}
+
+	void WebConsoleOutputHandler::WriteRecords(const std::vector<const Console::OutputRecord*> &records)
+	{
+		// The console screen still expects one event per line, but reuse the buffer across the batch
 		rapidjson::StringBuffer jsonBuffer;
-		rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
-		jsonWriter.StartObject();
-		jsonWriter.Key("line");
-		jsonWriter.String(line.c_str());
-		jsonWriter.EndObject();
-
-		// Broadcast a "console" event to all screens
-		Web::Ui::ScreenLayer::Notify("console", jsonBuffer.GetString(), true);
+		for (auto record : records)
+		{
+			// Create a JSON object with the line
+			jsonBuffer.Clear();
+			rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
+			jsonWriter.StartObject();
+			jsonWriter.Key("line");
+			jsonWriter.String(record->Text.c_str());
+			jsonWriter.Key("level");
+			jsonWriter.String(LevelToString(record->Level));
+			jsonWriter.Key("module");
+			jsonWriter.String(record->Module.c_str());
+			jsonWriter.EndObject();
+
+			// Broadcast a "console" event to all screens
+			Web::Ui::ScreenLayer::Notify("console", jsonBuffer.GetString(), true);
+		}
 	}
 
 	void OnGameInputUpdated()
@@ -1,24 +1,29 @@
 #include "WebLoadingScreen.hpp"
 #include "../../Patches/LoadingScreen.hpp"
+#include "../../Utils/Logger.hpp"
 #include "ScreenLayer.hpp"
+#include "LoadProgressTracker.hpp"
 #include "../../ThirdParty/rapidjson/stringbuffer.h"
 #include "../../ThirdParty/rapidjson/writer.h"
 #include <chrono>
+#include <cstdio>
 
 using namespace Web::Ui;
 
 namespace
 {
-	const auto kUpdateRatMs = 75;
+	// Progress updates wake the renderer, so keep them infrequent while the game is busy loading
+	const auto kUpdateRate = std::chrono::milliseconds(250);
+
+	// Per-map load times, used to estimate how long the next load will take
+	const auto kLoadHistoryPath = "load_times.json";
 
 	class WebLoadingScreenUi : public Patches::LoadingScreen::LoadingScreenUi
 	{
-		uint32_t currentBytes;
-		uint32_t totalBytes;
-		std::chrono::time_point<std::chrono::steady_clock> lastUpdateTime;
+		LoadProgressTracker tracker;
 
 	public:
-		WebLoadingScreenUi() : currentBytes(0), totalBytes(0) { }
+		WebLoadingScreenUi() { tracker.LoadHistory(kLoadHistoryPath); }
 
 		void Show(const std::string &mapPath) override;
 		void Begin(uint32_t totalBytes) override;
@@ -54,42 +59,44 @@ namespace
 
 		// Show the "loading" screen
 		ScreenLayer::Show("loading", jsonBuffer.GetString());
+
+		tracker.Show(mapName);
 	}
 
 	void WebLoadingScreenUi::Begin(uint32_t totalBytes)
 	{
-		currentBytes = 0;
-		this->totalBytes = totalBytes;
-		lastUpdateTime = std::chrono::steady_clock::now();
+		tracker.Begin(totalBytes);
 	}
 
 	void WebLoadingScreenUi::UpdateProgress(uint32_t bytes)
 	{
-		currentBytes += bytes;
-
-		auto currentTime = std::chrono::steady_clock::now();
-		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - lastUpdateTime).count();
-		if (elapsed < kUpdateRatMs)
+		tracker.UpdateProgress(bytes);
+		if (!tracker.ShouldNotify(kUpdateRate))
 			return;
 
-		lastUpdateTime = currentTime;
-
-		// Build a JSON object with the progress data
-		rapidjson::StringBuffer jsonBuffer;
-		rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
-		jsonWriter.StartObject();
-		jsonWriter.Key("currentBytes");
-		jsonWriter.Int64(currentBytes);
-		jsonWriter.Key("totalBytes");
-		jsonWriter.Int64(totalBytes);
-		jsonWriter.EndObject();
+		// The payload is fixed-shape, so format it directly instead of going through a JSON writer
+		char json[96];
+		sprintf_s(json, "{\"currentBytes\":%u,\"totalBytes\":%u,\"eta\":%lld}",
+			tracker.GetCurrentBytes(), tracker.GetTotalBytes(), tracker.GetEtaMs());
 
 		// Send a loadprogress event to visible screens only
-		ScreenLayer::Notify("loadprogress", jsonBuffer.GetString(), false);
+		ScreenLayer::Notify("loadprogress", json, false);
 	}
 
 	void WebLoadingScreenUi::Hide()
 	{
 		ScreenLayer::Hide("loading");
+
+		tracker.Hide();
+		if (tracker.GetMapName().empty())
+			return;
+
+		Utils::Logger::Instance().Log(Utils::LogTypes::Game, Utils::LogLevel::Info,
+			"Loaded %s (%u bytes) in %.2fs: preparing %.2fs, loading %.2fs, finishing %.2fs",
+			tracker.GetMapName().c_str(), tracker.GetTotalBytes(), tracker.GetTotalSeconds(),
+			tracker.GetPhaseSeconds(LoadProgressTracker::Phase::Preparing),
+			tracker.GetPhaseSeconds(LoadProgressTracker::Phase::Loading),
+			tracker.GetPhaseSeconds(LoadProgressTracker::Phase::Finishing));
+		tracker.SaveHistory(kLoadHistoryPath);
 	}
 }
\ No newline at end of file
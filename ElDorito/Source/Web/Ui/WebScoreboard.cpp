@@ -13,6 +13,7 @@
 #include "../../ThirdParty/rapidjson/writer.h"
 #include "../../ThirdParty/rapidjson/stringbuffer.h"
 #include "../../Utils/String.hpp"
+#include "../../Utils/Unicode.hpp"
 #include "../../ElDorito.hpp"
 
 #include <iomanip>
@@ -358,10 +359,11 @@ namespace
 
 			writer.StartObject();
 			// Player information
+			char name[Utils::Unicode::Utf8Size<16>::Value], serviceTag[Utils::Unicode::Utf8Size<6>::Value];
 			writer.Key("name");
-			writer.String(Utils::String::ThinString(player.Properties.DisplayName).c_str());
+			writer.String(name, Utils::Unicode::Utf16ToUtf8(player.Properties.DisplayName, name));
 			writer.Key("serviceTag");
-			writer.String(Utils::String::ThinString(player.Properties.ServiceTag).c_str());
+			writer.String(serviceTag, Utils::Unicode::Utf16ToUtf8(player.Properties.ServiceTag, serviceTag));
 			writer.Key("team");
 			writer.Int(player.Properties.TeamIndex);
 			char buff[17];
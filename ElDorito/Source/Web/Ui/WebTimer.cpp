@@ -1,16 +1,26 @@
 #include "WebTimer.hpp"
+#include "TimerExtrapolator.hpp"
 #include "../../ThirdParty/rapidjson/writer.h"
 #include "../../ThirdParty/rapidjson/stringbuffer.h"
+#include <chrono>
 #include <ctime>
 #include "ScreenLayer.hpp"
-#include "../../Blam/BlamPlayers.hpp"
-#include "../../Blam/BlamTime.hpp"
-#include "../../Pointer.hpp"
+
+namespace
+{
+	Web::Ui::TimerExtrapolator Timer;
+
+	double GetTimestamp();
+	int64_t ToUnixMilliseconds(double timestamp);
+	void WriteBaseline(rapidjson::Writer<rapidjson::StringBuffer> &jsonWriter, const Web::Ui::TimerExtrapolator::Baseline &baseline);
+}
 
 namespace Web::Ui
 {
-	void WebTimer::Start(const std::string& type, int initialValue)
+	void WebTimer::Start(const std::string& type, int initialValue, float rate)
 	{
+		Timer.Start(initialValue, rate, GetTimestamp());
+
 		rapidjson::StringBuffer jsonBuffer;
 		rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
 
@@ -19,8 +29,7 @@ namespace Web::Ui
 		jsonWriter.String(type.c_str());
 		jsonWriter.Key("startTime");
 		jsonWriter.Int64(_time64(0));
-		jsonWriter.Key("value");
-		jsonWriter.Int(initialValue);
+		WriteBaseline(jsonWriter, Timer.GetBaseline());
 		jsonWriter.EndObject();
 
 		Web::Ui::ScreenLayer::Notify("timerStart", jsonBuffer.GetString(), true);
@@ -28,12 +37,15 @@ namespace Web::Ui
 
 	void WebTimer::Update(int value)
 	{
+		// The UI extrapolates the value by itself, so only correct it if it's wrong
+		if (!Timer.Update(value, GetTimestamp()))
+			return;
+
 		rapidjson::StringBuffer jsonBuffer;
 		rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
 
 		jsonWriter.StartObject();
-		jsonWriter.Key("value");
-		jsonWriter.Int(value);
+		WriteBaseline(jsonWriter, Timer.GetBaseline());
 		jsonWriter.EndObject();
 
 		Web::Ui::ScreenLayer::Notify("timerUpdate", jsonBuffer.GetString(), true);
@@ -41,9 +53,34 @@ namespace Web::Ui
 
 	void WebTimer::End()
 	{
-		rapidjson::StringBuffer jsonBuffer;
-		rapidjson::Writer<rapidjson::StringBuffer> jsonWriter(jsonBuffer);
-
+		Timer.Stop();
 		Web::Ui::ScreenLayer::Notify("timerEnd", "{}", true);
 	}
 }
+
+namespace
+{
+	// Seconds on a monotonic clock, so that the timer isn't thrown off if the system clock changes
+	double GetTimestamp()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Converts a monotonic timestamp into the same moment on the system clock, which the UI can compare with Date.now()
+	int64_t ToUnixMilliseconds(double timestamp)
+	{
+		auto age = std::chrono::duration<double>(GetTimestamp() - timestamp);
+		auto time = std::chrono::system_clock::now() - std::chrono::duration_cast<std::chrono::system_clock::duration>(age);
+		return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+	}
+
+	void WriteBaseline(rapidjson::Writer<rapidjson::StringBuffer> &jsonWriter, const Web::Ui::TimerExtrapolator::Baseline &baseline)
+	{
+		jsonWriter.Key("value");
+		jsonWriter.Double(baseline.Value);
+		jsonWriter.Key("rate");
+		jsonWriter.Double(baseline.Rate);
+		jsonWriter.Key("timestamp");
+		jsonWriter.Int64(ToUnixMilliseconds(baseline.Time));
+	}
+}
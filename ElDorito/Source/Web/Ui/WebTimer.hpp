@@ -1,9 +1,18 @@
 #pragma once
 #include <string>
 
+// Timer messages carry a value, the rate it changes at per second, and the time the value was taken at as a Unix
+// timestamp in milliseconds. The UI extrapolates from the latest message with value + rate * (Date.now() - timestamp)
+// / 1000.
 namespace Web::Ui::WebTimer
 {
-	void Start(const std::string& type, int initialValue);
+	// Starts a timer and sends "timerStart".
+	void Start(const std::string& type, int initialValue, float rate);
+
+	// Passes the timer's current value from the engine. A "timerUpdate" is only sent if the UI's prediction is off,
+	// or the timer paused or jumped.
 	void Update(int value);
+
+	// Stops the timer and sends "timerEnd".
 	void End();
 }
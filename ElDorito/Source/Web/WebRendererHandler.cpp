@@ -62,6 +62,9 @@ void WebRendererHandler::OnAfterCreated(CefRefPtr<CefBrowser> p_Browser)
 		m_QueryHandler->AddMethod("forgeaction", Bridge::ClientFunctions::OnForgeAction);
 		m_QueryHandler->AddMethod("showlan", Bridge::ClientFunctions::OnShowLan);
 		m_QueryHandler->AddMethod("discord-reply", Bridge::ClientFunctions::OnDiscordReply);
+		m_QueryHandler->AddMethod("mpeventSubscribe", Bridge::ClientFunctions::OnMpEventSubscribe);
+		m_QueryHandler->AddMethod("mpeventUnsubscribe", Bridge::ClientFunctions::OnMpEventUnsubscribe);
+		m_QueryHandler->AddMethod("medalPacks", Bridge::ClientFunctions::OnMedalPacks);
 
 		m_BrowserRouter->AddHandler(m_QueryHandler.get(), true);
 	}
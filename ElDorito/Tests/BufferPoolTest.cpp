@@ -0,0 +1,117 @@
+#include "Test.hpp"
+#include "../Source/Utils/BufferPool.hpp"
+#include "../Source/Utils/Sha1.hpp"
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <openssl/sha.h>
+
+namespace
+{
+	void TestReuse()
+	{
+		// A freed buffer is handed out again for any size in the same class
+		auto buffer = Utils::BufferPool::Allocate(300);
+		Utils::BufferPool::Free(buffer, 300);
+		CHECK(Utils::BufferPool::Allocate(500) == buffer);
+		Utils::BufferPool::Free(buffer, 500);
+
+		// Sizes above the limit aren't pooled but still work
+		auto large = static_cast<char*>(Utils::BufferPool::Allocate(Utils::BufferPool::MaxPooledSize + 1));
+		memset(large, 0xAA, Utils::BufferPool::MaxPooledSize + 1);
+		Utils::BufferPool::Free(large, Utils::BufferPool::MaxPooledSize + 1);
+		Utils::BufferPool::Free(nullptr, 100);
+	}
+
+	// Fills live buffers with a pattern and checks nothing else wrote over them
+	void TestNoOverlap()
+	{
+		struct Live
+		{
+			uint8_t *Buffer;
+			size_t Size;
+			uint8_t Fill;
+		};
+
+		std::mt19937 random(3);
+		std::vector<Live> live;
+		for (auto i = 0; i < 20000; i++)
+		{
+			if (!live.empty() && random() % 2 == 0)
+			{
+				auto index = random() % live.size();
+				auto &entry = live[index];
+				for (size_t j = 0; j < entry.Size; j++)
+				{
+					if (entry.Buffer[j] != entry.Fill)
+					{
+						CHECK(!"A live buffer was overwritten");
+						break;
+					}
+				}
+				Utils::BufferPool::Free(entry.Buffer, entry.Size);
+				live.erase(live.begin() + index);
+			}
+			else
+			{
+				auto size = 1 + random() % (Utils::BufferPool::MaxPooledSize + 1024);
+				auto fill = static_cast<uint8_t>(i);
+				auto buffer = static_cast<uint8_t*>(Utils::BufferPool::Allocate(size));
+				memset(buffer, fill, size);
+				live.push_back({ buffer, size, fill });
+			}
+		}
+		for (auto &&entry : live)
+			Utils::BufferPool::Free(entry.Buffer, entry.Size);
+	}
+
+	// Buffers freed on another thread go into that thread's cache
+	void TestCrossThreadFree()
+	{
+		std::vector<void*> buffers;
+		for (auto i = 0; i < 4; i++)
+			buffers.push_back(Utils::BufferPool::Allocate(1000));
+
+		std::thread([&]
+		{
+			for (auto buffer : buffers)
+				Utils::BufferPool::Free(buffer, 1000);
+			auto reused = Utils::BufferPool::Allocate(1000);
+			CHECK(reused == buffers.back());
+			Utils::BufferPool::Free(reused, 1000);
+		}).join();
+	}
+
+	uint32_t OpenSslHash32(const std::string &data)
+	{
+		unsigned char digest[SHA_DIGEST_LENGTH];
+		SHA1(reinterpret_cast<const unsigned char*>(data.data()), data.length(), digest);
+		return static_cast<uint32_t>(digest[0]) << 24 | digest[1] << 16 | digest[2] << 8 | digest[3];
+	}
+
+	void TestSha1()
+	{
+		static_assert(Utils::Sha1::Hash32("eldewrito-player-uid") != 0, "Not usable at compile time");
+
+		// Lengths around the block and padding boundaries
+		std::mt19937 random(11);
+		for (size_t length = 0; length < 200; length++)
+		{
+			std::string data(length, '\0');
+			for (auto &ch : data)
+				ch = static_cast<char>(random());
+			CHECK(Utils::Sha1::Hash32(data.data(), data.length()) == OpenSslHash32(data));
+		}
+	}
+}
+
+int main()
+{
+	TestReuse();
+	TestNoOverlap();
+	TestCrossThreadFree();
+	TestSha1();
+	return TEST_RESULT();
+}
@@ -0,0 +1,141 @@
+#include "Test.hpp"
+#include "../Source/Utils/CameraPath.hpp"
+#include <cmath>
+
+using namespace Utils::CameraPath;
+using Blam::Math::RealPoint3D;
+
+namespace
+{
+	bool Near(float a, float b, float tolerance = 1e-3f)
+	{
+		return std::fabs(a - b) <= tolerance;
+	}
+
+	Keyframe MakeKeyframe(float x, float y, float z, float yaw = 0)
+	{
+		Keyframe keyframe;
+		keyframe.Position = RealPoint3D(x, y, z);
+		keyframe.Yaw = yaw;
+		keyframe.Fov = 1.f;
+		return keyframe;
+	}
+
+	void TestStraightLine()
+	{
+		// Keyframes spaced unevenly along a line, so the spline has to stay on it
+		Path path;
+		path.Add(MakeKeyframe(0, 0, 0));
+		path.Add(MakeKeyframe(1, 0, 0));
+		path.Add(MakeKeyframe(5, 0, 0));
+		path.Add(MakeKeyframe(6, 0, 0));
+		CHECK(Near(path.GetLength(), 6.f, 1e-2f));
+
+		// Constant speed: equal distances along the path are equal distances along the line
+		for (auto distance = 0.f; distance <= 6.f; distance += 0.5f)
+		{
+			auto sample = path.Sample(distance);
+			CHECK(Near(sample.Position.X, distance, 2e-2f));
+			CHECK(Near(sample.Position.Y, 0.f));
+		}
+
+		// Samples are clamped to the ends
+		CHECK(Near(path.Sample(-1.f).Position.X, 0.f));
+		CHECK(Near(path.Sample(100.f).Position.X, 6.f));
+	}
+
+	void TestPassesThroughKeyframes()
+	{
+		Path path;
+		path.Add(MakeKeyframe(0, 0, 0));
+		path.Add(MakeKeyframe(3, 4, 0));
+		path.Add(MakeKeyframe(3, 4, 0)); // Duplicate positions mustn't break anything
+		path.Add(MakeKeyframe(-2, 1, 7));
+		path.Add(MakeKeyframe(10, -3, 2));
+		for (size_t i = 0; i < path.GetKeyframes().size(); i++)
+		{
+			auto keyframe = path.Evaluate(static_cast<float>(i));
+			auto &expected = path.GetKeyframes()[i];
+			CHECK(Near(keyframe.Position.X, expected.Position.X));
+			CHECK(Near(keyframe.Position.Y, expected.Position.Y));
+			CHECK(Near(keyframe.Position.Z, expected.Position.Z));
+		}
+		CHECK(std::isfinite(path.GetLength()));
+		CHECK(path.GetLength() > 0);
+	}
+
+	void TestYawUnwrap()
+	{
+		// 350 degrees to 10 degrees turns 20 degrees, not 340 the other way
+		Path path;
+		path.Add(MakeKeyframe(0, 0, 0, 350.f * 3.14159265f / 180.f));
+		path.Add(MakeKeyframe(1, 0, 0, 10.f * 3.14159265f / 180.f));
+		auto &keyframes = path.GetKeyframes();
+		CHECK(Near(keyframes[1].Yaw - keyframes[0].Yaw, 20.f * 3.14159265f / 180.f));
+	}
+
+	void TestPlayer()
+	{
+		Path path;
+		path.Add(MakeKeyframe(0, 0, 0));
+		path.Add(MakeKeyframe(10, 0, 0));
+
+		Player player;
+		player.Start(4.f);
+		CHECK(player.IsPlaying());
+		CHECK(Near(player.Advance(path, 1.f).Position.X, 4.f, 2e-2f));
+		CHECK(Near(player.Advance(path, 1.f).Position.X, 8.f, 2e-2f));
+		CHECK(Near(player.Advance(path, 1.f).Position.X, 10.f));
+		CHECK(!player.IsPlaying());
+	}
+
+	void TestSerialize()
+	{
+		Path path;
+		path.Add(MakeKeyframe(1.5f, -2.25f, 3, 0.5f));
+		path.Add(MakeKeyframe(4, 5, 6, 1.f));
+
+		Path loaded;
+		std::string error;
+		CHECK(Deserialize(Serialize(path), &loaded, &error));
+		CHECK(loaded.GetKeyframes().size() == 2);
+		CHECK(Near(loaded.GetKeyframes()[0].Position.Y, -2.25f));
+		CHECK(Near(loaded.GetKeyframes()[1].Yaw, 1.f));
+
+		CHECK(!Deserialize("{", &loaded, &error));
+		CHECK(!error.empty());
+		CHECK(!Deserialize("{ \"keyframes\": [ { \"position\": [ 1, 2 ], \"yaw\": 0, \"pitch\": 0, \"fov\": 1 } ] }", &loaded, &error));
+		CHECK(loaded.GetKeyframes().size() == 2);
+	}
+
+	void TestNames()
+	{
+		CHECK(IsValidName("flyby"));
+		CHECK(IsValidName("guardian intro-2"));
+		CHECK(IsValidName("v1.2"));
+
+		CHECK(!IsValidName(""));
+		CHECK(!IsValidName("."));
+		CHECK(!IsValidName(".."));
+		CHECK(!IsValidName("../dewrito_prefs"));
+		CHECK(!IsValidName("..\\..\\dewrito_prefs"));
+		CHECK(!IsValidName("sub/path"));
+		CHECK(!IsValidName("C:evil"));
+		CHECK(!IsValidName("C:\\Windows\\evil"));
+		CHECK(!IsValidName("/etc/passwd"));
+		CHECK(!IsValidName("name."));
+		CHECK(!IsValidName("name "));
+		CHECK(!IsValidName(std::string("a\0b", 3)));
+	}
+}
+
+int main()
+{
+	TestStraightLine();
+	TestPassesThroughKeyframes();
+	TestYawUnwrap();
+	TestPlayer();
+	TestSerialize();
+	TestNames();
+	return TEST_RESULT();
+}
@@ -0,0 +1,258 @@
+#include "Test.hpp"
+#include "../Source/Server/ChatBatch.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace Server::Chat;
+
+namespace
+{
+	ChatMessage MakeMessage(ChatMessageType type, int sender, int target, const std::string &body)
+	{
+		ChatMessage message(type, body);
+		message.SenderPlayer = static_cast<uint8_t>(sender);
+		message.TargetPlayer = static_cast<uint8_t>(target);
+		return message;
+	}
+
+	bool SameMessage(const ChatMessage &a, const ChatMessage &b)
+	{
+		if (a.Type != b.Type || strcmp(a.Body, b.Body) != 0)
+			return false;
+		if (a.Type != ChatMessageType::Server && a.SenderPlayer != b.SenderPlayer)
+			return false;
+		return a.Type != ChatMessageType::Whisper || a.TargetPlayer == b.TargetPlayer;
+	}
+
+	std::vector<ChatMessage> Read(const ChatBatch &batch, bool *valid = nullptr)
+	{
+		std::vector<ChatMessage> result;
+		auto ok = ReadChatBatch(batch, [&](const ChatMessage &message) { result.push_back(message); });
+		if (valid)
+			*valid = ok;
+		return result;
+	}
+
+	void TestRoundTrip()
+	{
+		std::vector<ChatMessage> messages =
+		{
+			MakeMessage(ChatMessageType::Global, 3, 0, "hello"),
+			MakeMessage(ChatMessageType::Team, 15, 0, "go left"),
+			MakeMessage(ChatMessageType::Whisper, 1, 2, "psst"),
+			MakeMessage(ChatMessageType::Server, 0, 0, "Welcome!"),
+			MakeMessage(ChatMessageType::Global, 4, 0, "hello"),
+			MakeMessage(ChatMessageType::Global, 5, 0, ""),
+			MakeMessage(ChatMessageType::Global, 6, 0, std::string(200, 'x')), // Truncated to MaxMessageLength
+		};
+		CHECK(strlen(messages.back().Body) == MaxMessageLength);
+
+		for (auto dedup : { false, true })
+		{
+			ChatBatchWriter writer(dedup);
+			CHECK(writer.Empty());
+			for (auto &&message : messages)
+				CHECK(writer.Add(message));
+			CHECK(!writer.Empty());
+
+			bool valid;
+			auto read = Read(writer.GetBatch(), &valid);
+			CHECK(valid);
+			CHECK(read.size() == messages.size());
+			for (size_t i = 0; i < read.size() && i < messages.size(); i++)
+				CHECK(SameMessage(read[i], messages[i]));
+
+			writer.Reset();
+			CHECK(writer.Empty());
+			CHECK(writer.GetBatch().Size == 0);
+		}
+
+		// The repeated "hello" is a one-byte reference with dedup on
+		ChatBatchWriter plain(false), dedup(true);
+		for (auto &&message : messages)
+		{
+			plain.Add(message);
+			dedup.Add(message);
+		}
+		CHECK(static_cast<size_t>(plain.GetBatch().Size - dedup.GetBatch().Size) == strlen("hello"));
+	}
+
+	void TestSizeLimits()
+	{
+		// Full-length messages fill the batch by size
+		ChatBatchWriter writer(false);
+		auto longMessage = MakeMessage(ChatMessageType::Global, 1, 0, std::string(MaxMessageLength, 'a'));
+		size_t count = 0;
+		while (writer.Add(longMessage))
+			count++;
+		CHECK(count == MaxBatchSize / (MaxMessageLength + 3));
+		CHECK(writer.GetBatch().Size <= MaxBatchSize);
+		CHECK(Read(writer.GetBatch()).size() == count);
+
+		// Tiny messages run into the message limit first
+		writer.Reset();
+		auto shortMessage = MakeMessage(ChatMessageType::Server, 0, 0, "");
+		count = 0;
+		while (writer.Add(shortMessage))
+			count++;
+		CHECK(count == MaxBatchMessages);
+		CHECK(Read(writer.GetBatch()).size() == MaxBatchMessages);
+	}
+
+	void TestMalformed()
+	{
+		ChatBatchWriter writer(true);
+		writer.Add(MakeMessage(ChatMessageType::Global, 3, 0, "first"));
+		writer.Add(MakeMessage(ChatMessageType::Global, 4, 0, "first"));
+		auto good = writer.GetBatch();
+
+		// Truncating the batch anywhere inside a message keeps the messages before it
+		const uint16_t firstSize = 3 + 5;
+		for (uint16_t size = 1; size < good.Size; size++)
+		{
+			if (size == firstSize)
+				continue; // Ends cleanly after the first message
+			auto batch = good;
+			batch.Size = size;
+			bool valid;
+			auto read = Read(batch, &valid);
+			CHECK(!valid);
+			CHECK(read.size() == (size < firstSize ? 0U : 1U));
+		}
+
+		auto batch = good;
+		batch.Data[0] = static_cast<uint8_t>(ChatMessageType::Count);
+		CHECK(!ReadChatBatch(batch, [](const ChatMessage&) { }));
+
+		batch = good;
+		batch.Data[1] = MaxChatPlayers; // Sender out of range
+		CHECK(!ReadChatBatch(batch, [](const ChatMessage&) { }));
+
+		batch = good;
+		batch.Data[2] = MaxMessageLength + 1; // Body too long
+		CHECK(!ReadChatBatch(batch, [](const ChatMessage&) { }));
+
+		// A reference to itself or a later message
+		batch = good;
+		batch.Data[batch.Size - 1] = 1;
+		bool valid;
+		CHECK(Read(batch, &valid).size() == 1);
+		CHECK(!valid);
+
+		batch = good;
+		batch.Size = MaxBatchSize + 1;
+		CHECK(!ReadChatBatch(batch, [](const ChatMessage&) { }));
+	}
+
+	// What a flush delivered to each peer, in order
+	struct Delivery
+	{
+		std::map<int, std::vector<ChatMessage>> Messages;
+		std::map<int, int> Batches;
+		std::map<int, int> Singles;
+	};
+
+	Delivery Flush(ChatOutbox &outbox, PeerBitSet batchPeers)
+	{
+		Delivery result;
+		outbox.Flush(true, batchPeers, [&](int peer, const ChatBatch &batch)
+		{
+			CHECK(batch.Size <= MaxBatchSize);
+			result.Batches[peer]++;
+			bool valid;
+			auto read = Read(batch, &valid);
+			CHECK(valid);
+			auto &messages = result.Messages[peer];
+			messages.insert(messages.end(), read.begin(), read.end());
+		}, [&](int peer, const ChatMessage &message)
+		{
+			result.Singles[peer]++;
+			result.Messages[peer].push_back(message);
+		});
+		return result;
+	}
+
+	void TestOutbox()
+	{
+		// Team chat goes to peers 1-3, everything else to everyone
+		PeerBitSet everyone, team;
+		for (auto peer = 1; peer < 8; peer++)
+			everyone.set(peer);
+		team.set(1).set(2).set(3);
+
+		std::vector<ChatMessage> messages;
+		std::vector<PeerBitSet> peers;
+		for (auto i = 0; i < 20; i++)
+		{
+			auto isTeam = i % 3 == 0;
+			messages.push_back(MakeMessage(isTeam ? ChatMessageType::Team : ChatMessageType::Global, i % 16, 0,
+				"message " + std::to_string(i)));
+			peers.push_back(isTeam ? team : everyone);
+		}
+
+		// Peers 2 and 5 don't support batches
+		PeerBitSet batchPeers;
+		batchPeers.set();
+		batchPeers.reset(2).reset(5);
+
+		ChatOutbox outbox;
+		CHECK(outbox.Empty());
+		outbox.Queue(messages[0], PeerBitSet()); // Nobody to send to
+		CHECK(outbox.Empty());
+		for (size_t i = 0; i < messages.size(); i++)
+			outbox.Queue(messages[i], peers[i]);
+		CHECK(!outbox.Empty());
+
+		auto delivery = Flush(outbox, batchPeers);
+		CHECK(outbox.Empty());
+		CHECK(!delivery.Messages.count(0));
+		for (auto peer = 1; peer < 8; peer++)
+		{
+			std::vector<ChatMessage> expected;
+			for (size_t i = 0; i < messages.size(); i++)
+			{
+				if (peers[i][peer])
+					expected.push_back(messages[i]);
+			}
+
+			auto &received = delivery.Messages[peer];
+			CHECK(received.size() == expected.size());
+			for (size_t i = 0; i < received.size() && i < expected.size(); i++)
+				CHECK(SameMessage(received[i], expected[i]));
+
+			if (batchPeers[peer])
+			{
+				CHECK(delivery.Batches[peer] == 1);
+				CHECK(!delivery.Singles.count(peer));
+			}
+			else
+			{
+				CHECK(!delivery.Batches.count(peer));
+				CHECK(delivery.Singles[peer] == static_cast<int>(expected.size()));
+			}
+		}
+
+		// Flushing an empty outbox sends nothing
+		CHECK(Flush(outbox, batchPeers).Messages.empty());
+
+		// More than fits in one batch is split, still in order
+		for (auto i = 0; i < 50; i++)
+			outbox.Queue(MakeMessage(ChatMessageType::Global, 1, 0, std::to_string(i) + std::string(100, 'z')), everyone);
+		delivery = Flush(outbox, batchPeers);
+		CHECK(delivery.Batches[1] > 1);
+		CHECK(delivery.Messages[1].size() == 50);
+		for (auto i = 0; i < 50 && i < static_cast<int>(delivery.Messages[1].size()); i++)
+			CHECK(std::string(delivery.Messages[1][i].Body) == std::to_string(i) + std::string(100, 'z'));
+		CHECK(delivery.Singles[2] == 50);
+	}
+}
+
+int main()
+{
+	TestRoundTrip();
+	TestSizeLimits();
+	TestMalformed();
+	TestOutbox();
+	return TEST_RESULT();
+}
@@ -0,0 +1,163 @@
+#include "Test.hpp"
+#include "../Source/Utils/CommandTokens.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using Utils::CommandTokens;
+
+namespace
+{
+	// The rules of the CommandLineToArgvA that CommandTokens replaced
+	std::vector<std::string> ReferenceTokenize(const std::string &line)
+	{
+		std::vector<std::string> result;
+		auto inQuotes = false, inSpace = true;
+		for (auto ch : line)
+		{
+			if (inQuotes)
+			{
+				if (ch == '\"')
+					inQuotes = false;
+				else
+					result.back() += ch;
+				continue;
+			}
+
+			switch (ch)
+			{
+			case '\"':
+				inQuotes = true;
+				if (inSpace)
+					result.emplace_back();
+				inSpace = false;
+				break;
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				inSpace = true;
+				break;
+			default:
+				if (inSpace)
+					result.emplace_back();
+				result.back() += ch;
+				inSpace = false;
+				break;
+			}
+		}
+		return result;
+	}
+
+	void TestExamples()
+	{
+		CommandTokens empty("  \t ");
+		CHECK(empty.Empty());
+
+		std::string line = "Server.Name \"My Server\" a\"b c\"d \"\" last";
+		CommandTokens tokens(line);
+		CHECK(tokens.Count() == 5);
+		CHECK(tokens[0] == "Server.Name");
+		CHECK(tokens[1] == "My Server");
+		CHECK(tokens[2] == "ab cd");
+		CHECK(tokens[3] == "");
+		CHECK(tokens[4] == "last");
+		CHECK((tokens.ToVector(3) == std::vector<std::string>{ "", "last" }));
+		CHECK(tokens.ToVector(5).empty());
+
+		// Unsplit arguments are views of the input
+		CHECK(tokens[0].data() == line.data());
+		CHECK(tokens[1].data() == line.data() + 13);
+
+		// An unterminated quote runs to the end
+		CommandTokens unterminated("say \"hello there");
+		CHECK(unterminated.Count() == 2);
+		CHECK(unterminated[1] == "hello there");
+	}
+
+	void TestManyArguments()
+	{
+		std::string line;
+		for (auto i = 0; i < 20; i++)
+			line += "arg" + std::to_string(i) + " ";
+
+		CommandTokens tokens(line);
+		CHECK(tokens.Count() == 20);
+		for (size_t i = 0; i < tokens.Count(); i++)
+			CHECK(tokens[i] == "arg" + std::to_string(i));
+	}
+
+	void TestRandom()
+	{
+		std::mt19937 random(7);
+		const char alphabet[] = "ab \"\t.";
+		for (auto i = 0; i < 5000; i++)
+		{
+			std::string line;
+			auto length = random() % 40;
+			for (size_t j = 0; j < length; j++)
+				line += alphabet[random() % (sizeof(alphabet) - 1)];
+
+			auto expected = ReferenceTokenize(line);
+			CommandTokens tokens(line);
+			CHECK(tokens.ToVector() == expected);
+
+			// Appending in pieces gives the same result as tokenizing it all at once
+			auto split = line.empty() ? 0 : random() % line.length();
+			CommandTokens appended;
+			appended.Append(std::string_view(line).substr(0, split));
+			appended.Append(std::string_view(line).substr(split));
+			CHECK(appended.ToVector() == expected);
+		}
+	}
+
+	// A config file's worth of commands, the way ExecuteCommands tokenizes them
+	void Benchmark()
+	{
+		std::mt19937 random(11);
+		const char *commands[] = { "Player.Name", "Bind", "Settings.Fullscreen", "Server.Name", "Camera.Speed", "Graphics.Saturation" };
+		std::vector<std::string> lines;
+		size_t bytes = 0;
+		for (auto i = 0; i < 500; i++)
+		{
+			std::string line = commands[random() % 6];
+			for (auto j = random() % 4; j > 0; j--)
+				line += random() % 3 == 0 ? " \"two words\"" : " value" + std::to_string(random() % 1000);
+			bytes += line.length() + 1;
+			lines.push_back(line);
+		}
+
+		const int Rounds = 200;
+		size_t count = 0, expected = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (auto round = 0; round < Rounds; round++)
+		{
+			for (auto &&line : lines)
+			{
+				CommandTokens tokens(line);
+				count += tokens.Count();
+			}
+		}
+		auto middle = std::chrono::steady_clock::now();
+		for (auto round = 0; round < Rounds; round++)
+		{
+			for (auto &&line : lines)
+				expected += ReferenceTokenize(line).size();
+		}
+		auto end = std::chrono::steady_clock::now();
+		CHECK(count == expected);
+
+		auto tokensUs = std::chrono::duration<double, std::micro>(middle - start).count() / Rounds;
+		auto referenceUs = std::chrono::duration<double, std::micro>(end - middle).count() / Rounds;
+		printf("500 line, %zu byte config: CommandTokens %.1f us, string vector %.1f us\n", bytes, tokensUs, referenceUs);
+	}
+}
+
+int main()
+{
+	TestExamples();
+	TestManyArguments();
+	TestRandom();
+	Benchmark();
+	return TEST_RESULT();
+}
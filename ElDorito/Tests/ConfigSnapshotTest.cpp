@@ -0,0 +1,111 @@
+#include "Test.hpp"
+#include "../Source/ConfigSnapshot.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using Modules::ConfigSnapshot;
+
+namespace
+{
+	// Snapshots only use variables as keys, so any distinct addresses will do
+	char VariableStorage[2];
+	auto First = reinterpret_cast<const Modules::Command*>(&VariableStorage[0]);
+	auto Second = reinterpret_cast<const Modules::Command*>(&VariableStorage[1]);
+
+	std::shared_ptr<ConfigSnapshot> MakeSnapshot(unsigned long value)
+	{
+		auto snapshot = std::make_shared<ConfigSnapshot>();
+		snapshot->Set(First, { std::to_string(value), value, value, static_cast<float>(value) });
+		snapshot->Set(Second, { std::to_string(value), value, value, static_cast<float>(value) });
+		return snapshot;
+	}
+
+	void TestValues()
+	{
+		auto initial = ConfigSnapshot::Current();
+		CHECK(initial != nullptr);
+		CHECK(!initial->Contains(First));
+		CHECK(initial->GetString(First).empty());
+		CHECK(initial->GetInt(First) == 0);
+
+		auto previousVersion = ConfigSnapshot::CurrentVersion();
+		ConfigSnapshot::Publish(MakeSnapshot(5));
+		auto current = ConfigSnapshot::Current();
+		CHECK(current->GetVersion() == previousVersion + 1);
+		CHECK(ConfigSnapshot::CurrentVersion() == current->GetVersion());
+		CHECK(current->Contains(First));
+		CHECK(current->GetString(First) == "5");
+		CHECK(current->GetInt(First) == 5);
+		CHECK(current->GetInt64(First) == 5);
+		CHECK(current->GetFloat(First) == 5.f);
+
+		// Readers keep the snapshot they took
+		ConfigSnapshot::Publish(MakeSnapshot(6));
+		CHECK(current->GetInt(First) == 5);
+		CHECK(ConfigSnapshot::Current()->GetInt(First) == 6);
+	}
+
+	// Readers on other threads always see a whole snapshot, and versions never go backwards,
+	// even with several threads publishing at once (the game thread and the rcon thread both publish)
+	void TestConcurrentReaders()
+	{
+		const int Writers = 3;
+		const unsigned long PublishesPerWriter = 10000;
+
+		std::atomic<bool> done(false);
+		std::atomic<int> errors(0);
+		std::vector<std::thread> readers;
+		for (auto i = 0; i < 4; i++)
+		{
+			readers.emplace_back([&]
+			{
+				uint64_t lastVersion = 0;
+				while (!done)
+				{
+					auto snapshot = ConfigSnapshot::Current();
+					if (snapshot->GetVersion() < lastVersion || snapshot->GetInt(First) != snapshot->GetInt(Second)
+						|| snapshot->GetString(First) != std::to_string(snapshot->GetInt(Second)))
+					{
+						errors++;
+					}
+					lastVersion = snapshot->GetVersion();
+				}
+			});
+		}
+
+		auto startVersion = ConfigSnapshot::CurrentVersion();
+		std::vector<std::thread> writers;
+		for (auto writer = 0; writer < Writers; writer++)
+		{
+			writers.emplace_back([&, writer]
+			{
+				for (unsigned long i = 0; i < PublishesPerWriter; i++)
+				{
+					auto snapshot = MakeSnapshot(writer * PublishesPerWriter + i);
+					auto previous = ConfigSnapshot::CurrentVersion();
+					ConfigSnapshot::Publish(snapshot);
+					if (snapshot->GetVersion() <= previous)
+						errors++;
+				}
+			});
+		}
+		for (auto &&writer : writers)
+			writer.join();
+		done = true;
+		for (auto &&reader : readers)
+			reader.join();
+		CHECK(errors == 0);
+
+		// Every publish got its own version
+		CHECK(ConfigSnapshot::CurrentVersion() == startVersion + Writers * PublishesPerWriter);
+		CHECK(ConfigSnapshot::Current()->GetVersion() == ConfigSnapshot::CurrentVersion());
+	}
+}
+
+int main()
+{
+	TestValues();
+	TestConcurrentReaders();
+	return TEST_RESULT();
+}
@@ -0,0 +1,160 @@
+#include "Test.hpp"
+#include "../Source/Console.hpp"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Console;
+
+namespace
+{
+	// Keeps a copy of every record it's given
+	class CollectingHandler : public ConsoleOutputHandler
+	{
+	public:
+		std::vector<OutputRecord> Records;
+		int Batches = 0;
+
+		void WriteRecords(const std::vector<const OutputRecord*> &records) override
+		{
+			CHECK(!records.empty());
+			Batches++;
+			for (auto record : records)
+				Records.push_back(*record);
+		}
+	};
+
+	std::shared_ptr<CollectingHandler> All, Warnings, ServerOnly;
+
+	void Reset()
+	{
+		Flush();
+		for (auto &&handler : { All, Warnings, ServerOnly })
+		{
+			handler->Records.clear();
+			handler->Batches = 0;
+		}
+	}
+
+	void TestLinesAndFilters()
+	{
+		Reset();
+		WriteLine("first\nsecond\n\nfourth\n");
+		WriteLine(OutputLevel::Warning, "Server", "Announce failed");
+		WriteLine(OutputLevel::Trace, "Server", "noise");
+		WriteLine(OutputLevel::Error, "Game", "broken");
+		WriteLine("");
+
+		// Nothing is delivered until the flush
+		CHECK(All->Records.empty());
+		Flush();
+
+		CHECK(All->Batches == 1);
+		CHECK(All->Records.size() == 7);
+		if (All->Records.size() == 7)
+		{
+			CHECK(All->Records[0].Text == "first" && All->Records[0].Level == OutputLevel::Info && All->Records[0].Module.empty());
+			CHECK(All->Records[1].Text == "second");
+			CHECK(All->Records[2].Text.empty());
+			CHECK(All->Records[3].Text == "fourth");
+			CHECK(All->Records[0].Time == All->Records[3].Time);
+			CHECK(All->Records[4].Module == "Server" && All->Records[4].Level == OutputLevel::Warning);
+		}
+
+		CHECK(Warnings->Records.size() == 2);
+		if (Warnings->Records.size() == 2)
+			CHECK(Warnings->Records[0].Text == "Announce failed" && Warnings->Records[1].Text == "broken");
+
+		CHECK(ServerOnly->Records.size() == 2);
+		if (ServerOnly->Records.size() == 2)
+			CHECK(ServerOnly->Records[0].Text == "Announce failed" && ServerOnly->Records[1].Text == "noise");
+
+		// A handler with nothing matching isn't called
+		Reset();
+		WriteLine(OutputLevel::Info, "Game", "hello");
+		Flush();
+		CHECK(All->Batches == 1 && Warnings->Batches == 0 && ServerOnly->Batches == 0);
+	}
+
+	// Several threads write while the main thread flushes, like worker threads writing during ticks
+	void TestProducers()
+	{
+		Reset();
+		const int ThreadCount = 4;
+		const int LinesPerThread = 20000;
+
+		std::atomic<int> running(ThreadCount);
+		std::vector<std::thread> threads;
+		for (auto t = 0; t < ThreadCount; t++)
+		{
+			threads.emplace_back([t, &running]
+			{
+				auto module = "thread" + std::to_string(t);
+				for (auto i = 0; i < LinesPerThread; i++)
+					WriteLine(i % 10 == 0 ? OutputLevel::Warning : OutputLevel::Info, module, std::to_string(i));
+				running--;
+			});
+		}
+
+		size_t flushes = 0;
+		while (running > 0)
+		{
+			Flush();
+			flushes++;
+		}
+		for (auto &&thread : threads)
+			thread.join();
+
+		// Output beyond the per-flush limit waits for the next flush
+		auto previousBatches = All->Batches;
+		while (All->Records.size() < static_cast<size_t>(ThreadCount * LinesPerThread))
+		{
+			Flush();
+			CHECK(All->Batches == ++previousBatches);
+		}
+		Flush();
+		CHECK(All->Records.size() == static_cast<size_t>(ThreadCount * LinesPerThread));
+
+		// Each thread's lines arrive in the order it wrote them
+		std::map<std::string, int> next;
+		auto inOrder = true;
+		for (auto &&record : All->Records)
+		{
+			auto &expected = next[record.Module];
+			if (record.Text != std::to_string(expected))
+				inOrder = false;
+			expected++;
+		}
+		CHECK(inOrder);
+		CHECK(next.size() == static_cast<size_t>(ThreadCount));
+
+		CHECK(Warnings->Records.size() == static_cast<size_t>(ThreadCount * LinesPerThread / 10));
+		CHECK(ServerOnly->Records.empty());
+		printf("%d threads wrote %d lines over %zu flushes\n", ThreadCount, ThreadCount * LinesPerThread, flushes);
+	}
+}
+
+int main()
+{
+	All = std::make_shared<CollectingHandler>();
+	Warnings = std::make_shared<CollectingHandler>();
+	ServerOnly = std::make_shared<CollectingHandler>();
+
+	OutputFilter warnings;
+	warnings.MinLevel = OutputLevel::Warning;
+	OutputFilter serverOnly;
+	serverOnly.Modules = { "Server" };
+
+	RegisterHandler(All);
+	RegisterHandler(Warnings, warnings);
+	RegisterHandler(ServerOnly, serverOnly);
+
+	TestLinesAndFilters();
+	TestProducers();
+
+	// Left queued on purpose, the console frees it at exit (the sanitizer build checks for the leak)
+	WriteLine("never flushed");
+	return TEST_RESULT();
+}
@@ -0,0 +1,74 @@
+#include "Test.hpp"
+#include "../Source/Utils/DisplayModeTable.hpp"
+#include <algorithm>
+#include <random>
+
+using namespace Utils::DisplayModes;
+
+namespace
+{
+	void TestTable()
+	{
+		CHECK(BuildResolutionTable({}).empty());
+		CHECK(BuildResolutionsJson({}) == "[]");
+
+		// What a typical driver reports: every resolution at each bit depth and scaling mode, not in order, with
+		// "default" rates of 0 and 1 mixed in
+		std::vector<DisplayMode> modes =
+		{
+			{ 1920, 1080, 60 }, { 1920, 1080, 144 }, { 800, 600, 60 }, { 1280, 720, 60 }, { 1920, 1080, 60 },
+			{ 1280, 1024, 75 }, { 1280, 720, 1 }, { 800, 600, 56 }, { 1920, 1080, 120 }, { 1280, 1024, 60 },
+			{ 1920, 1080, 144 }, { 640, 480, 0 }, { 800, 600, 60 }, { 1280, 720, 60 },
+		};
+		auto table = BuildResolutionTable(modes);
+		CHECK(table.size() == 5);
+		if (table.size() != 5)
+			return;
+
+		CHECK(table[0].Width == 640 && table[0].Height == 480 && table[0].RefreshRates.empty());
+		CHECK(table[1].Width == 800 && table[1].Height == 600 && (table[1].RefreshRates == std::vector<uint32_t>{ 56, 60 }));
+		CHECK(table[2].Width == 1280 && table[2].Height == 720 && (table[2].RefreshRates == std::vector<uint32_t>{ 60 }));
+		CHECK(table[3].Width == 1280 && table[3].Height == 1024 && (table[3].RefreshRates == std::vector<uint32_t>{ 60, 75 }));
+		CHECK(table[4].Width == 1920 && table[4].Height == 1080 && (table[4].RefreshRates == std::vector<uint32_t>{ 60, 120, 144 }));
+
+		CHECK(BuildResolutionsJson(table) == "[\"640x480\",\"800x600\",\"1280x720\",\"1280x1024\",\"1920x1080\"]");
+		CHECK(BuildDisplayModesJson({ table[0], table[1] }) ==
+			"[{\"width\":640,\"height\":480,\"refreshRates\":[]},{\"width\":800,\"height\":600,\"refreshRates\":[56,60]}]");
+	}
+
+	// The table doesn't depend on the order the driver lists the modes in
+	void TestOrder()
+	{
+		std::mt19937 random(9);
+		auto next = [&](uint32_t range) { return static_cast<uint32_t>(random() % range); };
+		std::vector<DisplayMode> modes;
+		for (auto i = 0; i < 300; i++)
+			modes.push_back({ 640 + next(8) * 160, 480 + next(6) * 120, next(4) == 0 ? 0 : 50 + next(5) * 10 });
+
+		auto expected = BuildResolutionTable(modes);
+		for (auto round = 0; round < 20; round++)
+		{
+			std::shuffle(modes.begin(), modes.end(), random);
+			auto table = BuildResolutionTable(modes);
+			CHECK(BuildDisplayModesJson(table) == BuildDisplayModesJson(expected));
+		}
+
+		for (size_t i = 1; i < expected.size(); i++)
+		{
+			auto &a = expected[i - 1], &b = expected[i];
+			CHECK(a.Width < b.Width || (a.Width == b.Width && a.Height < b.Height));
+		}
+		for (auto &&resolution : expected)
+		{
+			for (size_t i = 1; i < resolution.RefreshRates.size(); i++)
+				CHECK(resolution.RefreshRates[i - 1] < resolution.RefreshRates[i]);
+		}
+	}
+}
+
+int main()
+{
+	TestTable();
+	TestOrder();
+	return TEST_RESULT();
+}
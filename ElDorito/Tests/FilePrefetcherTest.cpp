@@ -0,0 +1,172 @@
+#include "Test.hpp"
+#include "../Source/Utils/FilePrefetcher.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+using namespace Utils;
+
+namespace
+{
+	// Reads with stdio, and can fail or slow down reads
+	class StdioPrefetchReader : public PrefetchReader
+	{
+	public:
+		std::atomic<uint32_t> Reads{ 0 };
+		std::atomic<uint32_t> OpenFiles{ 0 };
+		std::atomic<int> FailAfterReads{ -1 };
+		std::atomic<int> ReadDelayMs{ 0 };
+		std::atomic<bool> Background{ false };
+		std::set<std::thread::id> ReadThreads;
+
+		void *Open(const std::string &path, uint64_t *size) override
+		{
+			auto file = std::fopen(path.c_str(), "rb");
+			if (!file)
+				return nullptr;
+			std::fseek(file, 0, SEEK_END);
+			*size = static_cast<uint64_t>(std::ftell(file));
+			std::fseek(file, 0, SEEK_SET);
+			OpenFiles++;
+			return file;
+		}
+
+		bool Read(void *file, uint8_t *buffer, size_t size, size_t *bytesRead) override
+		{
+			ReadThreads.insert(std::this_thread::get_id());
+			if (FailAfterReads >= 0 && static_cast<int>(Reads) >= FailAfterReads)
+				return false;
+			if (ReadDelayMs > 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(ReadDelayMs));
+			Reads++;
+			*bytesRead = std::fread(buffer, 1, size, static_cast<std::FILE*>(file));
+			return *bytesRead > 0;
+		}
+
+		void Close(void *file) override
+		{
+			std::fclose(static_cast<std::FILE*>(file));
+			OpenFiles--;
+		}
+
+		void SetBackgroundPriority(bool background) override
+		{
+			Background = background;
+		}
+	};
+
+	void WriteFile(const fs::path &path, size_t size)
+	{
+		std::ofstream(path.string(), std::ios::binary) << std::string(size, 'x');
+	}
+
+	void WaitForPrefetch(const FilePrefetcher &prefetcher)
+	{
+		while (prefetcher.IsRunning())
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	void TestReadsFiles(const fs::path &dir)
+	{
+		WriteFile(dir / "a.map", 600 * 1024);
+		WriteFile(dir / "b.map", 1000);
+		WriteFile(dir / "empty.map", 0);
+
+		auto reader = std::make_shared<StdioPrefetchReader>();
+		FilePrefetcher prefetcher(reader);
+		prefetcher.Start({ { (dir / "a.map").string(), 0 }, { (dir / "missing.map").string(), 0 }, { (dir / "b.map").string(), 0 },
+			{ (dir / "empty.map").string(), 0 } }, 0);
+		WaitForPrefetch(prefetcher);
+
+		auto stats = prefetcher.GetStats();
+		CHECK(!stats.Running && !stats.Cancelled);
+		CHECK(stats.FilesCompleted == 3 && stats.FilesFailed == 1);
+		CHECK(stats.BytesRequested == 600 * 1024 + 1000 && stats.BytesPrefetched == stats.BytesRequested);
+		CHECK(reader->Reads == 3 + 1); // The 600 KB file in 256 KB chunks
+		CHECK(reader->OpenFiles == 0);
+		CHECK(!reader->Background && reader->ReadThreads.size() == 1 && !reader->ReadThreads.count(std::this_thread::get_id()));
+
+		// Only the start of a file
+		prefetcher.Start({ { (dir / "a.map").string(), 300 * 1024 }, { (dir / "b.map").string(), 5000 } }, 0);
+		WaitForPrefetch(prefetcher);
+		stats = prefetcher.GetStats();
+		CHECK(stats.FilesCompleted == 2 && stats.BytesRequested == 300 * 1024 + 1000 && stats.BytesPrefetched == stats.BytesRequested);
+
+		// A failed read fails the file and moves on to the next one
+		reader->Reads = 0;
+		reader->FailAfterReads = 1;
+		prefetcher.Start({ { (dir / "a.map").string(), 0 } }, 0);
+		WaitForPrefetch(prefetcher);
+		stats = prefetcher.GetStats();
+		CHECK(stats.FilesCompleted == 0 && stats.FilesFailed == 1 && stats.BytesPrefetched == 256 * 1024);
+		CHECK(reader->OpenFiles == 0);
+	}
+
+	void TestThrottling(const fs::path &dir)
+	{
+		WriteFile(dir / "throttled.map", 512 * 1024);
+
+		// Two 256 KB chunks at 2 MB/s, so the second read has to wait about 125 ms after the first
+		auto reader = std::make_shared<StdioPrefetchReader>();
+		FilePrefetcher prefetcher(reader);
+		prefetcher.Start({ { (dir / "throttled.map").string(), 0 } }, 2 * 1024 * 1024);
+		WaitForPrefetch(prefetcher);
+
+		auto stats = prefetcher.GetStats();
+		CHECK(stats.FilesCompleted == 1 && stats.BytesPrefetched == 512 * 1024);
+		CHECK(stats.ElapsedSeconds >= 0.24 && stats.ElapsedSeconds < 5);
+		CHECK(stats.ReadSeconds < stats.ElapsedSeconds);
+	}
+
+	void TestCancel(const fs::path &dir)
+	{
+		WriteFile(dir / "slow.map", 4 * 1024 * 1024);
+
+		// Cancelling a throttled prefetch doesn't wait for the throttle
+		auto reader = std::make_shared<StdioPrefetchReader>();
+		FilePrefetcher prefetcher(reader);
+		prefetcher.Start({ { (dir / "slow.map").string(), 0 }, { (dir / "slow.map").string(), 0 } }, 1024);
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		CHECK(prefetcher.IsRunning());
+
+		auto start = std::chrono::steady_clock::now();
+		prefetcher.Cancel();
+		CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+		auto stats = prefetcher.GetStats();
+		CHECK(!prefetcher.IsRunning() && !stats.Running && stats.Cancelled);
+		CHECK(stats.FilesCompleted == 0 && stats.FilesFailed == 0 && stats.BytesPrefetched == 256 * 1024);
+		CHECK(reader->OpenFiles == 0 && !reader->Background);
+
+		// Starting a new prefetch cancels the running one
+		reader->ReadDelayMs = 20;
+		prefetcher.Start({ { (dir / "slow.map").string(), 0 } }, 0);
+		std::this_thread::sleep_for(std::chrono::milliseconds(30));
+		reader->ReadDelayMs = 0;
+		prefetcher.Start({ { (dir / "slow.map").string(), 1000 } }, 0);
+		WaitForPrefetch(prefetcher);
+		stats = prefetcher.GetStats();
+		CHECK(!stats.Cancelled && stats.FilesCompleted == 1 && stats.BytesPrefetched == 1000);
+
+		// As does destroying the prefetcher
+		{
+			FilePrefetcher temporary(reader);
+			temporary.Start({ { (dir / "slow.map").string(), 0 } }, 1024);
+		}
+		CHECK(reader->OpenFiles == 0);
+	}
+}
+
+int main()
+{
+	auto dir = fs::temp_directory_path() / fs::unique_path("FilePrefetcherTest-%%%%-%%%%");
+	fs::create_directories(dir);
+	TestReadsFiles(dir);
+	TestThrottling(dir);
+	TestCancel(dir);
+	fs::remove_all(dir);
+	return TEST_RESULT();
+}
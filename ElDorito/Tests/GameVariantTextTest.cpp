@@ -0,0 +1,160 @@
+#include "Test.hpp"
+#include "../Source/Game/GameVariantText.hpp"
+#include "../Source/Game/PlayerTraits.hpp"
+#include <cstring>
+#include <random>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+using namespace Game;
+
+namespace
+{
+	// Where a slayer variant keeps its trait profiles
+	const std::vector<size_t> TraitProfileOffsets = { 0x130, 0x1A4, 0x1C0, 0x1DC, 0x1F8, 0x214 };
+
+	// Builds a variant with every setting the text format covers set to something recognizable
+	void BuildVariant(uint8_t *variant)
+	{
+		memset(variant, 0, GameVariantText::VariantSize);
+		variant[0] = 2; // Slayer
+
+		const char16_t name[] = u"Swät";
+		for (size_t i = 0; name[i]; i++)
+		{
+			variant[0x34 + i * 2] = static_cast<uint8_t>(name[i] & 0xFF);
+			variant[0x34 + i * 2 + 1] = static_cast<uint8_t>(name[i] >> 8);
+		}
+		strcpy(reinterpret_cast<char*>(variant + 0x54), "Headshots only");
+		strcpy(reinterpret_cast<char*>(variant + 0xD4), "Bungie");
+		variant[0x124] = 1;  // teams
+		variant[0x125] = 10; // timeLimit
+		variant[0x126] = 3;  // rounds
+		variant[0x12D] = 5;  // respawnTime
+
+		auto value = 0;
+		for (auto offset : TraitProfileOffsets)
+		{
+			for (auto &&field : PlayerTraits::TraitFields)
+			{
+				auto trait = static_cast<uint8_t>(value++ % (field.Max + 1));
+				variant[offset + field.Offset] = trait;
+			}
+		}
+	}
+
+	void TestRoundTrip()
+	{
+		uint8_t original[GameVariantText::VariantSize];
+		BuildVariant(original);
+		auto text = GameVariantText::Decompile(original, TraitProfileOffsets, "slayer");
+
+		std::string base, error;
+		CHECK(GameVariantText::GetBase(text, base, error));
+		CHECK(base == "slayer");
+
+		// Compiling the text onto a variant with everything cleared restores every setting it covers
+		uint8_t compiled[GameVariantText::VariantSize];
+		memset(compiled, 0, sizeof(compiled));
+		compiled[0] = 2;
+		CHECK(GameVariantText::Compile(text, TraitProfileOffsets, compiled, error));
+		CHECK(memcmp(compiled, original, sizeof(compiled)) == 0);
+		CHECK(GameVariantText::Decompile(compiled, TraitProfileOffsets, "slayer") == text);
+
+		CHECK(text.find("\"name\": \"Sw\xC3\xA4t\"") != std::string::npos);
+		CHECK(text.find("\"rounds\": 3") != std::string::npos);
+	}
+
+	void TestOverrides()
+	{
+		uint8_t variant[GameVariantText::VariantSize];
+		BuildVariant(variant);
+		uint8_t expected[GameVariantText::VariantSize];
+		memcpy(expected, variant, sizeof(expected));
+
+		// Only the settings that are given change, and a null trait profile is left alone
+		std::string error;
+		auto text = R"({
+			"base": "slayer",
+			"timeLimit": 15,
+			"traitProfiles": [ null, { "health": { "shieldMultiplier": 0 }, "weapons": { "primaryWeapon": 254 } } ]
+		})";
+		CHECK(GameVariantText::Compile(text, TraitProfileOffsets, variant, error));
+		expected[0x125] = 15;
+		expected[TraitProfileOffsets[1] + offsetof(PlayerTraits::c_player_trait_profile, Health) +
+			offsetof(PlayerTraits::c_player_health_traits, ShieldMultiplier)] = 0;
+		expected[TraitProfileOffsets[1] + offsetof(PlayerTraits::c_player_trait_profile, Weapon) +
+			offsetof(PlayerTraits::c_player_weapon_traits, PrimaryWeaponIndex)] = 254;
+		CHECK(memcmp(variant, expected, sizeof(expected)) == 0);
+	}
+
+	void TestInvalid()
+	{
+		uint8_t variant[GameVariantText::VariantSize];
+		BuildVariant(variant);
+		uint8_t original[GameVariantText::VariantSize];
+		memcpy(original, variant, sizeof(original));
+
+		const char *invalid[] =
+		{
+			"not json",
+			R"({ "base": "slayer", "rounds": 0 })",
+			R"({ "base": "slayer", "rounds": 16 })", // Rounds are encoded in 4 bits
+			R"({ "base": "slayer", "timeLimit": 256 })",
+			R"({ "base": "slayer", "teams": 1 })",
+			R"({ "base": "slayer", "name": "This name is far too long" })",
+			R"({ "base": "slayer", "gravity": 1 })",
+			R"({ "base": "slayer", "traitProfiles": [ { "health": { "shieldMultiplier": 6 } } ] })",
+			R"({ "base": "slayer", "traitProfiles": [ { "health": { "invisible": 1 } } ] })",
+			R"({ "base": "slayer", "traitProfiles": [ {}, {}, {}, {}, {}, {}, {} ] })",
+			R"({ "base": "slayer", "timeLimit": 5, "respawnTime": -1 })",
+		};
+		for (auto text : invalid)
+		{
+			std::string error;
+			CHECK(!GameVariantText::Compile(text, TraitProfileOffsets, variant, error));
+			CHECK(!error.empty());
+			CHECK(memcmp(variant, original, sizeof(original)) == 0);
+		}
+
+		// A base without a known trait profile layout can still take the other settings
+		std::string error;
+		CHECK(GameVariantText::Compile(R"({ "base": "slayer", "rounds": 15 })", {}, variant, error));
+		CHECK(variant[0x126] == 15);
+		CHECK(!GameVariantText::Compile(R"({ "base": "slayer", "traitProfiles": [ {} ] })", {}, variant, error));
+	}
+
+	void TestCompiledCache()
+	{
+		auto directory = fs::temp_directory_path() / fs::unique_path("GameVariantTextTest-%%%%-%%%%");
+		fs::create_directories(directory);
+		auto path = (directory / "variant.bin").string();
+
+		auto text = R"({ "base": "slayer", "rounds": 5 })";
+		auto hash = GameVariantText::ComputeHash(text, "");
+		CHECK(hash.length() == 64);
+		CHECK(hash == GameVariantText::ComputeHash(text, ""));
+		CHECK(hash != GameVariantText::ComputeHash(text, "base file"));
+		CHECK(hash != GameVariantText::ComputeHash(R"({ "base": "slayer", "rounds": 6 })", ""));
+
+		uint8_t variant[GameVariantText::VariantSize];
+		BuildVariant(variant);
+		uint8_t loaded[GameVariantText::VariantSize];
+		CHECK(!GameVariantText::LoadCompiled(path, hash, loaded));
+		CHECK(GameVariantText::SaveCompiled(path, hash, variant));
+		CHECK(GameVariantText::LoadCompiled(path, hash, loaded));
+		CHECK(memcmp(loaded, variant, sizeof(variant)) == 0);
+		CHECK(!GameVariantText::LoadCompiled(path, GameVariantText::ComputeHash(text, "base file"), loaded));
+
+		fs::remove_all(directory);
+	}
+}
+
+int main()
+{
+	TestRoundTrip();
+	TestOverrides();
+	TestInvalid();
+	TestCompiledCache();
+	return TEST_RESULT();
+}
@@ -0,0 +1,113 @@
+#include "Test.hpp"
+#include "../Source/Utils/LaunchOptions.hpp"
+#include <vector>
+
+using namespace Utils::LaunchOptions;
+
+namespace
+{
+	Options ParseArgs(std::vector<const wchar_t*> args)
+	{
+		args.insert(args.begin(), L"eldorado.exe");
+		return Parse(static_cast<int>(args.size()), args.data());
+	}
+
+	bool HasError(const Options &options, const std::string &error)
+	{
+		for (auto &&e : options.Errors)
+		{
+			if (e == error)
+				return true;
+		}
+		return false;
+	}
+
+	void TestOptions()
+	{
+		auto options = ParseArgs({ L"-instance", L"second", L"-headless", L"-maps", L"D:\\maps", L"-webdebug",
+			L"-connect", L"192.168.0.2:11775", L"-password", L"hunter2", L"-cache-memory-increase", L"512",
+			L"-lod-increase" });
+		CHECK(options.Errors.empty());
+		CHECK(options.InstanceName == "second");
+		CHECK(options.Dedicated);
+		CHECK(options.MapsFolder == "D:\\maps\\");
+		CHECK(options.WebDebug);
+		CHECK(options.Connect && options.ConnectAddress == "192.168.0.2:11775");
+		CHECK(options.ConnectPassword == "hunter2");
+		CHECK(options.HasCacheMemoryIncrease && options.CacheMemoryIncrease == 512);
+		CHECK(options.LodIncrease);
+
+		// Nothing is set without arguments
+		options = ParseArgs({});
+		CHECK(options.Errors.empty() && options.Overrides.empty());
+		CHECK(options.InstanceName.empty() && !options.Dedicated && options.MapsFolder.empty() && !options.Connect);
+		CHECK(!options.HasCacheMemoryIncrease && !options.LodIncrease && !options.WebDebug);
+
+		// A trailing slash isn't doubled
+		CHECK(ParseArgs({ L"-maps", L"maps/" }).MapsFolder == "maps/");
+	}
+
+	void TestOverrides()
+	{
+		auto options = ParseArgs({ L"+Server.Name", L"My Server", L"-Player.Name=Bob", L"+Game.SkipTitleSplash", L"1" });
+		CHECK(options.Errors.empty());
+		CHECK(options.Overrides.size() == 3);
+		if (options.Overrides.size() == 3)
+		{
+			CHECK(options.Overrides[0].Name == "Server.Name" && options.Overrides[0].Value == "My Server");
+			CHECK(options.Overrides[1].Name == "Player.Name" && options.Overrides[1].Value == "Bob");
+			CHECK(options.Overrides[2].Name == "Game.SkipTitleSplash" && options.Overrides[2].Value == "1");
+		}
+	}
+
+	void TestErrors()
+	{
+		auto options = ParseArgs({ L"stray", L"-bogus", L"-cache-memory-increase", L"lots", L"-=1", L"-Player.Name=",
+			L"+", L"-connect" });
+		CHECK(HasError(options, "Unexpected argument \"stray\""));
+		CHECK(HasError(options, "Unknown option -bogus"));
+		CHECK(HasError(options, "Invalid value \"lots\" for -cache-memory-increase"));
+		CHECK(HasError(options, "Missing variable name in \"-=1\""));
+		CHECK(HasError(options, "Missing value for -Player.Name"));
+		CHECK(HasError(options, "Missing variable name after '+'"));
+		CHECK(HasError(options, "Missing value for -connect"));
+		CHECK(options.Errors.size() == 7);
+		CHECK(!options.HasCacheMemoryIncrease && !options.Connect && options.Overrides.empty());
+
+		// Parsing carries on past errors
+		options = ParseArgs({ L"-bogus", L"-instance", L"third" });
+		CHECK(options.Errors.size() == 1);
+		CHECK(options.InstanceName == "third");
+	}
+
+	void TestEngineOptions()
+	{
+		// The game's own options, and their values, aren't reported as unknown
+		auto options = ParseArgs({ L"-launcher", L"-dx9ex", L"-window", L"-width", L"1280", L"-height", L"720",
+			L"-adapter", L"1", L"-fullscreen", L"-instance", L"x" });
+		CHECK(options.Errors.empty());
+		CHECK(options.InstanceName == "x");
+
+		CHECK(HasError(ParseArgs({ L"-width" }), "Missing value for -width"));
+	}
+
+	void TestUnicode()
+	{
+		// Every character takes 4 bytes of UTF-8
+		auto options = ParseArgs({ L"-instance", L"\U0001F600\U0001F600\U0001F600" });
+		CHECK(options.InstanceName == "\xF0\x9F\x98\x80\xF0\x9F\x98\x80\xF0\x9F\x98\x80");
+
+		options = ParseArgs({ L"+Player.Name", L"J\u00F6rg\u4E2D" });
+		CHECK(options.Overrides.size() == 1 && options.Overrides[0].Value == "J\xC3\xB6rg\xE4\xB8\xAD");
+	}
+}
+
+int main()
+{
+	TestOptions();
+	TestOverrides();
+	TestErrors();
+	TestEngineOptions();
+	TestUnicode();
+	return TEST_RESULT();
+}
@@ -0,0 +1,135 @@
+#include "Test.hpp"
+#include "../Source/Web/Ui/LoadProgressTracker.hpp"
+#include <cstdio>
+
+using Web::Ui::LoadProgressTracker;
+
+namespace
+{
+	LoadProgressTracker::Clock::time_point Now;
+
+	LoadProgressTracker::Clock::time_point FakeClock()
+	{
+		return Now;
+	}
+
+	void Advance(int milliseconds)
+	{
+		Now += std::chrono::milliseconds(milliseconds);
+	}
+
+	void Load(LoadProgressTracker &tracker, const char *mapName, uint32_t totalBytes)
+	{
+		if (mapName)
+			tracker.Show(mapName);
+		Advance(100);
+		tracker.Begin(totalBytes);
+		for (uint32_t i = 0; i < 10; i++)
+		{
+			Advance(100);
+			tracker.UpdateProgress(totalBytes / 10);
+		}
+		Advance(200);
+		tracker.Hide();
+	}
+
+	void TestHistory()
+	{
+		LoadProgressTracker tracker(FakeClock);
+		Load(tracker, "guardian", 1000);
+		auto &history = tracker.GetHistory();
+		CHECK(history.size() == 1);
+		CHECK(history.at("guardian").Loads == 1);
+		CHECK(history.at("guardian").AverageSeconds > 1.29 && history.at("guardian").AverageSeconds < 1.31);
+
+		// A load that starts without the loading screen mustn't be recorded under the previous map
+		Load(tracker, nullptr, 5000);
+		CHECK(tracker.GetMapName().empty());
+		CHECK(history.size() == 1);
+		CHECK(history.at("guardian").Loads == 1);
+
+		Load(tracker, "valhalla", 2000);
+		CHECK(history.size() == 2);
+		CHECK(history.at("valhalla").Loads == 1);
+		CHECK(history.at("guardian").Loads == 1);
+	}
+
+	void TestIncompleteLoad()
+	{
+		LoadProgressTracker tracker(FakeClock);
+		tracker.Show("sandtrap");
+		tracker.Begin(1000);
+		tracker.UpdateProgress(500);
+		tracker.Hide();
+		CHECK(tracker.GetHistory().empty());
+	}
+
+	void TestThrottle()
+	{
+		LoadProgressTracker tracker(FakeClock);
+		auto interval = std::chrono::milliseconds(250);
+		tracker.Show("guardian");
+		tracker.Begin(1000);
+
+		Advance(300);
+		tracker.UpdateProgress(100);
+		CHECK(tracker.ShouldNotify(interval));
+		Advance(10);
+		tracker.UpdateProgress(100);
+		CHECK(!tracker.ShouldNotify(interval));
+
+		// The update that completes the load isn't throttled, but only once
+		Advance(10);
+		tracker.UpdateProgress(800);
+		CHECK(tracker.GetPhase() == LoadProgressTracker::Phase::Finishing);
+		CHECK(tracker.ShouldNotify(interval));
+		Advance(10);
+		CHECK(!tracker.ShouldNotify(interval));
+
+		// Showing the next load resets it
+		tracker.Hide();
+		tracker.Show("guardian");
+		tracker.Begin(100);
+		tracker.UpdateProgress(100);
+		CHECK(tracker.ShouldNotify(interval));
+	}
+
+	void TestEstimate()
+	{
+		LoadProgressTracker tracker(FakeClock);
+		auto interval = std::chrono::milliseconds(0);
+		tracker.Show("guardian");
+		CHECK(tracker.GetEtaMs() == -1);
+
+		// Without history the estimate comes from the byte rate: 100 bytes per 100 ms with 900 left
+		tracker.Begin(1000);
+		Advance(100);
+		tracker.UpdateProgress(100);
+		CHECK(tracker.ShouldNotify(interval));
+		CHECK(tracker.GetEtaMs() == 900);
+	}
+
+	void TestSaveAndLoad()
+	{
+		const char *path = "LoadProgressTrackerTest.json";
+		LoadProgressTracker tracker(FakeClock);
+		Load(tracker, "guardian", 1000);
+		CHECK(tracker.SaveHistory(path));
+
+		LoadProgressTracker loaded(FakeClock);
+		CHECK(loaded.LoadHistory(path));
+		CHECK(loaded.GetHistory().size() == 1);
+		CHECK(loaded.GetHistory().at("guardian").AverageBytes == 1000);
+		std::remove(path);
+	}
+}
+
+int main()
+{
+	TestHistory();
+	TestIncompleteLoad();
+	TestThrottle();
+	TestEstimate();
+	TestSaveAndLoad();
+	return TEST_RESULT();
+}
@@ -0,0 +1,209 @@
+#include "Test.hpp"
+#include "../Source/Utils/LogFilter.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+using Utils::LogFilter;
+
+namespace
+{
+	// A pattern checked the slow way, like the Logger did before the filters were compiled
+	struct ReferencePattern
+	{
+		std::string Text;
+		bool IgnoreCase;
+		bool AnchorStart;
+		bool AnchorEnd;
+	};
+
+	ReferencePattern Parse(std::string text)
+	{
+		ReferencePattern pattern = { "", false, false, false };
+		if (text.compare(0, 4, "(?i)") == 0)
+		{
+			pattern.IgnoreCase = true;
+			text.erase(0, 4);
+		}
+		if (!text.empty() && text.front() == '^')
+		{
+			pattern.AnchorStart = true;
+			text.erase(0, 1);
+		}
+		if (!text.empty() && text.back() == '$')
+		{
+			pattern.AnchorEnd = true;
+			text.pop_back();
+		}
+		pattern.Text = text;
+		return pattern;
+	}
+
+	char ToLower(char ch)
+	{
+		return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+	}
+
+	bool MatchesAt(const std::string &message, const ReferencePattern &pattern, size_t position)
+	{
+		for (size_t i = 0; i < pattern.Text.length(); i++)
+		{
+			auto a = message[position + i], b = pattern.Text[i];
+			if (pattern.IgnoreCase ? ToLower(a) != ToLower(b) : a != b)
+				return false;
+		}
+		return true;
+	}
+
+	bool Contains(const std::string &message, const ReferencePattern &pattern)
+	{
+		if (pattern.Text.length() > message.length())
+			return false;
+		if (pattern.AnchorStart && pattern.AnchorEnd)
+			return message.length() == pattern.Text.length() && MatchesAt(message, pattern, 0);
+		if (pattern.AnchorStart)
+			return MatchesAt(message, pattern, 0);
+		if (pattern.AnchorEnd)
+			return MatchesAt(message, pattern, message.length() - pattern.Text.length());
+		for (size_t i = 0; i + pattern.Text.length() <= message.length(); i++)
+		{
+			if (MatchesAt(message, pattern, i))
+				return true;
+		}
+		return false;
+	}
+
+	bool ReferenceAccepts(const std::string &message, const std::vector<std::string> &include, const std::vector<std::string> &exclude)
+	{
+		for (auto &&pattern : exclude)
+		{
+			if (Contains(message, Parse(pattern)))
+				return false;
+		}
+		for (auto &&pattern : include)
+		{
+			if (!Contains(message, Parse(pattern)))
+				return false;
+		}
+		return true;
+	}
+
+	std::string RandomString(std::mt19937 &random, size_t maxLength, const char *alphabet)
+	{
+		std::string result;
+		auto length = random() % (maxLength + 1);
+		for (size_t i = 0; i < length; i++)
+			result += alphabet[random() % strlen(alphabet)];
+		return result;
+	}
+
+	bool Accepts(LogFilter &filter, const char *message)
+	{
+		return filter.Accepts(message, strlen(message));
+	}
+
+	void TestExamples()
+	{
+		LogFilter filter;
+		CHECK(filter.IsEmpty());
+		CHECK(Accepts(filter, "anything"));
+
+		filter.Compile({ "Packet", "(?i)session" }, { "^[Trace]", "ping$" });
+		CHECK(!filter.IsEmpty());
+		CHECK(Accepts(filter, "Packet for SESSION 3"));
+		CHECK(!Accepts(filter, "Packet for 3"));
+		CHECK(!Accepts(filter, "packet for session 3"));
+		CHECK(!Accepts(filter, "[Trace] Packet session"));
+		CHECK(Accepts(filter, "x [Trace] Packet session"));
+		CHECK(!Accepts(filter, "Packet session ping"));
+		CHECK(Accepts(filter, "Packet session ping!"));
+
+		// Duplicate includes only have to be found once
+		filter.Compile({ "a", "a" }, {});
+		CHECK(Accepts(filter, "a"));
+		CHECK(!Accepts(filter, "b"));
+
+		filter.Compile({}, {});
+		CHECK(filter.IsEmpty());
+		CHECK(Accepts(filter, "anything"));
+	}
+
+	// Random filters and messages over a small alphabet, so that patterns overlap and share prefixes and suffixes
+	void TestRandom()
+	{
+		std::mt19937 random(3);
+		const char *prefixes[] = { "", "", "", "(?i)", "^", "(?i)^" };
+		for (auto round = 0; round < 3000; round++)
+		{
+			std::vector<std::string> include, exclude;
+			auto includeCount = random() % 4, excludeCount = random() % 4;
+			for (size_t i = 0; i < includeCount; i++)
+				include.push_back(prefixes[random() % 6] + RandomString(random, 3, "abAB") + (random() % 5 == 0 ? "$" : ""));
+			for (size_t i = 0; i < excludeCount; i++)
+				exclude.push_back(prefixes[random() % 6] + RandomString(random, 4, "abAB") + (random() % 5 == 0 ? "$" : ""));
+
+			LogFilter filter;
+			filter.Compile(include, exclude);
+			CHECK(filter.IsEmpty() == (include.empty() && exclude.empty()));
+			for (auto i = 0; i < 200; i++)
+			{
+				auto message = RandomString(random, 12, "abAB");
+				CHECK(filter.Accepts(message.c_str(), message.length()) == ReferenceAccepts(message, include, exclude));
+			}
+		}
+	}
+
+	// Compares the speed with the strstr loop the Logger used before, with a realistic filter list
+	void Benchmark()
+	{
+		std::mt19937 random(5);
+		const char *words[] = { "ping", "pong", "heartbeat", "simulation", "update", "voice", "ack", "stats", "keepalive",
+			"replication", "membership", "bandwidth", "rtt", "packet loss", "peer", "queue", "channel", "observer", "datagram", "timeout" };
+		std::vector<std::string> include = { "Network" }, exclude;
+		for (auto word : words)
+			exclude.push_back(std::string("[") + word + "]");
+
+		std::vector<std::string> messages;
+		size_t bytes = 0;
+		for (auto i = 0; i < 20000; i++)
+		{
+			auto message = "Network: " + RandomString(random, 160, "abcdefghijklmnopqrstuvwxyz  []0123456789");
+			if (i % 10 == 0)
+				message += std::string(" [") + words[random() % 20] + "]";
+			bytes += message.length();
+			messages.push_back(message);
+		}
+
+		LogFilter filter;
+		filter.Compile(include, exclude);
+		auto accepted = 0, expected = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (auto &&message : messages)
+			accepted += filter.Accepts(message.c_str(), message.length());
+		auto middle = std::chrono::steady_clock::now();
+		for (auto &&message : messages)
+		{
+			auto keep = true;
+			for (auto &&pattern : exclude)
+				keep = keep && !strstr(message.c_str(), pattern.c_str());
+			for (auto &&pattern : include)
+				keep = keep && strstr(message.c_str(), pattern.c_str());
+			expected += keep;
+		}
+		auto end = std::chrono::steady_clock::now();
+		CHECK(accepted == expected);
+
+		auto automatonSeconds = std::chrono::duration<double>(middle - start).count();
+		auto loopSeconds = std::chrono::duration<double>(end - middle).count();
+		printf("1 include and 20 excludes: automaton %.0f MB/s, strstr loop %.0f MB/s\n", bytes / automatonSeconds / 1e6, bytes / loopSeconds / 1e6);
+	}
+}
+
+int main()
+{
+	TestExamples();
+	TestRandom();
+	Benchmark();
+	return TEST_RESULT();
+}
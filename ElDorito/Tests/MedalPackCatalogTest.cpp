@@ -0,0 +1,136 @@
+#include "Test.hpp"
+#include "../Source/Game/MedalPackCatalog.hpp"
+#include <fstream>
+#include <set>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+using Game::MedalPackCatalog;
+using Game::MedalPackInfo;
+
+namespace
+{
+	void WriteFile(const fs::path &path, const std::string &data)
+	{
+		fs::create_directories(path.parent_path());
+		std::ofstream(path.string(), std::ios::binary) << data;
+	}
+
+	// Moves a modification time forward, since it may only have a resolution of a second
+	void Touch(const fs::path &path)
+	{
+		fs::last_write_time(path, fs::last_write_time(path) + 10);
+	}
+
+	const MedalPackInfo *FindPack(const MedalPackCatalog &catalog, const std::string &name)
+	{
+		for (auto &&pack : catalog.GetPacks())
+		{
+			if (pack.Name == name)
+				return &pack;
+		}
+		return nullptr;
+	}
+
+	void TestCatalog(const fs::path &dir)
+	{
+		std::set<std::string> knownEvents = { "earn_wp_event_kill", "earn_wp_event_headshot", "general_event_game_over" };
+		MedalPackCatalog catalog(dir.string(), [&](const std::string &name) { return knownEvents.count(name) != 0; });
+
+		// The directory doesn't exist yet
+		CHECK(catalog.Refresh() == 0);
+		CHECK(catalog.GetPacks().empty() && catalog.ToJson() == "[]");
+
+		// Files in the pack directory, images/ and audio/, with one image shared by two events
+		WriteFile(dir / "good/events.json", R"({ "earn_wp_event_kill": { "image": "kill.png", "sound": "kill.wav" },
+			"earn_wp_event_headshot": { "image": "kill.png", "sounds": [ "hs1.wav", "hs2.wav" ] },
+			"general_event_game_over": {} })");
+		WriteFile(dir / "good/kill.png", std::string(1000, 'i'));
+		WriteFile(dir / "good/audio/kill.wav", std::string(2000, 's'));
+		WriteFile(dir / "good/audio/hs1.wav", std::string(300, 's'));
+		WriteFile(dir / "good/hs2.wav", std::string(400, 's'));
+
+		WriteFile(dir / "missing/events.json", R"({ "earn_wp_event_kill": { "image": "nope.png" },
+			"made_up_event": { "sound": "../../etc/passwd" },
+			"earn_wp_event_headshot": { "images": "notarray.png", "sound": 5 },
+			"general_event_game_over": "oops" })");
+		WriteFile(dir / "badjson/events.json", "{ \"earn_wp_event_kill\": { ");
+		WriteFile(dir / "array/events.json", "[]");
+		std::string many = "{";
+		for (auto i = 0; i < 80; i++)
+			many += (i > 0 ? "," : "") + std::string("\"x") + std::to_string(i) + "\": {}";
+		WriteFile(dir / "many/events.json", many + "}");
+
+		// Not packs
+		fs::create_directories(dir / "empty");
+		WriteFile(dir / "stray.json", "{}");
+
+		CHECK(catalog.Refresh() == 5);
+		std::vector<std::string> names;
+		for (auto &&pack : catalog.GetPacks())
+			names.push_back(pack.Name);
+		CHECK((names == std::vector<std::string>{ "array", "badjson", "good", "many", "missing" }));
+
+		auto good = FindPack(catalog, "good");
+		auto eventsSize = fs::file_size(dir / "good/events.json");
+		CHECK(good->Valid && good->EventCount == 3 && good->Errors.empty());
+		CHECK(good->AssetBytes == eventsSize + 1000 + 2000 + 300 + 400);
+
+		auto missing = FindPack(catalog, "missing");
+		CHECK(!missing->Valid && missing->EventCount == 4 && missing->Errors.size() == 6);
+		auto badJson = FindPack(catalog, "badjson");
+		CHECK(!badJson->Valid && badJson->Errors[0].find("events.json:") == 0);
+		CHECK(!FindPack(catalog, "array")->Valid);
+		auto manyPack = FindPack(catalog, "many");
+		CHECK(manyPack->Errors.size() == 51 && manyPack->Errors.back() == "...30 more errors");
+
+		auto json = catalog.ToJson();
+		CHECK(json.find("{\"name\":\"good\",\"valid\":true,\"events\":3,\"assetBytes\":" + std::to_string(good->AssetBytes) + ",\"errors\":[]}") != std::string::npos);
+
+		// Nothing changed, so nothing is validated again
+		CHECK(catalog.Refresh() == 0 && catalog.GetPacks().size() == 5);
+
+		// Adding a missing file is noticed through its directory
+		WriteFile(dir / "missing/images/nope.png", "png");
+		Touch(dir / "missing/images");
+		Touch(dir / "missing");
+		CHECK(catalog.Refresh() == 1);
+		CHECK(FindPack(catalog, "missing")->Errors.size() == 5);
+
+		// Replacing a referenced file in place doesn't touch any directory, but its size is watched
+		WriteFile(dir / "good/audio/kill.wav", std::string(2500, 's'));
+		CHECK(catalog.Refresh() == 1);
+		CHECK(FindPack(catalog, "good")->AssetBytes == eventsSize + 1000 + 2500 + 300 + 400);
+
+		// And so is its modification time, for a replacement of the same size
+		WriteFile(dir / "good/kill.png", std::string(1000, 'j'));
+		Touch(dir / "good/kill.png");
+		CHECK(catalog.Refresh() == 1);
+
+		// Removing a referenced file
+		fs::remove(dir / "good/audio/hs1.wav");
+		Touch(dir / "good/audio");
+		CHECK(catalog.Refresh() == 1 && !FindPack(catalog, "good")->Valid);
+
+		// Editing events.json
+		WriteFile(dir / "good/events.json", R"({ "earn_wp_event_kill": { "image": "kill.png" } })");
+		Touch(dir / "good/events.json");
+		CHECK(catalog.Refresh() == 1);
+		good = FindPack(catalog, "good");
+		CHECK(good->Valid && good->EventCount == 1 && good->AssetBytes == fs::file_size(dir / "good/events.json") + 1000);
+
+		// Removing and adding packs
+		fs::remove_all(dir / "array");
+		WriteFile(dir / "new/events.json", "{}");
+		CHECK(catalog.Refresh() == 1);
+		CHECK(catalog.GetPacks().size() == 5 && !FindPack(catalog, "array") && FindPack(catalog, "new")->Valid);
+	}
+}
+
+int main()
+{
+	auto dir = fs::temp_directory_path() / fs::unique_path("MedalPackCatalogTest-%%%%-%%%%");
+	TestCatalog(dir);
+	fs::remove_all(dir);
+	return TEST_RESULT();
+}
@@ -0,0 +1,445 @@
+#include "Test.hpp"
+#include "../Source/Patches/MembershipDiff.hpp"
+#include <cstring>
+#include <cwchar>
+#include <random>
+
+using namespace Patches::Membership;
+
+namespace
+{
+	MembershipSnapshot EmptySnapshot()
+	{
+		MembershipSnapshot snapshot;
+		snapshot.Clear();
+		return snapshot;
+	}
+
+	void AddPlayer(MembershipSnapshot *snapshot, int peer, int player, uint64_t uid, const wchar_t *name, int team = 0)
+	{
+		snapshot->Peers[peer].Connected = true;
+		snapshot->Peers[peer].Player = player;
+		auto &entry = snapshot->Players[player];
+		entry.Active = true;
+		entry.Peer = peer;
+		entry.Uid = uid;
+		entry.Team = team;
+		memset(entry.Name, 0, sizeof(entry.Name));
+		wcsncpy(entry.Name, name, MembershipSnapshot::MaxNameLength - 1);
+	}
+
+	void RemovePeer(MembershipSnapshot *snapshot, int peer)
+	{
+		auto player = snapshot->Peers[peer].Player;
+		snapshot->Peers[peer].Connected = false;
+		snapshot->Peers[peer].Player = -1;
+		if (player >= 0)
+		{
+			memset(&snapshot->Players[player], 0, sizeof(snapshot->Players[player]));
+			snapshot->Players[player].Peer = -1;
+		}
+	}
+
+	std::vector<MembershipEvent> Diff(MembershipDiffer &differ, const MembershipSnapshot &snapshot)
+	{
+		std::vector<MembershipEvent> events;
+		differ.Diff(snapshot, &events);
+		return events;
+	}
+
+	void TestJoinAndLeave()
+	{
+		MembershipDiffer differ;
+		auto snapshot = EmptySnapshot();
+		snapshot.HostPeer = 0;
+		AddPlayer(&snapshot, 0, 0, 0x1111, L"host");
+
+		auto events = Diff(differ, snapshot);
+		CHECK(events.size() == 3);
+		CHECK(events[0].Type == MembershipEventType::HostChanged && events[0].OldValue == -1 && events[0].NewValue == 0);
+		CHECK(events[1].Type == MembershipEventType::PeerJoined && events[1].Peer == 0 && events[1].Player == 0 && events[1].Uid == 0x1111);
+		CHECK(events[2].Type == MembershipEventType::PlayerAssigned && events[2].OldValue == -1 && events[2].NewValue == 0);
+		CHECK(events[0].Sequence == 1 && events[2].Sequence == 3);
+		CHECK(differ.GetSequence() == 3);
+
+		// Nothing changed, nothing to report
+		CHECK(Diff(differ, snapshot).empty());
+
+		RemovePeer(&snapshot, 0);
+		events = Diff(differ, snapshot);
+		CHECK(events.size() == 1);
+		CHECK(events[0].Type == MembershipEventType::PeerLeft && events[0].Player == 0 && events[0].Uid == 0x1111);
+		CHECK(events[0].Sequence == 4);
+	}
+
+	void TestPeerReplaced()
+	{
+		// Someone else takes over a peer index within a single tick
+		MembershipDiffer differ;
+		auto snapshot = EmptySnapshot();
+		AddPlayer(&snapshot, 3, 2, 0xAAAA, L"first");
+		Diff(differ, snapshot);
+
+		AddPlayer(&snapshot, 3, 2, 0xBBBB, L"second");
+		auto events = Diff(differ, snapshot);
+		CHECK(events.size() == 3);
+		CHECK(events[0].Type == MembershipEventType::PeerLeft && events[0].Uid == 0xAAAA);
+		CHECK(events[1].Type == MembershipEventType::PeerJoined && events[1].Uid == 0xBBBB);
+		CHECK(events[2].Type == MembershipEventType::PlayerAssigned && events[2].OldValue == -1 && events[2].NewValue == 2);
+
+		// The same, but before the new player's properties have arrived
+		AddPlayer(&snapshot, 3, 2, 0, L"");
+		events = Diff(differ, snapshot);
+		CHECK(events.size() == 3);
+		CHECK(events[0].Type == MembershipEventType::PeerLeft && events[0].Uid == 0xBBBB);
+		CHECK(events[1].Type == MembershipEventType::PeerJoined && events[1].Uid == 0);
+		CHECK(events[2].Type == MembershipEventType::PlayerAssigned && events[2].NewValue == 2);
+	}
+
+	void TestPlayerChanges()
+	{
+		MembershipDiffer differ;
+		auto snapshot = EmptySnapshot();
+
+		// Joins before their properties arrive
+		AddPlayer(&snapshot, 1, 1, 0, L"");
+		CHECK(Diff(differ, snapshot).size() == 2);
+
+		// Getting a UID isn't becoming someone else, and the name shows up as a change
+		AddPlayer(&snapshot, 1, 1, 0x2222, L"player", 1);
+		auto events = Diff(differ, snapshot);
+		CHECK(events.size() == 2);
+		CHECK(events[0].Type == MembershipEventType::NameChanged && events[0].OldName[0] == 0 && wcscmp(events[0].NewName, L"player") == 0);
+		CHECK(events[1].Type == MembershipEventType::TeamChanged && events[1].OldValue == 0 && events[1].NewValue == 1);
+
+		AddPlayer(&snapshot, 1, 1, 0x2222, L"renamed", 1);
+		events = Diff(differ, snapshot);
+		CHECK(events.size() == 1);
+		CHECK(events[0].Type == MembershipEventType::NameChanged && wcscmp(events[0].OldName, L"player") == 0 && events[0].Uid == 0x2222);
+
+		// A different UID on the same peer is someone else taking it over, not a rename
+		snapshot.Players[1].Uid = 0x3333;
+		wcscpy(snapshot.Players[1].Name, L"other");
+		events = Diff(differ, snapshot);
+		CHECK(events.size() == 3);
+		CHECK(events[0].Type == MembershipEventType::PeerLeft && events[0].Uid == 0x2222);
+		CHECK(events[1].Type == MembershipEventType::PeerJoined && events[1].Uid == 0x3333);
+		CHECK(events[2].Type == MembershipEventType::PlayerAssigned && events[2].OldValue == -1 && events[2].NewValue == 1);
+
+		// Moving to another player index
+		snapshot.Players[4] = snapshot.Players[1];
+		memset(&snapshot.Players[1], 0, sizeof(snapshot.Players[1]));
+		snapshot.Peers[1].Player = 4;
+		events = Diff(differ, snapshot);
+		CHECK(events.size() == 1);
+		CHECK(events[0].Type == MembershipEventType::PlayerAssigned && events[0].OldValue == 1 && events[0].NewValue == 4);
+	}
+
+	void TestSessionEnd()
+	{
+		MembershipDiffer differ;
+		auto snapshot = EmptySnapshot();
+		snapshot.HostPeer = 0;
+		for (auto i = 0; i < 4; i++)
+			AddPlayer(&snapshot, i, i, 0x100 + i, L"p");
+		Diff(differ, snapshot);
+
+		auto events = Diff(differ, EmptySnapshot());
+		CHECK(events.size() == 5);
+		CHECK(events[0].Type == MembershipEventType::HostChanged && events[0].NewValue == -1);
+		for (size_t i = 1; i < events.size(); i++)
+			CHECK(events[i].Type == MembershipEventType::PeerLeft);
+		CHECK(differ.GetSnapshot().HostPeer == -1);
+	}
+
+	// Membership rebuilt from nothing but the events, the way a consumer of the journal would see it
+	struct RebuiltMembership
+	{
+		MembershipSnapshot Snapshot;
+		bool NameKnown[MembershipSnapshot::MaxPlayers]; // Names and teams are only reported when they change
+		bool TeamKnown[MembershipSnapshot::MaxPlayers];
+
+		RebuiltMembership()
+		{
+			Snapshot.Clear();
+			memset(NameKnown, 0, sizeof(NameKnown));
+			memset(TeamKnown, 0, sizeof(TeamKnown));
+		}
+
+		void Apply(const MembershipEvent &event, const MembershipSnapshot &previous)
+		{
+			auto &peer = Snapshot.Peers[event.Peer >= 0 ? event.Peer : 0];
+			switch (event.Type)
+			{
+			case MembershipEventType::HostChanged:
+				CHECK(event.OldValue == Snapshot.HostPeer);
+				Snapshot.HostPeer = event.NewValue;
+				break;
+			case MembershipEventType::PeerLeft:
+				CHECK(peer.Connected && event.Player == peer.Player);
+				ReleasePlayer(event.Peer, peer.Player);
+				peer.Connected = false;
+				peer.Player = -1;
+				break;
+			case MembershipEventType::PeerJoined:
+				// The player shows up in the PlayerAssigned which follows
+				CHECK(!peer.Connected);
+				peer.Connected = true;
+				break;
+			case MembershipEventType::PlayerAssigned:
+				CHECK(peer.Connected && event.OldValue == peer.Player && event.NewValue == event.Player);
+				ReleasePlayer(event.Peer, peer.Player);
+				peer.Player = event.NewValue;
+				if (event.NewValue >= 0)
+				{
+					auto &player = Snapshot.Players[event.NewValue];
+					player.Active = true;
+					player.Peer = event.Peer;
+					player.Uid = event.Uid;
+					NameKnown[event.NewValue] = TeamKnown[event.NewValue] = false;
+				}
+				break;
+			case MembershipEventType::NameChanged:
+				CHECK(Snapshot.Players[event.Player].Active && Snapshot.Players[event.Player].Peer == event.Peer);
+				CHECK(wcscmp(event.OldName, previous.Players[event.Player].Name) == 0);
+				wcscpy(Snapshot.Players[event.Player].Name, event.NewName);
+				Snapshot.Players[event.Player].Uid = event.Uid;
+				NameKnown[event.Player] = true;
+				break;
+			case MembershipEventType::TeamChanged:
+				CHECK(Snapshot.Players[event.Player].Active && Snapshot.Players[event.Player].Peer == event.Peer);
+				CHECK(event.OldValue == previous.Players[event.Player].Team);
+				Snapshot.Players[event.Player].Team = event.NewValue;
+				Snapshot.Players[event.Player].Uid = event.Uid;
+				TeamKnown[event.Player] = true;
+				break;
+			}
+		}
+
+		// Checks that everything the events said matches the snapshot they were made from
+		bool Matches(const MembershipSnapshot &expected) const
+		{
+			if (Snapshot.HostPeer != expected.HostPeer)
+				return false;
+			for (auto i = 0; i < MembershipSnapshot::MaxPeers; i++)
+			{
+				if (Snapshot.Peers[i].Connected != expected.Peers[i].Connected || Snapshot.Peers[i].Player != expected.Peers[i].Player)
+					return false;
+			}
+			for (auto i = 0; i < MembershipSnapshot::MaxPlayers; i++)
+			{
+				auto &player = Snapshot.Players[i];
+				auto &expectedPlayer = expected.Players[i];
+				if (player.Active != expectedPlayer.Active)
+					return false;
+				if (!player.Active)
+					continue;
+				if (player.Peer != expectedPlayer.Peer || player.Uid != expectedPlayer.Uid)
+					return false;
+				if (NameKnown[i] && wcscmp(player.Name, expectedPlayer.Name) != 0)
+					return false;
+				if (TeamKnown[i] && player.Team != expectedPlayer.Team)
+					return false;
+			}
+			return true;
+		}
+
+	private:
+		void ReleasePlayer(int peer, int player)
+		{
+			// Another peer can have taken the player index over earlier in the same batch
+			if (player < 0 || Snapshot.Players[player].Peer != peer)
+				return;
+			memset(&Snapshot.Players[player], 0, sizeof(Snapshot.Players[player]));
+			Snapshot.Players[player].Peer = -1;
+			NameKnown[player] = TeamKnown[player] = false;
+		}
+	};
+
+	// Makes random changes to a session the way the engine can between two ticks
+	class MembershipTraceGenerator
+	{
+	public:
+		explicit MembershipTraceGenerator(unsigned int seed)
+			: random(seed), nextUid(1)
+		{
+			snapshot.Clear();
+		}
+
+		const MembershipSnapshot &Next()
+		{
+			for (auto changes = 1 + random() % 4; changes > 0; changes--)
+				Change();
+			return snapshot;
+		}
+
+	private:
+		std::mt19937 random;
+		MembershipSnapshot snapshot;
+		uint64_t nextUid;
+
+		void Change()
+		{
+			auto peer = static_cast<int>(random() % MembershipSnapshot::MaxPeers);
+			auto &entry = snapshot.Peers[peer];
+			auto player = entry.Player;
+			switch (random() % 10)
+			{
+			case 0: // Join, maybe before there is a player or their properties have arrived
+				if (entry.Connected)
+					break;
+				entry.Connected = true;
+				entry.Player = -1;
+				if (random() % 4 != 0)
+					Assign(peer, random() % 2 == 0);
+				break;
+			case 1: // Leave
+				if (entry.Connected)
+					Leave(peer);
+				break;
+			case 2: // Leave and have someone else take the peer over
+				if (!entry.Connected)
+					break;
+				Leave(peer);
+				entry.Connected = true;
+				Assign(peer, random() % 2 == 0);
+				break;
+			case 3: // Get a player, or move to another one
+				if (entry.Connected)
+				{
+					auto uid = player >= 0 ? snapshot.Players[player].Uid : 0;
+					auto moved = player >= 0 ? snapshot.Players[player] : MembershipSnapshot::PlayerEntry();
+					if (!Assign(peer, false) || player < 0)
+						break;
+					snapshot.Players[entry.Player] = moved;
+					snapshot.Players[entry.Player].Uid = uid;
+					Clear(player);
+				}
+				break;
+			case 4: // Properties arrive
+				if (player >= 0 && !snapshot.Players[player].Uid)
+					SetProperties(player);
+				break;
+			case 5: // Rename
+				if (player >= 0 && snapshot.Players[player].Uid)
+					SetName(player);
+				break;
+			case 6: // Change teams
+				if (player >= 0)
+					snapshot.Players[player].Team = random() % 4;
+				break;
+			case 7: // Host moves
+				snapshot.HostPeer = entry.Connected ? peer : -1;
+				break;
+			case 8: // Session ends
+				if (random() % 20 == 0)
+					snapshot.Clear();
+				break;
+			case 9: // Lose the player without leaving
+				if (player >= 0)
+				{
+					Clear(player);
+					entry.Player = -1;
+				}
+				break;
+			}
+		}
+
+		bool Assign(int peer, bool withProperties)
+		{
+			int free[MembershipSnapshot::MaxPlayers];
+			auto count = 0;
+			for (auto i = 0; i < MembershipSnapshot::MaxPlayers; i++)
+			{
+				if (!snapshot.Players[i].Active)
+					free[count++] = i;
+			}
+			if (!count)
+				return false;
+
+			auto player = free[random() % count];
+			snapshot.Peers[peer].Player = player;
+			auto &entry = snapshot.Players[player];
+			memset(&entry, 0, sizeof(entry));
+			entry.Active = true;
+			entry.Peer = peer;
+			entry.Team = random() % 4;
+			if (withProperties)
+				SetProperties(player);
+			return true;
+		}
+
+		void SetProperties(int player)
+		{
+			snapshot.Players[player].Uid = nextUid++;
+			SetName(player);
+		}
+
+		void SetName(int player)
+		{
+			static const wchar_t *names[] = { L"alpha", L"bravo", L"charlie", L"delta", L"a very long name indeed" };
+			auto &entry = snapshot.Players[player];
+			memset(entry.Name, 0, sizeof(entry.Name));
+			wcsncpy(entry.Name, names[random() % 5], MembershipSnapshot::MaxNameLength - 1);
+		}
+
+		void Leave(int peer)
+		{
+			if (snapshot.Peers[peer].Player >= 0)
+				Clear(snapshot.Peers[peer].Player);
+			snapshot.Peers[peer].Connected = false;
+			snapshot.Peers[peer].Player = -1;
+			if (snapshot.HostPeer == peer)
+				snapshot.HostPeer = -1;
+		}
+
+		void Clear(int player)
+		{
+			memset(&snapshot.Players[player], 0, sizeof(snapshot.Players[player]));
+			snapshot.Players[player].Peer = -1;
+		}
+	};
+
+	void TestRandomTraces()
+	{
+		for (auto seed = 1U; seed <= 50; seed++)
+		{
+			MembershipTraceGenerator generator(seed);
+			MembershipDiffer differ;
+			RebuiltMembership rebuilt;
+			uint32_t sequence = 0;
+			auto mismatches = 0, gaps = 0;
+			for (auto tick = 0; tick < 2000; tick++)
+			{
+				auto previous = differ.GetSnapshot();
+				auto &snapshot = generator.Next();
+				auto events = Diff(differ, snapshot);
+
+				// Every event is numbered one after the other, even across ticks
+				for (auto &&event : events)
+				{
+					if (event.Sequence != ++sequence)
+						gaps++;
+					sequence = event.Sequence;
+					rebuilt.Apply(event, previous);
+				}
+				if (differ.GetSequence() != sequence)
+					gaps++;
+				if (!rebuilt.Matches(snapshot))
+					mismatches++;
+			}
+			CHECK(gaps == 0);
+			CHECK(mismatches == 0);
+		}
+	}
+}
+
+int main()
+{
+	TestJoinAndLeave();
+	TestPeerReplaced();
+	TestPlayerChanges();
+	TestSessionEnd();
+	TestRandomTraces();
+	return TEST_RESULT();
+}
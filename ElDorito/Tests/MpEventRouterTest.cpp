@@ -0,0 +1,166 @@
+#include "Test.hpp"
+#include "../Source/Web/Ui/MpEventRouter.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+using Web::Ui::MpEventRouter;
+
+namespace
+{
+	long Allocations = 0;
+}
+
+// Counts allocations, so that dispatching can be checked not to allocate
+void *operator new(size_t size)
+{
+	Allocations++;
+	auto result = malloc(size ? size : 1);
+	if (!result)
+		throw std::bad_alloc();
+	return result;
+}
+
+void operator delete(void *pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+	free(pointer);
+}
+
+namespace
+{
+	struct Recorder
+	{
+		std::vector<std::pair<std::string, std::string>> Sent;
+
+		int Dispatch(MpEventRouter &router, uint32_t name, int category, int audience)
+		{
+			return router.Dispatch(name, category, audience,
+				[this](const std::string &screenId, const std::string &json) { Sent.emplace_back(screenId, json); });
+		}
+	};
+
+	void TestJson()
+	{
+		MpEventRouter router;
+		router.AddEventName(0x40010, "earn_wp_event_kill");
+		router.AddEventName(0x40011, "quote\"name");
+		router.Subscribe("all", 0xFFFFFFFF, 0xFFFFFFFF);
+
+		Recorder recorder;
+		recorder.Dispatch(router, 0x40010, 2, 3);
+		recorder.Dispatch(router, 0x40011, 0, 0);
+		recorder.Dispatch(router, 0xABCDE, 31, 1);
+		CHECK(recorder.Sent.size() == 3);
+		if (recorder.Sent.size() == 3)
+		{
+			CHECK(recorder.Sent[0].second == "{\"name\":\"earn_wp_event_kill\",\"category\":2,\"audience\":3}");
+			CHECK(recorder.Sent[1].second == "{\"name\":\"quote\\\"name\",\"category\":0,\"audience\":0}");
+			CHECK(recorder.Sent[2].second == "{\"name\":\"0xabcde\",\"category\":31,\"audience\":1}");
+		}
+
+		// Adding a name again replaces it
+		router.AddEventName(0x40010, "renamed");
+		recorder.Dispatch(router, 0x40010, 1, 1);
+		CHECK(recorder.Sent.back().second == "{\"name\":\"renamed\",\"category\":1,\"audience\":1}");
+	}
+
+	void TestSubscriptions()
+	{
+		MpEventRouter router;
+		router.AddEventName(1, "event");
+
+		// Nothing is sent without subscriptions
+		Recorder recorder;
+		CHECK(recorder.Dispatch(router, 1, 4, 0) == 0);
+		CHECK(recorder.Sent.empty());
+		CHECK(!router.IsSubscribed(4, 0));
+
+		router.Subscribe("medals", 1U << 4 | 1U << 5, 1U << 0);
+		router.Subscribe("scoreboard", 1U << 5, 1U << 0 | 1U << 1);
+		CHECK(router.IsSubscribed(4, 0));
+		CHECK(!router.IsSubscribed(4, 1));
+		CHECK(router.IsSubscribed(5, 1));
+		CHECK(!router.IsSubscribed(-1, 0));
+		CHECK(!router.IsSubscribed(0, MpEventRouter::MaxAudiences));
+
+		CHECK(recorder.Dispatch(router, 1, 4, 0) == 1);
+		CHECK(recorder.Sent.size() == 1 && recorder.Sent[0].first == "medals");
+		CHECK(recorder.Dispatch(router, 1, 5, 0) == 2);
+		CHECK(recorder.Dispatch(router, 1, 5, 1) == 1);
+		CHECK(recorder.Sent.back().first == "scoreboard");
+		CHECK(recorder.Dispatch(router, 1, 6, 0) == 0);
+		CHECK(recorder.Sent.size() == 4);
+
+		// Subscribing again replaces the subscription, and an empty mask unsubscribes
+		router.Subscribe("medals", 1U << 6, 1U << 0);
+		CHECK(!router.IsSubscribed(4, 0));
+		CHECK(router.IsSubscribed(6, 0));
+		router.Subscribe("medals", 0, 1U << 0);
+		CHECK(!router.IsSubscribed(6, 0));
+		router.Unsubscribe("scoreboard");
+		CHECK(!router.IsSubscribed(5, 1));
+
+		recorder = Recorder();
+		CHECK(recorder.Dispatch(router, 1, 5, 1) == 0);
+		CHECK(recorder.Sent.empty());
+
+		// Screens which want everything, until the UI reloads
+		router.Subscribe("legacy", 0xFFFFFFFF, 0xFFFFFFFF);
+		router.Subscribe("medals", 1U << 4, 1U << 0);
+		CHECK(router.IsSubscribed(0, 0) && router.IsSubscribed(31, 31));
+		CHECK(recorder.Dispatch(router, 1, 4, 0) == 2);
+		router.UnsubscribeAll();
+		CHECK(!router.IsSubscribed(4, 0) && !router.IsSubscribed(0, 0));
+		CHECK(recorder.Dispatch(router, 1, 4, 0) == 0);
+	}
+
+	void Benchmark()
+	{
+		MpEventRouter router;
+		for (uint32_t i = 0; i < 200; i++)
+			router.AddEventName(0x40010 + i, ("event_name_" + std::to_string(i)).c_str());
+		router.Subscribe("medals", 1U << 2, 1U << 0);
+		router.Subscribe("scoreboard", 1U << 2 | 1U << 3, 1U << 0 | 1U << 1);
+
+		const int Iterations = 1000000;
+		size_t sentBytes = 0;
+		auto send = [&](const std::string &screenId, const std::string &json) { sentBytes += json.length(); };
+
+		// Events nobody wants
+		auto before = Allocations;
+		auto start = std::chrono::steady_clock::now();
+		auto sent = 0;
+		for (auto i = 0; i < Iterations; i++)
+			sent += router.Dispatch(0x40010 + i % 200, i % 2, i % 3, send);
+		auto middle = std::chrono::steady_clock::now();
+		CHECK(sent == 0 && sentBytes == 0);
+		CHECK(Allocations == before);
+
+		// Events which reach one or two screens, including names which aren't known
+		for (auto i = 0; i < Iterations; i++)
+			sent += router.Dispatch(0x40010 + i % 250, 2 + i % 2, 0, send);
+		auto end = std::chrono::steady_clock::now();
+		CHECK(sent == Iterations + Iterations / 2);
+		CHECK(Allocations == before);
+
+		auto filteredNs = std::chrono::duration<double, std::nano>(middle - start).count() / Iterations;
+		auto sentNs = std::chrono::duration<double, std::nano>(end - middle).count() / Iterations;
+		printf("Filtered out: %.1f ns per event, delivered: %.1f ns per event, %ld allocations\n", filteredNs, sentNs,
+			Allocations - before);
+	}
+}
+
+int main()
+{
+	TestJson();
+	TestSubscriptions();
+	Benchmark();
+	return TEST_RESULT();
+}
@@ -0,0 +1,124 @@
+#include "Test.hpp"
+#include "../Source/Utils/ObjectRegistry.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+
+using Utils::ObjectRegistry;
+
+namespace
+{
+	uint32_t MakeHandle(uint16_t salt, uint16_t index)
+	{
+		return static_cast<uint32_t>(salt) << 16 | index;
+	}
+
+	void TestBasics()
+	{
+		ObjectRegistry registry;
+		auto a = MakeHandle(0xE001, 1);
+		auto b = MakeHandle(0xE002, 2);
+		auto c = MakeHandle(0xE003, 3);
+		CHECK(registry.Add(a, 100, 0));
+		CHECK(registry.Add(b, 100, 1));
+		CHECK(registry.Add(c, 200, 1));
+		CHECK(!registry.Add(MakeHandle(0xE004, 4), 100, ObjectRegistry::MaxTypes));
+		CHECK(!registry.Add(MakeHandle(0xE004, 0xFFFF), 100, 0));
+		CHECK(registry.Count() == 3);
+
+		CHECK((registry.GetWithTag(100) == std::vector<uint32_t>{ b, a }));
+		CHECK((registry.GetOfType(1) == std::vector<uint32_t>{ c, b }));
+		CHECK(registry.GetFirstWithTag(200) == c);
+		CHECK(registry.GetFirstWithTag(300) == static_cast<uint32_t>(-1));
+
+		// A stale handle for the same index doesn't remove the live object
+		CHECK(!registry.Remove(MakeHandle(0xE000, 2)));
+		CHECK(registry.Contains(b));
+		CHECK(registry.Remove(b));
+		CHECK(!registry.Contains(b));
+		CHECK((registry.GetWithTag(100) == std::vector<uint32_t>{ a }));
+		CHECK((registry.GetOfType(1) == std::vector<uint32_t>{ c }));
+
+		// Reusing an index replaces the object that was there
+		auto d = MakeHandle(0xE005, 1);
+		CHECK(registry.Add(d, 200, 2));
+		CHECK(!registry.Contains(a));
+		CHECK(registry.GetWithTag(100).empty());
+		CHECK(registry.GetOfType(0).empty());
+		CHECK((registry.GetWithTag(200) == std::vector<uint32_t>{ d, c }));
+		CHECK(registry.Count() == 2);
+
+		registry.Clear();
+		CHECK(registry.Count() == 0);
+		CHECK(registry.GetWithTag(200).empty());
+	}
+
+	// Compares the registry against a plain map through random adds and removes
+	void TestRandom()
+	{
+		struct Object
+		{
+			uint32_t Handle;
+			uint32_t TagIndex;
+			int Type;
+			uint32_t Order;
+		};
+
+		std::mt19937 random(1234);
+		ObjectRegistry registry;
+		std::map<uint16_t, Object> expected;
+		uint32_t order = 0;
+		for (auto i = 0; i < 20000; i++)
+		{
+			auto index = static_cast<uint16_t>(random() % 512);
+			if (random() % 3 == 0)
+			{
+				auto it = expected.find(index);
+				auto handle = it != expected.end() ? it->second.Handle : MakeHandle(1, index);
+				CHECK(registry.Remove(handle) == (it != expected.end()));
+				if (it != expected.end())
+					expected.erase(it);
+			}
+			else
+			{
+				Object object = { MakeHandle(static_cast<uint16_t>(random()), index), static_cast<uint32_t>(random() % 16), static_cast<int>(random() % ObjectRegistry::MaxTypes), order++ };
+				CHECK(registry.Add(object.Handle, object.TagIndex, object.Type));
+				expected[index] = object;
+			}
+		}
+
+		CHECK(registry.Count() == expected.size());
+		std::vector<Object> objects;
+		for (auto &&pair : expected)
+			objects.push_back(pair.second);
+		std::sort(objects.begin(), objects.end(), [](const Object &a, const Object &b) { return a.Order > b.Order; });
+
+		for (uint32_t tag = 0; tag < 16; tag++)
+		{
+			std::vector<uint32_t> handles;
+			for (auto &&object : objects)
+			{
+				if (object.TagIndex == tag)
+					handles.push_back(object.Handle);
+			}
+			CHECK(registry.GetWithTag(tag) == handles);
+		}
+		for (auto type = 0; type < ObjectRegistry::MaxTypes; type++)
+		{
+			std::vector<uint32_t> handles;
+			for (auto &&object : objects)
+			{
+				if (object.Type == type)
+					handles.push_back(object.Handle);
+			}
+			CHECK(registry.GetOfType(type) == handles);
+		}
+	}
+}
+
+int main()
+{
+	TestBasics();
+	TestRandom();
+	return TEST_RESULT();
+}
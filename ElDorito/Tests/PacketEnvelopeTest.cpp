@@ -0,0 +1,396 @@
+#include "Test.hpp"
+#include "TestBitStream.hpp"
+#include "../Source/Patches/PacketEnvelope.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Patches::CustomPackets;
+
+namespace
+{
+	// Stands in for PacketBase, without the game's packet header type
+	struct TestPacketBase
+	{
+		explicit TestPacketBase(PacketGuid guid)
+			: TypeGuid(guid)
+		{
+		}
+
+		uint8_t Header[0x10];
+		PacketGuid TypeGuid;
+	};
+
+	typedef BasicEnvelopePacket<TestPacketBase> TestEnvelope;
+	typedef BasicEnvelopeWriter<TestPacketBase> TestEnvelopeWriter;
+
+	constexpr PacketName EnvelopeName("eldewrito-packet-envelope");
+	constexpr PacketName FixedName("test-fixed");
+	constexpr PacketName VariableName("test-variable");
+	constexpr PacketName UnknownName("test-unknown");
+
+	struct FixedPacket : TestPacketBase
+	{
+		FixedPacket() : TestPacketBase(FixedName.Guid), Value(0) { }
+		uint32_t Value;
+	};
+
+	struct VariablePacket : TestPacketBase
+	{
+		VariablePacket() : TestPacketBase(VariableName.Guid), Length(0) { }
+		uint8_t Length;
+		uint8_t Data[200];
+	};
+
+	// Where VariablePacket::Data starts (offsetof isn't allowed on it because of the base class)
+	const int VariableDataOffset = static_cast<int>(sizeof(TestPacketBase)) + 1;
+
+	// Handler interface used by the envelope code, like RawPacketHandler but over the test stream
+	class TestHandler
+	{
+	public:
+		virtual ~TestHandler() { }
+		virtual int GetMinRawPacketSize() const = 0;
+		virtual int GetMaxRawPacketSize() const = 0;
+		virtual void SerializeRawPacket(Test::BitStream *stream, int packetSize, const void *packet) = 0;
+		virtual bool DeserializeRawPacket(Test::BitStream *stream, int packetSize, void *packet) = 0;
+	};
+
+	class FixedHandler : public TestHandler
+	{
+	public:
+		int GetMinRawPacketSize() const override { return sizeof(FixedPacket); }
+		int GetMaxRawPacketSize() const override { return sizeof(FixedPacket); }
+
+		void SerializeRawPacket(Test::BitStream *stream, int packetSize, const void *packet) override
+		{
+			stream->WriteUnsigned(static_cast<const FixedPacket*>(packet)->Value, 32);
+		}
+
+		bool DeserializeRawPacket(Test::BitStream *stream, int packetSize, void *packet) override
+		{
+			static_cast<FixedPacket*>(packet)->Value = stream->ReadUnsigned<uint32_t>(32);
+			return true;
+		}
+	} fixedHandler;
+
+	// Only sends as many bytes as the packet holds
+	class VariableHandler : public TestHandler
+	{
+	public:
+		int GetMinRawPacketSize() const override { return VariableDataOffset; }
+		int GetMaxRawPacketSize() const override { return sizeof(VariablePacket); }
+
+		void SerializeRawPacket(Test::BitStream *stream, int packetSize, const void *packet) override
+		{
+			auto variable = static_cast<const VariablePacket*>(packet);
+			stream->WriteUnsigned(variable->Length, 8);
+			for (auto i = 0; i < variable->Length; i++)
+				stream->WriteUnsigned(variable->Data[i], 8);
+		}
+
+		bool DeserializeRawPacket(Test::BitStream *stream, int packetSize, void *packet) override
+		{
+			auto variable = static_cast<VariablePacket*>(packet);
+			variable->Length = stream->ReadUnsigned<uint8_t>(8);
+			if (variable->Length > packetSize - VariableDataOffset)
+				return false;
+			for (auto i = 0; i < variable->Length; i++)
+				variable->Data[i] = stream->ReadUnsigned<uint8_t>(8);
+			return true;
+		}
+	} variableHandler;
+
+	TestHandler *LookUp(PacketGuid guid)
+	{
+		if (guid == FixedName.Guid)
+			return &fixedHandler;
+		if (guid == VariableName.Guid)
+			return &variableHandler;
+		return nullptr;
+	}
+
+	int VariableSize(const VariablePacket &packet)
+	{
+		return VariableDataOffset + packet.Length;
+	}
+
+	// A receive buffer with an envelope header in it, like the one the game passes to DeserializeRawPacket
+	struct ReceiveBuffer
+	{
+		ReceiveBuffer()
+		{
+			memset(Data, 0, sizeof(Data));
+			auto envelope = new (Data) TestEnvelope(EnvelopeName.Guid);
+			for (auto i = 0; i < 0x10; i++)
+				envelope->Header[i] = static_cast<uint8_t>(0xA0 + i);
+		}
+
+		TestEnvelope *Envelope() { return reinterpret_cast<TestEnvelope*>(Data); }
+
+		alignas(Envelope::Alignment) uint8_t Data[MaxEnvelopeSize];
+	};
+
+	void TestRoundTrip()
+	{
+		TestEnvelopeWriter writer;
+		CHECK(writer.Empty());
+
+		std::vector<FixedPacket> fixed(5);
+		std::vector<VariablePacket> variable(4);
+		CHECK(variable[0].Data - reinterpret_cast<uint8_t*>(&variable[0]) == VariableDataOffset);
+		for (size_t i = 0; i < fixed.size(); i++)
+		{
+			fixed[i].Value = 0xDEAD0000 + static_cast<uint32_t>(i);
+			memset(fixed[i].Header, 0x11, sizeof(fixed[i].Header));
+		}
+		for (size_t i = 0; i < variable.size(); i++)
+		{
+			variable[i].Length = static_cast<uint8_t>(i * 33);
+			for (auto j = 0; j < variable[i].Length; j++)
+				variable[i].Data[j] = static_cast<uint8_t>(i + j);
+		}
+
+		// Alternate the types so that the entries end up at different alignments
+		FixedPacket unknown;
+		unknown.TypeGuid = UnknownName.Guid;
+		CHECK(writer.Add(&fixed[0], sizeof(FixedPacket)));
+		CHECK(writer.Add(&unknown, sizeof(unknown))); // No handler, so it isn't serialized
+		for (size_t i = 0; i < variable.size(); i++)
+		{
+			CHECK(writer.Add(&variable[i], VariableSize(variable[i])));
+			CHECK(writer.Add(&fixed[i + 1], sizeof(FixedPacket)));
+		}
+		CHECK(writer.Count() == 10);
+		auto envelope = writer.Finish(EnvelopeName.Guid);
+		CHECK(envelope->TypeGuid == EnvelopeName.Guid && envelope->PacketCount == 10);
+
+		uint8_t wire[MaxEnvelopeSize] = {};
+		Test::BitStream out(wire, sizeof(wire));
+		SerializeEnvelope(&out, writer.GetSize(), envelope, LookUp);
+
+		// The packet headers aren't sent
+		auto expectedBits = 8;
+		expectedBits += 5 * (16 + 32 + 32);
+		for (auto &&packet : variable)
+			expectedBits += 16 + 32 + 8 + packet.Length * 8;
+		CHECK(out.Position() == expectedBits);
+
+		ReceiveBuffer received;
+		Test::BitStream in(wire, sizeof(wire));
+		CHECK(DeserializeEnvelope(&in, MaxEnvelopeSize, received.Envelope(), LookUp));
+		CHECK(in.Position() == out.Position());
+		CHECK(received.Envelope()->PacketCount == 9);
+
+		auto index = 0;
+		ForEachEnvelopePacket(received.Envelope(), MaxEnvelopeSize, [&](const TestPacketBase *packet, int packetSize)
+		{
+			CHECK(reinterpret_cast<uintptr_t>(packet) % Envelope::Alignment == 0);
+			CHECK(memcmp(packet->Header, received.Envelope()->Header, sizeof(packet->Header)) == 0);
+			if (index % 2 == 0)
+			{
+				auto &expected = fixed[index / 2];
+				CHECK(packet->TypeGuid == FixedName.Guid && packetSize == static_cast<int>(sizeof(FixedPacket)));
+				CHECK(static_cast<const FixedPacket*>(packet)->Value == expected.Value);
+			}
+			else
+			{
+				auto &expected = variable[index / 2];
+				auto actual = static_cast<const VariablePacket*>(packet);
+				CHECK(packet->TypeGuid == VariableName.Guid && packetSize == VariableSize(expected));
+				CHECK(actual->Length == expected.Length && memcmp(actual->Data, expected.Data, expected.Length) == 0);
+			}
+			index++;
+		});
+		CHECK(index == 9);
+
+		writer.Reset();
+		CHECK(writer.Empty() && writer.GetSize() == Envelope::FirstEntryOffset<TestPacketBase>);
+	}
+
+	void TestLimits()
+	{
+		TestEnvelopeWriter writer;
+		TestPacketBase tooSmall(FixedName.Guid);
+		CHECK(!writer.Add(&tooSmall, sizeof(tooSmall) - 1));
+
+		// Fills up by size
+		FixedPacket packet;
+		auto entrySize = Envelope::AlignUp(Envelope::EntryHeaderSize + static_cast<int>(sizeof(packet)));
+		auto added = 0;
+		while (writer.Add(&packet, sizeof(packet)))
+			added++;
+		CHECK(added == (MaxEnvelopeSize - Envelope::FirstEntryOffset<TestPacketBase>) / entrySize);
+		CHECK(writer.GetSize() <= MaxEnvelopeSize);
+
+		// Serializing all of it needs the whole buffer on the receiving end
+		std::vector<uint8_t> wire(MaxEnvelopeSize);
+		Test::BitStream out(wire.data(), static_cast<int>(wire.size()));
+		SerializeEnvelope(&out, writer.GetSize(), writer.Finish(EnvelopeName.Guid), LookUp);
+		ReceiveBuffer received;
+		Test::BitStream in(wire.data(), static_cast<int>(wire.size()));
+		CHECK(!DeserializeEnvelope(&in, writer.GetSize() - 1, received.Envelope(), LookUp));
+		in = Test::BitStream(wire.data(), static_cast<int>(wire.size()));
+		CHECK(DeserializeEnvelope(&in, writer.GetSize(), received.Envelope(), LookUp));
+		CHECK(static_cast<int>(received.Envelope()->PacketCount) == added);
+
+		// Fills up by count with the smallest packets possible
+		writer.Reset();
+		added = 0;
+		while (writer.Add(&tooSmall, sizeof(tooSmall)))
+			added++;
+		CHECK(added == std::min(MaxEnvelopePackets,
+			(MaxEnvelopeSize - Envelope::FirstEntryOffset<TestPacketBase>) / Envelope::AlignUp(Envelope::EntryHeaderSize + static_cast<int>(sizeof(tooSmall)))));
+
+		// Sizes outside of what the handler allows are rejected
+		uint8_t bad[16] = {};
+		Test::BitStream badOut(bad, sizeof(bad));
+		badOut.WriteUnsigned(1U, Envelope::PacketCountBits);
+		badOut.WriteUnsigned(static_cast<uint32_t>(sizeof(FixedPacket) + 4), Envelope::PacketSizeBits);
+		badOut.WriteUnsigned(FixedName.Guid, 32);
+		Test::BitStream badIn(bad, sizeof(bad));
+		CHECK(!DeserializeEnvelope(&badIn, MaxEnvelopeSize, received.Envelope(), LookUp));
+
+		// As are nested envelopes, since the lookup doesn't know them
+		Test::BitStream nestedOut(bad, sizeof(bad));
+		nestedOut.WriteUnsigned(1U, Envelope::PacketCountBits);
+		nestedOut.WriteUnsigned(static_cast<uint32_t>(sizeof(TestEnvelope)), Envelope::PacketSizeBits);
+		nestedOut.WriteUnsigned(EnvelopeName.Guid, 32);
+		Test::BitStream nestedIn(bad, sizeof(bad));
+		CHECK(!DeserializeEnvelope(&nestedIn, MaxEnvelopeSize, received.Envelope(), LookUp));
+	}
+
+	// Whatever DeserializeEnvelope accepts has to be safe to walk with ForEachEnvelopePacket
+	void CheckReceived(ReceiveBuffer &received, int *packets)
+	{
+		auto count = 0;
+		ForEachEnvelopePacket(received.Envelope(), MaxEnvelopeSize, [&](const TestPacketBase *packet, int packetSize)
+		{
+			auto handler = LookUp(packet->TypeGuid);
+			CHECK(handler != nullptr);
+			if (handler)
+				CHECK(packetSize >= handler->GetMinRawPacketSize() && packetSize <= handler->GetMaxRawPacketSize());
+			if (packet->TypeGuid == VariableName.Guid)
+				CHECK(VariableSize(*static_cast<const VariablePacket*>(packet)) <= packetSize);
+			count++;
+		});
+		CHECK(count == static_cast<int>(received.Envelope()->PacketCount));
+		*packets += count;
+	}
+
+	void TestFuzz()
+	{
+		std::mt19937 random(1234);
+		std::uniform_int_distribution<int> byte(0, 255);
+
+		// A valid envelope to mutate
+		TestEnvelopeWriter writer;
+		for (auto i = 0; i < 12; i++)
+		{
+			if (i % 3 == 0)
+			{
+				VariablePacket packet;
+				packet.Length = static_cast<uint8_t>(i * 5);
+				writer.Add(&packet, VariableSize(packet));
+			}
+			else
+			{
+				FixedPacket packet;
+				packet.Value = i;
+				writer.Add(&packet, sizeof(packet));
+			}
+		}
+		uint8_t valid[MaxEnvelopeSize] = {};
+		Test::BitStream out(valid, sizeof(valid));
+		SerializeEnvelope(&out, writer.GetSize(), writer.Finish(EnvelopeName.Guid), LookUp);
+		auto validBytes = (out.Position() + 7) / 8;
+
+		auto accepted = 0, packets = 0;
+		const int Iterations = 20000;
+		std::vector<uint8_t> wire;
+		for (auto i = 0; i < Iterations; i++)
+		{
+			if (i % 2 == 0)
+			{
+				// Random bytes, with a small packet count and a known GUID now and then so they get past the first check
+				wire.resize(std::uniform_int_distribution<int>(0, 64)(random));
+				for (auto &&b : wire)
+					b = static_cast<uint8_t>(byte(random));
+				if (wire.size() >= 7 && i % 4 == 0)
+				{
+					Test::BitStream header(wire.data(), static_cast<int>(wire.size()));
+					header.WriteUnsigned(static_cast<uint32_t>(byte(random) % 4), Envelope::PacketCountBits);
+					header.WriteUnsigned(static_cast<uint32_t>(byte(random) % 64), Envelope::PacketSizeBits);
+					header.WriteUnsigned(i % 8 == 0 ? FixedName.Guid : VariableName.Guid, 32);
+				}
+			}
+			else
+			{
+				// The valid envelope with some bits flipped and maybe cut short
+				wire.assign(valid, valid + validBytes);
+				auto flips = std::uniform_int_distribution<int>(1, 4)(random);
+				for (auto f = 0; f < flips; f++)
+				{
+					auto bit = std::uniform_int_distribution<int>(0, validBytes * 8 - 1)(random);
+					wire[bit / 8] ^= 1 << (bit % 8);
+				}
+				if (i % 5 == 0)
+					wire.resize(std::uniform_int_distribution<int>(0, validBytes)(random));
+			}
+
+			ReceiveBuffer received;
+			Test::BitStream in(wire.data(), static_cast<int>(wire.size()));
+			auto envelopeSize = i % 3 == 0 ? std::uniform_int_distribution<int>(0, MaxEnvelopeSize)(random) : MaxEnvelopeSize;
+			if (DeserializeEnvelope(&in, envelopeSize, received.Envelope(), LookUp))
+			{
+				accepted++;
+				CheckReceived(received, &packets);
+			}
+		}
+		printf("Fuzzing: %d of %d streams accepted, %d packets\n", accepted, Iterations, packets);
+	}
+
+	void Benchmark()
+	{
+		// A tick's worth of small synchronization-sized packets for one peer
+		TestEnvelopeWriter writer;
+		for (auto i = 0; i < 40; i++)
+		{
+			FixedPacket packet;
+			packet.Value = i;
+			writer.Add(&packet, sizeof(packet));
+		}
+		auto envelope = writer.Finish(EnvelopeName.Guid);
+
+		const int Iterations = 20000;
+		uint8_t wire[MaxEnvelopeSize];
+		ReceiveBuffer received;
+		uint32_t checksum = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (auto i = 0; i < Iterations; i++)
+		{
+			Test::BitStream out(wire, sizeof(wire));
+			SerializeEnvelope(&out, writer.GetSize(), envelope, LookUp);
+			Test::BitStream in(wire, sizeof(wire));
+			CHECK(DeserializeEnvelope(&in, MaxEnvelopeSize, received.Envelope(), LookUp));
+			checksum += received.Envelope()->PacketCount;
+		}
+		auto end = std::chrono::steady_clock::now();
+		CHECK(checksum == 40U * Iterations);
+
+		auto seconds = std::chrono::duration<double>(end - start).count();
+		printf("40-packet envelope: %.0f ns per round trip, %.1f million packets/s\n",
+			seconds * 1e9 / Iterations, 40.0 * Iterations / seconds / 1e6);
+	}
+}
+
+int main()
+{
+	TestRoundTrip();
+	TestLimits();
+	TestFuzz();
+	Benchmark();
+	return TEST_RESULT();
+}
@@ -0,0 +1,149 @@
+#include "Test.hpp"
+#include "../Source/Patches/PacketRegistry.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+
+using namespace Patches::CustomPackets;
+
+namespace
+{
+	struct Handler
+	{
+		int Id;
+	};
+
+	const char *const BuiltInNames[] =
+	{
+		"eldewrito-packet-envelope", "eldewrito-text-chat", "eldewrito-text-chat-batch", "eldewrito-voting-message",
+		"eldewrito-sync-var", "eldewrito-signal-server-echo",
+	};
+
+	void TestLookup()
+	{
+		constexpr PacketName Constant("eldewrito-text-chat");
+		CHECK(Constant.Guid == PacketName(std::string("eldewrito-text-chat")).Guid);
+		CHECK(Constant.Name == "eldewrito-text-chat");
+
+		// Registering in any order gives the same lookups
+		std::vector<int> order = { 0, 1, 2, 3, 4, 5 };
+		std::mt19937 random(4);
+		for (auto round = 0; round < 10; round++)
+		{
+			std::shuffle(order.begin(), order.end(), random);
+			PacketRegistry<Handler> registry;
+			for (auto i : order)
+				registry.Add(PacketName(std::string(BuiltInNames[i])), std::make_shared<Handler>(Handler { i }));
+			CHECK(registry.Size() == order.size());
+
+			for (auto i = 0; i < 6; i++)
+			{
+				auto entry = registry.Find(PacketName(std::string(BuiltInNames[i])).Guid);
+				CHECK(entry && entry->Handler->Id == i && entry->Name == BuiltInNames[i]);
+			}
+			CHECK(!registry.Find(PacketName("eldewrito-not-registered").Guid));
+		}
+
+		PacketRegistry<Handler> empty;
+		CHECK(!empty.Find(0));
+		CHECK(!empty.Find(Constant.Guid));
+	}
+
+	bool Throws(PacketRegistry<Handler> &registry, const std::string &name, std::string &message)
+	{
+		try
+		{
+			registry.Add(PacketName(name), std::make_shared<Handler>(Handler { -1 }));
+		}
+		catch (const std::runtime_error &e)
+		{
+			message = e.what();
+			return true;
+		}
+		return false;
+	}
+
+	void TestCollisions()
+	{
+		PacketRegistry<Handler> registry;
+		registry.Add(PacketName("eldewrito-text-chat"), std::make_shared<Handler>(Handler { 1 }));
+
+		std::string message;
+		CHECK(Throws(registry, "eldewrito-text-chat", message));
+		CHECK(message.find("\"eldewrito-text-chat\" (already used by \"eldewrito-text-chat\")") != std::string::npos);
+
+		// Find two different names with the same 32-bit GUID (the birthday bound makes this quick)
+		std::unordered_map<PacketGuid, std::string> seen;
+		std::string first, second;
+		for (auto i = 0; second.empty(); i++)
+		{
+			auto name = "plugin-packet-" + std::to_string(i);
+			auto result = seen.emplace(PacketName(name).Guid, name);
+			if (!result.second)
+			{
+				first = result.first->second;
+				second = name;
+			}
+		}
+
+		CHECK(!Throws(registry, first, message));
+		CHECK(Throws(registry, second, message));
+		CHECK(message.find("\"" + second + "\" (already used by \"" + first + "\")") != std::string::npos);
+
+		// The failed registration didn't replace anything
+		CHECK(registry.Size() == 2);
+		CHECK(registry.Find(PacketName(first).Guid)->Name == first);
+		CHECK(registry.Find(PacketName(second).Guid)->Handler->Id == -1);
+	}
+
+	// Every custom packet that's sent or received looks up its handler.
+	// Compares the registry with the sorted vector and binary search it used to be.
+	void Benchmark()
+	{
+		typedef PacketRegistry<Handler>::Entry SortedEntry;
+
+		PacketRegistry<Handler> registry;
+		std::vector<SortedEntry> sorted;
+		std::vector<PacketGuid> guids;
+		for (auto i = 0; i < 16; i++)
+		{
+			auto nameString = i < 6 ? std::string(BuiltInNames[i]) : "plugin-packet-" + std::to_string(i);
+			PacketName name(nameString);
+			auto handler = std::make_shared<Handler>(Handler { i });
+			registry.Add(name, handler);
+			sorted.push_back({ name.Guid, nameString, handler });
+			guids.push_back(name.Guid);
+		}
+		auto compare = [](const SortedEntry &entry, PacketGuid guid) { return entry.Guid < guid; };
+		std::sort(sorted.begin(), sorted.end(), [](const SortedEntry &a, const SortedEntry &b) { return a.Guid < b.Guid; });
+
+		std::mt19937 random(8);
+		std::vector<PacketGuid> lookups;
+		for (auto i = 0; i < 1000000; i++)
+			lookups.push_back(guids[random() % guids.size()]);
+
+		long long sum = 0, expected = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (auto guid : lookups)
+			sum += registry.Find(guid)->Handler->Id;
+		auto middle = std::chrono::steady_clock::now();
+		for (auto guid : lookups)
+			expected += std::lower_bound(sorted.begin(), sorted.end(), guid, compare)->Handler->Id;
+		auto end = std::chrono::steady_clock::now();
+		CHECK(sum == expected);
+
+		auto registryNs = std::chrono::duration<double, std::nano>(middle - start).count() / lookups.size();
+		auto sortedNs = std::chrono::duration<double, std::nano>(end - middle).count() / lookups.size();
+		printf("16 packet types: registry %.1f ns, sorted vector %.1f ns per lookup\n", registryNs, sortedNs);
+	}
+}
+
+int main()
+{
+	TestLookup();
+	TestCollisions();
+	Benchmark();
+	return TEST_RESULT();
+}
@@ -0,0 +1,383 @@
+#include "Test.hpp"
+#include "TestBitStream.hpp"
+#include "../Source/Patches/PlayerPropertiesLayout.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+using namespace Patches::Network;
+
+namespace
+{
+	long Allocations = 0;
+}
+
+// Counts allocations, so that building and sending the data can be checked not to allocate
+void *operator new(size_t size)
+{
+	Allocations++;
+	auto result = malloc(size ? size : 1);
+	if (!result)
+		throw std::bad_alloc();
+	return result;
+}
+
+void operator delete(void *pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+	free(pointer);
+}
+
+namespace
+{
+	// Stands in for Blam::Players::PlayerProperties
+	struct TestProperties
+	{
+		uint64_t Uid;
+		uint32_t Score;
+		bool Flag;
+		char Name[16];
+	};
+
+	// What each player's BuildData() reads from
+	TestProperties LocalPlayers[2];
+
+	// Stands in for PlayerPropertiesExtensionBase
+	class TestExtension
+	{
+	public:
+		virtual ~TestExtension() { }
+		virtual void BuildData(int playerIndex, void *out) = 0;
+		virtual size_t GetDataSize() const = 0;
+		virtual void ApplyData(int playerIndex, TestProperties *properties, const void *data) = 0;
+		virtual void Serialize(Test::BitStream *stream, const void *data) = 0;
+		virtual void Deserialize(Test::BitStream *stream, void *out) = 0;
+		virtual int GetMaxSerializedBits() const = 0;
+	};
+
+	typedef PlayerPropertiesLayout<TestExtension> TestLayout;
+
+	class UidExtension : public TestExtension
+	{
+	public:
+		void BuildData(int playerIndex, void *out) override { *static_cast<uint64_t*>(out) = LocalPlayers[playerIndex].Uid; }
+		size_t GetDataSize() const override { return sizeof(uint64_t); }
+		void ApplyData(int, TestProperties *properties, const void *data) override { properties->Uid = *static_cast<const uint64_t*>(data); }
+		void Serialize(Test::BitStream *stream, const void *data) override { stream->WriteUnsigned(*static_cast<const uint64_t*>(data), 64); }
+		void Deserialize(Test::BitStream *stream, void *out) override { *static_cast<uint64_t*>(out) = stream->ReadUnsigned<uint64_t>(64); }
+		int GetMaxSerializedBits() const override { return 64; }
+	};
+
+	// Takes up 8 bytes in memory but only 21 bits on the wire
+	struct ScoreData
+	{
+		uint32_t Score;
+		bool Flag;
+	};
+
+	class ScoreExtension : public TestExtension
+	{
+	public:
+		explicit ScoreExtension(int scoreBits = 20) : scoreBits(scoreBits) { }
+
+		void BuildData(int playerIndex, void *out) override
+		{
+			auto data = static_cast<ScoreData*>(out);
+			data->Score = LocalPlayers[playerIndex].Score;
+			data->Flag = LocalPlayers[playerIndex].Flag;
+		}
+
+		size_t GetDataSize() const override { return sizeof(ScoreData); }
+
+		void ApplyData(int, TestProperties *properties, const void *data) override
+		{
+			properties->Score = static_cast<const ScoreData*>(data)->Score;
+			properties->Flag = static_cast<const ScoreData*>(data)->Flag;
+		}
+
+		void Serialize(Test::BitStream *stream, const void *data) override
+		{
+			stream->WriteUnsigned(static_cast<const ScoreData*>(data)->Score, scoreBits);
+			stream->WriteUnsigned(static_cast<const ScoreData*>(data)->Flag, 1);
+		}
+
+		void Deserialize(Test::BitStream *stream, void *out) override
+		{
+			static_cast<ScoreData*>(out)->Score = stream->ReadUnsigned<uint32_t>(scoreBits);
+			static_cast<ScoreData*>(out)->Flag = stream->ReadUnsigned<bool>(1);
+		}
+
+		int GetMaxSerializedBits() const override { return scoreBits + 1; }
+
+	private:
+		int scoreBits;
+	};
+
+	// Only sends the characters that are used, so it's padded on the wire
+	class NameExtension : public TestExtension
+	{
+	public:
+		void BuildData(int playerIndex, void *out) override { memcpy(out, LocalPlayers[playerIndex].Name, 16); }
+		size_t GetDataSize() const override { return 16; }
+		void ApplyData(int, TestProperties *properties, const void *data) override { memcpy(properties->Name, data, 16); }
+
+		void Serialize(Test::BitStream *stream, const void *data) override
+		{
+			auto name = static_cast<const char*>(data);
+			auto length = strnlen(name, 15);
+			stream->WriteUnsigned(length, 4);
+			for (size_t i = 0; i < length; i++)
+				stream->WriteUnsigned(name[i], 8);
+		}
+
+		void Deserialize(Test::BitStream *stream, void *out) override
+		{
+			auto name = static_cast<char*>(out);
+			auto length = stream->ReadUnsigned<int>(4);
+			for (auto i = 0; i < length && i < 15; i++)
+				name[i] = stream->ReadUnsigned<char>(8);
+		}
+
+		int GetMaxSerializedBits() const override { return 4 + 15 * 8; }
+	};
+
+	// Reads past its budget
+	class BrokenExtension : public UidExtension
+	{
+	public:
+		void Deserialize(Test::BitStream *stream, void *out) override
+		{
+			UidExtension::Deserialize(stream, out);
+			stream->ReadUnsigned<int>(1);
+		}
+	};
+
+	// Writes a marker after the extension data so that the test can check the receiver ends up in the right place
+	int Send(TestLayout &sender, int playerIndex, std::vector<uint8_t> *wire, const void *data = nullptr)
+	{
+		std::vector<uint8_t> built(sender.GetTotalSize());
+		if (!data)
+		{
+			sender.BuildData(playerIndex, built.data());
+			data = built.data();
+		}
+		wire->assign(1024, 0);
+		Test::BitStream stream(wire->data(), static_cast<int>(wire->size()));
+		sender.SerializeData(&stream, data);
+		auto bits = stream.Position();
+		stream.WriteUnsigned(0xC0FFEEU, 32);
+		return bits;
+	}
+
+	bool Receive(TestLayout &receiver, std::vector<uint8_t> &wire, std::vector<uint8_t> *data, TestProperties *properties)
+	{
+		data->assign(receiver.GetTotalSize(), 0xCC);
+		Test::BitStream stream(wire.data(), static_cast<int>(wire.size()));
+		if (!receiver.DeserializeData(&stream, data->data()))
+			return false;
+		CHECK(stream.ReadUnsigned<uint32_t>(32) == 0xC0FFEE);
+		memset(properties, 0, sizeof(*properties));
+		receiver.ApplyData(0, properties, data->data());
+		return true;
+	}
+
+	void TestLayoutAndHash()
+	{
+		TestLayout layout;
+		layout.Add("uid", std::make_shared<UidExtension>());
+		layout.Add("score", std::make_shared<ScoreExtension>());
+		layout.Add("name", std::make_shared<NameExtension>());
+
+		// Presence mask, then each extension aligned to 8 bytes
+		CHECK(layout.GetTotalSize() == 8 + 8 + 8 + 16);
+
+		try
+		{
+			layout.Add("late", std::make_shared<UidExtension>());
+			CHECK(false);
+		}
+		catch (const std::runtime_error&) { }
+
+		TestLayout duplicate;
+		duplicate.Add("uid", std::make_shared<UidExtension>());
+		try
+		{
+			duplicate.Add("uid", std::make_shared<NameExtension>());
+			CHECK(false);
+		}
+		catch (const std::runtime_error&) { }
+
+		TestLayout tooBig;
+		tooBig.Add("score", std::make_shared<ScoreExtension>(1 << 16));
+		try
+		{
+			tooBig.Freeze();
+			CHECK(false);
+		}
+		catch (const std::runtime_error&) { }
+
+		// The hash covers the names, order and budgets of the extensions
+		TestLayout same, reordered, rebudgeted, renamed;
+		same.Add("uid", std::make_shared<UidExtension>());
+		same.Add("score", std::make_shared<ScoreExtension>());
+		same.Add("name", std::make_shared<NameExtension>());
+		reordered.Add("score", std::make_shared<ScoreExtension>());
+		reordered.Add("uid", std::make_shared<UidExtension>());
+		reordered.Add("name", std::make_shared<NameExtension>());
+		rebudgeted.Add("uid", std::make_shared<UidExtension>());
+		rebudgeted.Add("score", std::make_shared<ScoreExtension>(24));
+		rebudgeted.Add("name", std::make_shared<NameExtension>());
+		renamed.Add("uid", std::make_shared<UidExtension>());
+		renamed.Add("score2", std::make_shared<ScoreExtension>());
+		renamed.Add("name", std::make_shared<NameExtension>());
+		CHECK(same.GetLayoutHash() == layout.GetLayoutHash());
+		CHECK(reordered.GetLayoutHash() != layout.GetLayoutHash());
+		CHECK(rebudgeted.GetLayoutHash() != layout.GetLayoutHash());
+		CHECK(renamed.GetLayoutHash() != layout.GetLayoutHash());
+	}
+
+	void TestRoundTrip()
+	{
+		TestLayout sender, receiver;
+		for (auto layout : { &sender, &receiver })
+		{
+			layout->Add("uid", std::make_shared<UidExtension>());
+			layout->Add("score", std::make_shared<ScoreExtension>());
+			layout->Add("name", std::make_shared<NameExtension>());
+		}
+
+		std::vector<uint8_t> wire, data;
+		TestProperties properties;
+		auto bits = Send(sender, 1, &wire);
+
+		// Each extension takes up its budget on the wire, not the size of its data
+		CHECK(bits == 32 + 6 + 3 * (32 + 16) + 64 + 21 + 124);
+
+		CHECK(Receive(receiver, wire, &data, &properties));
+		CHECK(properties.Uid == LocalPlayers[1].Uid);
+		CHECK(properties.Score == LocalPlayers[1].Score && properties.Flag == LocalPlayers[1].Flag);
+		CHECK(strcmp(properties.Name, LocalPlayers[1].Name) == 0);
+
+		// No extensions at all
+		TestLayout empty, emptyReceiver;
+		CHECK(Send(empty, 0, &wire) == 32 + 6);
+		CHECK(empty.GetTotalSize() == 8);
+		CHECK(Receive(emptyReceiver, wire, &data, &properties));
+	}
+
+	void TestMismatch()
+	{
+		TestLayout sender;
+		sender.Add("uid", std::make_shared<UidExtension>());
+		sender.Add("score", std::make_shared<ScoreExtension>());
+		sender.Add("name", std::make_shared<NameExtension>());
+
+		// Missing the UID, has an extra extension, and a different order
+		TestLayout other;
+		other.Add("name", std::make_shared<NameExtension>());
+		other.Add("extra", std::make_shared<UidExtension>());
+		other.Add("score", std::make_shared<ScoreExtension>());
+
+		std::vector<uint8_t> wire, data;
+		TestProperties properties;
+		Send(sender, 0, &wire);
+		CHECK(Receive(other, wire, &data, &properties));
+		CHECK(properties.Uid == 0);
+		CHECK(properties.Score == LocalPlayers[0].Score && properties.Flag == LocalPlayers[0].Flag);
+		CHECK(strcmp(properties.Name, LocalPlayers[0].Name) == 0);
+
+		// And back the other way, where "extra" isn't known
+		Send(other, 0, &wire);
+		CHECK(Receive(sender, wire, &data, &properties));
+		CHECK(properties.Uid == 0);
+		CHECK(properties.Score == LocalPlayers[0].Score);
+		CHECK(strcmp(properties.Name, LocalPlayers[0].Name) == 0);
+
+		// The host passes on what it received, without the extensions it didn't get
+		auto relayed = data;
+		Send(sender, 0, &wire, relayed.data());
+		CHECK(Receive(sender, wire, &data, &properties));
+		CHECK(properties.Uid == 0 && properties.Score == LocalPlayers[0].Score);
+
+		// An extension whose budget changed is skipped rather than misread
+		TestLayout rebudgeted;
+		rebudgeted.Add("uid", std::make_shared<UidExtension>());
+		rebudgeted.Add("score", std::make_shared<ScoreExtension>(24));
+		rebudgeted.Add("name", std::make_shared<NameExtension>());
+		Send(sender, 1, &wire);
+		CHECK(Receive(rebudgeted, wire, &data, &properties));
+		CHECK(properties.Uid == LocalPlayers[1].Uid && properties.Score == 0);
+		CHECK(strcmp(properties.Name, LocalPlayers[1].Name) == 0);
+	}
+
+	void TestMalformed()
+	{
+		TestLayout sender, broken;
+		sender.Add("uid", std::make_shared<UidExtension>());
+		broken.Add("uid", std::make_shared<BrokenExtension>());
+		CHECK(sender.GetLayoutHash() == broken.GetLayoutHash());
+
+		std::vector<uint8_t> wire, data;
+		TestProperties properties;
+		Send(sender, 0, &wire);
+		CHECK(!Receive(broken, wire, &data, &properties));
+
+		// More extensions than there can be
+		wire.assign(64, 0);
+		Test::BitStream stream(wire.data(), static_cast<int>(wire.size()));
+		stream.WriteUnsigned(0U, 32);
+		stream.WriteUnsigned(TestLayout::MaxExtensions + 1, 6);
+		CHECK(!Receive(sender, wire, &data, &properties));
+	}
+
+	void TestNoAllocations()
+	{
+		TestLayout sender, receiver;
+		sender.Add("uid", std::make_shared<UidExtension>());
+		sender.Add("score", std::make_shared<ScoreExtension>());
+		sender.Add("name", std::make_shared<NameExtension>());
+		receiver.Add("name", std::make_shared<NameExtension>());
+		receiver.Add("score", std::make_shared<ScoreExtension>());
+		sender.Freeze();
+		receiver.Freeze();
+
+		uint8_t built[64], received[64], wire[256];
+		TestProperties properties;
+		auto before = Allocations;
+		for (auto i = 0; i < 1000; i++)
+		{
+			sender.BuildData(i % 2, built);
+			Test::BitStream out(wire, sizeof(wire));
+			sender.SerializeData(&out, built);
+
+			// Both the matching and mismatched paths
+			Test::BitStream in(wire, sizeof(wire));
+			CHECK(sender.DeserializeData(&in, received));
+			sender.ApplyData(0, &properties, received);
+			Test::BitStream otherIn(wire, sizeof(wire));
+			CHECK(receiver.DeserializeData(&otherIn, received));
+			receiver.ApplyData(0, &properties, received);
+		}
+		CHECK(Allocations == before);
+		printf("%ld allocations for 1000 build/send/receive rounds\n", Allocations - before);
+	}
+}
+
+int main()
+{
+	LocalPlayers[0] = { 0x1122334455667788ULL, 12345, true, "Alice" };
+	LocalPlayers[1] = { 0xFEDCBA9876543210ULL, 999999, false, "fifteen chars!!" };
+
+	TestLayoutAndHash();
+	TestRoundTrip();
+	TestMismatch();
+	TestMalformed();
+	TestNoAllocations();
+	return TEST_RESULT();
+}
@@ -0,0 +1,143 @@
+#include "Test.hpp"
+#include "../Source/Utils/StageScheduler.hpp"
+#include <atomic>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+using Utils::StageScheduler;
+typedef StageScheduler::StageThread StageThread;
+typedef StageScheduler::StageStatus StageStatus;
+
+namespace
+{
+	void TestAdd()
+	{
+		StageScheduler scheduler;
+		scheduler.Add("a", StageThread::Caller, {}, [] { });
+
+		auto threw = false;
+		try
+		{
+			scheduler.Add("a", StageThread::Caller, {}, [] { });
+		}
+		catch (std::invalid_argument&)
+		{
+			threw = true;
+		}
+		CHECK(threw);
+
+		threw = false;
+		try
+		{
+			scheduler.Add("b", StageThread::Caller, { "missing" }, [] { });
+		}
+		catch (std::invalid_argument&)
+		{
+			threw = true;
+		}
+		CHECK(threw);
+	}
+
+	// Every stage starts after its dependencies finish, on the thread it asked for
+	void TestOrder()
+	{
+		std::mutex mutex;
+		std::map<std::string, int> finishOrder;
+		std::map<std::string, std::thread::id> threads;
+		auto order = 0;
+		auto record = [&](const std::string &name)
+		{
+			return [&, name]
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+				std::lock_guard<std::mutex> lock(mutex);
+				finishOrder[name] = ++order;
+				threads[name] = std::this_thread::get_id();
+			};
+		};
+
+		StageScheduler scheduler;
+		scheduler.Add("load", StageThread::Worker, {}, record("load"));
+		scheduler.Add("parse", StageThread::Worker, { "load" }, record("parse"));
+		scheduler.Add("patch", StageThread::Caller, {}, record("patch"));
+		scheduler.Add("apply", StageThread::Caller, { "patch", "parse" }, record("apply"));
+		scheduler.Add("background", StageThread::Worker, { "patch" }, record("background"));
+		scheduler.Run(2);
+		scheduler.WaitAll();
+
+		CHECK(scheduler.IsFinished());
+		CHECK(finishOrder.size() == 5);
+		CHECK(finishOrder["load"] < finishOrder["parse"]);
+		CHECK(finishOrder["parse"] < finishOrder["apply"]);
+		CHECK(finishOrder["patch"] < finishOrder["apply"]);
+		CHECK(finishOrder["patch"] < finishOrder["background"]);
+		CHECK(threads["patch"] == std::this_thread::get_id());
+		CHECK(threads["apply"] == std::this_thread::get_id());
+		CHECK(threads["load"] != std::this_thread::get_id());
+		CHECK(scheduler.GetReport().size() >= 5);
+	}
+
+	void TestFailure()
+	{
+		std::atomic<int> ran(0);
+		StageScheduler scheduler;
+		scheduler.Add("broken", StageThread::Worker, {}, [] { throw std::runtime_error("broken"); });
+		scheduler.Add("dependent", StageThread::Caller, { "broken" }, [&] { ran++; });
+		scheduler.Add("indirect", StageThread::Worker, { "dependent" }, [&] { ran++; });
+		scheduler.Add("independent", StageThread::Caller, {}, [&] { ran++; });
+		scheduler.Run(1);
+
+		CHECK(scheduler.Wait("broken") == StageStatus::Failed);
+		CHECK(scheduler.Wait("dependent") == StageStatus::Skipped);
+		CHECK(scheduler.Wait("indirect") == StageStatus::Skipped);
+		CHECK(scheduler.Wait("independent") == StageStatus::Done);
+		CHECK(scheduler.Wait("unknown") == StageStatus::Skipped);
+		scheduler.WaitAll();
+		CHECK(ran == 1);
+	}
+
+	// Worker stages that nothing waits for can still be running when Run() returns
+	void TestDestroyWhileRunning()
+	{
+		std::atomic<bool> finished(false);
+		{
+			StageScheduler scheduler;
+			scheduler.Add("slow", StageThread::Worker, {}, [&]
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				finished = true;
+			});
+			scheduler.Run(1);
+		}
+		CHECK(finished);
+	}
+
+	// Destroying the scheduler runs the stages which are ready, but not the ones still waiting on them
+	void TestDestroyDoesNotStartStages()
+	{
+		std::atomic<bool> finished(false), started(false);
+		{
+			StageScheduler scheduler;
+			scheduler.Add("slow", StageThread::Worker, {}, [&]
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				finished = true;
+			});
+			scheduler.Add("after", StageThread::Worker, { "slow" }, [&] { started = true; });
+			scheduler.Run(1);
+		}
+		CHECK(finished);
+		CHECK(!started);
+	}
+}
+
+int main()
+{
+	TestAdd();
+	TestOrder();
+	TestFailure();
+	TestDestroyWhileRunning();
+	TestDestroyDoesNotStartStages();
+	return TEST_RESULT();
+}
@@ -0,0 +1,136 @@
+#include "Test.hpp"
+#include "../Source/Blam/Tags/TagGroupIndex.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+using namespace Blam::Tags;
+
+namespace
+{
+	long Allocations = 0;
+
+	struct Instance
+	{
+		uint16_t Index;
+		Instance(uint16_t index) : Index(index) { }
+	};
+}
+
+// Counts allocations, so that lookups can be checked not to allocate
+void *operator new(size_t size)
+{
+	Allocations++;
+	auto result = malloc(size ? size : 1);
+	if (!result)
+		throw std::bad_alloc();
+	return result;
+}
+
+void operator delete(void *pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+	free(pointer);
+}
+
+namespace
+{
+	const uint32_t TagCount = 60000;
+
+	std::vector<Tag> MakeTable(std::vector<Tag> *groups)
+	{
+		for (auto i = 0; i < 250; i++)
+			groups->push_back(0x61610000 + i * 0x101);
+		groups->push_back('matg');
+		groups->push_back('scnr');
+
+		std::mt19937 random(7);
+		std::vector<Tag> table(TagCount);
+		for (auto &tag : table)
+			tag = random() % 10 == 0 ? static_cast<Tag>(-1) : (*groups)[random() % groups->size()];
+		table[5] = 'matg';
+		return table;
+	}
+
+	std::vector<uint16_t> LinearScan(const std::vector<Tag> &table, Tag group)
+	{
+		std::vector<uint16_t> result;
+		for (uint32_t i = 0; i < table.size(); i++)
+		{
+			if (table[i] == group)
+				result.push_back(static_cast<uint16_t>(i));
+		}
+		return result;
+	}
+
+	void TestFind()
+	{
+		std::vector<Tag> groups;
+		auto table = MakeTable(&groups);
+
+		TagGroupIndex<Instance> index;
+		CHECK(!index.IsBuiltFor(TagCount));
+		index.Build(TagCount, [&](uint32_t i) { return table[i]; });
+		CHECK(index.IsBuiltFor(TagCount));
+		CHECK(!index.IsBuiltFor(TagCount + 1));
+
+		for (auto group : groups)
+		{
+			auto expected = LinearScan(table, group);
+			auto span = index.Find(group);
+			CHECK(span.size() == expected.size());
+			for (size_t i = 0; i < span.size() && i < expected.size(); i++)
+				CHECK(span[i].Index == expected[i]);
+		}
+		CHECK(index.Find('none').empty());
+		CHECK(index.Find(static_cast<Tag>(-1)).empty());
+		CHECK(index.Find('matg')[0].Index == 5);
+
+		// Lookups don't allocate
+		auto before = Allocations;
+		size_t total = 0;
+		const auto Lookups = 100000;
+		auto start = std::chrono::steady_clock::now();
+		for (auto i = 0; i < Lookups; i++)
+		{
+			for (auto &&instance : index.Find(groups[i % groups.size()]))
+				total += instance.Index;
+		}
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		CHECK(Allocations == before);
+		printf("Indexed lookup: %.2f us (checksum %zu)\n", std::chrono::duration<double, std::micro>(elapsed).count() / Lookups, total);
+	}
+
+	void TestRebuild()
+	{
+		std::vector<Tag> groups;
+		auto table = MakeTable(&groups);
+		TagGroupIndex<Instance> index;
+		index.Build(TagCount, [&](uint32_t i) { return table[i]; });
+
+		// Rebuilding after an invalidation picks up changes
+		table[5] = 'scnr';
+		index.Invalidate();
+		CHECK(!index.IsBuiltFor(TagCount));
+		index.Build(TagCount, [&](uint32_t i) { return table[i]; });
+		CHECK(index.IsBuiltFor(TagCount));
+		CHECK(index.Find('scnr')[0].Index == 5);
+		CHECK(index.Find('matg').empty() || index.Find('matg')[0].Index != 5);
+
+		index.Build(0, [&](uint32_t i) { return table[i]; });
+		CHECK(index.Find('scnr').empty());
+	}
+}
+
+int main()
+{
+	TestFind();
+	TestRebuild();
+	return TEST_RESULT();
+}
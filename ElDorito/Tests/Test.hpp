@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdio>
+
+// Minimal checks for the portable tests. A failed check is reported and the test keeps going, and main() returns
+// TEST_RESULT() so that ctest sees the failure.
+namespace Test
+{
+	inline int &Failures()
+	{
+		static int failures = 0;
+		return failures;
+	}
+}
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			Test::Failures()++; \
+		} \
+	} while (false)
+
+#define TEST_RESULT() (Test::Failures() == 0 ? 0 : 1)
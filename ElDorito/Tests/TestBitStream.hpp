@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+
+namespace Test
+{
+	// Stands in for Blam::BitStream. Reading past the end gives zeros, like the game's stream does once it overflows.
+	class BitStream
+	{
+	public:
+		BitStream(uint8_t *data, int size)
+			: data(data), sizeBits(size * 8), position(0)
+		{
+		}
+
+		template<class T>
+		void WriteUnsigned(T value, int bits)
+		{
+			for (auto i = 0; i < bits; i++, position++)
+			{
+				if (position >= sizeBits)
+					continue;
+				auto bit = (static_cast<uint64_t>(value) >> i) & 1;
+				if (bit)
+					data[position / 8] |= 1 << (position % 8);
+				else
+					data[position / 8] &= ~(1 << (position % 8));
+			}
+		}
+
+		template<class T>
+		T ReadUnsigned(int bits)
+		{
+			uint64_t value = 0;
+			for (auto i = 0; i < bits; i++, position++)
+			{
+				if (position < sizeBits && (data[position / 8] >> (position % 8)) & 1)
+					value |= 1ULL << i;
+			}
+			return static_cast<T>(value);
+		}
+
+		int Position() const { return position; }
+
+	private:
+		uint8_t *data;
+		int sizeBits;
+		int position;
+	};
+}
@@ -0,0 +1,108 @@
+#include "Test.hpp"
+#include "../Source/Web/Ui/TimerExtrapolator.hpp"
+#include <cmath>
+
+using Web::Ui::TimerExtrapolator;
+
+namespace
+{
+	const double FrameTime = 1.0 / 60;
+
+	// Simulates a countdown which the engine reports in whole seconds, updated every frame.
+	// Returns the number of corrections sent to the UI, and checks the UI is never off by more than the threshold.
+	int Run(TimerExtrapolator &timer, double *seconds, double *time, double duration, double rate)
+	{
+		auto corrections = 0;
+		for (auto end = *time + duration; *time < end; *time += FrameTime)
+		{
+			*seconds += rate * FrameTime;
+			auto reported = std::floor(*seconds);
+			if (timer.Update(reported, *time))
+				corrections++;
+			CHECK(std::fabs(timer.Predict(*time) - reported) <= 1.5 + 1e-9);
+		}
+		return corrections;
+	}
+
+	void TestSteadyCountdown()
+	{
+		TimerExtrapolator timer;
+		double seconds = 600, time = 0;
+		timer.Start(seconds, -1, time);
+
+		// A timer counting at the predicted rate never needs correcting
+		CHECK(Run(timer, &seconds, &time, 120, -1) == 0);
+	}
+
+	void TestPauseAndResume()
+	{
+		TimerExtrapolator timer;
+		double seconds = 600, time = 0;
+		timer.Start(seconds, -1, time);
+		Run(timer, &seconds, &time, 10, -1);
+
+		// Pausing is noticed once the prediction would be off, and then nothing more is sent
+		CHECK(Run(timer, &seconds, &time, 30, 0) == 1);
+		CHECK(timer.GetBaseline().Rate == 0);
+
+		// Resuming goes back to the old rate straight away
+		CHECK(Run(timer, &seconds, &time, 30, -1) == 1);
+		CHECK(timer.GetBaseline().Rate == -1);
+	}
+
+	void TestJumpAndRateChange()
+	{
+		TimerExtrapolator timer;
+		double seconds = 600, time = 0;
+		timer.Start(seconds, -1, time);
+		Run(timer, &seconds, &time, 5, -1);
+
+		// A jump is corrected once without changing the rate
+		seconds -= 60;
+		CHECK(Run(timer, &seconds, &time, 5, -1) == 1);
+		CHECK(timer.GetBaseline().Rate == -1);
+
+		// A timer running at double speed gets a new rate after a correction, then stays in step
+		auto corrections = Run(timer, &seconds, &time, 5, -2);
+		CHECK(corrections >= 1 && corrections <= 3);
+		CHECK(std::fabs(timer.GetBaseline().Rate + 2) < 0.1);
+		CHECK(Run(timer, &seconds, &time, 60, -2) == 0);
+	}
+
+	void TestOvertime()
+	{
+		// A countdown which runs out and turns into a count-up, like a round going into overtime
+		TimerExtrapolator timer;
+		double seconds = 10, time = 0;
+		timer.Start(seconds, -1, time);
+		CHECK(Run(timer, &seconds, &time, 10, -1) == 0);
+
+		// Counting up is picked up as soon as the value starts going the other way, and then stays in step
+		auto corrections = Run(timer, &seconds, &time, 5, 1);
+		CHECK(corrections >= 1 && corrections <= 2);
+		CHECK(timer.GetBaseline().Rate == 1);
+		CHECK(Run(timer, &seconds, &time, 60, 1) == 0);
+		CHECK(std::fabs(timer.Predict(time) - seconds) <= 1.5);
+	}
+
+	void TestStopped()
+	{
+		TimerExtrapolator timer;
+		CHECK(!timer.IsRunning());
+		CHECK(!timer.Update(100, 0));
+		timer.Start(10, 1, 0);
+		CHECK(timer.IsRunning());
+		timer.Stop();
+		CHECK(!timer.Update(50, 1));
+	}
+}
+
+int main()
+{
+	TestSteadyCountdown();
+	TestPauseAndResume();
+	TestJumpAndRateChange();
+	TestOvertime();
+	TestStopped();
+	return TEST_RESULT();
+}
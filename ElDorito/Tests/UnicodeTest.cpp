@@ -0,0 +1,211 @@
+#include "Test.hpp"
+#include "../Source/Utils/Unicode.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace Utils::Unicode;
+
+namespace
+{
+	// wchar_t is UTF-16 on Windows, but a whole code point elsewhere
+	const bool WideIsUtf16 = sizeof(wchar_t) == sizeof(uint16_t);
+
+	std::wstring Wide(std::initializer_list<uint32_t> codePoints)
+	{
+		std::wstring result;
+		for (auto codePoint : codePoints)
+		{
+			if (codePoint >= 0x10000 && WideIsUtf16)
+			{
+				codePoint -= 0x10000;
+				result += static_cast<wchar_t>(0xD800 | (codePoint >> 10));
+				result += static_cast<wchar_t>(0xDC00 | (codePoint & 0x3FF));
+			}
+			else
+			{
+				result += static_cast<wchar_t>(codePoint);
+			}
+		}
+		return result;
+	}
+
+	// Straightforward decoder to compare the fast paths against
+	std::wstring ReferenceUtf8ToUtf16(const std::string &str)
+	{
+		std::wstring result;
+		size_t pos = 0;
+		while (pos < str.length())
+		{
+			auto lead = static_cast<unsigned char>(str[pos++]);
+			size_t extra = 0;
+			uint32_t codePoint = lead, min = 0;
+			if (lead >= 0x80)
+			{
+				if (lead >= 0xC2 && lead <= 0xDF)
+					extra = 1, codePoint = lead & 0x1F, min = 0x80;
+				else if (lead >= 0xE0 && lead <= 0xEF)
+					extra = 2, codePoint = lead & 0x0F, min = 0x800;
+				else if (lead >= 0xF0 && lead <= 0xF4)
+					extra = 3, codePoint = lead & 0x07, min = 0x10000;
+				else
+					codePoint = ReplacementCharacter;
+			}
+
+			for (size_t i = 0; i < extra; i++)
+			{
+				if (pos >= str.length() || (str[pos] & 0xC0) != 0x80)
+				{
+					codePoint = ReplacementCharacter;
+					min = 0;
+					break;
+				}
+				codePoint = (codePoint << 6) | (str[pos++] & 0x3F);
+			}
+			if (codePoint < min || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+				codePoint = ReplacementCharacter;
+			result += Wide({ codePoint });
+		}
+		return result;
+	}
+
+	void TestConversions()
+	{
+		CHECK(Utf8ToUtf16("") == L"");
+		CHECK(Utf8ToUtf16("Hello, world! This is longer than sixteen characters.") == L"Hello, world! This is longer than sixteen characters.");
+		CHECK(Utf8ToUtf16("caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80") == Wide({ 'c', 'a', 'f', 0xE9, ' ', 0x20AC, ' ', 0x1F600 }));
+		CHECK(Utf16ToUtf8(Wide({ 'c', 'a', 'f', 0xE9, ' ', 0x20AC, ' ', 0x1F600 })) == "caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80");
+		CHECK(Utf16ToUtf8(Wide({ 0x1F600 })) == "\xF0\x9F\x98\x80");
+
+		// Invalid sequences become U+FFFD, and decoding resumes at the byte that broke the sequence
+		CHECK(Utf8ToUtf16("a\x80z") == Wide({ 'a', 0xFFFD, 'z' }));
+		CHECK(Utf8ToUtf16("\xC0\xAF") == Wide({ 0xFFFD, 0xFFFD }));
+		CHECK(Utf8ToUtf16("\xE2\x82z") == Wide({ 0xFFFD, 'z' }));
+		CHECK(Utf8ToUtf16("\xED\xA0\x80") == Wide({ 0xFFFD }));
+		CHECK(Utf8ToUtf16("\xF4\x90\x80\x80") == Wide({ 0xFFFD }));
+		if (WideIsUtf16)
+		{
+			CHECK(Utf16ToUtf8(std::wstring(1, static_cast<wchar_t>(0xD800)) + L"a") == "\xEF\xBF\xBD" "a");
+			CHECK(Utf16ToUtf8(std::wstring(1, static_cast<wchar_t>(0xDC00))) == "\xEF\xBF\xBD");
+		}
+	}
+
+	void TestTruncation()
+	{
+		// A fixed-size game string keeps N - 1 units and never splits a character
+		wchar_t name[4];
+		CHECK(Utf8ToUtf16("abcdef", name) == 3);
+		CHECK(std::wstring(name) == L"abc");
+		CHECK(Utf8ToUtf16("ab\xF0\x9F\x98\x80", name) == (WideIsUtf16 ? 2 : 3));
+
+		char out[5];
+		CHECK(Utf16ToUtf8(L"abcdef", 6, out, sizeof(out)) == 4);
+		CHECK(std::string(out) == "abcd");
+		auto euro = Wide({ 'a', 'b', 0x20AC });
+		CHECK(Utf16ToUtf8(euro.c_str(), euro.length(), out, sizeof(out)) == 2);
+		CHECK(std::string(out) == "ab");
+
+		// Unterminated fixed-size strings are read up to their size
+		wchar_t unterminated[3] = { 'x', 'y', 'z' };
+		char fixedOut[Utf8Size<3>::Value];
+		CHECK(Utf16ToUtf8(unterminated, fixedOut) == 3);
+		CHECK(std::string(fixedOut) == "xyz");
+	}
+
+	void TestRandom()
+	{
+		std::mt19937 random(42);
+		const char pieces[][5] = { "a", "Z", " ", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\x80", "\xC3", "\xE2\x82", "\xFF", "\xC0\x80", "\xED\xA0\x80" };
+		for (auto i = 0; i < 2000; i++)
+		{
+			std::string str;
+			auto count = random() % 64;
+			for (size_t j = 0; j < count; j++)
+			{
+				// Mostly ASCII so the bulk conversions get exercised
+				auto piece = random() % 4 != 0 ? 0 : random() % (sizeof(pieces) / sizeof(pieces[0]));
+				str += piece == 0 ? std::string(random() % 20, static_cast<char>('a' + random() % 26)) : pieces[piece];
+			}
+
+			auto wide = Utf8ToUtf16(str);
+			CHECK(wide == ReferenceUtf8ToUtf16(str));
+			CHECK(Utf8ToUtf16(Utf16ToUtf8(wide)) == wide);
+		}
+	}
+
+	// Player-name-sized strings, converted the way the scoreboard does it and the way the reference decoder does
+	void Benchmark()
+	{
+		std::mt19937 random(3);
+		const char *pieces[] = { "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80" };
+		std::vector<std::string> names;
+		for (auto i = 0; i < 20000; i++)
+		{
+			std::string name;
+			while (name.length() < 12)
+				name += random() % 8 != 0 ? std::string(1, static_cast<char>('a' + random() % 26)) : pieces[random() % 3];
+			names.push_back(name);
+		}
+
+		const int Rounds = 10;
+		size_t checksum = 0, expected = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (auto round = 0; round < Rounds; round++)
+		{
+			for (auto &&name : names)
+			{
+				wchar_t wide[16];
+				checksum += Utf8ToUtf16(name, wide);
+			}
+		}
+		auto middle = std::chrono::steady_clock::now();
+		for (auto round = 0; round < Rounds; round++)
+		{
+			for (auto &&name : names)
+				expected += std::min<size_t>(ReferenceUtf8ToUtf16(name).length(), 15);
+		}
+		auto end = std::chrono::steady_clock::now();
+		CHECK(checksum == expected);
+
+		auto calls = static_cast<double>(names.size() * Rounds);
+		auto fixedNs = std::chrono::duration<double, std::nano>(middle - start).count() / calls;
+		auto referenceNs = std::chrono::duration<double, std::nano>(end - middle).count() / calls;
+		printf("UTF-8 to UTF-16, 12 character names: fixed buffer %.1f ns, reference decoder %.1f ns\n", fixedNs, referenceNs);
+
+		std::vector<std::wstring> wideNames;
+		for (auto &&name : names)
+			wideNames.push_back(Utf8ToUtf16(name));
+		checksum = expected = 0;
+		start = std::chrono::steady_clock::now();
+		for (auto round = 0; round < Rounds; round++)
+		{
+			for (auto &&name : wideNames)
+			{
+				char thin[Utf8Size<16>::Value];
+				checksum += Utf16ToUtf8(name.c_str(), name.length(), thin, sizeof(thin));
+			}
+		}
+		middle = std::chrono::steady_clock::now();
+		for (auto round = 0; round < Rounds; round++)
+		{
+			for (auto &&name : wideNames)
+				expected += Utf16ToUtf8(name).length();
+		}
+		end = std::chrono::steady_clock::now();
+		CHECK(checksum == expected);
+
+		fixedNs = std::chrono::duration<double, std::nano>(middle - start).count() / calls;
+		auto allocatingNs = std::chrono::duration<double, std::nano>(end - middle).count() / calls;
+		printf("UTF-16 to UTF-8, 12 character names: fixed buffer %.1f ns, std::string %.1f ns\n", fixedNs, allocatingNs);
+	}
+}
+
+int main()
+{
+	TestConversions();
+	TestTruncation();
+	TestRandom();
+	Benchmark();
+	return TEST_RESULT();
+}
@@ -0,0 +1,394 @@
+#include "Test.hpp"
+#include "../Source/Utils/UpdateEngine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <boost/filesystem.hpp>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/sha.h>
+
+namespace fs = boost::filesystem;
+using namespace Utils;
+
+namespace
+{
+	// Stands in for the release key, so that test manifests can be signed
+	class SigningKey
+	{
+	public:
+		std::string PublicKey;
+
+		SigningKey() : key(nullptr)
+		{
+			auto context = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+			if (!context)
+				return;
+			if (EVP_PKEY_keygen_init(context) != 1 || EVP_PKEY_CTX_set_rsa_keygen_bits(context, 2048) != 1 || EVP_PKEY_keygen(context, &key) != 1)
+				key = nullptr;
+			EVP_PKEY_CTX_free(context);
+
+			auto bio = BIO_new(BIO_s_mem());
+			if (key && bio && PEM_write_bio_PUBKEY(bio, key))
+			{
+				char *data;
+				auto size = BIO_get_mem_data(bio, &data);
+				PublicKey.assign(data, size);
+			}
+			BIO_free_all(bio);
+		}
+
+		~SigningKey()
+		{
+			EVP_PKEY_free(key);
+		}
+
+		std::string Sign(const std::string &data) const
+		{
+			std::string signature(key ? EVP_PKEY_size(key) : 0, '\0');
+			auto length = signature.size();
+			auto context = EVP_MD_CTX_create();
+			auto success = key && context
+				&& EVP_DigestSignInit(context, nullptr, EVP_sha256(), nullptr, key) == 1
+				&& EVP_DigestSignUpdate(context, data.data(), data.size()) == 1
+				&& EVP_DigestSignFinal(context, reinterpret_cast<unsigned char*>(&signature[0]), &length) == 1;
+			EVP_MD_CTX_destroy(context);
+			signature.resize(success ? length : 0);
+			return signature;
+		}
+
+	private:
+		EVP_PKEY *key;
+	};
+
+	const SigningKey &GetTestKey()
+	{
+		static SigningKey key;
+		return key;
+	}
+
+	std::string Sha256(const std::string &data)
+	{
+		unsigned char hash[SHA256_DIGEST_LENGTH];
+		SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), hash);
+
+		static const char digits[] = "0123456789abcdef";
+		std::string result;
+		for (auto byte : hash)
+		{
+			result += digits[byte >> 4];
+			result += digits[byte & 0xF];
+		}
+		return result;
+	}
+
+	void WriteFile(const fs::path &path, const std::string &data)
+	{
+		fs::create_directories(path.parent_path());
+		std::ofstream(path.string(), std::ios::binary) << data;
+	}
+
+	std::string ReadFile(const fs::path &path)
+	{
+		std::ifstream in(path.string(), std::ios::binary);
+		std::stringstream stream;
+		stream << in.rdbuf();
+		return stream.str();
+	}
+
+	// Serves the files in a directory, with faults that can be switched on
+	class DirectoryTransport : public UpdateTransport
+	{
+	public:
+		fs::path Directory;
+		std::string Manifest;
+		std::string Signature;
+		bool SupportsRanges = true;
+		int64_t DropAfter = -1;      // Fails the next file request after this many bytes
+		std::string CorruptPath;     // Flips a byte in the middle of this file
+		uint32_t Fetches = 0;
+		uint64_t BytesSent = 0;
+
+		bool FetchManifest(std::string *manifest, std::string *signature, std::string *) override
+		{
+			*manifest = Manifest;
+			*signature = Signature;
+			return true;
+		}
+
+		bool FetchFile(const std::string &path, uint64_t *offset, const WriteCallback &write, std::string *error) override
+		{
+			Fetches++;
+			auto data = ReadFile(Directory / path);
+			if (path == CorruptPath)
+				data[data.size() / 2] ^= 0x55;
+			if (!SupportsRanges)
+				*offset = 0;
+
+			for (auto pos = *offset; pos < data.size();)
+			{
+				auto size = static_cast<size_t>(std::min<uint64_t>(1000, data.size() - pos));
+				if (DropAfter >= 0 && static_cast<int64_t>(pos - *offset + size) > DropAfter)
+				{
+					DropAfter = -1;
+					*error = "Connection reset";
+					return false;
+				}
+				if (!write(reinterpret_cast<const uint8_t*>(data.data() + pos), size))
+					return false;
+				pos += size;
+				BytesSent += size;
+			}
+			return true;
+		}
+
+		// Lists the given files with their current size and hash
+		void MakeManifest(const std::vector<std::string> &paths, const std::string &version)
+		{
+			Manifest = "{\"version\":\"" + version + "\",\"files\":[";
+			for (size_t i = 0; i < paths.size(); i++)
+			{
+				auto data = ReadFile(Directory / paths[i]);
+				Manifest += (i > 0 ? "," : "");
+				Manifest += "{\"path\":\"" + paths[i] + "\",\"size\":" + std::to_string(data.size()) + ",\"sha256\":\"" + Sha256(data) + "\"}";
+			}
+			Manifest += "]}";
+			Signature = GetTestKey().Sign(Manifest);
+		}
+	};
+
+	// Slows every write down so that an update can be cancelled part way
+	class SlowTransport : public DirectoryTransport
+	{
+	public:
+		bool FetchFile(const std::string &path, uint64_t *offset, const WriteCallback &write, std::string *error) override
+		{
+			return DirectoryTransport::FetchFile(path, offset, [&](const uint8_t *data, size_t size)
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+				return write(data, size);
+			}, error);
+		}
+	};
+
+	std::string RandomData(std::mt19937 &random, size_t size)
+	{
+		std::string result(size, '\0');
+		for (auto &ch : result)
+			ch = static_cast<char>(random());
+		return result;
+	}
+
+	bool IsAcceptedPath(const std::string &path)
+	{
+		std::string version, error;
+		std::vector<UpdateFile> files;
+		return ParseUpdateManifest("{\"files\":[{\"path\":\"" + path + "\",\"size\":1,\"sha256\":\"" + std::string(64, 'a') + "\"}]}", &version, &files, &error);
+	}
+
+	void TestManifest()
+	{
+		CHECK(IsAcceptedPath("maps/guardian.map"));
+		CHECK(IsAcceptedPath("update.txt"));
+		CHECK(IsAcceptedPath("mods/update/x"));
+		CHECK(IsAcceptedPath("mods/.hidden"));
+
+		CHECK(!IsAcceptedPath(""));
+		CHECK(!IsAcceptedPath("../x"));
+		CHECK(!IsAcceptedPath("a/../../b"));
+		CHECK(!IsAcceptedPath("./a"));
+		CHECK(!IsAcceptedPath("a//b"));
+		CHECK(!IsAcceptedPath("/etc/passwd"));
+		CHECK(!IsAcceptedPath("c:/x"));
+		CHECK(!IsAcceptedPath("a\\\\b"));
+
+		// The update directory can't be written to, however Windows spells it
+		CHECK(!IsAcceptedPath("update/staging/x"));
+		CHECK(!IsAcceptedPath("Update/pending.txt"));
+		CHECK(!IsAcceptedPath("UPDATE/installing.txt"));
+		CHECK(!IsAcceptedPath("update./x"));
+		CHECK(!IsAcceptedPath("update /x"));
+		CHECK(!IsAcceptedPath("maps/a.map."));
+		CHECK(!IsAcceptedPath("maps /a.map"));
+
+		std::string version, error;
+		std::vector<UpdateFile> files;
+		CHECK(!ParseUpdateManifest("not json", &version, &files, &error));
+		CHECK(!ParseUpdateManifest("{\"version\":\"1\"}", &version, &files, &error));
+		CHECK(!ParseUpdateManifest("{\"files\":[{\"path\":\"a\",\"size\":1,\"sha256\":\"zz\"}]}", &version, &files, &error));
+
+		CHECK(ParseUpdateManifest("{\"version\":\"0.7\",\"files\":[{\"path\":\"a\",\"size\":3,\"sha256\":\"" + std::string(64, 'A') + "\"}]}", &version, &files, &error));
+		CHECK(version == "0.7" && files.size() == 1 && files[0].Size == 3 && files[0].Sha256 == std::string(64, 'a'));
+	}
+
+	void TestSignature()
+	{
+		auto &key = GetTestKey();
+		CHECK(!key.PublicKey.empty());
+		std::string manifest = "{\"version\":\"0.7\",\"files\":[]}";
+		auto signature = key.Sign(manifest);
+		CHECK(VerifyUpdateManifest(manifest, signature, key.PublicKey));
+
+		// Any change to the manifest or the signature is caught
+		auto changed = manifest;
+		changed[12] = '8';
+		CHECK(!VerifyUpdateManifest(changed, signature, key.PublicKey));
+		CHECK(!VerifyUpdateManifest(manifest + " ", signature, key.PublicKey));
+		auto badSignature = signature;
+		badSignature[badSignature.size() / 2] ^= 1;
+		CHECK(!VerifyUpdateManifest(manifest, badSignature, key.PublicKey));
+		CHECK(!VerifyUpdateManifest(manifest, signature.substr(1), key.PublicKey));
+		CHECK(!VerifyUpdateManifest(manifest, "", key.PublicKey));
+
+		// Only the key the engine was given is trusted
+		CHECK(!VerifyUpdateManifest(manifest, signature, UpdatePublicKey));
+		CHECK(!VerifyUpdateManifest(manifest, signature, ""));
+		CHECK(!VerifyUpdateManifest(manifest, signature, "-----BEGIN PUBLIC KEY-----\nnot a key\n-----END PUBLIC KEY-----\n"));
+
+		// The built-in key has to load, or no update could ever be verified
+		auto bio = BIO_new_mem_buf(UpdatePublicKey, -1);
+		auto builtIn = PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr);
+		CHECK(builtIn != nullptr);
+		EVP_PKEY_free(builtIn);
+		BIO_free_all(bio);
+	}
+
+	void TestUpdate(const fs::path &root)
+	{
+		auto install = root / "game", server = root / "server";
+		std::mt19937 random(1);
+		std::string error;
+
+		WriteFile(install / "mtndew.dll", "old dll");
+		WriteFile(install / "maps/a.map", RandomData(random, 300000));
+		WriteFile(install / "maps/b.map", RandomData(random, 200000));
+		WriteFile(install / "mods/user.txt", "user content");
+		WriteFile(server / "maps/a.map", ReadFile(install / "maps/a.map"));
+		WriteFile(server / "mtndew.dll", "new dll!!");
+		WriteFile(server / "maps/b.map", RandomData(random, 250000));
+		WriteFile(server / "maps/new folder/c.map", RandomData(random, 120000));
+		std::vector<std::string> allFiles = { "mtndew.dll", "maps/a.map", "maps/b.map", "maps/new folder/c.map" };
+
+		auto transport = std::make_shared<DirectoryTransport>();
+		transport->Directory = server;
+		transport->MakeManifest(allFiles, "0.7");
+		UpdateEngine engine(install.string(), GetTestKey().PublicKey);
+
+		// Nothing is fetched or staged for a manifest with a bad signature
+		auto signature = transport->Signature;
+		transport->Signature[0] ^= 1;
+		CHECK(!engine.Run(*transport));
+		CHECK(engine.GetProgress().State == UpdateState::Failed && engine.GetProgress().Error.find("signature") != std::string::npos);
+		CHECK(transport->Fetches == 0 && !fs::exists(install / "update/staging"));
+		transport->Signature = signature;
+
+		// A dropped connection keeps the partial file
+		transport->DropAfter = 150000;
+		CHECK(!engine.Run(*transport));
+		auto progress = engine.GetProgress();
+		CHECK(progress.State == UpdateState::Failed && progress.Version == "0.7");
+		CHECK(progress.Error.find("Connection reset") != std::string::npos);
+		CHECK(fs::exists(install / "update/staging/mtndew.dll"));
+		CHECK(fs::file_size(install / "update/staging/maps/b.map.part") == 150000);
+
+		// Resuming only downloads the rest, and the unchanged file isn't downloaded at all
+		transport->BytesSent = 0;
+		transport->Fetches = 0;
+		CHECK(engine.Run(*transport));
+		progress = engine.GetProgress();
+		CHECK(progress.State == UpdateState::Staged && progress.FilesToDownload == 3 && progress.FilesDownloaded == 3);
+		CHECK(progress.BytesDownloaded == progress.BytesToDownload);
+		CHECK(transport->BytesSent == 100000 + 120000 && transport->Fetches == 2);
+		CHECK(ReadFile(install / "mtndew.dll") == "old dll");
+
+		// Installed on the next launch, leaving other files alone
+		CHECK(UpdateEngine::InstallStaged(install.string(), &error));
+		CHECK(ReadFile(install / "mtndew.dll") == "new dll!!");
+		CHECK(ReadFile(install / "maps/b.map") == ReadFile(server / "maps/b.map"));
+		CHECK(ReadFile(install / "maps/new folder/c.map") == ReadFile(server / "maps/new folder/c.map"));
+		CHECK(ReadFile(install / "mods/user.txt") == "user content");
+		CHECK(!fs::exists(install / "update/staging") && !fs::exists(install / "update/backup") && !fs::exists(install / "update/pending.txt"));
+		CHECK(UpdateEngine::InstallStaged(install.string(), &error));
+
+		// Up to date, from the hash cache
+		transport->Fetches = 0;
+		CHECK(engine.Run(*transport) && engine.GetProgress().State == UpdateState::UpToDate && transport->Fetches == 0);
+
+		// A corrupt download is rejected, here from a server that doesn't support ranges
+		WriteFile(server / "maps/a.map", RandomData(random, 90000));
+		transport->MakeManifest(allFiles, "0.8");
+		transport->CorruptPath = "maps/a.map";
+		transport->SupportsRanges = false;
+		CHECK(!engine.Run(*transport));
+		CHECK(engine.GetProgress().Error.find("verification") != std::string::npos);
+		CHECK(!fs::exists(install / "update/staging/maps/a.map") && !fs::exists(install / "update/staging/maps/a.map.part"));
+		CHECK(!fs::exists(install / "update/pending.txt"));
+
+		// Without ranges, a partial file is downloaded again from the start
+		transport->CorruptPath.clear();
+		transport->DropAfter = 40000;
+		CHECK(!engine.Run(*transport));
+		CHECK(fs::file_size(install / "update/staging/maps/a.map.part") == 40000);
+		CHECK(engine.Run(*transport) && engine.GetProgress().State == UpdateState::Staged);
+		transport->SupportsRanges = true;
+
+		// Rolled back when a file can't be replaced: a directory blocks the backup of the second file
+		WriteFile(server / "mtndew.dll", "newest dll");
+		transport->MakeManifest({ "mtndew.dll", "maps/a.map" }, "0.9");
+		CHECK(engine.Run(*transport) && engine.GetProgress().FilesToDownload == 2);
+		auto oldA = ReadFile(install / "maps/a.map");
+		fs::create_directories(install / "update/backup/mtndew.dll/blocker");
+		CHECK(!UpdateEngine::InstallStaged(install.string(), &error));
+		CHECK(!error.empty());
+		CHECK(ReadFile(install / "mtndew.dll") == "new dll!!" && ReadFile(install / "maps/a.map") == oldA);
+		CHECK(!fs::exists(install / "update/installing.txt") && !fs::exists(install / "update/staging"));
+
+		// Rolled back after a crash part way through an install: do the first swap by hand, as if the game died after it
+		CHECK(engine.Run(*transport) && engine.GetProgress().State == UpdateState::Staged);
+		fs::rename(install / "update/pending.txt", install / "update/installing.txt");
+		fs::create_directories(install / "update/backup/maps");
+		fs::rename(install / "maps/a.map", install / "update/backup/maps/a.map");
+		fs::rename(install / "update/staging/maps/a.map", install / "maps/a.map");
+		CHECK(!UpdateEngine::InstallStaged(install.string(), &error));
+		CHECK(ReadFile(install / "maps/a.map") == oldA && ReadFile(install / "mtndew.dll") == "new dll!!");
+
+		// And the update goes through after that
+		CHECK(engine.Run(*transport));
+		CHECK(UpdateEngine::InstallStaged(install.string(), &error));
+		CHECK(ReadFile(install / "mtndew.dll") == "newest dll" && ReadFile(install / "maps/a.map") == ReadFile(server / "maps/a.map"));
+
+		// Cancelling a background update keeps the partial file for next time
+		WriteFile(server / "maps/big.map", RandomData(random, 3000000));
+		auto slow = std::make_shared<SlowTransport>();
+		slow->Directory = server;
+		slow->MakeManifest({ "maps/big.map" }, "1.0");
+		engine.Start(slow);
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		CHECK(engine.IsRunning());
+		engine.Cancel();
+		CHECK(!engine.IsRunning() && engine.GetProgress().State == UpdateState::Cancelled);
+		auto partialSize = fs::file_size(install / "update/staging/maps/big.map.part");
+		CHECK(partialSize > 0 && partialSize < 3000000);
+
+		transport->Manifest = slow->Manifest;
+		transport->Signature = slow->Signature;
+		transport->BytesSent = 0;
+		engine.Start(transport);
+		while (engine.IsRunning())
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		CHECK(engine.GetProgress().State == UpdateState::Staged);
+		CHECK(transport->BytesSent == 3000000 - partialSize);
+	}
+}
+
+int main()
+{
+	auto root = fs::temp_directory_path() / fs::unique_path("UpdateEngineTest-%%%%-%%%%");
+	TestManifest();
+	TestSignature();
+	TestUpdate(root);
+	fs::remove_all(root);
+	return TEST_RESULT();
+}
@@ -0,0 +1,180 @@
+#include "Test.hpp"
+#include "../Source/Web/Ui/VotingState.hpp"
+#include "../Source/ThirdParty/rapidjson/document.h"
+#include <cstring>
+#include <map>
+
+using namespace Server::Voting;
+using Web::Ui::Voting::VotingStateModel;
+using Web::Ui::Voting::VotingUpdate;
+
+namespace
+{
+	VotingMessage Options(int voteTime, std::initializer_list<const char*> maps)
+	{
+		VotingMessage message(VotingMessageType::VotingOptions);
+		message.voteTime = voteTime;
+		auto i = 0;
+		for (auto map : maps)
+		{
+			strncpy(message.votingOptions[i].mapName, map, sizeof(message.votingOptions[i].mapName) - 1);
+			strncpy(message.votingOptions[i].typeName, "Slayer", sizeof(message.votingOptions[i].typeName) - 1);
+			message.votingOptions[i].mapId = 320 + i;
+			i++;
+		}
+		return message;
+	}
+
+	VotingMessage Veto(int voteTime, const char *map, bool canVeto, int votesNeeded)
+	{
+		VotingMessage message(VotingMessageType::VetoOption);
+		message.voteTime = voteTime;
+		message.votesNeededToPass = votesNeeded;
+		strncpy(message.votingOptions[0].mapName, map, sizeof(message.votingOptions[0].mapName) - 1);
+		strncpy(message.votingOptions[0].typeName, "Slayer", sizeof(message.votingOptions[0].typeName) - 1);
+		message.votingOptions[0].canVeto = canVeto;
+		message.votingOptions[0].mapId = 340;
+		return message;
+	}
+
+	VotingMessage Tally(std::initializer_list<int> votes, int votesNeeded = 0)
+	{
+		VotingMessage message(VotingMessageType::VoteTally);
+		auto i = 0;
+		for (auto count : votes)
+			message.votes[i++] = count;
+		message.votesNeededToPass = votesNeeded;
+		return message;
+	}
+
+	VotingMessage Winner(int winner, int time)
+	{
+		VotingMessage message(VotingMessageType::Winner);
+		message.winner = winner;
+		message.voteTime = time;
+		return message;
+	}
+
+	// Applies one frame's worth of messages and returns the notifications sent at the end of the frame
+	std::vector<VotingUpdate> Frame(VotingStateModel &model, std::initializer_list<VotingMessage> messages)
+	{
+		for (auto &&message : messages)
+			model.Apply(message);
+		return model.Flush();
+	}
+
+	std::vector<std::string> Events(const std::vector<VotingUpdate> &updates)
+	{
+		std::vector<std::string> events;
+		for (auto &&update : updates)
+			events.push_back(update.Event);
+		return events;
+	}
+
+	// Parses a VoteCountsUpdated into option index -> count
+	std::map<int, int> Counts(const VotingUpdate &update, int *votesNeeded = nullptr)
+	{
+		rapidjson::Document document;
+		document.Parse<0>(update.Data.c_str());
+		std::map<int, int> counts;
+		for (auto it = document["voteCounts"].Begin(); it != document["voteCounts"].End(); ++it)
+			counts[(*it)["OptionIndex"].GetInt()] = (*it)["Count"].GetInt();
+		if (votesNeeded)
+			*votesNeeded = document["votesNeededToPass"].GetInt();
+		return counts;
+	}
+
+	// A map vote as a host sends it: the options, votes trickling in (some in the same frame), a player joining part
+	// way and getting the options re-sent, the winner, and then the next vote
+	void TestMapVote()
+	{
+		VotingStateModel model;
+		CHECK(!model.HasPendingUpdates() && model.Flush().empty());
+
+		auto options = Options(30, { "Guardian", "Valhalla", "Edge", "Reactor", "Revote" });
+		auto updates = Frame(model, { options });
+		CHECK((Events(updates) == std::vector<std::string>{ "VotingOptionsUpdated" }));
+		rapidjson::Document document;
+		document.Parse<0>(updates[0].Data.c_str());
+		CHECK(document["timeRemaining"].GetInt() == 30 && document["votingOptions"].Size() == 5);
+		CHECK(std::string(document["votingOptions"][1]["mapname"].GetString()) == "Valhalla");
+		CHECK(std::string(document["votingOptions"][0]["image"].GetString()) == "guardian");
+
+		// The same options again change nothing
+		CHECK(Frame(model, { options }).empty());
+
+		// One vote, then two in the same frame: only the options whose count changed are listed
+		updates = Frame(model, { Tally({ 1, 0, 0, 0, 0 }) });
+		CHECK(updates.size() == 1 && (Counts(updates[0]) == std::map<int, int>{ { 1, 1 } }));
+		updates = Frame(model, { Tally({ 1, 1, 0, 0, 0 }), Tally({ 1, 1, 0, 1, 0 }) });
+		CHECK(updates.size() == 1 && (Counts(updates[0]) == std::map<int, int>{ { 2, 1 }, { 4, 1 } }));
+
+		// A player changing their vote
+		updates = Frame(model, { Tally({ 0, 2, 0, 1, 0 }) });
+		CHECK(updates.size() == 1 && (Counts(updates[0]) == std::map<int, int>{ { 1, 0 }, { 2, 2 } }));
+
+		// A tally that changes nothing (the host re-sends it when a player joins)
+		CHECK(Frame(model, { Tally({ 0, 2, 0, 1, 0 }) }).empty());
+
+		// Options re-sent with less time while votes are in are passed on, the UI resets its timer and counts
+		updates = Frame(model, { Options(21, { "Guardian", "Valhalla", "Edge", "Reactor", "Revote" }), Tally({ 0, 2, 0, 1, 0 }) });
+		CHECK((Events(updates) == std::vector<std::string>{ "VotingOptionsUpdated", "VoteCountsUpdated" }));
+		CHECK((Counts(updates[1]) == std::map<int, int>{ { 2, 2 }, { 4, 1 } }));
+
+		updates = Frame(model, { Tally({ 0, 3, 0, 1, 0 }), Winner(2, 5) });
+		CHECK((Events(updates) == std::vector<std::string>{ "VoteCountsUpdated", "Winner" }));
+		document.Parse<0>(updates[1].Data.c_str());
+		CHECK(document["Winner"].GetInt() == 2 && document["timeUntilGameStart"].GetInt() == 5);
+		CHECK(Frame(model, { Winner(2, 5) }).empty());
+
+		// The next vote with the same maps still reaches the UI, which has to clear the winner and counts
+		updates = Frame(model, { options });
+		CHECK((Events(updates) == std::vector<std::string>{ "VotingOptionsUpdated" }));
+		updates = Frame(model, { Tally({ 0, 0, 1, 0, 0 }) });
+		CHECK(updates.size() == 1 && (Counts(updates[0]) == std::map<int, int>{ { 3, 1 } }));
+
+		// Votes for the old options that arrive in the same frame as new options start from the new ones
+		updates = Frame(model, { Tally({ 0, 0, 2, 0, 0 }), Options(30, { "Narrows", "Sandtrap", "Icebox", "Standoff", "Revote" }) });
+		CHECK((Events(updates) == std::vector<std::string>{ "VotingOptionsUpdated" }));
+		updates = Frame(model, { Tally({ 0, 0, 2, 0, 0 }) });
+		CHECK(updates.size() == 1 && (Counts(updates[0]) == std::map<int, int>{ { 3, 2 } }));
+	}
+
+	void TestVeto()
+	{
+		VotingStateModel model;
+		auto veto = Veto(20, "Valhalla", true, 3);
+		auto updates = Frame(model, { veto });
+		CHECK((Events(updates) == std::vector<std::string>{ "VetoOptionsUpdated" }));
+		rapidjson::Document document;
+		document.Parse<0>(updates[0].Data.c_str());
+		CHECK(document["votesNeededToPass"].GetInt() == 3 && document["vetoOption"]["canveto"].GetBool());
+		CHECK(Frame(model, { veto }).empty());
+
+		updates = Frame(model, { Tally({ 1, 0, 0, 0, 0 }, 3) });
+		CHECK(updates.size() == 1 && (Counts(updates[0]) == std::map<int, int>{ { 1, 1 } }));
+
+		// A player leaving lowers the votes needed without changing the count
+		int votesNeeded = 0;
+		updates = Frame(model, { Tally({ 1, 0, 0, 0, 0 }, 2) });
+		CHECK(updates.size() == 1 && Counts(updates[0], &votesNeeded).empty() && votesNeeded == 2);
+
+		// Vetoed: a new option that can't be vetoed
+		updates = Frame(model, { Tally({ 2, 0, 0, 0, 0 }, 2), Veto(10, "Guardian", false, 0) });
+		CHECK((Events(updates) == std::vector<std::string>{ "VetoOptionsUpdated" }));
+		document.Parse<0>(updates[0].Data.c_str());
+		CHECK(!document["vetoOption"]["canveto"].GetBool() && std::string(document["vetoOption"]["mapname"].GetString()) == "Guardian");
+
+		// Reset when the lobby ends, after which the same message is new again
+		model.Reset();
+		CHECK(!model.HasPendingUpdates());
+		CHECK((Events(Frame(model, { Veto(10, "Guardian", false, 0) })) == std::vector<std::string>{ "VetoOptionsUpdated" }));
+	}
+}
+
+int main()
+{
+	TestMapVote();
+	TestVeto();
+	return TEST_RESULT();
+}